@@ -0,0 +1,146 @@
+/**
+ * @file Benchmark.ino
+ * @author Paul Schlarmann (paul.schlarmann@makerspace-minden.de)
+ * @brief Measures espIOTLib overhead on the device and prints it to Serial
+ * @version 0.1
+ * @date 2026-10-16
+ * 
+ * @copyright Copyright (c) Paul Schlarmann 2023
+ * 
+ * Covers loop() overhead, render cost of the built-in pages (fetched over a loopback
+ * HTTP connection), publish throughput and the heap used per operation.
+ * Configure WiFi and MQTT through the portal once, the benchmark starts after the
+ * MQTT connection is up (or after BENCH_START_TIMEOUT without one) and repeats every BENCH_PERIOD.
+ * Build with ESP_IOTLIB_LOOP_PROFILING to get the per stage histograms as well.
+ */
+#include <Arduino.h>
+#ifdef ESP8266
+#include <ESP8266WiFi.h>
+#elif defined(ESP32)
+#include <WiFi.h>
+#endif
+#include <espIOTLib.h>
+
+#define BENCH_ITERATIONS 1000
+#define BENCH_PAGE_ITERATIONS 10
+#define BENCH_START_TIMEOUT 30000
+#define BENCH_PERIOD 60000
+
+espIOTLib iot("espIOTBench", "bench1");
+uint32_t lastRun = 0;
+bool firstRun = true;
+
+void report(const char *name, uint32_t iterations, uint32_t elapsedUs, int32_t heapDelta, uint32_t minFreeHeap){
+    Serial.printf("%-24s %6u x %9.2f us/op, heap delta %6d B (%7.2f B/op), min free %6u B\n",
+        name, iterations, (double)elapsedUs / iterations, heapDelta, (double)heapDelta / iterations, minFreeHeap);
+}
+
+void benchLoop(){
+    uint32_t heapBefore = ESP.getFreeHeap();
+    uint32_t minFree = heapBefore;
+    uint32_t start = micros();
+    for(uint32_t i = 0; i < BENCH_ITERATIONS; i++){
+        iot.loop();
+        uint32_t freeHeap = ESP.getFreeHeap();
+        if(freeHeap < minFree)
+            minFree = freeHeap;
+    }
+    report("loop()", BENCH_ITERATIONS, micros() - start, (int32_t)heapBefore - (int32_t)ESP.getFreeHeap(), minFree);
+}
+
+void benchPublish(){
+    char topic[48];
+    snprintf(topic, sizeof(topic), "%s/bench", iot.getIotWebConf()->getThingName());
+    uint32_t heapBefore = ESP.getFreeHeap();
+    uint32_t minFree = heapBefore;
+    uint32_t start = micros();
+    for(uint32_t i = 0; i < BENCH_ITERATIONS; i++){
+        iot.publishFloat(topic, i * 0.25);
+        uint32_t freeHeap = ESP.getFreeHeap();
+        if(freeHeap < minFree)
+            minFree = freeHeap;
+    }
+    report("publishFloat()", BENCH_ITERATIONS, micros() - start, (int32_t)heapBefore - (int32_t)ESP.getFreeHeap(), minFree);
+
+    heapBefore = ESP.getFreeHeap();
+    minFree = heapBefore;
+    start = micros();
+    for(uint32_t i = 0; i < BENCH_ITERATIONS; i++){
+        iot.publishInt(topic, i);
+        uint32_t freeHeap = ESP.getFreeHeap();
+        if(freeHeap < minFree)
+            minFree = freeHeap;
+    }
+    report("publishInt()", BENCH_ITERATIONS, micros() - start, (int32_t)heapBefore - (int32_t)ESP.getFreeHeap(), minFree);
+    // Let queued publishes drain before the next benchmark
+    for(uint16_t i = 0; i < 100; i++)
+        iot.loop();
+}
+
+// Fetch a page from our own web server, loop() has to run for the request to be served
+void benchPage(const char *uri){
+    IPAddress ip = (WiFi.getMode() & WIFI_STA) ? WiFi.localIP() : WiFi.softAPIP();
+    uint32_t heapBefore = ESP.getFreeHeap();
+    uint32_t minFree = heapBefore;
+    uint32_t bytes = 0;
+    uint32_t start = micros();
+    for(uint8_t i = 0; i < BENCH_PAGE_ITERATIONS; i++){
+        WiFiClient client;
+        if(!client.connect(ip, 80)){
+            Serial.printf("Could not connect to %s\n", ip.toString().c_str());
+            return;
+        }
+        client.printf("GET %s HTTP/1.1\r\nHost: %s\r\nConnection: close\r\n\r\n", uri, ip.toString().c_str());
+        uint32_t requestStart = millis();
+        while((client.connected() || client.available()) && millis() - requestStart < 5000){
+            iot.loop();
+            while(client.available()){
+                client.read();
+                bytes++;
+            }
+            uint32_t freeHeap = ESP.getFreeHeap();
+            if(freeHeap < minFree)
+                minFree = freeHeap;
+        }
+        client.stop();
+    }
+    report(uri, BENCH_PAGE_ITERATIONS, micros() - start, (int32_t)heapBefore - (int32_t)ESP.getFreeHeap(), minFree);
+    Serial.printf("%-24s %6u bytes per response\n", "", bytes / BENCH_PAGE_ITERATIONS);
+}
+
+void printLoopStages(){
+    for(uint8_t i = 0; i < ESP_IOTLIB_STAGE_COUNT; i++){
+        const espIOTLib_histogram *histogram = iot.getLoopHistogram((espIOTLib_loopStage)i);
+        if(!histogram)
+            return;
+        Serial.printf("stage %-17s %8u calls, mean %6u us, p99 %6u us, max %6u us\n", espIOTLib::loopStageName((espIOTLib_loopStage)i),
+            histogram->count(), histogram->mean(), histogram->percentile(99), histogram->max());
+    }
+}
+
+void setup(){
+    Serial.begin(115200);
+    iot.enableMQTT("broker.local", "", "");
+    iot.enableMQTTOutbox();
+    iot.start();
+}
+
+void loop(){
+    iot.loop();
+    bool ready = iot.isConnectedToWifi() && (iot.getMQTTState() == ESP_IOTLIB_MQTT_CONNECTED || millis() > BENCH_START_TIMEOUT);
+    if(!ready || (!firstRun && millis() - lastRun < BENCH_PERIOD))
+        return;
+    firstRun = false;
+    Serial.printf("\n--- espIOTLib benchmark, MQTT %s, free heap %u B ---\n",
+        espIOTLib::mqttStateName(iot.getMQTTState()), ESP.getFreeHeap());
+    benchLoop();
+    benchPublish();
+    benchPage("/");
+    benchPage("/espIOTWeb/status");
+    benchPage("/espIOTWeb/metrics");
+    printLoopStages();
+    const espIOTLib_stats &stats = iot.getStats();
+    Serial.printf("published %u, failed %u, dropped %u, slow loops %u\n",
+        stats.mqttPublished, stats.mqttPublishFails, stats.mqttPublishDropped, stats.slowLoops);
+    lastRun = millis();
+}
@@ -0,0 +1,40 @@
+/**
+ * @file DutyCycle.ino
+ * @author Paul Schlarmann (paul.schlarmann@makerspace-minden.de)
+ * @brief Battery sensor that wakes every 5 minutes, publishes one reading and goes back to deep sleep
+ * @version 0.1
+ * @date 2026-10-16
+ * 
+ * @copyright Copyright (c) Paul Schlarmann 2023
+ * 
+ * On an ESP8266 GPIO16 has to be connected to RST for the wake up.
+ * The phase times of each cycle are published with the next one to "sensor/dutyCycle".
+ */
+#include <Arduino.h>
+#include <espIOTLib.h>
+
+espIOTLib *iot;
+float temperature;
+
+// Before WiFi is started, the radio does not disturb the measurement
+void sample(espIOTLib_wakeReason reason){
+    temperature = analogRead(A0) * 0.1f;
+}
+
+void publish(){
+    iot->publishFloatQoS1("sensor/temperature", temperature);
+}
+
+void setup(){
+    iot = new espIOTLib("dutyCycle", "duty1");
+    iot->enableMQTT("broker.local", "", "");
+    iot->enableQoS1();
+    iot->enableFastConnect();
+    iot->enableDutyCycle(5 * 60 * 1000UL, sample, publish);
+    iot->setDutyCycleReportTopic("sensor/dutyCycle");
+    iot->start();
+}
+
+void loop(){
+    iot->loop();
+}
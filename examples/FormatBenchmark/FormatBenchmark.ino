@@ -0,0 +1,50 @@
+/**
+ * @file FormatBenchmark.ino
+ * @author Paul Schlarmann (paul.schlarmann@makerspace-minden.de)
+ * @brief Compares the payload formatters against the old snprintf/dtostrf path
+ * @version 0.1
+ * @date 2026-10-16
+ * 
+ * @copyright Copyright (c) Paul Schlarmann 2023
+ * 
+ * Prints CPU cycles per call (ESP.getCycleCount()) for each formatter and its printf
+ * based counterpart as used by publishInt/publishFloat before. No WiFi needed.
+ */
+#include <Arduino.h>
+#include <espIOTLib.h>
+
+#define BENCH_ITERATIONS 2000
+#define BENCH_BUFFER_LEN ESP_IOTLIB_MQTT_DATA_BUFFER_LEN
+
+char buffer[BENCH_BUFFER_LEN];
+volatile uint32_t sink = 0;
+
+// Inputs are varied per iteration so nothing gets folded into a constant
+#define BENCH(name, expr) do { \
+        uint32_t start = ESP.getCycleCount(); \
+        for(uint32_t i = 0; i < BENCH_ITERATIONS; i++){ \
+            expr; \
+            sink += buffer[0]; \
+        } \
+        uint32_t cycles = ESP.getCycleCount() - start; \
+        Serial.printf("%-34s %7u cycles/call  \"%s\"\n", name, cycles / BENCH_ITERATIONS, buffer); \
+    } while(0)
+
+void setup(){
+    Serial.begin(115200);
+    delay(500);
+    Serial.printf("\n--- Payload formatting, %u iterations, CPU %u MHz ---\n", BENCH_ITERATIONS, ESP.getCpuFreqMHz());
+
+    BENCH("snprintf(\"%d\", uint32_t)", snprintf(buffer, BENCH_BUFFER_LEN-1, "%d", 3000000000UL + i));
+    BENCH("espIOTLib_formatUInt", espIOTLib_formatUInt(buffer, BENCH_BUFFER_LEN, 3000000000UL + i));
+    BENCH("snprintf(\"%ld\", int32_t)", snprintf(buffer, BENCH_BUFFER_LEN-1, "%ld", (long)(-1234567 - (int32_t)i)));
+    BENCH("espIOTLib_formatInt", espIOTLib_formatInt(buffer, BENCH_BUFFER_LEN, -1234567 - (int32_t)i));
+    BENCH("snprintf(\"%lld\", int64_t)", snprintf(buffer, BENCH_BUFFER_LEN-1, "%lld", (long long)(-123456789012345LL - i)));
+    BENCH("espIOTLib_formatInt64", espIOTLib_formatInt64(buffer, BENCH_BUFFER_LEN, -123456789012345LL - i));
+    BENCH("dtostrf(double)", dtostrf(21.375 + i * 0.001, BENCH_BUFFER_LEN-1, ESP_IOTLIB_MQTT_FLOAT_PRECISION, buffer));
+    BENCH("espIOTLib_formatFloat(double)", espIOTLib_formatFloat(buffer, BENCH_BUFFER_LEN, 21.375 + i * 0.001, ESP_IOTLIB_MQTT_FLOAT_PRECISION));
+    BENCH("espIOTLib_formatFloat(float)", espIOTLib_formatFloat(buffer, BENCH_BUFFER_LEN, 21.375f + i * 0.001f, ESP_IOTLIB_MQTT_FLOAT_PRECISION));
+}
+
+void loop(){
+}
@@ -0,0 +1,62 @@
+/**
+ * @file SizeReport.ino
+ * @author Paul Schlarmann (paul.schlarmann@makerspace-minden.de)
+ * @brief Prints the RAM cost of espIOTLib and of each optional subsystem
+ * @version 0.1
+ * @date 2026-10-16
+ * 
+ * @copyright Copyright (c) Paul Schlarmann 2023
+ * 
+ * Static sizes come from sizeof(), the cost of each enable call is measured as heap delta.
+ * Build it once per configuration, e.g. with and without ESP_IOTLIB_NO_OTA / ESP_IOTLIB_NO_HTTP_UPDATE
+ * and ESP_IOTLIB_LOOP_PROFILING, and compare the numbers (and the RAM/flash summary of the build).
+ */
+#include <Arduino.h>
+#include <espIOTLib.h>
+
+void reportHeap(const char *step, uint32_t &lastFree){
+    uint32_t freeHeap = ESP.getFreeHeap();
+    Serial.printf("%-28s %6d B heap\n", step, (int32_t)lastFree - (int32_t)freeHeap);
+    lastFree = freeHeap;
+}
+
+void setup(){
+    Serial.begin(115200);
+    delay(1000);
+    Serial.println(F("--- espIOTLib size report ---"));
+#ifdef ESP_IOTLIB_NO_OTA
+    Serial.println(F("ESP_IOTLIB_NO_OTA"));
+#endif
+#ifdef ESP_IOTLIB_NO_HTTP_UPDATE
+    Serial.println(F("ESP_IOTLIB_NO_HTTP_UPDATE"));
+#endif
+#ifdef ESP_IOTLIB_LOOP_PROFILING
+    Serial.println(F("ESP_IOTLIB_LOOP_PROFILING"));
+#endif
+    Serial.printf("%-28s %6u B\n", "sizeof(espIOTLib)", (unsigned)sizeof(espIOTLib));
+    Serial.printf("%-28s %6u B\n", "sizeof(mqttConfig)", (unsigned)sizeof(espIOTLib_mqttConfig));
+    Serial.printf("%-28s %6u B\n", "sizeof(staticIPConfig)", (unsigned)sizeof(espIOTLib_staticIPConfig));
+    Serial.printf("%-28s %6u B\n", "sizeof(outboxEntry)", (unsigned)sizeof(espIOTLib_outboxEntry));
+    Serial.printf("%-28s %6u B\n", "sizeof(logEntry)", (unsigned)sizeof(espIOTLib_logEntry));
+
+    uint32_t lastFree = ESP.getFreeHeap();
+    espIOTLib *iot = new espIOTLib("sizeReport", "size1");
+    reportHeap("new espIOTLib", lastFree);
+    iot->configureStaticIP(IPAddress(192, 168, 1, 50), IPAddress(192, 168, 1, 1), IPAddress(255, 255, 255, 0), IPAddress(192, 168, 1, 1));
+    reportHeap("configureStaticIP()", lastFree);
+    iot->enableMQTT("broker.local", "", "");
+    reportHeap("enableMQTT()", lastFree);
+    iot->enableMQTTOutbox();
+    reportHeap("enableMQTTOutbox()", lastFree);
+    iot->enableLog();
+    reportHeap("enableLog()", lastFree);
+#ifndef ESP_IOTLIB_NO_OTA
+    iot->enableOTA("");
+    reportHeap("enableOTA()", lastFree);
+#endif
+    iot->start();
+    reportHeap("start()", lastFree);
+}
+
+void loop(){
+}
@@ -0,0 +1,100 @@
+/**
+ * @file formatCheck.cpp
+ * @author Paul Schlarmann (paul.schlarmann@makerspace-minden.de)
+ * @brief Host check of the publish number formatters against snprintf
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) Paul Schlarmann 2023
+ *
+ * Formats integers and floats with espIOTLib_format* and with snprintf and prints every value where the two differ.
+ * Floats are checked with every precision, over random bit patterns and the values above 2^24 / 10^precision
+ * where single precision scaling runs out of digits. Exits with 1 on the first mismatches.
+ *
+ *     g++ -O2 -std=gnu++17 -Isrc extras/formatCheck/formatCheck.cpp src/espIOTLib_format.cpp -o formatCheck
+ */
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include <random>
+
+#include "espIOTLib_format.h"
+
+#define CHECK_RANDOM_VALUES 2000000UL
+#define CHECK_MAX_ERRORS 20
+#define CHECK_BUFFER_LEN 48
+
+static const float checkFloats[] = {
+    0.0f, -0.0f, 0.5f, 1.5f, 2.5f, 0.125f, 0.0625f, -0.0004f, 21.5f, 1013.25f,
+    101325.5f, 123456.7f, 16777216.0f, 16777217.0f, 4294967296.0f, 1e15f, 3.4e10f
+};
+#define CHECK_FLOATS (sizeof(checkFloats) / sizeof(checkFloats[0]))
+
+static uint32_t errors = 0;
+static uint32_t checked = 0;
+
+static void compare(const char *what, const char *own, size_t ownLength, const char *reference){
+    checked++;
+    // snprintf prints "-0.000", the formatters drop the sign of zero
+    if(reference[0] == '-' && strspn(reference + 1, "0.") == strlen(reference + 1))
+        reference++;
+    if(ownLength == strlen(reference) && strcmp(own, reference) == 0)
+        return;
+    if(errors++ < CHECK_MAX_ERRORS)
+        printf("%-10s got \"%s\", snprintf \"%s\"\n", what, own, reference);
+}
+
+static void checkFloat(float value){
+    char own[CHECK_BUFFER_LEN];
+    char reference[CHECK_BUFFER_LEN];
+    for(uint8_t precision = 0; precision <= ESP_IOTLIB_FORMAT_MAX_PRECISION; precision++){
+        // Out of range for the 64 bit fixed point value
+        if(fabs((double)value) * pow(10, precision) >= 18446744073709551615.0)
+            continue;
+        size_t length = espIOTLib_formatFloat(own, CHECK_BUFFER_LEN, value, precision);
+        snprintf(reference, CHECK_BUFFER_LEN, "%.*f", precision, (double)value);
+        compare("float", own, length, reference);
+    }
+}
+
+static void checkInt(int64_t value){
+    char own[CHECK_BUFFER_LEN];
+    char reference[CHECK_BUFFER_LEN];
+    size_t length = espIOTLib_formatInt64(own, CHECK_BUFFER_LEN, value);
+    snprintf(reference, CHECK_BUFFER_LEN, "%lld", (long long)value);
+    compare("int64", own, length, reference);
+    length = espIOTLib_formatInt(own, CHECK_BUFFER_LEN, (int32_t)value);
+    snprintf(reference, CHECK_BUFFER_LEN, "%ld", (long)(int32_t)value);
+    compare("int32", own, length, reference);
+}
+
+int main(){
+    std::mt19937_64 random(42);
+
+    for(size_t i = 0; i < CHECK_FLOATS; i++)
+        checkFloat(checkFloats[i]);
+    for(uint32_t i = 0; i < CHECK_RANDOM_VALUES; i++){
+        uint32_t bits = (uint32_t)random();
+        float value;
+        memcpy(&value, &bits, sizeof(value));
+        if(isfinite(value))
+            checkFloat(value);
+    }
+    // Where float scaling loses digits: from 2^24 / 10^precision upwards
+    for(uint32_t i = 0; i < CHECK_RANDOM_VALUES; i++){
+        double exponent = 24 * log10(2.0) - ESP_IOTLIB_FORMAT_MAX_PRECISION + (random() % 1000000) / 1e6 * 16;
+        float value = (float)pow(10, exponent);
+        checkFloat(random() & 1 ? value : -value);
+    }
+
+    checkInt(0);
+    checkInt(INT64_MIN);
+    checkInt(INT64_MAX);
+    checkInt(INT32_MIN);
+    for(uint32_t i = 0; i < CHECK_RANDOM_VALUES; i++)
+        checkInt((int64_t)random() >> (random() % 64));
+
+    printf("%u values checked, %u mismatches\n", checked, errors);
+    return errors > 0 ? 1 : 0;
+}
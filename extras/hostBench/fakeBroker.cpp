@@ -0,0 +1,274 @@
+/**
+ * @file fakeBroker.cpp
+ * @author Paul Schlarmann (paul.schlarmann@makerspace-minden.de)
+ * @brief Loopback MQTT 3.1.1 broker for the host benchmark
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) Paul Schlarmann 2023
+ *
+ */
+
+// --- Includes ---
+#include "fakeBroker.h"
+
+#include <Arduino.h>
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+// --- Defines ---
+#define BROKER_POLL_MS 1
+#define BROKER_READ_LEN 4096
+
+// --- Private Functions ---
+bool fakeBroker::_send(session &client, const uint8_t *data, size_t length){
+    size_t sent = 0;
+    while(sent < length){
+        ssize_t n = send(client.fd, data + sent, length - sent, MSG_NOSIGNAL);
+        if(n > 0){
+            sent += n;
+            continue;
+        }
+        if(n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)){
+            struct pollfd pfd = {client.fd, POLLOUT, 0};
+            poll(&pfd, 1, 100);
+            continue;
+        }
+        return false;
+    }
+    return true;
+}
+
+static std::string packetString(const uint8_t *body, size_t length, size_t *pos){
+    if(*pos + 2 > length)
+        return std::string();
+    size_t stringLength = ((size_t)body[*pos] << 8) | body[*pos + 1];
+    *pos += 2;
+    if(*pos + stringLength > length)
+        stringLength = length - *pos;
+    std::string s((const char *)body + *pos, stringLength);
+    *pos += stringLength;
+    return s;
+}
+
+static bool filterMatches(const std::string &filter, const std::string &topic){
+    if(filter == "#" || filter == topic)
+        return true;
+    return filter.size() >= 2 && filter.compare(filter.size() - 2, 2, "/#") == 0 && topic.compare(0, filter.size() - 1, filter, 0, filter.size() - 1) == 0;
+}
+
+static std::vector<uint8_t> publishPacket(const std::string &topic, const std::string &payload){
+    std::vector<uint8_t> packet;
+    size_t remaining = 2 + topic.size() + payload.size();
+    packet.push_back(0x30);
+    do {
+        uint8_t digit = remaining % 128;
+        remaining /= 128;
+        packet.push_back(remaining > 0 ? digit | 0x80 : digit);
+    } while(remaining > 0);
+    packet.push_back(topic.size() >> 8);
+    packet.push_back(topic.size() & 0xff);
+    packet.insert(packet.end(), topic.begin(), topic.end());
+    packet.insert(packet.end(), payload.begin(), payload.end());
+    return packet;
+}
+
+void fakeBroker::_route(const std::string &topic, const std::string &payload){
+    std::vector<uint8_t> packet;
+    for(session &client : this->_sessions){
+        for(const std::string &filter : client.filters){
+            if(!filterMatches(filter, topic))
+                continue;
+            if(packet.empty())
+                packet = publishPacket(topic, payload);
+            _send(client, packet.data(), packet.size());
+            break;
+        }
+    }
+}
+
+bool fakeBroker::_handle(session &client, uint8_t header, const uint8_t *body, size_t length){
+    switch(header >> 4)
+    {
+    case 1: { // CONNECT
+        const uint8_t connack[4] = {0x20, 0x02, 0x00, 0x00};
+        client.connected = true;
+        client.filters.clear();
+        this->_connects++;
+        return _send(client, connack, sizeof(connack));
+    }
+    case 3: { // PUBLISH
+        uint8_t qos = (header >> 1) & 0x03;
+        size_t pos = 0;
+        std::string topic = packetString(body, length, &pos);
+        if(qos > 0 && pos + 2 <= length){
+            const uint8_t puback[4] = {0x40, 0x02, body[pos], body[pos + 1]};
+            pos += 2;
+            this->_qos1Publishes++;
+            if(!_send(client, puback, sizeof(puback)))
+                return false;
+        }
+        std::string payload((const char *)body + pos, length - pos);
+        this->_publishes++;
+        this->_payloadBytes += payload.size();
+        this->_route(topic, payload);
+        return true;
+    }
+    case 8: { // SUBSCRIBE
+        if(length < 2)
+            return false;
+        std::vector<uint8_t> suback = {0x90, 0x00, body[0], body[1]};
+        size_t pos = 2;
+        while(pos < length){
+            client.filters.push_back(packetString(body, length, &pos));
+            pos++; // Requested QoS, 0 is granted
+            suback.push_back(0x00);
+        }
+        suback[1] = suback.size() - 2;
+        this->_subscribes++;
+        return _send(client, suback.data(), suback.size());
+    }
+    case 10: { // UNSUBSCRIBE
+        if(length < 2)
+            return false;
+        const uint8_t unsuback[4] = {0xb0, 0x02, body[0], body[1]};
+        return _send(client, unsuback, sizeof(unsuback));
+    }
+    case 12: { // PINGREQ
+        const uint8_t pingresp[2] = {0xd0, 0x00};
+        this->_pings++;
+        return _send(client, pingresp, sizeof(pingresp));
+    }
+    case 14: // DISCONNECT
+        return false;
+    default:
+        return true;
+    }
+}
+
+// Reads what is there and handles every complete packet, false once the client is gone
+bool fakeBroker::_process(session &client){
+    uint8_t buffer[BROKER_READ_LEN];
+    ssize_t n = recv(client.fd, buffer, sizeof(buffer), MSG_DONTWAIT);
+    if(n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK))
+        return false;
+    if(n > 0)
+        client.input.insert(client.input.end(), buffer, buffer + n);
+    size_t consumed = 0;
+    while(client.input.size() - consumed >= 2){
+        const uint8_t *packet = client.input.data() + consumed;
+        size_t available = client.input.size() - consumed;
+        size_t remaining = 0;
+        size_t pos = 1;
+        bool complete = false;
+        for(uint8_t shift = 0; pos < available && pos <= 4; shift += 7){
+            uint8_t digit = packet[pos++];
+            remaining |= (size_t)(digit & 0x7f) << shift;
+            if(!(digit & 0x80)){
+                complete = true;
+                break;
+            }
+        }
+        if(!complete || available - pos < remaining)
+            break;
+        if(!this->_handle(client, packet[0], packet + pos, remaining))
+            return false;
+        consumed += pos + remaining;
+    }
+    client.input.erase(client.input.begin(), client.input.begin() + consumed);
+    return true;
+}
+
+void fakeBroker::_run(){
+    hostHeapIgnoreThread();
+    while(this->_running){
+        std::vector<struct pollfd> fds;
+        fds.push_back({this->_listenFd, POLLIN, 0});
+        for(session &client : this->_sessions)
+            fds.push_back({client.fd, POLLIN, 0});
+        poll(fds.data(), fds.size(), BROKER_POLL_MS);
+
+        if(fds[0].revents & POLLIN){
+            int fd = accept(this->_listenFd, NULL, NULL);
+            if(fd >= 0){
+                int one = 1;
+                setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+                this->_sessions.push_back(session{fd, false, {}, {}});
+            }
+        }
+        bool drop = this->_dropClients.exchange(false);
+        for(size_t i = 0; i < this->_sessions.size(); ){
+            if(drop || !this->_process(this->_sessions[i])){
+                close(this->_sessions[i].fd);
+                this->_sessions.erase(this->_sessions.begin() + i);
+                continue;
+            }
+            i++;
+        }
+        std::vector<message> injected;
+        {
+            std::lock_guard<std::mutex> lock(this->_mutex);
+            injected.swap(this->_injected);
+        }
+        for(const message &m : injected)
+            this->_route(m.topic, m.payload);
+    }
+    for(session &client : this->_sessions)
+        close(client.fd);
+    this->_sessions.clear();
+}
+
+// --- Public Functions ---
+fakeBroker::fakeBroker() : _running(false), _dropClients(false), _connects(0), _publishes(0), _qos1Publishes(0),
+    _payloadBytes(0), _subscribes(0), _pings(0) {}
+
+fakeBroker::~fakeBroker(){
+    this->stop();
+}
+
+bool fakeBroker::start(uint16_t port){
+    this->_listenFd = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if(this->_listenFd < 0)
+        return false;
+    int one = 1;
+    setsockopt(this->_listenFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if(bind(this->_listenFd, (struct sockaddr *)&address, sizeof(address)) < 0 || listen(this->_listenFd, 8) < 0){
+        close(this->_listenFd);
+        this->_listenFd = -1;
+        return false;
+    }
+    this->_running = true;
+    this->_thread = std::thread(&fakeBroker::_run, this);
+    return true;
+}
+
+void fakeBroker::stop(){
+    if(!this->_running)
+        return;
+    this->_running = false;
+    this->_thread.join();
+    close(this->_listenFd);
+    this->_listenFd = -1;
+}
+
+void fakeBroker::publish(const char *topic, const char *payload){
+    std::lock_guard<std::mutex> lock(this->_mutex);
+    this->_injected.push_back(message{topic, payload});
+}
+
+void fakeBroker::dropClients(){
+    this->_dropClients = true;
+}
@@ -0,0 +1,85 @@
+/**
+ * @file fakeBroker.h
+ * @author Paul Schlarmann (paul.schlarmann@makerspace-minden.de)
+ * @brief Loopback MQTT 3.1.1 broker for the host benchmark
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) Paul Schlarmann 2023
+ *
+ * Runs on its own thread and is just enough for espIOTLib: CONNACK for every CONNECT, PUBACK for QoS 1,
+ * SUBACK with QoS 0 granted, PINGRESP, and publishes are forwarded to subscribers of the exact topic or a
+ * "#" filter. It counts what it receives, so the benchmark can check that nothing got lost.
+ */
+#ifndef HOSTBENCH_FAKEBROKER_H
+#define HOSTBENCH_FAKEBROKER_H
+
+// --- Includes ---
+#include <stdint.h>
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// --- Public Classes ---
+class fakeBroker
+{
+protected:
+    struct session{
+        int fd;
+        bool connected;
+        std::vector<uint8_t> input;
+        std::vector<std::string> filters;
+    };
+    struct message{
+        std::string topic;
+        std::string payload;
+    };
+
+    int _listenFd = -1;
+    std::thread _thread;
+    std::atomic<bool> _running;
+    std::vector<session> _sessions;
+    std::mutex _mutex;
+    std::vector<message> _injected;
+    std::atomic<bool> _dropClients;
+
+    std::atomic<uint32_t> _connects;
+    std::atomic<uint32_t> _publishes;
+    std::atomic<uint32_t> _qos1Publishes;
+    std::atomic<uint64_t> _payloadBytes;
+    std::atomic<uint32_t> _subscribes;
+    std::atomic<uint32_t> _pings;
+
+    void _run();
+    bool _process(session &client);
+    bool _handle(session &client, uint8_t header, const uint8_t *body, size_t length);
+    void _route(const std::string &topic, const std::string &payload);
+    static bool _send(session &client, const uint8_t *data, size_t length);
+
+public:
+    fakeBroker();
+    ~fakeBroker();
+
+    /**
+     * @brief Listen on 127.0.0.1:port and start the broker thread
+     */
+    bool start(uint16_t port);
+    void stop();
+
+    // Queue a publish to the subscribers, sent from the broker thread
+    void publish(const char *topic, const char *payload);
+    // Close all client connections on the next pass, to exercise the reconnect path
+    void dropClients();
+
+    uint32_t connectCount() { return this->_connects; }
+    uint32_t publishCount() { return this->_publishes; }
+    uint32_t qos1PublishCount() { return this->_qos1Publishes; }
+    uint64_t payloadBytes() { return this->_payloadBytes; }
+    uint32_t subscribeCount() { return this->_subscribes; }
+    uint32_t pingCount() { return this->_pings; }
+};
+
+#endif /* HOSTBENCH_FAKEBROKER_H */
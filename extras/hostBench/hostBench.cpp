@@ -0,0 +1,206 @@
+/**
+ * @file hostBench.cpp
+ * @author Paul Schlarmann (paul.schlarmann@makerspace-minden.de)
+ * @brief Host build of espIOTLib with a loopback broker, benchmarks loop(), pages and publishing
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) Paul Schlarmann 2023
+ *
+ * Builds src/ unchanged as an ESP8266 target against the stand-ins in shims/ (Arduino core, WiFi, WebServer,
+ * IotWebConf, ArduinoOTA, MQTTClient, LittleFS, lwIP raw API) and talks MQTT to fakeBroker over 127.0.0.1.
+ * Every allocation through operator new is counted, so the allocs/op and bytes/op columns show what the
+ * library allocates per call; live is the net heap growth over the whole run. Times are host times, only
+ * the ratios and the allocation counts carry over to a device. Exits non-zero if a publish gets lost or a
+ * page does not render, so it also runs as a test.
+ *
+ *     cmake -S extras/hostBench -B build/hostBench && cmake --build build/hostBench && build/hostBench/hostBench [iterations]
+ *
+ * hostBenchProfiling is the same with ESP_IOTLIB_LOOP_PROFILING and prints the per stage loop() histograms.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <espIOTLib.h>
+
+#include "fakeBroker.h"
+
+#define BENCH_DEFAULT_ITERATIONS 10000UL
+#define BENCH_CONNECT_TIMEOUT 5000UL
+#define BENCH_DRAIN_TIMEOUT 5000UL
+
+// Counts the bytes of a rendered page and drops them
+class benchSink : public Print
+{
+public:
+    size_t bytes = 0;
+
+    size_t write(uint8_t) override { this->bytes++; return 1; }
+    size_t write(const uint8_t *buffer, size_t size) override { (void)buffer; this->bytes += size; return size; }
+};
+
+struct benchMark{
+    uint32_t start;
+    hostHeapCounters heap;
+};
+
+static espIOTLib iot("espIOTBench", "bench1");
+static fakeBroker broker;
+
+static benchMark benchBegin(){
+    benchMark mark;
+    mark.heap = hostHeap();
+    mark.start = micros();
+    return mark;
+}
+
+static void benchReport(const char *name, unsigned long iterations, const benchMark &mark){
+    uint32_t elapsed = micros() - mark.start;
+    const hostHeapCounters &heap = hostHeap();
+    printf("%-24s %8lu %10.3f %10.2f %10.1f %8lld\n", name, iterations, (double)elapsed / iterations,
+        (double)(heap.allocations - mark.heap.allocations) / iterations,
+        (double)(heap.allocatedBytes - mark.heap.allocatedBytes) / iterations,
+        (long long)(heap.liveBytes - mark.heap.liveBytes));
+}
+
+static void pump(){
+    iot.loop();
+    // The lwIP callbacks run between loop() calls, like the system tasks on the ESP8266
+    yield();
+}
+
+static bool waitFor(uint32_t published, uint32_t timeout){
+    uint32_t start = millis();
+    while(broker.publishCount() < published){
+        if(millis() - start > timeout)
+            return false;
+        pump();
+    }
+    return true;
+}
+
+static bool benchPage(const char *uri, unsigned long iterations){
+    benchSink sink;
+    int code = 0;
+    benchMark mark = benchBegin();
+    for(unsigned long i = 0; i < iterations; i++)
+        code = iot.getWebServer()->hostRequest(uri, sink);
+    benchReport(uri, iterations, mark);
+    if(code != 200 || sink.bytes == 0){
+        printf("FAIL: %s returned %d with %zu bytes\n", uri, code, sink.bytes);
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char **argv){
+    unsigned long iterations = argc > 1 ? strtoul(argv[1], NULL, 10) : BENCH_DEFAULT_ITERATIONS;
+    if(iterations == 0)
+        iterations = BENCH_DEFAULT_ITERATIONS;
+    bool ok = true;
+
+    if(!broker.start(ESP_IOTLIB_MQTT_PORT)){
+        printf("FAIL: broker could not listen on port %d\n", ESP_IOTLIB_MQTT_PORT);
+        return 1;
+    }
+    iot.enableMQTT("127.0.0.1", "", "");
+    iot.enableQoS1();
+    iot.start();
+
+    // The CONNACK has to be picked up by a later loop() than the one that sent CONNECT
+    uint32_t connectStart = millis();
+    bool connackWaited = false;
+    while(iot.getMQTTState() != ESP_IOTLIB_MQTT_CONNECTED){
+        if(millis() - connectStart > BENCH_CONNECT_TIMEOUT){
+            printf("FAIL: no MQTT connection, state %s\n", espIOTLib::mqttStateName(iot.getMQTTState()));
+            return 1;
+        }
+        pump();
+        connackWaited |= iot.getMQTTState() == ESP_IOTLIB_MQTT_CONNACK_WAIT;
+    }
+    printf("connected in %lu ms\n\n", (unsigned long)(millis() - connectStart));
+    if(!connackWaited){
+        printf("FAIL: connect did not pass through %s\n", espIOTLib::mqttStateName(ESP_IOTLIB_MQTT_CONNACK_WAIT));
+        ok = false;
+    }
+    printf("%-24s %8s %10s %10s %10s %8s\n", "benchmark", "ops", "us/op", "allocs/op", "bytes/op", "live");
+
+    benchMark mark = benchBegin();
+    for(unsigned long i = 0; i < iterations; i++)
+        pump();
+    benchReport("loop() idle", iterations, mark);
+
+    uint32_t published = broker.publishCount();
+    mark = benchBegin();
+    for(unsigned long i = 0; i < iterations; i++){
+        iot.publishFloat("bench/float", (float)i * 0.25f);
+        pump();
+    }
+    benchReport("publishFloat()", iterations, mark);
+    mark = benchBegin();
+    for(unsigned long i = 0; i < iterations; i++){
+        iot.publishInt("bench/int", (long)i);
+        pump();
+    }
+    benchReport("publishInt()", iterations, mark);
+    mark = benchBegin();
+    if(!waitFor(published + 2 * iterations, BENCH_DRAIN_TIMEOUT)){
+        printf("FAIL: broker received %lu of %lu publishes\n", (unsigned long)(broker.publishCount() - published), 2 * iterations);
+        ok = false;
+    }
+    benchReport("publish drain", 1, mark);
+
+    // QoS 1: a full window has to wait for PUBACKs, so this is throughput with acknowledgements
+    espIOTLib_inflight *inflight = iot.getQoS1Inflight();
+    uint32_t acked = inflight->ackedCount();
+    mark = benchBegin();
+    for(unsigned long i = 0; i < iterations; i++){
+        uint32_t start = millis();
+        while(!iot.publishFloatQoS1("bench/qos1", (float)i * 0.5f)){
+            if(millis() - start > BENCH_DRAIN_TIMEOUT)
+                break;
+            pump();
+        }
+        pump();
+    }
+    uint32_t start = millis();
+    while(inflight->depth() > 0 && millis() - start < BENCH_DRAIN_TIMEOUT)
+        pump();
+    benchReport("publishFloatQoS1()", iterations, mark);
+    if(inflight->ackedCount() - acked != iterations || inflight->depth() != 0){
+        printf("FAIL: %lu of %lu QoS 1 publishes acknowledged, %u still in flight\n", (unsigned long)(inflight->ackedCount() - acked),
+            iterations, (unsigned)inflight->depth());
+        ok = false;
+    }
+
+    // Out of the fixed point range, must be counted instead of vanishing
+    uint32_t dropped = iot.getStats().mqttPublishDropped;
+    iot.publishFloat("bench/range", 1e30);
+    if(iot.getStats().mqttPublishDropped != dropped + 1){
+        printf("FAIL: out of range float was not counted as dropped\n");
+        ok = false;
+    }
+
+    ok &= benchPage("/", iterations);
+    ok &= benchPage("/espIOTWeb/status", iterations);
+    ok &= benchPage("/espIOTWeb/metrics", iterations);
+
+    const espIOTLib_stats &stats = iot.getStats();
+    printf("\nbroker: %lu connects, %lu publishes, %llu payload bytes\n", (unsigned long)broker.connectCount(),
+        (unsigned long)broker.publishCount(), (unsigned long long)broker.payloadBytes());
+    printf("library: %lu published, %lu publish fails, %lu dropped, %lu loops, %lu slow, max %lu us\n", (unsigned long)stats.mqttPublished,
+        (unsigned long)stats.mqttPublishFails, (unsigned long)stats.mqttPublishDropped, (unsigned long)stats.loops,
+        (unsigned long)stats.slowLoops, (unsigned long)stats.loopMaxMicros);
+
+#ifdef ESP_IOTLIB_LOOP_PROFILING
+    printf("\n%-16s %10s %8s %8s %8s\n", "stage", "count", "mean", "p99", "max");
+    for(int stage = 0; stage < ESP_IOTLIB_STAGE_COUNT; stage++){
+        const espIOTLib_histogram *histogram = iot.getLoopHistogram((espIOTLib_loopStage)stage);
+        printf("%-16s %10lu %8lu %8lu %8lu\n", espIOTLib::loopStageName((espIOTLib_loopStage)stage), (unsigned long)histogram->count(),
+            (unsigned long)histogram->mean(), (unsigned long)histogram->percentile(99), (unsigned long)histogram->max());
+    }
+#endif
+
+    broker.stop();
+    return ok ? 0 : 1;
+}
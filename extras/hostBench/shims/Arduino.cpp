@@ -0,0 +1,382 @@
+/**
+ * @file Arduino.cpp
+ * @author Paul Schlarmann (paul.schlarmann@makerspace-minden.de)
+ * @brief Host stand-in for the ESP8266 Arduino core, only what espIOTLib uses
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) Paul Schlarmann 2023
+ *
+ */
+
+// --- Includes ---
+#include <Arduino.h>
+#include <ArduinoOTA.h>
+
+#include <arpa/inet.h>
+#include <atomic>
+#include <chrono>
+#include <new>
+#include <thread>
+
+// --- Defines ---
+#define HOST_HEAP_SIZE 81920
+#define HOST_RTC_MEMORY_LEN 512
+#define HOST_ALLOC_HEADER 16 // Keeps the alignment of malloc()
+
+// --- Public Vars ---
+HardwareSerial Serial;
+EspClass ESP;
+ArduinoOTAClass ArduinoOTA;
+
+// --- Private Vars ---
+static std::atomic<uint64_t> heapAllocations(0);
+static std::atomic<uint64_t> heapFrees(0);
+static std::atomic<uint64_t> heapAllocatedBytes(0);
+static std::atomic<int64_t> heapLiveBytes(0);
+static hostHeapCounters heapSnapshot;
+static const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+static uint8_t rtcMemory[HOST_RTC_MEMORY_LEN];
+static thread_local bool heapCounted = true;
+
+// Defined in lwip.cpp
+void hostLwipPoll();
+
+// --- Private Functions ---
+static void *countedAlloc(size_t size){
+    uint8_t *block = (uint8_t *)malloc(size + HOST_ALLOC_HEADER);
+    if(!block)
+        return NULL;
+    memcpy(block, &size, sizeof(size));
+    block[sizeof(size)] = heapCounted;
+    if(heapCounted){
+        heapAllocations++;
+        heapAllocatedBytes += size;
+        heapLiveBytes += size;
+    }
+    return block + HOST_ALLOC_HEADER;
+}
+
+static void countedFree(void *pointer){
+    if(!pointer)
+        return;
+    uint8_t *block = (uint8_t *)pointer - HOST_ALLOC_HEADER;
+    size_t size;
+    memcpy(&size, block, sizeof(size));
+    if(block[sizeof(size)]){
+        heapFrees++;
+        heapLiveBytes -= size;
+    }
+    free(block);
+}
+
+// --- Public Functions ---
+void *operator new(size_t size){
+    void *pointer = countedAlloc(size);
+    if(!pointer)
+        throw std::bad_alloc();
+    return pointer;
+}
+void *operator new[](size_t size){
+    return operator new(size);
+}
+void *operator new(size_t size, const std::nothrow_t &) noexcept{
+    return countedAlloc(size);
+}
+void *operator new[](size_t size, const std::nothrow_t &) noexcept{
+    return countedAlloc(size);
+}
+void operator delete(void *pointer) noexcept{
+    countedFree(pointer);
+}
+void operator delete[](void *pointer) noexcept{
+    countedFree(pointer);
+}
+void operator delete(void *pointer, size_t) noexcept{
+    countedFree(pointer);
+}
+void operator delete[](void *pointer, size_t) noexcept{
+    countedFree(pointer);
+}
+
+const hostHeapCounters &hostHeap(){
+    heapSnapshot.allocations = heapAllocations.load();
+    heapSnapshot.frees = heapFrees.load();
+    heapSnapshot.allocatedBytes = heapAllocatedBytes.load();
+    heapSnapshot.liveBytes = heapLiveBytes.load();
+    return heapSnapshot;
+}
+
+void hostHeapIgnoreThread(){
+    heapCounted = false;
+}
+
+unsigned long millis(){
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+unsigned long micros(){
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+// Like the ESP8266, the system tasks (here the lwIP callbacks) run while the sketch waits
+void delay(unsigned long ms){
+    uint32_t start = millis();
+    do {
+        yield();
+        if(ms > 0)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    } while(millis() - start < ms);
+}
+
+void yield(){
+    hostLwipPoll();
+}
+
+long random(long howBig){
+    return howBig > 0 ? ::random() % howBig : 0;
+}
+
+long random(long howSmall, long howBig){
+    return howBig > howSmall ? howSmall + random(howBig - howSmall) : howSmall;
+}
+
+void randomSeed(unsigned long seed){
+    srandom(seed);
+}
+
+char *dtostrf(double number, signed char width, unsigned char prec, char *s){
+    sprintf(s, "%*.*f", width, prec, number);
+    return s;
+}
+
+int analogRead(uint8_t pin){
+    return 512;
+}
+
+void pinMode(uint8_t pin, uint8_t mode){
+}
+
+int digitalRead(uint8_t pin){
+    return HIGH;
+}
+
+void digitalWrite(uint8_t pin, uint8_t value){
+}
+
+// --- String ---
+static std::string numberToString(unsigned long long value, uint8_t base, bool negative){
+    char buffer[66];
+    char *p = buffer + sizeof(buffer) - 1;
+    *p = '\0';
+    if(base < 2)
+        base = 10;
+    do {
+        uint8_t digit = value % base;
+        *--p = digit < 10 ? '0' + digit : 'A' + digit - 10;
+        value /= base;
+    } while(value);
+    if(negative)
+        *--p = '-';
+    return std::string(p);
+}
+
+String::String(int value, unsigned char base) : String((long)value, base) {}
+String::String(unsigned int value, unsigned char base) : String((unsigned long)value, base) {}
+String::String(long value, unsigned char base){
+    bool negative = value < 0 && base == 10;
+    this->_s = numberToString(negative ? -(unsigned long)value : (unsigned long)value, base, negative);
+}
+String::String(unsigned long value, unsigned char base){
+    this->_s = numberToString(value, base, false);
+}
+String::String(float value, unsigned char decimals) : String((double)value, decimals) {}
+String::String(double value, unsigned char decimals){
+    char buffer[64];
+    snprintf(buffer, sizeof(buffer), "%.*f", decimals, value);
+    this->_s = buffer;
+}
+
+int String::indexOf(char c, unsigned int from) const{
+    size_t index = this->_s.find(c, from);
+    return index == std::string::npos ? -1 : (int)index;
+}
+
+int String::indexOf(const String &s, unsigned int from) const{
+    size_t index = this->_s.find(s._s, from);
+    return index == std::string::npos ? -1 : (int)index;
+}
+
+String String::substring(unsigned int from, unsigned int to) const{
+    if(from > to)
+        std::swap(from, to);
+    if(from >= this->_s.size())
+        return String();
+    return String(this->_s.substr(from, to - from).c_str());
+}
+
+void String::trim(){
+    size_t start = this->_s.find_first_not_of(" \t\r\n");
+    size_t end = this->_s.find_last_not_of(" \t\r\n");
+    this->_s = start == std::string::npos ? std::string() : this->_s.substr(start, end - start + 1);
+}
+
+void String::toLowerCase(){
+    for(char &c : this->_s)
+        c = tolower(c);
+}
+
+String operator+(const String &a, const String &b){
+    String result(a);
+    result += b;
+    return result;
+}
+
+String operator+(const String &a, const char *b){
+    String result(a);
+    result += b;
+    return result;
+}
+
+// --- Print ---
+size_t Print::write(const uint8_t *buffer, size_t size){
+    size_t written = 0;
+    while(size--){
+        if(!this->write(*buffer++))
+            break;
+        written++;
+    }
+    return written;
+}
+
+size_t Print::_printNumber(unsigned long long value, uint8_t base, bool negative){
+    std::string s = numberToString(value, base, negative);
+    return this->write((const uint8_t *)s.data(), s.size());
+}
+
+size_t Print::print(long value, int base){
+    return this->print((long long)value, base);
+}
+
+size_t Print::print(long long value, int base){
+    if(base == 10 && value < 0)
+        return this->_printNumber(-(unsigned long long)value, base, true);
+    return this->_printNumber((unsigned long long)value, base, false);
+}
+
+size_t Print::print(double value, int digits){
+    char buffer[64];
+    int length = snprintf(buffer, sizeof(buffer), "%.*f", digits, value);
+    return this->write((const uint8_t *)buffer, length < (int)sizeof(buffer) ? length : sizeof(buffer) - 1);
+}
+
+// Same as the core: a stack buffer first, heap only for long output
+static size_t vprintTo(Print &p, const char *format, va_list args){
+    char buffer[64];
+    va_list copy;
+    va_copy(copy, args);
+    int length = vsnprintf(buffer, sizeof(buffer), format, copy);
+    va_end(copy);
+    if(length < 0)
+        return 0;
+    if(length < (int)sizeof(buffer))
+        return p.write((const uint8_t *)buffer, length);
+    char *heapBuffer = new char[length + 1];
+    vsnprintf(heapBuffer, length + 1, format, args);
+    size_t written = p.write((const uint8_t *)heapBuffer, length);
+    delete[] heapBuffer;
+    return written;
+}
+
+size_t Print::printf(const char *format, ...){
+    va_list args;
+    va_start(args, format);
+    size_t written = vprintTo(*this, format, args);
+    va_end(args);
+    return written;
+}
+
+size_t Print::printf_P(PGM_P format, ...){
+    va_list args;
+    va_start(args, format);
+    size_t written = vprintTo(*this, format, args);
+    va_end(args);
+    return written;
+}
+
+size_t Stream::readBytes(char *buffer, size_t length){
+    size_t count = 0;
+    uint32_t start = millis();
+    while(count < length && millis() - start < this->_timeout){
+        int c = this->read();
+        if(c < 0){
+            yield();
+            continue;
+        }
+        buffer[count++] = (char)c;
+    }
+    return count;
+}
+
+// --- IPAddress ---
+bool IPAddress::fromString(const char *address){
+    struct in_addr parsed;
+    if(!address || inet_pton(AF_INET, address, &parsed) != 1)
+        return false;
+    memcpy(this->_address, &parsed.s_addr, 4);
+    return true;
+}
+
+String IPAddress::toString() const{
+    char buffer[16];
+    snprintf(buffer, sizeof(buffer), "%u.%u.%u.%u", this->_address[0], this->_address[1], this->_address[2], this->_address[3]);
+    return String(buffer);
+}
+
+size_t IPAddress::printTo(Print &p) const{
+    return p.print(this->toString());
+}
+
+// --- EspClass ---
+uint32_t EspClass::getFreeHeap(){
+    int64_t live = heapLiveBytes.load();
+    return live >= HOST_HEAP_SIZE ? 0 : HOST_HEAP_SIZE - (uint32_t)(live > 0 ? live : 0);
+}
+
+void EspClass::getHeapStats(uint32_t *freeHeap, uint32_t *maxBlock, uint8_t *fragmentation){
+    if(freeHeap)
+        *freeHeap = this->getFreeHeap();
+    if(maxBlock)
+        *maxBlock = this->getFreeHeap();
+    if(fragmentation)
+        *fragmentation = 0;
+}
+
+rst_info *EspClass::getResetInfoPtr(){
+    static rst_info info = {REASON_DEFAULT_RST};
+    return &info;
+}
+
+bool EspClass::rtcUserMemoryRead(uint32_t offset, uint32_t *data, size_t size){
+    if(offset * 4 + size > HOST_RTC_MEMORY_LEN)
+        return false;
+    memcpy(data, rtcMemory + offset * 4, size);
+    return true;
+}
+
+bool EspClass::rtcUserMemoryWrite(uint32_t offset, uint32_t *data, size_t size){
+    if(offset * 4 + size > HOST_RTC_MEMORY_LEN)
+        return false;
+    memcpy(rtcMemory + offset * 4, data, size);
+    return true;
+}
+
+void EspClass::deepSleep(uint64_t micros, int mode){
+    fprintf(stderr, "ESP.deepSleep(%llu) on the host, exiting\n", (unsigned long long)micros);
+    exit(0);
+}
+
+void EspClass::restart(){
+    fprintf(stderr, "ESP.restart() on the host, exiting\n");
+    exit(0);
+}
@@ -0,0 +1,269 @@
+/**
+ * @file Arduino.h
+ * @author Paul Schlarmann (paul.schlarmann@makerspace-minden.de)
+ * @brief Host stand-in for the ESP8266 Arduino core, only what espIOTLib uses
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) Paul Schlarmann 2023
+ *
+ * Flash strings are plain strings, the heap figures come from the counting operator new in Arduino.cpp
+ * and the lwIP callbacks of lwip/ run from yield(), like the system tasks between two loop() calls on the device.
+ */
+#ifndef HOSTBENCH_ARDUINO_H
+#define HOSTBENCH_ARDUINO_H
+
+// --- Includes ---
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <math.h>
+
+#include <algorithm>
+#include <functional>
+#include <string>
+
+// --- Defines ---
+#define PROGMEM
+#define PGM_P const char *
+#define PSTR(s) (s)
+#define FPSTR(p) (reinterpret_cast<const __FlashStringHelper *>(p))
+#define F(s) FPSTR(PSTR(s))
+#define pgm_read_byte(addr) (*(const uint8_t *)(addr))
+#define pgm_read_word(addr) (*(const uint16_t *)(addr))
+#define pgm_read_dword(addr) (*(const uint32_t *)(addr))
+#define strlen_P strlen
+#define strcpy_P strcpy
+#define strncpy_P strncpy
+#define strcmp_P strcmp
+#define strncmp_P strncmp
+#define strstr_P strstr
+#define memcpy_P memcpy
+#define sprintf_P sprintf
+#define snprintf_P snprintf
+#define vsnprintf_P vsnprintf
+#define IRAM_ATTR
+#define ICACHE_RAM_ATTR
+#define RTC_DATA_ATTR
+
+#define LOW 0
+#define HIGH 1
+#define INPUT 0
+#define OUTPUT 1
+#define A0 17
+#define DEC 10
+#define HEX 16
+
+using std::min;
+using std::max;
+
+// --- Typedefs ---
+class __FlashStringHelper;
+
+// --- Public Functions ---
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void yield();
+long random(long howBig);
+long random(long howSmall, long howBig);
+void randomSeed(unsigned long seed);
+char *dtostrf(double number, signed char width, unsigned char prec, char *s);
+int analogRead(uint8_t pin);
+void pinMode(uint8_t pin, uint8_t mode);
+int digitalRead(uint8_t pin);
+void digitalWrite(uint8_t pin, uint8_t value);
+
+// Host only: counted by the replaced operator new/delete
+struct hostHeapCounters{
+    uint64_t allocations;
+    uint64_t frees;
+    uint64_t allocatedBytes;
+    int64_t liveBytes;
+};
+const hostHeapCounters &hostHeap();
+// Host only: allocations of the calling thread are not counted, for the fake broker
+void hostHeapIgnoreThread();
+
+// --- Public Classes ---
+class String
+{
+protected:
+    std::string _s;
+
+public:
+    String(const char *s = "") : _s(s ? s : "") {}
+    String(const String &other) = default;
+    String(String &&other) = default;
+    String(const __FlashStringHelper *s) : _s(s ? (const char *)s : "") {}
+    explicit String(char c) : _s(1, c) {}
+    explicit String(int value, unsigned char base = 10);
+    explicit String(unsigned int value, unsigned char base = 10);
+    explicit String(long value, unsigned char base = 10);
+    explicit String(unsigned long value, unsigned char base = 10);
+    explicit String(float value, unsigned char decimals = 2);
+    explicit String(double value, unsigned char decimals = 2);
+
+    String &operator=(const String &other) = default;
+    String &operator=(String &&other) = default;
+    String &operator=(const char *s) { this->_s = s ? s : ""; return *this; }
+
+    const char *c_str() const { return this->_s.c_str(); }
+    unsigned int length() const { return this->_s.size(); }
+    bool isEmpty() const { return this->_s.empty(); }
+    bool reserve(unsigned int size) { this->_s.reserve(size); return true; }
+    char charAt(unsigned int index) const { return index < this->_s.size() ? this->_s[index] : 0; }
+    char operator[](unsigned int index) const { return this->charAt(index); }
+    char &operator[](unsigned int index) { return this->_s[index]; }
+
+    bool concat(const String &s) { this->_s += s._s; return true; }
+    bool concat(const char *s) { if(s) this->_s += s; return true; }
+    bool concat(const char *s, unsigned int length) { if(s) this->_s.append(s, length); return true; }
+    bool concat(char c) { this->_s += c; return true; }
+    String &operator+=(const String &s) { this->concat(s); return *this; }
+    String &operator+=(const char *s) { this->concat(s); return *this; }
+    String &operator+=(const __FlashStringHelper *s) { this->concat((const char *)s); return *this; }
+    String &operator+=(char c) { this->concat(c); return *this; }
+    String &operator+=(int value) { this->concat(String(value)); return *this; }
+    String &operator+=(unsigned int value) { this->concat(String(value)); return *this; }
+    String &operator+=(long value) { this->concat(String(value)); return *this; }
+    String &operator+=(unsigned long value) { this->concat(String(value)); return *this; }
+
+    bool equals(const String &s) const { return this->_s == s._s; }
+    bool equals(const char *s) const { return this->_s == (s ? s : ""); }
+    bool operator==(const String &s) const { return this->equals(s); }
+    bool operator==(const char *s) const { return this->equals(s); }
+    bool operator!=(const String &s) const { return !this->equals(s); }
+    bool operator!=(const char *s) const { return !this->equals(s); }
+    bool operator<(const String &s) const { return this->_s < s._s; }
+    bool startsWith(const String &s) const { return this->_s.compare(0, s._s.size(), s._s) == 0; }
+    bool endsWith(const String &s) const { return this->_s.size() >= s._s.size() && this->_s.compare(this->_s.size() - s._s.size(), s._s.size(), s._s) == 0; }
+    int indexOf(char c, unsigned int from = 0) const;
+    int indexOf(const String &s, unsigned int from = 0) const;
+    String substring(unsigned int from) const { return this->substring(from, this->_s.size()); }
+    String substring(unsigned int from, unsigned int to) const;
+    void trim();
+    void toLowerCase();
+    long toInt() const { return atol(this->_s.c_str()); }
+    float toFloat() const { return atof(this->_s.c_str()); }
+};
+String operator+(const String &a, const String &b);
+String operator+(const String &a, const char *b);
+
+class Print;
+
+class Printable
+{
+public:
+    virtual ~Printable() {}
+    virtual size_t printTo(Print &p) const = 0;
+};
+
+class Print
+{
+protected:
+    size_t _printNumber(unsigned long long value, uint8_t base, bool negative);
+
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t *buffer, size_t size);
+    size_t write(const char *s) { return s ? this->write((const uint8_t *)s, strlen(s)) : 0; }
+    size_t write(const char *buffer, size_t size) { return this->write((const uint8_t *)buffer, size); }
+    virtual int availableForWrite() { return 0; }
+    virtual void flush() {}
+
+    size_t printf(const char *format, ...) __attribute__((format(printf, 2, 3)));
+    size_t printf_P(PGM_P format, ...) __attribute__((format(printf, 2, 3)));
+    size_t print(const __FlashStringHelper *s) { return this->write((const char *)s); }
+    size_t print(const String &s) { return this->write((const uint8_t *)s.c_str(), s.length()); }
+    size_t print(const char *s) { return this->write(s); }
+    size_t print(char c) { return this->write((uint8_t)c); }
+    size_t print(unsigned char value, int base = DEC) { return this->print((unsigned long)value, base); }
+    size_t print(int value, int base = DEC) { return this->print((long)value, base); }
+    size_t print(unsigned int value, int base = DEC) { return this->print((unsigned long)value, base); }
+    size_t print(long value, int base = DEC);
+    size_t print(unsigned long value, int base = DEC) { return this->_printNumber(value, base, false); }
+    size_t print(long long value, int base = DEC);
+    size_t print(unsigned long long value, int base = DEC) { return this->_printNumber(value, base, false); }
+    size_t print(double value, int digits = 2);
+    size_t print(const Printable &p) { return p.printTo(*this); }
+    size_t println() { return this->write("\r\n"); }
+    template<typename T> size_t println(const T &value) { size_t n = this->print(value); return n + this->println(); }
+    template<typename T> size_t println(const T &value, int format) { size_t n = this->print(value, format); return n + this->println(); }
+};
+
+class Stream : public Print
+{
+protected:
+    unsigned long _timeout = 1000;
+
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+    void setTimeout(unsigned long timeout) { this->_timeout = timeout; }
+    unsigned long getTimeout() const { return this->_timeout; }
+    virtual size_t readBytes(char *buffer, size_t length);
+    size_t readBytes(uint8_t *buffer, size_t length) { return this->readBytes((char *)buffer, length); }
+};
+
+// Serial goes to stdout
+class HardwareSerial : public Stream
+{
+public:
+    void begin(unsigned long baud) {}
+    size_t write(uint8_t c) override { return fwrite(&c, 1, 1, stdout); }
+    size_t write(const uint8_t *buffer, size_t size) override { return fwrite(buffer, 1, size, stdout); }
+    using Print::write;
+    int availableForWrite() override { return 256; }
+    int available() override { return 0; }
+    int read() override { return -1; }
+    int peek() override { return -1; }
+    void flush() override { fflush(stdout); }
+};
+extern HardwareSerial Serial;
+
+#include "IPAddress.h"
+
+struct rst_info{
+    uint32_t reason;
+};
+enum rst_reason {
+    REASON_DEFAULT_RST = 0,
+    REASON_WDT_RST,
+    REASON_EXCEPTION_RST,
+    REASON_SOFT_WDT_RST,
+    REASON_SOFT_RESTART,
+    REASON_DEEP_SLEEP_AWAKE,
+    REASON_EXT_SYS_RST
+};
+
+// Heap figures of an 80 KB ESP8266 heap, less what the host build has allocated through operator new
+class EspClass
+{
+public:
+    uint32_t getFreeHeap();
+    uint32_t getMaxFreeBlockSize() { return this->getFreeHeap(); }
+    uint8_t getHeapFragmentation() { return 0; }
+    void getHeapStats(uint32_t *freeHeap, uint32_t *maxBlock, uint8_t *fragmentation);
+    uint32_t getFreeContStack() { return 4096; }
+    uint32_t getFreeSketchSpace() { return 1024 * 1024; }
+    const char *getSdkVersion() { return "host"; }
+    uint8_t getCpuFreqMHz() { return 80; }
+    uint32_t getChipId() { return 0x00c0ffee; }
+    uint32_t getCycleCount() { return micros() * 80; }
+    rst_info *getResetInfoPtr();
+    String getResetReason() { return String("Host start"); }
+    bool rtcUserMemoryRead(uint32_t offset, uint32_t *data, size_t size);
+    bool rtcUserMemoryWrite(uint32_t offset, uint32_t *data, size_t size);
+    uint64_t deepSleepMax() { return 0xffffffffULL; }
+    void deepSleep(uint64_t micros, int mode = 0);
+    void restart();
+};
+extern EspClass ESP;
+
+#endif /* HOSTBENCH_ARDUINO_H */
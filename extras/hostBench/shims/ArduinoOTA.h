@@ -0,0 +1,40 @@
+/**
+ * @file ArduinoOTA.h
+ * @author Paul Schlarmann (paul.schlarmann@makerspace-minden.de)
+ * @brief Host stand-in for ArduinoOTA, handle() only counts its calls
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) Paul Schlarmann 2023
+ *
+ */
+#ifndef HOSTBENCH_ARDUINOOTA_H
+#define HOSTBENCH_ARDUINOOTA_H
+
+// --- Includes ---
+#include <Arduino.h>
+#include <functional>
+
+// --- Public Classes ---
+class ArduinoOTAClass
+{
+protected:
+    bool _started = false;
+    uint32_t _handled = 0;
+    std::function<void(void)> _onEnd;
+
+public:
+    void setPort(uint16_t port) {}
+    void setHostname(const char *hostname) {}
+    void setPassword(const char *password) {}
+    void setPasswordHash(const char *password) {}
+    void onEnd(std::function<void(void)> callback) { this->_onEnd = callback; }
+    void begin(bool useMDNS = true) { this->_started = true; }
+    void handle() { this->_handled++; }
+    // Host only
+    bool started() { return this->_started; }
+    uint32_t handleCount() { return this->_handled; }
+};
+extern ArduinoOTAClass ArduinoOTA;
+
+#endif /* HOSTBENCH_ARDUINOOTA_H */
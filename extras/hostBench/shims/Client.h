@@ -0,0 +1,36 @@
+/**
+ * @file Client.h
+ * @author Paul Schlarmann (paul.schlarmann@makerspace-minden.de)
+ * @brief Host stand-in for the ESP8266 core's Client interface
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) Paul Schlarmann 2023
+ *
+ */
+#ifndef HOSTBENCH_CLIENT_H
+#define HOSTBENCH_CLIENT_H
+
+// --- Includes ---
+#include <Arduino.h>
+
+// --- Public Classes ---
+class Client : public Stream
+{
+public:
+    virtual int connect(IPAddress ip, uint16_t port) = 0;
+    virtual int connect(const char *host, uint16_t port) = 0;
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t *buffer, size_t size) = 0;
+    using Print::write;
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int read(uint8_t *buffer, size_t size) = 0;
+    virtual int peek() = 0;
+    virtual bool flush(unsigned int maxWaitMs = 0) = 0;
+    virtual bool stop(unsigned int maxWaitMs = 0) = 0;
+    virtual uint8_t connected() = 0;
+    virtual operator bool() = 0;
+};
+
+#endif /* HOSTBENCH_CLIENT_H */
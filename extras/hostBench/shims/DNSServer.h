@@ -0,0 +1,22 @@
+/**
+ * @file DNSServer.h
+ * @author Paul Schlarmann (paul.schlarmann@makerspace-minden.de)
+ * @brief Host stand-in for the captive portal DNS server, never started on the host
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) Paul Schlarmann 2023
+ *
+ */
+#ifndef HOSTBENCH_DNSSERVER_H
+#define HOSTBENCH_DNSSERVER_H
+
+// --- Public Classes ---
+class DNSServer
+{
+public:
+    void processNextRequest() {}
+    void stop() {}
+};
+
+#endif /* HOSTBENCH_DNSSERVER_H */
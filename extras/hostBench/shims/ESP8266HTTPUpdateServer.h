@@ -0,0 +1,25 @@
+/**
+ * @file ESP8266HTTPUpdateServer.h
+ * @author Paul Schlarmann (paul.schlarmann@makerspace-minden.de)
+ * @brief Host stand-in for the HTTP firmware update server, registers nothing
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) Paul Schlarmann 2023
+ *
+ */
+#ifndef HOSTBENCH_ESP8266HTTPUPDATESERVER_H
+#define HOSTBENCH_ESP8266HTTPUPDATESERVER_H
+
+// --- Includes ---
+#include <ESP8266WebServer.h>
+
+// --- Public Classes ---
+class ESP8266HTTPUpdateServer
+{
+public:
+    void setup(ESP8266WebServer *server, const char *path = "/update") {}
+    void updateCredentials(const char *userName, const char *password) {}
+};
+
+#endif /* HOSTBENCH_ESP8266HTTPUPDATESERVER_H */
@@ -0,0 +1,168 @@
+/**
+ * @file ESP8266WebServer.cpp
+ * @author Paul Schlarmann (paul.schlarmann@makerspace-minden.de)
+ * @brief Host stand-in for ESP8266WebServer, requests are dispatched in-process
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) Paul Schlarmann 2023
+ *
+ */
+
+// --- Includes ---
+#include <ESP8266WebServer.h>
+
+// --- Private Functions ---
+static const char *statusText(int code){
+    switch(code)
+    {
+    case 200: return "OK";
+    case 302: return "Found";
+    case 304: return "Not Modified";
+    case 400: return "Bad Request";
+    case 404: return "Not Found";
+    case 500: return "Internal Server Error";
+    default: return "";
+    }
+}
+
+void ESP8266WebServer::_write(const char *data, size_t length){
+    if(this->_out && length > 0)
+        this->_out->write((const uint8_t *)data, length);
+}
+
+void ESP8266WebServer::_sendHeader(int code, const char *contentType, size_t contentLength){
+    char line[96];
+    this->_code = code;
+    int length = snprintf(line, sizeof(line), "HTTP/1.1 %d %s\r\n", code, statusText(code));
+    this->_write(line, length);
+    if(contentType){
+        length = snprintf(line, sizeof(line), "Content-Type: %s\r\n", contentType);
+        this->_write(line, length);
+    }
+    this->_chunked = contentLength == CONTENT_LENGTH_UNKNOWN;
+    if(this->_chunked){
+        this->_write("Transfer-Encoding: chunked\r\n", 28);
+    } else {
+        length = snprintf(line, sizeof(line), "Content-Length: %u\r\n", (unsigned)contentLength);
+        this->_write(line, length);
+    }
+    this->_write(this->_responseHeaders.c_str(), this->_responseHeaders.length());
+    this->_write("Connection: close\r\n\r\n", 21);
+    this->_responseHeaders = String();
+    this->_contentLength = CONTENT_LENGTH_NOT_SET;
+}
+
+// --- Public Functions ---
+void ESP8266WebServer::on(const String &uri, HTTPMethod method, THandlerFunction function){
+    this->_handlers.push_back(handler{uri, method, function});
+}
+
+String ESP8266WebServer::arg(const String &name){
+    for(const pair &arg : this->_args){
+        if(arg.name == name)
+            return arg.value;
+    }
+    return String();
+}
+
+bool ESP8266WebServer::hasArg(const String &name){
+    for(const pair &arg : this->_args){
+        if(arg.name == name)
+            return true;
+    }
+    return false;
+}
+
+String ESP8266WebServer::header(const String &name){
+    for(const pair &header : this->_requestHeaders){
+        if(header.name == name)
+            return header.value;
+    }
+    return String();
+}
+
+bool ESP8266WebServer::hasHeader(const String &name){
+    for(const pair &header : this->_requestHeaders){
+        if(header.name == name)
+            return true;
+    }
+    return false;
+}
+
+void ESP8266WebServer::sendHeader(const String &name, const String &value, bool first){
+    String line = name + ": " + value + "\r\n";
+    this->_responseHeaders = first ? line + this->_responseHeaders : this->_responseHeaders + line;
+}
+
+void ESP8266WebServer::send(int code, const char *contentType, const String &content){
+    size_t contentLength = this->_contentLength == CONTENT_LENGTH_NOT_SET ? content.length() : this->_contentLength;
+    this->_sendHeader(code, contentType, contentLength);
+    if(content.length() > 0)
+        this->sendContent(content.c_str(), content.length());
+}
+
+void ESP8266WebServer::send_P(int code, PGM_P contentType, PGM_P content, size_t contentLength){
+    this->_sendHeader(code, contentType, contentLength);
+    this->sendContent(content, contentLength);
+}
+
+// Chunked framing while the length is unknown, an empty chunk ends the response
+void ESP8266WebServer::sendContent(const char *content, size_t contentLength){
+    if(!this->_chunked){
+        this->_write(content, contentLength);
+        return;
+    }
+    char size[12];
+    int length = snprintf(size, sizeof(size), "%x\r\n", (unsigned)contentLength);
+    this->_write(size, length);
+    this->_write(content, contentLength);
+    this->_write("\r\n", 2);
+    if(contentLength == 0)
+        this->_chunked = false;
+}
+
+int ESP8266WebServer::hostRequest(const char *uri, Print &out, const char *headers[]){
+    this->_args.clear();
+    this->_requestHeaders.clear();
+    this->_responseHeaders = String();
+    this->_contentLength = CONTENT_LENGTH_NOT_SET;
+    this->_chunked = false;
+    this->_code = 0;
+    this->_out = &out;
+    this->_method = HTTP_GET;
+
+    const char *query = strchr(uri, '?');
+    this->_uri = query ? String(uri).substring(0, query - uri) : String(uri);
+    while(query && *query){
+        const char *start = query + 1;
+        const char *end = strchr(start, '&');
+        String item = end ? String(start).substring(0, end - start) : String(start);
+        int equals = item.indexOf('=');
+        if(item.length() > 0)
+            this->_args.push_back(pair{equals >= 0 ? item.substring(0, equals) : item, equals >= 0 ? item.substring(equals + 1) : String()});
+        query = end;
+    }
+    for(uint8_t i = 0; headers && headers[i]; i++){
+        String line(headers[i]);
+        int colon = line.indexOf(':');
+        if(colon < 0)
+            continue;
+        String value = line.substring(colon + 1);
+        value.trim();
+        this->_requestHeaders.push_back(pair{line.substring(0, colon), value});
+    }
+
+    bool handled = false;
+    for(const handler &handler : this->_handlers){
+        if(handler.uri == this->_uri && (handler.method == HTTP_ANY || handler.method == HTTP_GET)){
+            handler.function();
+            handled = true;
+            break;
+        }
+    }
+    if(!handled && this->_notFound)
+        this->_notFound();
+    this->_out = NULL;
+    return this->_code;
+}
@@ -0,0 +1,115 @@
+/**
+ * @file ESP8266WebServer.h
+ * @author Paul Schlarmann (paul.schlarmann@makerspace-minden.de)
+ * @brief Host stand-in for ESP8266WebServer, requests are dispatched in-process
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) Paul Schlarmann 2023
+ *
+ * There is no listening socket, hostRequest() runs the handler of a URI like handleClient() would for a
+ * GET request and writes the response, status line and headers included, to a Print. Chunked responses
+ * (CONTENT_LENGTH_UNKNOWN) are framed like on the device, so the byte counts match what goes over the air.
+ */
+#ifndef HOSTBENCH_ESP8266WEBSERVER_H
+#define HOSTBENCH_ESP8266WEBSERVER_H
+
+// --- Includes ---
+#include <Arduino.h>
+#include <WiFiClient.h>
+
+#include <vector>
+
+// --- Defines ---
+#define CONTENT_LENGTH_UNKNOWN ((size_t)-1)
+#define CONTENT_LENGTH_NOT_SET ((size_t)-2)
+
+// --- Typedefs ---
+enum HTTPMethod { HTTP_ANY, HTTP_GET, HTTP_HEAD, HTTP_POST, HTTP_PUT, HTTP_PATCH, HTTP_DELETE, HTTP_OPTIONS };
+
+// --- Public Classes ---
+class ESP8266WebServer
+{
+public:
+    typedef std::function<void(void)> THandlerFunction;
+
+protected:
+    struct handler{
+        String uri;
+        HTTPMethod method;
+        THandlerFunction function;
+    };
+    struct pair{
+        String name;
+        String value;
+    };
+    std::vector<handler> _handlers;
+    THandlerFunction _notFound;
+    std::vector<pair> _args;
+    std::vector<pair> _requestHeaders;
+    String _responseHeaders;
+    String _uri;
+    HTTPMethod _method = HTTP_GET;
+    Print *_out = NULL;
+    size_t _contentLength = CONTENT_LENGTH_NOT_SET;
+    bool _chunked = false;
+    int _code = 0;
+    WiFiClient _client;
+
+    void _sendHeader(int code, const char *contentType, size_t contentLength);
+    void _write(const char *data, size_t length);
+
+public:
+    ESP8266WebServer(int port = 80) {}
+
+    void begin() {}
+    void handleClient() {}
+    void on(const String &uri, THandlerFunction function) { this->on(uri, HTTP_ANY, function); }
+    void on(const String &uri, HTTPMethod method, THandlerFunction function);
+    void onNotFound(THandlerFunction function) { this->_notFound = function; }
+    void collectHeaders(const char *headerKeys[], size_t headerKeysCount) {}
+
+    String uri() { return this->_uri; }
+    HTTPMethod method() { return this->_method; }
+    WiFiClient &client() { return this->_client; }
+    String arg(const String &name);
+    String arg(int index) { return index < (int)this->_args.size() ? this->_args[index].value : String(); }
+    String argName(int index) { return index < (int)this->_args.size() ? this->_args[index].name : String(); }
+    int args() { return this->_args.size(); }
+    bool hasArg(const String &name);
+    String header(const String &name);
+    bool hasHeader(const String &name);
+
+    void setContentLength(size_t contentLength) { this->_contentLength = contentLength; }
+    void sendHeader(const String &name, const String &value, bool first = false);
+    void send(int code, const char *contentType = NULL, const String &content = String());
+    void send(int code, const char *contentType, const char *content) { this->send(code, contentType, String(content)); }
+    void send_P(int code, PGM_P contentType, PGM_P content) { this->send(code, contentType, content); }
+    void send_P(int code, PGM_P contentType, PGM_P content, size_t contentLength);
+    void sendContent(const String &content) { this->sendContent(content.c_str(), content.length()); }
+    void sendContent(const char *content, size_t contentLength);
+    void sendContent_P(PGM_P content) { this->sendContent(content, strlen(content)); }
+    void sendContent_P(PGM_P content, size_t size) { this->sendContent(content, size); }
+    template<typename T> size_t streamFile(T &file, const String &contentType){
+        this->setContentLength(file.size());
+        this->send(200, contentType.c_str(), String());
+        char buffer[256];
+        size_t total = 0;
+        size_t length;
+        while((length = file.read((uint8_t *)buffer, sizeof(buffer))) > 0){
+            this->_write(buffer, length);
+            total += length;
+        }
+        return total;
+    }
+
+    /**
+     * @brief Host only: serve a GET request for uri, "?a=b&c=d" become the args
+     *
+     * @param headers "Name: value" lines of the request, NULL terminated, or NULL
+     * @return The status code sent by the handler, 0 if it sent nothing
+     */
+    int hostRequest(const char *uri, Print &out, const char *headers[] = NULL);
+};
+
+#endif /* HOSTBENCH_ESP8266WEBSERVER_H */
@@ -0,0 +1,72 @@
+/**
+ * @file ESP8266WiFi.h
+ * @author Paul Schlarmann (paul.schlarmann@makerspace-minden.de)
+ * @brief Host stand-in for the ESP8266 WiFi class, always connected through the host's network
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) Paul Schlarmann 2023
+ *
+ */
+#ifndef HOSTBENCH_ESP8266WIFI_H
+#define HOSTBENCH_ESP8266WIFI_H
+
+// --- Includes ---
+#include <Arduino.h>
+#include <WiFiClient.h>
+
+// --- Typedefs ---
+typedef enum {
+    WIFI_OFF = 0,
+    WIFI_STA = 1,
+    WIFI_AP = 2,
+    WIFI_AP_STA = 3
+} WiFiMode_t;
+
+typedef enum {
+    WL_IDLE_STATUS = 0,
+    WL_NO_SSID_AVAIL = 1,
+    WL_CONNECTED = 3,
+    WL_CONNECT_FAILED = 4,
+    WL_DISCONNECTED = 6
+} wl_status_t;
+
+// --- Public Classes ---
+class ESP8266WiFiClass
+{
+protected:
+    WiFiMode_t _mode = WIFI_STA;
+    bool _connected = true;
+
+public:
+    bool mode(WiFiMode_t mode) { this->_mode = mode; return true; }
+    WiFiMode_t getMode() { return this->_mode; }
+    bool persistent(bool persistent) { return true; }
+    bool setAutoReconnect(bool autoReconnect) { return true; }
+    bool config(IPAddress local, IPAddress gateway, IPAddress subnet, IPAddress dns1 = IPAddress(), IPAddress dns2 = IPAddress()) { return true; }
+    wl_status_t begin(const char *ssid, const char *password = NULL, int32_t channel = 0, const uint8_t *bssid = NULL, bool connect = true);
+    bool disconnect(bool wifiOff = false) { this->_connected = false; return true; }
+    bool isConnected() { return this->_connected; }
+    wl_status_t status() { return this->_connected ? WL_CONNECTED : WL_DISCONNECTED; }
+    bool forceSleepBegin(uint32_t sleepUs = 0) { this->_connected = false; return true; }
+    bool forceSleepWake() { return true; }
+
+    String SSID() { return String("host"); }
+    int32_t RSSI() { return -50; }
+    uint8_t *BSSID();
+    int32_t channel() { return 1; }
+    String macAddress() { return String("02:00:00:00:00:01"); }
+    uint8_t *macAddress(uint8_t *mac);
+    IPAddress localIP() { return IPAddress(127, 0, 0, 1); }
+    IPAddress subnetMask() { return IPAddress(255, 0, 0, 0); }
+    IPAddress gatewayIP() { return IPAddress(127, 0, 0, 1); }
+    IPAddress dnsIP(uint8_t index = 0) { return IPAddress(127, 0, 0, 53); }
+    IPAddress broadcastIP() { return IPAddress(127, 255, 255, 255); }
+    IPAddress softAPIP() { return IPAddress(127, 0, 0, 1); }
+
+    // Blocking getaddrinfo(), like the ESP8266 version waits for the DNS answer
+    int hostByName(const char *host, IPAddress &result, uint32_t timeoutMs = 10000);
+};
+extern ESP8266WiFiClass WiFi;
+
+#endif /* HOSTBENCH_ESP8266WIFI_H */
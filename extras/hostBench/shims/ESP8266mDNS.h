@@ -0,0 +1,14 @@
+/**
+ * @file ESP8266mDNS.h
+ * @author Paul Schlarmann (paul.schlarmann@makerspace-minden.de)
+ * @brief Host stand-in for the mDNS responder, espIOTLib only includes it
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) Paul Schlarmann 2023
+ *
+ */
+#ifndef HOSTBENCH_ESP8266MDNS_H
+#define HOSTBENCH_ESP8266MDNS_H
+
+#endif /* HOSTBENCH_ESP8266MDNS_H */
@@ -0,0 +1,39 @@
+/**
+ * @file IPAddress.h
+ * @author Paul Schlarmann (paul.schlarmann@makerspace-minden.de)
+ * @brief Host stand-in for the IPv4 IPAddress of the Arduino cores
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) Paul Schlarmann 2023
+ *
+ */
+#ifndef HOSTBENCH_IPADDRESS_H
+#define HOSTBENCH_IPADDRESS_H
+
+// --- Public Classes ---
+// The uint32_t form is the lwIP one: network byte order, first octet in the lowest byte
+class IPAddress : public Printable
+{
+protected:
+    uint8_t _address[4] = {0, 0, 0, 0};
+
+public:
+    IPAddress() {}
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) { this->_address[0] = a; this->_address[1] = b; this->_address[2] = c; this->_address[3] = d; }
+    IPAddress(uint32_t address) { memcpy(this->_address, &address, 4); }
+
+    bool fromString(const char *address);
+    bool fromString(const String &address) { return this->fromString(address.c_str()); }
+    String toString() const;
+    size_t printTo(Print &p) const override;
+
+    bool isSet() const { return (uint32_t)*this != 0; }
+    operator uint32_t() const { uint32_t address; memcpy(&address, this->_address, 4); return address; }
+    uint8_t operator[](int index) const { return this->_address[index]; }
+    uint8_t &operator[](int index) { return this->_address[index]; }
+    bool operator==(const IPAddress &other) const { return (uint32_t)*this == (uint32_t)other; }
+    bool operator!=(const IPAddress &other) const { return !(*this == other); }
+};
+
+#endif /* HOSTBENCH_IPADDRESS_H */
@@ -0,0 +1,77 @@
+/**
+ * @file IotWebConf.cpp
+ * @author Paul Schlarmann (paul.schlarmann@makerspace-minden.de)
+ * @brief Host stand-in for IotWebConf 3.x, boots without a stored config and connects right away
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) Paul Schlarmann 2023
+ *
+ */
+
+// --- Includes ---
+#include <IotWebConf.h>
+
+namespace iotwebconf {
+
+// --- Public Functions ---
+bool IotWebConf::init(){
+    if(this->_updateServerSetup)
+        this->_updateServerSetup("/firmware");
+    return false;
+}
+
+void IotWebConf::doLoop(){
+    switch(this->_state)
+    {
+    case Boot:
+        this->_state = Connecting;
+        if(this->_wifiConnectionHandler)
+            this->_wifiConnectionHandler(this->_ssid, this->_password);
+        else
+            WiFi.begin(this->_ssid, this->_password);
+        break;
+    case Connecting:
+        if(WiFi.isConnected()){
+            this->_state = OnLine;
+            if(this->_wifiConnectionCallback)
+                this->_wifiConnectionCallback();
+        }
+        break;
+    case OnLine:
+        // Modem sleep of the duty cycle, connect again
+        if(!WiFi.isConnected())
+            this->_state = Boot;
+        break;
+    default:
+        break;
+    }
+}
+
+// A plain form with the current values, enough to measure the page
+void IotWebConf::handleConfig(){
+    String page = F("<!DOCTYPE html><html><head><title>Config</title></head><body><form method='post'>");
+    for(ParameterGroup *group : this->_groups){
+        page += F("<fieldset><legend>");
+        page += group->label ? group->label : group->id;
+        page += F("</legend>");
+        for(Parameter *parameter : group->items){
+            page += F("<label>");
+            page += parameter->label;
+            page += F("</label><input name='");
+            page += parameter->id;
+            page += F("' value='");
+            page += parameter->valueBuffer;
+            page += F("'><br>");
+        }
+        page += F("</fieldset>");
+    }
+    page += F("<button type='submit'>Apply</button></form></body></html>");
+    this->_server->send(200, "text/html", page);
+}
+
+void IotWebConf::handleNotFound(){
+    this->_server->send(404, "text/plain", "Not found");
+}
+
+} // namespace iotwebconf
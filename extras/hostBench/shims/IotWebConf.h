@@ -0,0 +1,136 @@
+/**
+ * @file IotWebConf.h
+ * @author Paul Schlarmann (paul.schlarmann@makerspace-minden.de)
+ * @brief Host stand-in for IotWebConf 3.x, boots without a stored config and connects right away
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) Paul Schlarmann 2023
+ *
+ * init() reports no valid config, so espIOTLib loads its defaults. The first doLoop() hands the
+ * connection to the WiFi connection handler and the next one reports it up, like a station
+ * that got its address between two loops.
+ */
+#ifndef HOSTBENCH_IOTWEBCONF_H
+#define HOSTBENCH_IOTWEBCONF_H
+
+// --- Includes ---
+#include <Arduino.h>
+#include <DNSServer.h>
+#include <ESP8266WebServer.h>
+#include <ESP8266WiFi.h>
+
+#include <vector>
+
+// --- Defines ---
+#define WebServer ESP8266WebServer
+#define IOTWEBCONF_WORD_LEN 33
+#define IOTWEBCONF_PASSWORD_LEN 33
+
+namespace iotwebconf {
+
+// --- Typedefs ---
+typedef struct WifiAuthInfo{
+    char *ssid;
+    char *password;
+} WifiAuthInfo;
+
+enum NetworkState {
+    Boot,
+    NotConfigured,
+    ApMode,
+    Connecting,
+    OnLine,
+    OffLine
+};
+
+typedef std::function<void()> WifiConnectionCallback;
+typedef std::function<void(const char *ssid, const char *password)> WifiConnectionHandler;
+typedef std::function<WifiAuthInfo *()> WifiConnectionFailedHandler;
+typedef std::function<void(const char *updatePath)> UpdateServerSetupFunction;
+typedef std::function<void(const char *userName, char *password)> UpdateServerUpdateCredentialsFunction;
+
+// --- Public Classes ---
+class Parameter
+{
+public:
+    const char *label;
+    const char *id;
+    char *valueBuffer;
+    int length;
+    const char *defaultValue;
+
+    Parameter(const char *label, const char *id, char *valueBuffer, int length, const char *defaultValue = NULL)
+        : label(label), id(id), valueBuffer(valueBuffer), length(length), defaultValue(defaultValue) {}
+    virtual ~Parameter() {}
+};
+
+class TextParameter : public Parameter
+{
+public:
+    TextParameter(const char *label, const char *id, char *valueBuffer, int length, const char *defaultValue = NULL,
+        const char *placeholder = NULL, const char *customHtml = NULL) : Parameter(label, id, valueBuffer, length, defaultValue) {}
+};
+
+class PasswordParameter : public Parameter
+{
+public:
+    PasswordParameter(const char *label, const char *id, char *valueBuffer, int length, const char *defaultValue = NULL,
+        const char *placeholder = NULL, const char *customHtml = NULL) : Parameter(label, id, valueBuffer, length, defaultValue) {}
+};
+
+class ParameterGroup
+{
+public:
+    const char *id;
+    const char *label;
+    std::vector<Parameter *> items;
+
+    ParameterGroup(const char *id, const char *label = NULL) : id(id), label(label) {}
+    void addItem(Parameter *parameter) { this->items.push_back(parameter); }
+};
+
+class IotWebConf
+{
+protected:
+    const char *_thingName;
+    WebServer *_server;
+    NetworkState _state = Boot;
+    std::vector<ParameterGroup *> _groups;
+    WifiConnectionCallback _wifiConnectionCallback;
+    WifiConnectionHandler _wifiConnectionHandler;
+    UpdateServerSetupFunction _updateServerSetup;
+    char _ssid[IOTWEBCONF_WORD_LEN] = "host";
+    char _password[IOTWEBCONF_PASSWORD_LEN] = "";
+
+public:
+    IotWebConf(const char *thingName, DNSServer *dnsServer, WebServer *server, const char *initialApPassword, const char *configVersion = "init")
+        : _thingName(thingName), _server(server) {}
+
+    bool init();
+    void doLoop();
+    void handleConfig();
+    void handleNotFound();
+    bool handleCaptivePortal() { return false; }
+
+    void addParameterGroup(ParameterGroup *group) { this->_groups.push_back(group); }
+    void setWifiConnectionCallback(WifiConnectionCallback callback) { this->_wifiConnectionCallback = callback; }
+    void setWifiConnectionHandler(WifiConnectionHandler handler) { this->_wifiConnectionHandler = handler; }
+    void setWifiConnectionFailedHandler(WifiConnectionFailedHandler handler) {}
+    void setConfigSavedCallback(std::function<void()> callback) {}
+    void setupUpdateServer(UpdateServerSetupFunction setup, UpdateServerUpdateCredentialsFunction updateCredentials) { this->_updateServerSetup = setup; }
+    void setApTimeoutMs(unsigned long apTimeoutMs) {}
+    void setWifiConnectionTimeoutMs(unsigned long timeoutMs) {}
+    void setConfigPin(int pin) {}
+    void skipApStartup() {}
+    void goOffLine(bool sleep = true) { this->_state = OffLine; }
+    void goOnLine(bool apOnly = true) { this->_state = Boot; }
+
+    const char *getThingName() { return this->_thingName; }
+    NetworkState getState() { return this->_state; }
+    WifiAuthInfo getWifiAuthInfo() { return WifiAuthInfo{this->_ssid, this->_password}; }
+};
+
+} // namespace iotwebconf
+
+#endif /* HOSTBENCH_IOTWEBCONF_H */
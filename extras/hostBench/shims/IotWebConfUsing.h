@@ -0,0 +1,19 @@
+/**
+ * @file IotWebConfUsing.h
+ * @author Paul Schlarmann (paul.schlarmann@makerspace-minden.de)
+ * @brief Host stand-in for the IotWebConf aliases
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) Paul Schlarmann 2023
+ *
+ */
+#ifndef HOSTBENCH_IOTWEBCONFUSING_H
+#define HOSTBENCH_IOTWEBCONFUSING_H
+
+using iotwebconf::IotWebConf;
+typedef iotwebconf::ParameterGroup IotWebConfParameterGroup;
+typedef iotwebconf::TextParameter IotWebConfTextParameter;
+typedef iotwebconf::PasswordParameter IotWebConfPasswordParameter;
+
+#endif /* HOSTBENCH_IOTWEBCONFUSING_H */
@@ -0,0 +1,87 @@
+/**
+ * @file LittleFS.cpp
+ * @author Paul Schlarmann (paul.schlarmann@makerspace-minden.de)
+ * @brief Host stand-in for LittleFS, files live in memory for the run
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) Paul Schlarmann 2023
+ *
+ */
+
+// --- Includes ---
+#include <LittleFS.h>
+
+// --- Public Vars ---
+FS LittleFS;
+
+// --- Public Functions ---
+size_t File::write(const uint8_t *buffer, size_t size){
+    if(!this->_data || !this->_writable)
+        return 0;
+    if(this->_position + size > this->_data->size())
+        this->_data->resize(this->_position + size);
+    memcpy(this->_data->data() + this->_position, buffer, size);
+    this->_position += size;
+    return size;
+}
+
+int File::read(){
+    uint8_t c;
+    return this->read(&c, 1) == 1 ? c : -1;
+}
+
+size_t File::read(uint8_t *buffer, size_t size){
+    if(!this->_data || this->_position >= this->_data->size())
+        return 0;
+    size_t length = std::min(size, this->_data->size() - this->_position);
+    memcpy(buffer, this->_data->data() + this->_position, length);
+    this->_position += length;
+    return length;
+}
+
+int File::peek(){
+    if(!this->_data || this->_position >= this->_data->size())
+        return -1;
+    return (*this->_data)[this->_position];
+}
+
+bool File::seek(uint32_t position){
+    if(!this->_data || position > this->_data->size())
+        return false;
+    this->_position = position;
+    return true;
+}
+
+bool File::truncate(uint32_t size){
+    if(!this->_data || !this->_writable)
+        return false;
+    this->_data->resize(size);
+    if(this->_position > size)
+        this->_position = size;
+    return true;
+}
+
+File FS::open(const char *path, const char *mode){
+    auto existing = this->_files.find(path);
+    bool plus = strchr(mode, '+') != NULL;
+    if(mode[0] == 'r'){
+        if(existing == this->_files.end())
+            return File();
+        return File(existing->second, plus, false);
+    }
+    if(existing == this->_files.end() || mode[0] == 'w')
+        this->_files[path] = std::make_shared<std::vector<uint8_t>>();
+    return File(this->_files[path], true, mode[0] == 'a');
+}
+
+bool FS::rename(const char *from, const char *to){
+    auto existing = this->_files.find(from);
+    if(existing == this->_files.end())
+        return false;
+    if(strcmp(from, to) == 0)
+        return true;
+    this->_files[to] = existing->second;
+    this->_files.erase(from);
+    return true;
+}
@@ -0,0 +1,64 @@
+/**
+ * @file LittleFS.h
+ * @author Paul Schlarmann (paul.schlarmann@makerspace-minden.de)
+ * @brief Host stand-in for LittleFS, files live in memory for the run
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) Paul Schlarmann 2023
+ *
+ */
+#ifndef HOSTBENCH_LITTLEFS_H
+#define HOSTBENCH_LITTLEFS_H
+
+// --- Includes ---
+#include <Arduino.h>
+
+#include <map>
+#include <memory>
+#include <vector>
+
+// --- Public Classes ---
+class File : public Stream
+{
+protected:
+    std::shared_ptr<std::vector<uint8_t>> _data;
+    size_t _position = 0;
+    bool _writable = false;
+
+public:
+    File() {}
+    File(std::shared_ptr<std::vector<uint8_t>> data, bool writable, bool append) : _data(data), _position(append ? data->size() : 0), _writable(writable) {}
+
+    size_t write(uint8_t c) override { return this->write(&c, 1); }
+    size_t write(const uint8_t *buffer, size_t size) override;
+    using Print::write;
+    int available() override { return this->_data ? this->_data->size() - this->_position : 0; }
+    int read() override;
+    size_t read(uint8_t *buffer, size_t size);
+    int peek() override;
+    bool seek(uint32_t position);
+    size_t position() const { return this->_position; }
+    size_t size() const { return this->_data ? this->_data->size() : 0; }
+    bool truncate(uint32_t size);
+    void close() { this->_data.reset(); }
+    operator bool() const { return (bool)this->_data; }
+};
+
+class FS
+{
+protected:
+    std::map<std::string, std::shared_ptr<std::vector<uint8_t>>> _files;
+
+public:
+    bool begin() { return true; }
+    void end() {}
+    // "r", "r+", "w", "w+", "a" and "a+"
+    File open(const char *path, const char *mode);
+    bool exists(const char *path) { return this->_files.count(path) > 0; }
+    bool remove(const char *path) { return this->_files.erase(path) > 0; }
+    bool rename(const char *from, const char *to);
+};
+extern FS LittleFS;
+
+#endif /* HOSTBENCH_LITTLEFS_H */
@@ -0,0 +1,344 @@
+/**
+ * @file MQTT.cpp
+ * @author Paul Schlarmann (paul.schlarmann@makerspace-minden.de)
+ * @brief Host stand-in for arduino-mqtt's MQTTClient, MQTT 3.1.1 over any Client
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) Paul Schlarmann 2023
+ *
+ */
+
+// --- Includes ---
+#include <MQTT.h>
+
+// --- Defines ---
+#define MQTT_CONNECT 1
+#define MQTT_CONNACK 2
+#define MQTT_PUBLISH 3
+#define MQTT_PUBACK 4
+#define MQTT_SUBSCRIBE 8
+#define MQTT_SUBACK 9
+#define MQTT_UNSUBSCRIBE 10
+#define MQTT_UNSUBACK 11
+#define MQTT_PINGREQ 12
+#define MQTT_PINGRESP 13
+#define MQTT_DISCONNECT 14
+#define MQTT_FIXED_HEADER_MAX 5
+
+// --- Private Functions ---
+static size_t putRemainingLength(uint8_t *buffer, size_t length){
+    size_t pos = 0;
+    do {
+        uint8_t digit = length % 128;
+        length /= 128;
+        buffer[pos++] = length > 0 ? digit | 0x80 : digit;
+    } while(length > 0);
+    return pos;
+}
+
+static size_t putString(uint8_t *buffer, const char *s, size_t length){
+    buffer[0] = length >> 8;
+    buffer[1] = length & 0xff;
+    memcpy(buffer + 2, s, length);
+    return length + 2;
+}
+
+// Fixed header in front of a variable part already at _writeBuffer + MQTT_FIXED_HEADER_MAX
+static size_t frame(uint8_t *buffer, uint8_t header, size_t remaining){
+    uint8_t fixed[MQTT_FIXED_HEADER_MAX];
+    fixed[0] = header;
+    size_t fixedLength = 1 + putRemainingLength(fixed + 1, remaining);
+    memcpy(buffer + MQTT_FIXED_HEADER_MAX - fixedLength, fixed, fixedLength);
+    return fixedLength;
+}
+
+bool MQTTClient::_fail(lwmqtt_err_t error){
+    this->_lastError = error;
+    this->_close();
+    return false;
+}
+
+void MQTTClient::_close(){
+    this->_connected = false;
+    if(this->_netClient)
+        this->_netClient->stop();
+}
+
+uint16_t MQTTClient::_packetId(){
+    uint16_t id = this->_nextId++;
+    // espIOTLib's in-flight window numbers from 0x8000
+    if(this->_nextId >= 0x8000)
+        this->_nextId = 1;
+    return id;
+}
+
+bool MQTTClient::_readBytes(uint8_t *buffer, size_t length){
+    size_t got = 0;
+    uint32_t start = millis();
+    while(got < length){
+        int n = this->_netClient->read(buffer + got, length - got);
+        if(n > 0){
+            got += n;
+            continue;
+        }
+        if(!this->_netClient->connected())
+            return this->_fail(LWMQTT_NETWORK_FAILED_READ);
+        if(millis() - start >= this->_timeout)
+            return this->_fail(LWMQTT_NETWORK_TIMEOUT);
+        yield();
+    }
+    return true;
+}
+
+// Header byte of the next packet with its body in _readBuffer, 0 if nothing is there and wait is false, -1 on error
+int MQTTClient::_readPacket(size_t *length, bool wait){
+    if(!wait && this->_netClient->available() <= 0)
+        return 0;
+    uint8_t header;
+    if(!this->_readBytes(&header, 1))
+        return -1;
+    size_t remaining = 0;
+    for(uint8_t i = 0, shift = 0; ; i++, shift += 7){
+        uint8_t digit;
+        if(i == 4){
+            this->_fail(LWMQTT_VARNUM_OVERFLOW);
+            return -1;
+        }
+        if(!this->_readBytes(&digit, 1))
+            return -1;
+        remaining |= (size_t)(digit & 0x7f) << shift;
+        if(!(digit & 0x80))
+            break;
+    }
+    if(remaining > this->_bufferSize){
+        this->_fail(LWMQTT_BUFFER_TOO_SHORT);
+        return -1;
+    }
+    if(remaining > 0 && !this->_readBytes(this->_readBuffer, remaining))
+        return -1;
+    this->_readBuffer[remaining] = '\0';
+    *length = remaining;
+    return header;
+}
+
+bool MQTTClient::_handle(uint8_t header, size_t length){
+    switch(header >> 4)
+    {
+    case MQTT_PUBLISH: {
+        uint8_t qos = (header >> 1) & 0x03;
+        if(length < 2)
+            return this->_fail(LWMQTT_REMAINING_LENGTH_MISMATCH);
+        size_t topicLength = ((size_t)this->_readBuffer[0] << 8) | this->_readBuffer[1];
+        size_t payloadStart = 2 + topicLength + (qos > 0 ? 2 : 0);
+        if(payloadStart > length)
+            return this->_fail(LWMQTT_REMAINING_LENGTH_MISMATCH);
+        if(qos > 0){
+            uint8_t *ack = this->_writeBuffer + MQTT_FIXED_HEADER_MAX;
+            ack[0] = this->_readBuffer[2 + topicLength];
+            ack[1] = this->_readBuffer[3 + topicLength];
+            size_t fixed = frame(this->_writeBuffer, MQTT_PUBACK << 4, 2);
+            if(this->_netClient->write(this->_writeBuffer + MQTT_FIXED_HEADER_MAX - fixed, fixed + 2) != fixed + 2)
+                return this->_fail(LWMQTT_NETWORK_FAILED_WRITE);
+        }
+        // Topic and payload as terminated strings, like arduino-mqtt hands them over
+        char *topic = (char *)this->_readBuffer + this->_bufferSize + 1;
+        memcpy(topic, this->_readBuffer + 2, topicLength);
+        topic[topicLength] = '\0';
+        char *payload = (char *)this->_readBuffer + payloadStart;
+        int payloadLength = length - payloadStart;
+        if(this->_callbackFunction)
+            this->_callbackFunction(this, topic, payload, payloadLength);
+        else if(this->_callback)
+            this->_callback(this, topic, payload, payloadLength);
+        break;
+    }
+    case MQTT_PINGRESP:
+        this->_pongPending = false;
+        break;
+    default:
+        // PUBACKs of espIOTLib's own QoS 1 publishes and late acknowledgements
+        break;
+    }
+    return true;
+}
+
+bool MQTTClient::_cycleUntil(uint8_t type, uint16_t packetId){
+    uint32_t start = millis();
+    while(millis() - start < this->_timeout){
+        size_t length;
+        int header = this->_readPacket(&length, true);
+        if(header < 0)
+            return false;
+        if(!this->_handle(header, length))
+            return false;
+        if((header >> 4) != type)
+            continue;
+        if(packetId == 0 || (length >= 2 && (((uint16_t)this->_readBuffer[0] << 8) | this->_readBuffer[1]) == packetId))
+            return true;
+    }
+    return this->_fail(LWMQTT_NETWORK_TIMEOUT);
+}
+
+// --- Public Functions ---
+MQTTClient::MQTTClient(int bufSize){
+    this->_bufferSize = bufSize;
+    // Body, terminator and a copy of the topic
+    this->_readBuffer = new uint8_t[2 * bufSize + 2];
+    this->_writeBuffer = new uint8_t[bufSize + MQTT_FIXED_HEADER_MAX];
+}
+
+MQTTClient::~MQTTClient(){
+    delete[] this->_readBuffer;
+    delete[] this->_writeBuffer;
+}
+
+bool MQTTClient::connect(const char *clientId, const char *username, const char *password, bool skip){
+    if(!this->_netClient)
+        return false;
+    if(this->connected())
+        this->_close();
+    if(!skip){
+        int connected = this->_hostname ? this->_netClient->connect(this->_hostname, this->_port) : this->_netClient->connect(this->_address, this->_port);
+        if(!connected){
+            this->_lastError = LWMQTT_NETWORK_FAILED_CONNECT;
+            return false;
+        }
+    }
+    bool hasUsername = username && username[0];
+    bool hasPassword = hasUsername && password && password[0];
+    size_t remaining = 10 + 2 + strlen(clientId) + (hasUsername ? 2 + strlen(username) : 0) + (hasPassword ? 2 + strlen(password) : 0);
+    if(remaining > this->_bufferSize)
+        return this->_fail(LWMQTT_BUFFER_TOO_SHORT);
+    uint8_t *p = this->_writeBuffer + MQTT_FIXED_HEADER_MAX;
+    p += putString(p, "MQTT", 4);
+    *p++ = 4;
+    *p++ = (this->_cleanSession ? 0x02 : 0) | (hasUsername ? 0x80 : 0) | (hasPassword ? 0x40 : 0);
+    *p++ = this->_keepAlive >> 8;
+    *p++ = this->_keepAlive & 0xff;
+    p += putString(p, clientId, strlen(clientId));
+    if(hasUsername)
+        p += putString(p, username, strlen(username));
+    if(hasPassword)
+        p += putString(p, password, strlen(password));
+    size_t fixed = frame(this->_writeBuffer, MQTT_CONNECT << 4, remaining);
+    if(this->_netClient->write(this->_writeBuffer + MQTT_FIXED_HEADER_MAX - fixed, fixed + remaining) != fixed + remaining)
+        return this->_fail(LWMQTT_NETWORK_FAILED_WRITE);
+    if(!this->_cycleUntil(MQTT_CONNACK, 0))
+        return false;
+    this->_returnCode = (lwmqtt_return_code_t)this->_readBuffer[1];
+    if(this->_returnCode != LWMQTT_CONNECTION_ACCEPTED)
+        return this->_fail(LWMQTT_CONNECTION_DENIED);
+    this->_lastError = LWMQTT_SUCCESS;
+    this->_connected = true;
+    this->_pongPending = false;
+    this->_lastSend = millis();
+    return true;
+}
+
+bool MQTTClient::publish(const char *topic, const char *payload, int length, bool retained, int qos){
+    if(!this->connected())
+        return false;
+    size_t topicLength = strlen(topic);
+    size_t remaining = 2 + topicLength + (qos > 0 ? 2 : 0) + length;
+    if(remaining > this->_bufferSize)
+        return this->_fail(LWMQTT_BUFFER_TOO_SHORT);
+    uint8_t *p = this->_writeBuffer + MQTT_FIXED_HEADER_MAX;
+    p += putString(p, topic, topicLength);
+    uint16_t packetId = 0;
+    if(qos > 0){
+        packetId = this->_packetId();
+        *p++ = packetId >> 8;
+        *p++ = packetId & 0xff;
+    }
+    memcpy(p, payload, length);
+    size_t fixed = frame(this->_writeBuffer, (MQTT_PUBLISH << 4) | (qos > 0 ? 0x02 : 0) | (retained ? 0x01 : 0), remaining);
+    if(this->_netClient->write(this->_writeBuffer + MQTT_FIXED_HEADER_MAX - fixed, fixed + remaining) != fixed + remaining)
+        return this->_fail(LWMQTT_NETWORK_FAILED_WRITE);
+    this->_lastSend = millis();
+    return qos == 0 || this->_cycleUntil(MQTT_PUBACK, packetId);
+}
+
+bool MQTTClient::subscribe(const char *topic, int qos){
+    if(!this->connected())
+        return false;
+    size_t topicLength = strlen(topic);
+    size_t remaining = 2 + 2 + topicLength + 1;
+    if(remaining > this->_bufferSize)
+        return this->_fail(LWMQTT_BUFFER_TOO_SHORT);
+    uint16_t packetId = this->_packetId();
+    uint8_t *p = this->_writeBuffer + MQTT_FIXED_HEADER_MAX;
+    *p++ = packetId >> 8;
+    *p++ = packetId & 0xff;
+    p += putString(p, topic, topicLength);
+    *p++ = qos;
+    size_t fixed = frame(this->_writeBuffer, (MQTT_SUBSCRIBE << 4) | 0x02, remaining);
+    if(this->_netClient->write(this->_writeBuffer + MQTT_FIXED_HEADER_MAX - fixed, fixed + remaining) != fixed + remaining)
+        return this->_fail(LWMQTT_NETWORK_FAILED_WRITE);
+    this->_lastSend = millis();
+    if(!this->_cycleUntil(MQTT_SUBACK, packetId))
+        return false;
+    if(this->_readBuffer[2] == 0x80)
+        return this->_fail(LWMQTT_FAILED_SUBSCRIPTION);
+    return true;
+}
+
+bool MQTTClient::unsubscribe(const char *topic){
+    if(!this->connected())
+        return false;
+    size_t topicLength = strlen(topic);
+    size_t remaining = 2 + 2 + topicLength;
+    if(remaining > this->_bufferSize)
+        return this->_fail(LWMQTT_BUFFER_TOO_SHORT);
+    uint16_t packetId = this->_packetId();
+    uint8_t *p = this->_writeBuffer + MQTT_FIXED_HEADER_MAX;
+    *p++ = packetId >> 8;
+    *p++ = packetId & 0xff;
+    putString(p, topic, topicLength);
+    size_t fixed = frame(this->_writeBuffer, (MQTT_UNSUBSCRIBE << 4) | 0x02, remaining);
+    if(this->_netClient->write(this->_writeBuffer + MQTT_FIXED_HEADER_MAX - fixed, fixed + remaining) != fixed + remaining)
+        return this->_fail(LWMQTT_NETWORK_FAILED_WRITE);
+    this->_lastSend = millis();
+    return this->_cycleUntil(MQTT_UNSUBACK, packetId);
+}
+
+bool MQTTClient::loop(){
+    if(!this->connected())
+        return false;
+    while(this->_netClient->available() > 0){
+        size_t length;
+        int header = this->_readPacket(&length, false);
+        if(header < 0)
+            return false;
+        if(header == 0)
+            break;
+        if(!this->_handle(header, length))
+            return false;
+    }
+    if(this->_keepAlive > 0 && millis() - this->_lastSend >= this->_keepAlive * 1000UL){
+        if(this->_pongPending)
+            return this->_fail(LWMQTT_PONG_TIMEOUT);
+        const uint8_t ping[2] = {MQTT_PINGREQ << 4, 0};
+        if(this->_netClient->write(ping, 2) != 2)
+            return this->_fail(LWMQTT_NETWORK_FAILED_WRITE);
+        this->_pongPending = true;
+        this->_lastSend = millis();
+    }
+    return true;
+}
+
+bool MQTTClient::connected(){
+    bool connected = this->_netClient && this->_netClient->connected() && this->_connected;
+    if(this->_connected && !connected)
+        this->_connected = false;
+    return connected;
+}
+
+bool MQTTClient::disconnect(){
+    if(!this->connected())
+        return false;
+    const uint8_t packet[2] = {MQTT_DISCONNECT << 4, 0};
+    this->_netClient->write(packet, 2);
+    this->_close();
+    return true;
+}
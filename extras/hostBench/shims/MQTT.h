@@ -0,0 +1,121 @@
+/**
+ * @file MQTT.h
+ * @author Paul Schlarmann (paul.schlarmann@makerspace-minden.de)
+ * @brief Host stand-in for arduino-mqtt's MQTTClient, MQTT 3.1.1 over any Client
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) Paul Schlarmann 2023
+ *
+ * Behaves like lwmqtt where espIOTLib depends on it: connect() with skip only sends CONNECT and waits for
+ * CONNACK, subscribe() waits for SUBACK, QoS 0 publishes are a single write, loop() reads whatever is
+ * available and ignores acknowledgements it did not ask for, and any network error closes the client.
+ */
+#ifndef HOSTBENCH_MQTT_H
+#define HOSTBENCH_MQTT_H
+
+// --- Includes ---
+#include <Arduino.h>
+#include <Client.h>
+
+// --- Defines ---
+#define MQTT_HAS_FUNCTIONAL 1
+
+// --- Typedefs ---
+typedef enum {
+    LWMQTT_CONNECTION_ACCEPTED = 0,
+    LWMQTT_UNACCEPTABLE_PROTOCOL = 1,
+    LWMQTT_IDENTIFIER_REJECTED = 2,
+    LWMQTT_SERVER_UNAVAILABLE = 3,
+    LWMQTT_BAD_USERNAME_OR_PASSWORD = 4,
+    LWMQTT_NOT_AUTHORIZED = 5,
+    LWMQTT_UNKNOWN_RETURN_CODE = 6
+} lwmqtt_return_code_t;
+
+typedef enum {
+    LWMQTT_SUCCESS = 0,
+    LWMQTT_BUFFER_TOO_SHORT = -1,
+    LWMQTT_VARNUM_OVERFLOW = -2,
+    LWMQTT_NETWORK_FAILED_CONNECT = -3,
+    LWMQTT_NETWORK_TIMEOUT = -4,
+    LWMQTT_NETWORK_FAILED_READ = -5,
+    LWMQTT_NETWORK_FAILED_WRITE = -6,
+    LWMQTT_REMAINING_LENGTH_OVERFLOW = -7,
+    LWMQTT_REMAINING_LENGTH_MISMATCH = -8,
+    LWMQTT_MISSING_OR_WRONG_PACKET = -9,
+    LWMQTT_CONNECTION_DENIED = -10,
+    LWMQTT_FAILED_SUBSCRIPTION = -11,
+    LWMQTT_SUBACK_ARRAY_OVERFLOW = -12,
+    LWMQTT_PONG_TIMEOUT = -13
+} lwmqtt_err_t;
+
+class MQTTClient;
+typedef void (*MQTTClientCallbackAdvanced)(MQTTClient *client, char topic[], char bytes[], int length);
+typedef std::function<void(MQTTClient *client, char topic[], char bytes[], int length)> MQTTClientCallbackAdvancedFunction;
+
+// --- Public Classes ---
+class MQTTClient
+{
+protected:
+    size_t _bufferSize;
+    uint8_t *_readBuffer;
+    uint8_t *_writeBuffer;
+    Client *_netClient = NULL;
+    const char *_hostname = NULL;
+    IPAddress _address;
+    int _port = 1883;
+    uint16_t _keepAlive = 10;
+    bool _cleanSession = true;
+    uint32_t _timeout = 1000;
+    bool _connected = false;
+    lwmqtt_err_t _lastError = LWMQTT_SUCCESS;
+    lwmqtt_return_code_t _returnCode = LWMQTT_CONNECTION_ACCEPTED;
+    uint16_t _nextId = 1;
+    uint32_t _lastSend = 0;
+    bool _pongPending = false;
+    MQTTClientCallbackAdvanced _callback = NULL;
+    MQTTClientCallbackAdvancedFunction _callbackFunction;
+
+    bool _readBytes(uint8_t *buffer, size_t length);
+    int _readPacket(size_t *length, bool wait);
+    bool _handle(uint8_t header, size_t length);
+    bool _cycleUntil(uint8_t type, uint16_t packetId);
+    bool _fail(lwmqtt_err_t error);
+    void _close();
+    uint16_t _packetId();
+
+public:
+    explicit MQTTClient(int bufSize = 128);
+    ~MQTTClient();
+
+    void begin(Client &client) { this->_netClient = &client; }
+    void begin(const char *hostname, Client &client) { this->begin(hostname, 1883, client); }
+    void begin(const char *hostname, int port, Client &client) { this->setHost(hostname, port); this->begin(client); }
+    void begin(IPAddress address, int port, Client &client) { this->setHost(address, port); this->begin(client); }
+    void setHost(const char *hostname, int port = 1883) { this->_hostname = hostname; this->_port = port; }
+    void setHost(IPAddress address, int port = 1883) { this->_hostname = NULL; this->_address = address; this->_port = port; }
+    void setKeepAlive(int keepAlive) { this->_keepAlive = keepAlive; }
+    void setCleanSession(bool cleanSession) { this->_cleanSession = cleanSession; }
+    void setTimeout(int timeout) { this->_timeout = timeout; }
+    void onMessageAdvanced(MQTTClientCallbackAdvanced callback) { this->_callback = callback; }
+    void onMessageAdvanced(MQTTClientCallbackAdvancedFunction callback) { this->_callbackFunction = callback; }
+
+    bool connect(const char *clientId, bool skip = false) { return this->connect(clientId, NULL, NULL, skip); }
+    bool connect(const char *clientId, const char *username, const char *password = NULL, bool skip = false);
+    bool publish(const char *topic) { return this->publish(topic, "", 0, false, 0); }
+    bool publish(const char *topic, const String &payload) { return this->publish(topic, payload.c_str(), payload.length(), false, 0); }
+    bool publish(const char *topic, const char *payload) { return this->publish(topic, payload, strlen(payload), false, 0); }
+    bool publish(const char *topic, const char *payload, int length) { return this->publish(topic, payload, length, false, 0); }
+    bool publish(const char *topic, const char *payload, bool retained, int qos) { return this->publish(topic, payload, strlen(payload), retained, qos); }
+    bool publish(const char *topic, const char *payload, int length, bool retained, int qos);
+    bool subscribe(const char *topic, int qos = 0);
+    bool unsubscribe(const char *topic);
+    bool loop();
+    bool connected();
+    bool disconnect();
+
+    lwmqtt_err_t lastError() { return this->_lastError; }
+    lwmqtt_return_code_t returnCode() { return this->_returnCode; }
+};
+
+#endif /* HOSTBENCH_MQTT_H */
@@ -0,0 +1,226 @@
+/**
+ * @file WiFiClient.cpp
+ * @author Paul Schlarmann (paul.schlarmann@makerspace-minden.de)
+ * @brief Host stand-in for the ESP8266 WiFiClient and WiFi class on POSIX sockets
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) Paul Schlarmann 2023
+ *
+ */
+
+// --- Includes ---
+#include <ESP8266WiFi.h>
+#include <include/ClientContext.h>
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+// --- Defines ---
+// What the ESP8266 reports with the default lwIP build
+#define HOST_TCP_SND_BUF 2920
+
+// --- Public Vars ---
+ESP8266WiFiClass WiFi;
+
+// --- Private Functions ---
+static bool waitFor(int fd, short events, uint32_t timeout){
+    struct pollfd pfd = {fd, events, 0};
+    return poll(&pfd, 1, timeout) > 0 && (pfd.revents & events);
+}
+
+WiFiClient::socket::~socket(){
+    if(this->fd >= 0)
+        close(this->fd);
+}
+
+// --- Public Functions ---
+WiFiClient::WiFiClient(int fd){
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+    this->_socket = std::make_shared<socket>();
+    this->_socket->fd = fd;
+}
+
+WiFiClient::WiFiClient(ClientContext *context) : WiFiClient(context->fd){
+    delete context;
+}
+
+int WiFiClient::connect(IPAddress ip, uint16_t port){
+    this->stop();
+    int fd = ::socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if(fd < 0)
+        return 0;
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = (uint32_t)ip;
+    int result = ::connect(fd, (struct sockaddr *)&address, sizeof(address));
+    if(result < 0 && errno == EINPROGRESS && waitFor(fd, POLLOUT, this->_timeout)){
+        int error = 0;
+        socklen_t length = sizeof(error);
+        getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &length);
+        result = error == 0 ? 0 : -1;
+    }
+    if(result < 0){
+        close(fd);
+        return 0;
+    }
+    this->_socket = std::make_shared<socket>();
+    this->_socket->fd = fd;
+    return 1;
+}
+
+int WiFiClient::connect(const char *host, uint16_t port){
+    IPAddress ip;
+    if(!WiFi.hostByName(host, ip, this->_timeout))
+        return 0;
+    return this->connect(ip, port);
+}
+
+// Blocks until everything is in the socket buffer, for at most the stream timeout, like the ESP8266
+size_t WiFiClient::write(const uint8_t *buffer, size_t size){
+    int fd = this->_fd();
+    if(fd < 0)
+        return 0;
+    size_t written = 0;
+    uint32_t start = millis();
+    while(written < size){
+        ssize_t n = send(fd, buffer + written, size - written, MSG_NOSIGNAL);
+        if(n > 0){
+            written += n;
+            continue;
+        }
+        if(n < 0 && errno != EAGAIN && errno != EWOULDBLOCK)
+            break;
+        uint32_t waited = millis() - start;
+        if(waited >= this->_timeout || !waitFor(fd, POLLOUT, this->_timeout - waited))
+            break;
+    }
+    return written;
+}
+
+int WiFiClient::availableForWrite(){
+    int fd = this->_fd();
+    if(fd < 0)
+        return 0;
+    int queued = 0;
+    ioctl(fd, TIOCOUTQ, &queued);
+    return queued < HOST_TCP_SND_BUF ? HOST_TCP_SND_BUF - queued : 0;
+}
+
+int WiFiClient::available(){
+    int fd = this->_fd();
+    int count = 0;
+    if(fd < 0 || ioctl(fd, FIONREAD, &count) < 0)
+        return 0;
+    return count;
+}
+
+int WiFiClient::read(){
+    uint8_t c;
+    return this->read(&c, 1) == 1 ? c : -1;
+}
+
+int WiFiClient::read(uint8_t *buffer, size_t size){
+    int fd = this->_fd();
+    if(fd < 0)
+        return -1;
+    ssize_t n = recv(fd, buffer, size, MSG_DONTWAIT);
+    return n > 0 ? n : (n == 0 ? 0 : -1);
+}
+
+int WiFiClient::peek(){
+    int fd = this->_fd();
+    uint8_t c;
+    if(fd < 0 || recv(fd, &c, 1, MSG_DONTWAIT | MSG_PEEK) != 1)
+        return -1;
+    return c;
+}
+
+bool WiFiClient::stop(unsigned int maxWaitMs){
+    if(!this->_socket)
+        return true;
+    // Closes the socket for all copies, like ESP8266's ClientContext::close()
+    if(this->_socket->fd >= 0){
+        close(this->_socket->fd);
+        this->_socket->fd = -1;
+    }
+    this->_socket.reset();
+    return true;
+}
+
+// Still connected while unread data is there, like on the device
+uint8_t WiFiClient::connected(){
+    int fd = this->_fd();
+    if(fd < 0)
+        return 0;
+    uint8_t c;
+    ssize_t n = recv(fd, &c, 1, MSG_DONTWAIT | MSG_PEEK);
+    if(n > 0)
+        return 1;
+    return n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+}
+
+void WiFiClient::setNoDelay(bool noDelay){
+    int fd = this->_fd();
+    int value = noDelay;
+    if(fd >= 0)
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &value, sizeof(value));
+}
+
+IPAddress WiFiClient::remoteIP(){
+    struct sockaddr_in address;
+    socklen_t length = sizeof(address);
+    if(this->_fd() < 0 || getpeername(this->_fd(), (struct sockaddr *)&address, &length) < 0)
+        return IPAddress();
+    return IPAddress((uint32_t)address.sin_addr.s_addr);
+}
+
+uint16_t WiFiClient::remotePort(){
+    struct sockaddr_in address;
+    socklen_t length = sizeof(address);
+    if(this->_fd() < 0 || getpeername(this->_fd(), (struct sockaddr *)&address, &length) < 0)
+        return 0;
+    return ntohs(address.sin_port);
+}
+
+// --- ESP8266WiFiClass ---
+wl_status_t ESP8266WiFiClass::begin(const char *ssid, const char *password, int32_t channel, const uint8_t *bssid, bool connect){
+    this->_connected = true;
+    return WL_CONNECTED;
+}
+
+uint8_t *ESP8266WiFiClass::BSSID(){
+    static uint8_t bssid[6] = {0x02, 0x00, 0x00, 0x00, 0x00, 0xfe};
+    return bssid;
+}
+
+uint8_t *ESP8266WiFiClass::macAddress(uint8_t *mac){
+    const uint8_t address[6] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x01};
+    memcpy(mac, address, 6);
+    return mac;
+}
+
+int ESP8266WiFiClass::hostByName(const char *host, IPAddress &result, uint32_t timeoutMs){
+    if(result.fromString(host))
+        return 1;
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    struct addrinfo *info = NULL;
+    if(getaddrinfo(host, NULL, &hints, &info) != 0 || !info)
+        return 0;
+    result = IPAddress((uint32_t)((struct sockaddr_in *)info->ai_addr)->sin_addr.s_addr);
+    freeaddrinfo(info);
+    return 1;
+}
@@ -0,0 +1,65 @@
+/**
+ * @file WiFiClient.h
+ * @author Paul Schlarmann (paul.schlarmann@makerspace-minden.de)
+ * @brief Host stand-in for the ESP8266 WiFiClient on a POSIX TCP socket
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) Paul Schlarmann 2023
+ *
+ * Copies share the socket like on the ESP8266. connect() and write() wait up to the stream timeout,
+ * reads never wait.
+ */
+#ifndef HOSTBENCH_WIFICLIENT_H
+#define HOSTBENCH_WIFICLIENT_H
+
+// --- Includes ---
+#include <Arduino.h>
+#include <Client.h>
+
+#include <memory>
+
+// --- Typedefs ---
+class ClientContext;
+
+// --- Public Classes ---
+class WiFiClient : public Client
+{
+protected:
+    struct socket{
+        int fd;
+        ~socket();
+    };
+    std::shared_ptr<socket> _socket;
+
+    int _fd() const { return this->_socket ? this->_socket->fd : -1; }
+    // Like WiFiServer's, wraps the connection of a pcb
+    explicit WiFiClient(ClientContext *context);
+
+public:
+    WiFiClient() {}
+    // Host only: wraps an accepted socket
+    explicit WiFiClient(int fd);
+
+    int connect(IPAddress ip, uint16_t port) override;
+    int connect(const char *host, uint16_t port) override;
+    size_t write(uint8_t c) override { return this->write(&c, 1); }
+    size_t write(const uint8_t *buffer, size_t size) override;
+    using Print::write;
+    int availableForWrite() override;
+    int available() override;
+    int read() override;
+    int read(uint8_t *buffer, size_t size) override;
+    int peek() override;
+    bool flush(unsigned int maxWaitMs = 0) override { return true; }
+    bool stop(unsigned int maxWaitMs = 0) override;
+    uint8_t connected() override;
+    operator bool() override { return this->connected(); }
+
+    void setNoDelay(bool noDelay);
+    void setSync(bool sync) {}
+    IPAddress remoteIP();
+    uint16_t remotePort();
+};
+
+#endif /* HOSTBENCH_WIFICLIENT_H */
@@ -0,0 +1,31 @@
+/**
+ * @file ClientContext.h
+ * @author Paul Schlarmann (paul.schlarmann@makerspace-minden.de)
+ * @brief Host stand-in for the ESP8266 core's ClientContext, wraps the socket of an established pcb
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) Paul Schlarmann 2023
+ *
+ */
+#ifndef HOSTBENCH_CLIENTCONTEXT_H
+#define HOSTBENCH_CLIENTCONTEXT_H
+
+// --- Includes ---
+#include <lwip/tcp.h>
+
+// --- Typedefs ---
+class ClientContext;
+typedef void (*discard_cb_t)(void *arg, ClientContext *context);
+
+// --- Public Classes ---
+// Takes over the pcb like the device's, WiFiClient(ClientContext *) then takes over the socket and deletes the context
+class ClientContext
+{
+public:
+    int fd;
+
+    ClientContext(struct tcp_pcb *pcb, discard_cb_t discardCB, void *discardArg) : fd(hostLwipTakeSocket(pcb)) { (void)discardCB; (void)discardArg; }
+};
+
+#endif /* HOSTBENCH_CLIENTCONTEXT_H */
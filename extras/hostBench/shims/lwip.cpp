@@ -0,0 +1,166 @@
+/**
+ * @file lwip.cpp
+ * @author Paul Schlarmann (paul.schlarmann@makerspace-minden.de)
+ * @brief Host stand-in for the parts of lwIP's raw API espIOTLib uses, on POSIX sockets
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) Paul Schlarmann 2023
+ *
+ */
+
+// --- Includes ---
+#include <Arduino.h>
+#include <lwip/dns.h>
+#include <lwip/tcp.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <vector>
+
+// --- Typedefs ---
+struct tcp_pcb{
+    int fd;
+    void *arg;
+    tcp_err_fn err;
+    tcp_connected_fn connected;
+    tcp_recv_fn recv;
+};
+
+// --- Private Vars ---
+static std::vector<struct tcp_pcb *> connecting;
+static std::vector<struct tcp_pcb *> receiving;
+
+// --- Private Functions ---
+static void forget(std::vector<struct tcp_pcb *> &list, struct tcp_pcb *pcb){
+    for(size_t i = 0; i < list.size(); i++){
+        if(list[i] == pcb){
+            list.erase(list.begin() + i);
+            return;
+        }
+    }
+}
+
+static void release(struct tcp_pcb *pcb){
+    forget(connecting, pcb);
+    forget(receiving, pcb);
+    if(pcb->fd >= 0)
+        close(pcb->fd);
+    delete pcb;
+}
+
+// --- Public Functions ---
+// Called from yield(), reports finished connects through the callbacks
+void hostLwipPoll(){
+    for(size_t i = 0; i < connecting.size(); ){
+        struct tcp_pcb *pcb = connecting[i];
+        struct pollfd pfd = {pcb->fd, POLLOUT, 0};
+        if(poll(&pfd, 1, 0) <= 0){
+            i++;
+            continue;
+        }
+        connecting.erase(connecting.begin() + i);
+        int error = 0;
+        socklen_t length = sizeof(error);
+        getsockopt(pcb->fd, SOL_SOCKET, SO_ERROR, &error, &length);
+        if(error == 0){
+            // The callback closes or aborts the pcb itself
+            pcb->connected(pcb->arg, pcb, ERR_OK);
+        } else {
+            // lwIP frees the pcb before the error callback
+            tcp_err_fn err = pcb->err;
+            void *arg = pcb->arg;
+            release(pcb);
+            if(err)
+                err(arg, ERR_RST);
+        }
+    }
+    // Established pcbs with a receive callback, a closed peer reads as EOF
+    for(size_t i = 0; i < receiving.size(); ){
+        struct tcp_pcb *pcb = receiving[i];
+        uint8_t c;
+        if(recv(pcb->fd, &c, 1, MSG_DONTWAIT | MSG_PEEK) != 0){
+            i++;
+            continue;
+        }
+        receiving.erase(receiving.begin() + i);
+        // The callback closes or aborts the pcb itself
+        pcb->recv(pcb->arg, pcb, NULL, ERR_OK);
+    }
+}
+
+err_t dns_gethostbyname(const char *hostname, ip_addr_t *addr, dns_found_callback found, void *callback_arg){
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    struct addrinfo *info = NULL;
+    if(getaddrinfo(hostname, NULL, &hints, &info) != 0 || !info)
+        return ERR_ARG;
+    addr->addr = ((struct sockaddr_in *)info->ai_addr)->sin_addr.s_addr;
+    freeaddrinfo(info);
+    return ERR_OK;
+}
+
+struct tcp_pcb *tcp_new(void){
+    struct tcp_pcb *pcb = new tcp_pcb();
+    pcb->fd = -1;
+    return pcb;
+}
+
+void tcp_arg(struct tcp_pcb *pcb, void *arg){
+    pcb->arg = arg;
+}
+
+void tcp_err(struct tcp_pcb *pcb, tcp_err_fn err){
+    pcb->err = err;
+}
+
+void tcp_recv(struct tcp_pcb *pcb, tcp_recv_fn recv){
+    forget(receiving, pcb);
+    pcb->recv = recv;
+    if(recv)
+        receiving.push_back(pcb);
+}
+
+err_t tcp_connect(struct tcp_pcb *pcb, const ip_addr_t *ipaddr, uint16_t port, tcp_connected_fn connected){
+    pcb->fd = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if(pcb->fd < 0)
+        return ERR_MEM;
+    fcntl(pcb->fd, F_SETFL, fcntl(pcb->fd, F_GETFL, 0) | O_NONBLOCK);
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = ipaddr->addr;
+    if(connect(pcb->fd, (struct sockaddr *)&address, sizeof(address)) < 0 && errno != EINPROGRESS)
+        return ERR_CONN;
+    pcb->connected = connected;
+    connecting.push_back(pcb);
+    return ERR_OK;
+}
+
+err_t tcp_close(struct tcp_pcb *pcb){
+    release(pcb);
+    return ERR_OK;
+}
+
+void tcp_abort(struct tcp_pcb *pcb){
+    release(pcb);
+}
+
+uint8_t pbuf_free(struct pbuf *p){
+    return p ? 1 : 0;
+}
+
+int hostLwipTakeSocket(struct tcp_pcb *pcb){
+    int fd = pcb->fd;
+    pcb->fd = -1;
+    release(pcb);
+    return fd;
+}
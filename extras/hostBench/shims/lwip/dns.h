@@ -0,0 +1,25 @@
+/**
+ * @file dns.h
+ * @author Paul Schlarmann (paul.schlarmann@makerspace-minden.de)
+ * @brief Host stand-in for lwIP's DNS client
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) Paul Schlarmann 2023
+ *
+ */
+#ifndef HOSTBENCH_LWIP_DNS_H
+#define HOSTBENCH_LWIP_DNS_H
+
+// --- Includes ---
+#include <lwip/err.h>
+#include <lwip/ip_addr.h>
+
+// --- Typedefs ---
+typedef void (*dns_found_callback)(const char *name, const ip_addr_t *ipaddr, void *callback_arg);
+
+// --- Public Functions ---
+// Answers like a cache hit (ERR_OK) or a failed lookup, the found callback is never called
+err_t dns_gethostbyname(const char *hostname, ip_addr_t *addr, dns_found_callback found, void *callback_arg);
+
+#endif /* HOSTBENCH_LWIP_DNS_H */
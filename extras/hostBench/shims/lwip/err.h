@@ -0,0 +1,32 @@
+/**
+ * @file err.h
+ * @author Paul Schlarmann (paul.schlarmann@makerspace-minden.de)
+ * @brief Host stand-in for lwIP's error codes
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) Paul Schlarmann 2023
+ *
+ */
+#ifndef HOSTBENCH_LWIP_ERR_H
+#define HOSTBENCH_LWIP_ERR_H
+
+// --- Includes ---
+#include <stdint.h>
+
+// --- Defines ---
+#define ERR_OK 0
+#define ERR_MEM -1
+#define ERR_TIMEOUT -3
+#define ERR_INPROGRESS -5
+#define ERR_VAL -6
+#define ERR_ARG -16
+#define ERR_ABRT -13
+#define ERR_RST -14
+#define ERR_CLSD -15
+#define ERR_CONN -11
+
+// --- Typedefs ---
+typedef int8_t err_t;
+
+#endif /* HOSTBENCH_LWIP_ERR_H */
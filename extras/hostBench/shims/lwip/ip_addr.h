@@ -0,0 +1,29 @@
+/**
+ * @file ip_addr.h
+ * @author Paul Schlarmann (paul.schlarmann@makerspace-minden.de)
+ * @brief Host stand-in for lwIP's IPv4-only ip_addr_t, as in the ESP8266 core's default lwIP build
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) Paul Schlarmann 2023
+ *
+ */
+#ifndef HOSTBENCH_LWIP_IP_ADDR_H
+#define HOSTBENCH_LWIP_IP_ADDR_H
+
+// --- Includes ---
+#include <stdint.h>
+
+// --- Defines ---
+#define ip_2_ip4(ipaddr) (ipaddr)
+#define ip4_addr_get_u32(ipaddr) ((ipaddr)->addr)
+// Network byte order, first octet in the lowest byte
+#define IP_ADDR4(ipaddr, a, b, c, d) ((ipaddr)->addr = (uint32_t)(a) | ((uint32_t)(b) << 8) | ((uint32_t)(c) << 16) | ((uint32_t)(d) << 24))
+
+// --- Typedefs ---
+typedef struct ip4_addr{
+    uint32_t addr;
+} ip4_addr_t;
+typedef ip4_addr_t ip_addr_t;
+
+#endif /* HOSTBENCH_LWIP_IP_ADDR_H */
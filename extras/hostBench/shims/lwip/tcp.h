@@ -0,0 +1,39 @@
+/**
+ * @file tcp.h
+ * @author Paul Schlarmann (paul.schlarmann@makerspace-minden.de)
+ * @brief Host stand-in for lwIP's raw TCP API, connect and hand over only
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) Paul Schlarmann 2023
+ *
+ */
+#ifndef HOSTBENCH_LWIP_TCP_H
+#define HOSTBENCH_LWIP_TCP_H
+
+// --- Includes ---
+#include <lwip/err.h>
+#include <lwip/ip_addr.h>
+
+// --- Typedefs ---
+struct tcp_pcb;
+struct pbuf;
+typedef err_t (*tcp_connected_fn)(void *arg, struct tcp_pcb *tpcb, err_t err);
+typedef err_t (*tcp_recv_fn)(void *arg, struct tcp_pcb *tpcb, struct pbuf *p, err_t err);
+typedef void (*tcp_err_fn)(void *arg, err_t err);
+
+// --- Public Functions ---
+// A non-blocking socket, the callbacks run from yield() like lwIP's between two loop() calls
+struct tcp_pcb *tcp_new(void);
+void tcp_arg(struct tcp_pcb *pcb, void *arg);
+void tcp_err(struct tcp_pcb *pcb, tcp_err_fn err);
+// Only told about the peer closing, as a NULL pbuf, data is left in the socket
+void tcp_recv(struct tcp_pcb *pcb, tcp_recv_fn recv);
+err_t tcp_connect(struct tcp_pcb *pcb, const ip_addr_t *ipaddr, uint16_t port, tcp_connected_fn connected);
+err_t tcp_close(struct tcp_pcb *pcb);
+void tcp_abort(struct tcp_pcb *pcb);
+uint8_t pbuf_free(struct pbuf *p);
+// Host only: the socket of an established pcb, the pcb is freed
+int hostLwipTakeSocket(struct tcp_pcb *pcb);
+
+#endif /* HOSTBENCH_LWIP_TCP_H */
@@ -0,0 +1,138 @@
+/**
+ * @file payloadBench.cpp
+ * @author Paul Schlarmann (paul.schlarmann@makerspace-minden.de)
+ * @brief Host benchmark of text vs. CBOR vs. MessagePack payload encoding
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) Paul Schlarmann 2023
+ *
+ * Encodes the same readings as publishInt/publishFloat and as a record with each payload format
+ * and prints encode time and payload bytes. The text rows use the formatters of the current publish path,
+ * snprintf is listed for reference. Times are host times, only the ratios carry over to a device.
+ *
+ *     g++ -O2 -std=gnu++17 -Isrc extras/payloadBench/payloadBench.cpp src/espIOTLib_encoder.cpp src/espIOTLib_format.cpp -o payloadBench
+ */
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+
+#include "espIOTLib_encoder.h"
+#include "espIOTLib_format.h"
+
+#define BENCH_ROUNDS 2000000UL
+#define BENCH_BUFFER_LEN 256
+#define BENCH_PRECISION 3
+
+// Typical sensor readings: counters, small signed values, temperatures, pressures
+static const int64_t benchInts[] = {0, 7, 42, -12, 1013, 65535, 123456, -98765, 4000000000LL};
+static const float benchFloats[] = {21.5f, -3.25f, 1013.25f, 0.001f, 47.8f, 99.9f};
+#define BENCH_INTS (sizeof(benchInts) / sizeof(benchInts[0]))
+#define BENCH_FLOATS (sizeof(benchFloats) / sizeof(benchFloats[0]))
+
+static const char *formatNames[] = {"text", "cbor", "msgpack"};
+
+static uint8_t buffer[BENCH_BUFFER_LEN];
+// Keeps the compiler from dropping the encoding
+static volatile size_t sink;
+
+static int64_t nowNanos(){
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void report(const char *what, const char *format, int64_t elapsed, size_t bytes, size_t values){
+    printf("%-8s %-9s %7.1f ns/value %6.2f bytes/value\n", what, format,
+        (double)elapsed / (BENCH_ROUNDS * values), (double)bytes / values);
+}
+
+static void benchInt(){
+    size_t bytes = 0;
+    int64_t start = nowNanos();
+    for(uint32_t round = 0; round < BENCH_ROUNDS; round++){
+        for(size_t i = 0; i < BENCH_INTS; i++)
+            sink = snprintf((char *)buffer, BENCH_BUFFER_LEN, "%lld", (long long)benchInts[i]);
+    }
+    for(size_t i = 0; i < BENCH_INTS; i++)
+        bytes += snprintf((char *)buffer, BENCH_BUFFER_LEN, "%lld", (long long)benchInts[i]);
+    report("int", "snprintf", nowNanos() - start, bytes, BENCH_INTS);
+
+    for(uint8_t format = ESP_IOTLIB_PAYLOAD_TEXT; format <= ESP_IOTLIB_PAYLOAD_MSGPACK; format++){
+        espIOTLib_encoder encoder(buffer, BENCH_BUFFER_LEN, (espIOTLib_payloadFormat)format);
+        bytes = 0;
+        start = nowNanos();
+        for(uint32_t round = 0; round < BENCH_ROUNDS; round++){
+            for(size_t i = 0; i < BENCH_INTS; i++){
+                encoder.reset((espIOTLib_payloadFormat)format);
+                encoder.encodeInt(benchInts[i]);
+                sink = encoder.length();
+                if(round == 0)
+                    bytes += encoder.length();
+            }
+        }
+        report("int", formatNames[format], nowNanos() - start, bytes, BENCH_INTS);
+    }
+}
+
+static void benchFloat(){
+    size_t bytes = 0;
+    int64_t start = nowNanos();
+    for(uint32_t round = 0; round < BENCH_ROUNDS; round++){
+        for(size_t i = 0; i < BENCH_FLOATS; i++)
+            sink = snprintf((char *)buffer, BENCH_BUFFER_LEN, "%.3f", benchFloats[i]);
+    }
+    for(size_t i = 0; i < BENCH_FLOATS; i++)
+        bytes += snprintf((char *)buffer, BENCH_BUFFER_LEN, "%.3f", benchFloats[i]);
+    report("float", "snprintf", nowNanos() - start, bytes, BENCH_FLOATS);
+
+    for(uint8_t format = ESP_IOTLIB_PAYLOAD_TEXT; format <= ESP_IOTLIB_PAYLOAD_MSGPACK; format++){
+        espIOTLib_encoder encoder(buffer, BENCH_BUFFER_LEN, (espIOTLib_payloadFormat)format);
+        encoder.setFloatPrecision(BENCH_PRECISION);
+        bytes = 0;
+        start = nowNanos();
+        for(uint32_t round = 0; round < BENCH_ROUNDS; round++){
+            for(size_t i = 0; i < BENCH_FLOATS; i++){
+                encoder.reset((espIOTLib_payloadFormat)format);
+                encoder.encodeFloat(benchFloats[i]);
+                sink = encoder.length();
+                if(round == 0)
+                    bytes += encoder.length();
+            }
+        }
+        report("float", formatNames[format], nowNanos() - start, bytes, BENCH_FLOATS);
+    }
+}
+
+// One environment sensor reading as a record, 4 values per payload
+static void benchRecord(){
+    for(uint8_t format = ESP_IOTLIB_PAYLOAD_TEXT; format <= ESP_IOTLIB_PAYLOAD_MSGPACK; format++){
+        espIOTLib_encoder encoder(buffer, BENCH_BUFFER_LEN, (espIOTLib_payloadFormat)format);
+        encoder.setFloatPrecision(BENCH_PRECISION);
+        size_t bytes = 0;
+        int64_t start = nowNanos();
+        for(uint32_t round = 0; round < BENCH_ROUNDS; round++){
+            encoder.reset((espIOTLib_payloadFormat)format);
+            encoder.beginMap();
+            encoder.key("temp");
+            encoder.encodeFloat(benchFloats[round % BENCH_FLOATS]);
+            encoder.key("hum");
+            encoder.encodeFloat(47.8f);
+            encoder.key("press");
+            encoder.encodeFloat(1013.25f);
+            encoder.key("count");
+            encoder.encodeInt(round);
+            encoder.endMap();
+            sink = encoder.length();
+            if(round == 0)
+                bytes = encoder.length();
+        }
+        report("record", formatNames[format], nowNanos() - start, bytes, 4);
+    }
+}
+
+int main(){
+    printf("%lu rounds, bytes are payload bytes on the wire (text without terminator)\n", BENCH_ROUNDS);
+    benchInt();
+    benchFloat();
+    benchRecord();
+    return 0;
+}
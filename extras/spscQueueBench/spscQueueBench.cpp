@@ -0,0 +1,95 @@
+/**
+ * @file spscQueueBench.cpp
+ * @author Paul Schlarmann (paul.schlarmann@makerspace-minden.de)
+ * @brief Host benchmark and sanity check of the network task handoff queue
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) Paul Schlarmann 2023
+ *
+ * Runs the producer on a thread started through the espIOTLib_thread shim (std::thread on the host)
+ * and the consumer on the main thread, like the application and network task on an ESP32.
+ * Checks that every message arrives once and in order, and prints throughput and handoff latency.
+ *
+ *     g++ -O2 -std=gnu++17 -pthread -Isrc extras/spscQueueBench/spscQueueBench.cpp src/espIOTLib_thread.cpp -o spscQueueBench
+ */
+#include <stdio.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <vector>
+#include <algorithm>
+
+#include "espIOTLib_spscQueue.h"
+#include "espIOTLib_thread.h"
+
+#define BENCH_MESSAGES 2000000UL
+#define BENCH_QUEUE_ENTRIES 16
+
+// Same size class as espIOTLib_netMessage
+struct benchMessage{
+    uint32_t sequence;
+    int64_t sentNanos;
+    char topic[64];
+    char payload[128];
+};
+
+static espIOTLib_spscQueue<benchMessage> queue(BENCH_QUEUE_ENTRIES);
+static std::atomic<bool> producerDone(false);
+static uint32_t producerFull = 0;
+
+static int64_t nowNanos(){
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void producer(void *arg){
+    (void)arg;
+    for(uint32_t i = 0; i < BENCH_MESSAGES; i++){
+        benchMessage *slot;
+        while(!(slot = queue.back())){
+            producerFull++;
+            espIOTLib_threadSleep(0);
+        }
+        slot->sequence = i;
+        strcpy(slot->topic, "bench/topic");
+        slot->sentNanos = nowNanos();
+        queue.commit();
+    }
+    producerDone.store(true);
+}
+
+int main(){
+    std::vector<uint32_t> latencies;
+    latencies.reserve(BENCH_MESSAGES);
+    uint32_t expected = 0;
+    uint32_t errors = 0;
+
+    int64_t start = nowNanos();
+    if(!espIOTLib_startThread("producer", producer, NULL, 0, 0, -1)){
+        printf("Could not start producer thread\n");
+        return 1;
+    }
+    while(expected < BENCH_MESSAGES){
+        benchMessage *message = queue.front();
+        if(!message){
+            espIOTLib_threadSleep(0);
+            continue;
+        }
+        if(message->sequence != expected || strcmp(message->topic, "bench/topic") != 0)
+            errors++;
+        latencies.push_back((uint32_t)(nowNanos() - message->sentNanos));
+        expected++;
+        queue.pop();
+    }
+    int64_t elapsed = nowNanos() - start;
+    while(!producerDone.load())
+        espIOTLib_threadSleep(1);
+
+    std::sort(latencies.begin(), latencies.end());
+    printf("%lu messages of %u bytes through a %u entry queue\n", BENCH_MESSAGES, (unsigned)sizeof(benchMessage), BENCH_QUEUE_ENTRIES);
+    printf("throughput %.2f M msg/s, %.1f ns/msg\n", BENCH_MESSAGES * 1000.0 / elapsed, (double)elapsed / BENCH_MESSAGES);
+    printf("latency p50 %u ns, p99 %u ns, max %u ns\n",
+        latencies[latencies.size() / 2], latencies[latencies.size() * 99 / 100], latencies.back());
+    printf("producer saw a full queue %u times, %u ordering errors\n", producerFull, errors);
+    return errors == 0 ? 0 : 1;
+}
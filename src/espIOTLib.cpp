@@ -11,9 +11,14 @@
 
 // --- Includes ---
 #include "espIOTLib.h"
+#include "espIOTLib_pageWriter.h"
+#include "espIOTLib_template.h"
+#include "espIOTLib_metricsWriter.h"
 
 #include <Arduino.h>
+#ifndef ESP_IOTLIB_NO_OTA
 #include <ArduinoOTA.h>
+#endif
 # ifdef ESP8266
 #  include <ESP8266mDNS.h>
 #  include <ESP8266WiFi.h>
@@ -31,52 +36,242 @@
 #ifdef ESP8266
 #define OTA_PORT 8266
 #define CHIP_IDENT "ESP8266"
+#define MAX_FREE_BLOCK() ESP.getMaxFreeBlockSize()
 #elif defined(ESP32)
 #define OTA_PORT 3232
 #define CHIP_IDENT ESP.getChipModel()
+#define MAX_FREE_BLOCK() ESP.getMaxAllocHeap()
 #endif
 
 #define ESP_IOTLIB_WEB_ROOT "/espIOTWeb"
 #define ESP_IOTLIB_WEB_ENDPOINT ESP_IOTLIB_WEB_ROOT "/config"
 #define ESP_IOTLIB_STATUS_ENDPOINT ESP_IOTLIB_WEB_ROOT "/status"
+#define ESP_IOTLIB_METRICS_ENDPOINT ESP_IOTLIB_WEB_ROOT "/metrics"
+#define ESP_IOTLIB_METRICS_JSON_ENDPOINT ESP_IOTLIB_METRICS_ENDPOINT ".json"
 #define ESP_IOTLIB_RESET_ENDPOINT ESP_IOTLIB_WEB_ROOT "/reset"
 #define ESP_IOTLIB_MQTT_DISCONNECT_ENDPOINT ESP_IOTLIB_WEB_ROOT "/mqttDisconnect"
 #define ESP_IOTLIB_MQTT_CONNECT_ENDPOINT ESP_IOTLIB_WEB_ROOT "/mqttConnect"
+#define ESP_IOTLIB_HISTORY_ENDPOINT ESP_IOTLIB_WEB_ROOT "/history"
+#define ESP_IOTLIB_EVENTS_ENDPOINT ESP_IOTLIB_WEB_ROOT "/events"
+#define ESP_IOTLIB_LIVE_ENDPOINT ESP_IOTLIB_WEB_ROOT "/live"
+#define ESP_IOTLIB_LOG_ENDPOINT ESP_IOTLIB_WEB_ROOT "/log"
 
+// Queued in _log and printed from loop(), the format stays in flash
 #ifdef ESP_IOTLIB_MQTT_LOG
-    #define LOG_MQTT_IDENT "[m] "
-    #define MQTT_LOGF(...) Serial.print(LOG_MQTT_IDENT);Serial.printf(__VA_ARGS__)
+    #define MQTT_LOG(level, format, ...) do { if(this->_log) this->_log->log(ESP_IOTLIB_LOG_MQTT, level, PSTR(format), ##__VA_ARGS__); } while(0)
 #else
-    #define MQTT_LOGF(...)
+    #define MQTT_LOG(level, format, ...) do {} while(0)
 #endif
 #ifdef ESP_IOTLIB_IOT_LOG
-    #define LOG_IOT_IDENT "[i] "
-    #define IOT_LOGF(...) Serial.print(LOG_IOT_IDENT);Serial.printf(__VA_ARGS__)
+    #define IOT_LOG(level, format, ...) do { if(this->_log) this->_log->log(ESP_IOTLIB_LOG_IOT, level, PSTR(format), ##__VA_ARGS__); } while(0)
+#else
+    #define IOT_LOG(level, format, ...) do {} while(0)
+#endif
+#define MQTT_LOGE(...) MQTT_LOG(ESP_IOTLIB_LOG_ERROR, __VA_ARGS__)
+#define MQTT_LOGW(...) MQTT_LOG(ESP_IOTLIB_LOG_WARN, __VA_ARGS__)
+#define MQTT_LOGF(...) MQTT_LOG(ESP_IOTLIB_LOG_INFO, __VA_ARGS__)
+#define MQTT_LOGD(...) MQTT_LOG(ESP_IOTLIB_LOG_DEBUG, __VA_ARGS__)
+#define IOT_LOGE(...) IOT_LOG(ESP_IOTLIB_LOG_ERROR, __VA_ARGS__)
+#define IOT_LOGW(...) IOT_LOG(ESP_IOTLIB_LOG_WARN, __VA_ARGS__)
+#define IOT_LOGF(...) IOT_LOG(ESP_IOTLIB_LOG_INFO, __VA_ARGS__)
+#ifdef ESP_IOTLIB_LOOP_PROFILING
+    #define PROFILE_STAGE(stage, start) start = this->_profileStage(stage, start)
+    // For a stage that runs in several places per loop, recorded once with PROFILE_RECORD
+    #define PROFILE_ADD(total, start) do { uint32_t profileNow = micros(); total += profileNow - start; start = profileNow; } while(0)
+    #define PROFILE_RECORD(stage, total) this->_loopHistograms[stage].record(total)
+#else
+    #define PROFILE_STAGE(stage, start)
+    #define PROFILE_ADD(total, start)
+    #define PROFILE_RECORD(stage, total)
+#endif
+#ifdef ESP_IOTLIB_HEAP_ACCOUNTING
+    #define HEAP_SCOPE(scope) espIOTLib_heapScope heapScope(this->_heapStats, scope)
 #else
-    #define IOT_LOGF(...)
+    #define HEAP_SCOPE(scope)
 #endif
+#define HTML_HEAD_TEXT "<!DOCTYPE html><html lang=\"en\"><head><meta name=\"viewport\" content=\"width=device-width, initial-scale=1, user-scalable=no\"/>"
 // --- Marcos ---
 
 // --- Typedefs ---
 
 // --- Private Vars ---
+// Page templates, see espIOTLib_renderTemplate()
+static const char HTML_ROOT[] PROGMEM = HTML_HEAD_TEXT "<title>{{thing}} - Main</title></head><body><div><p>Main page of {{thing}}</p>"
+    "<p>Using Chip: {{chip}}</p><p>SDK Version: {{sdk}}</p></div><hr/>{{mqtt}}{{ip}}{{ota}}"
+    "<p>Go to <a href='" ESP_IOTLIB_WEB_ENDPOINT "'>configure page</a> to change values.</p>"
+    "<p><a href='" ESP_IOTLIB_STATUS_ENDPOINT "'>Status</a> | <a href='" ESP_IOTLIB_METRICS_ENDPOINT "'>Metrics</a> | <a href='" ESP_IOTLIB_RESET_ENDPOINT "'>Reset CPU</a> | <a href='" ESP_IOTLIB_MQTT_DISCONNECT_ENDPOINT "'>Force MQTT Reconnect</a> | </p>"
+    "<hr/><p>User Pages:</p><p>{{pages}}</p></body></html>\n";
+static const char HTML_ROOT_MQTT[] PROGMEM = "<p>MQTT Config: </p><ul><li>Server: {{server}}</li><li>User: {{user}}</li><li>{{connected}}</li></ul>"
+    "<p>MQTT Defaults: </p><ul><li>Server: {{defaultServer}}</li><li>User: {{defaultUser}}</li></ul><hr/>";
+static const char HTML_ROOT_IP[] PROGMEM = "<p>IP Config: </p><ul><li>IP address: {{ip}}</li><li>Gateway: {{gateway}}</li><li>Netmask: {{netmask}}</li><li>DNS address: {{dns}}</li></ul><hr/>";
+static const char HTML_STATUS[] PROGMEM = HTML_HEAD_TEXT "<title>{{thing}} - Status</title></head><body><div><p>Status page of {{thing}}</p>"
+    "<p>Using Chip: {{chip}} @ SDK Version: {{sdk}}</p><hr/><h3>Free Memory</h3>{{memory}}</div><hr/>"
+    "<h3>Connection Status</h3>{{connection}}<hr/>{{duty}}{{mqtt}}<h3>Loop Timing</h3>{{loop}}<hr/>{{events}}{{history}}{{assets}}{{log}}{{tasks}}"
+    "<p><a href='/'>HOME</a></p></body></html>\n";
+static const char HTML_MQTT_DISCONNECT[] PROGMEM = HTML_HEAD_TEXT "<title>MQTT Disconnect...</title></head><body><div><p>Trying MQTT Disconnect...</p>"
+    "<p>{{result}}</p><ul>{{mqtt}}<li>{{connected}}</li></ul></div><hr /><p>Go <a href='" ESP_IOTLIB_MQTT_CONNECT_ENDPOINT "'>here</a> to connect again</p></body></html>\n";
+static const char HTML_MQTT_CONNECT[] PROGMEM = HTML_HEAD_TEXT "<title>MQTT Connect...</title></head><body><div><p>Trying MQTT Connect...</p>"
+    "<p>{{result}}</p><ul>{{mqtt}}<li> mqttLastConnectFailTime (0 if not failed): {{failTime}}</li></ul></div><hr /><p><a href='/'>HOME</a></p></body></html>\n";
+static const char HTML_LIVE[] PROGMEM = HTML_HEAD_TEXT "<title>Live</title><style>td{padding:0 1em}</style></head><body><h3>Values</h3><table id='v'></table><h3>Status</h3><table id='s'></table>"
+    "<p><a href='/'>HOME</a></p><script>"
+    "function row(t,k,o){var r=o[k];if(!r){r=document.getElementById(t).insertRow();r.insertCell().textContent=k;r.insertCell();o[k]=r;}return r.cells[1];}"
+    "var e=new EventSource('" ESP_IOTLIB_EVENTS_ENDPOINT "'),v={},s={};"
+    "e.addEventListener('value',function(m){var d=JSON.parse(m.data);row('v',d.topic,v).textContent=d.value;});"
+    "e.addEventListener('status',function(m){var d=JSON.parse(m.data);for(var k in d)row('s',k,s).textContent=d[k];});"
+    "</script></body></html>\n";
+// Order of the values in _eventStatus
+static const char *const SSE_STATUS_NAMES[ESP_IOTLIB_SSE_STATUS_FIELDS] = {
+    "free_heap_bytes", "max_free_block_bytes", "wifi_connected", "wifi_rssi_dbm", "mqtt_state",
+    "mqtt_published_total", "mqtt_publish_dropped_total", "mqtt_received_total", "slow_loops_total"
+};
+static const char HTML_RESET[] PROGMEM = HTML_HEAD_TEXT "<title>Resetting...</title></head><body><div><p>Resetting...</p></div><hr /><p><a href='/'>HOME</a></p></body></html>\n";
 
 // --- Private Functions ---
-void espIOTLib::_mqttConnect(){
-    // Attempt to connect
-    if (!this->_mqttClient->connect(this->_iotWebConf->getThingName(), this->_mqttUserName, this->_mqttUserPassword)) {
-        MQTT_LOGF("Could not connect to MQTT server!!\n");
-        MQTT_LOGF(" -- Connect return: %d // Error: %d, try again in 5 seconds.\n", mqttClient.returnCode(), mqttClient.lastError());
-        this->_mqttLastConnectFailTime = millis();
-    } else {
-        MQTT_LOGF("Connected to MQTT\n");
-        this->_mqttLastConnectFailTime = 0;
-        // Subscribe to topics
-        for(String topic : this->_mqttTopics){
-            MQTT_LOGF("Subscribing to topic: %s\n", topic.c_str());
-            this->_mqttClient->subscribe(topic.c_str());
+void espIOTLib::_mqttSetState(espIOTLib_mqttState state){
+    this->_mqttState = state;
+    this->_mqttStateSince = millis();
+}
+
+// Give up on the current attempt and wait with exponential backoff plus jitter before the next one
+void espIOTLib::_mqttConnectFailed(){
+    this->_stats.mqttConnectFails++;
+    this->_mqttConnectAttempts++;
+    this->_mqttLastConnectFailTime = millis();
+    this->_mqttConnector->cancel();
+    this->_mqttNetClient->stop();
+    if(this->_brokers){
+        this->_brokers->failed(this->_mqttBroker, millis());
+        int next = this->_brokers->pick(millis());
+        if(next >= 0){
+            // Another broker is ready, no need to back off
+            this->_mqttSelectBroker(next);
+            this->_mqttSetState(ESP_IOTLIB_MQTT_DISCONNECTED);
+            return;
         }
     }
+
+    uint8_t shift = this->_mqttConnectAttempts - 1;
+    if(shift > 16)
+        shift = 16;
+    uint32_t backoff = (uint32_t)ESP_IOTLIB_MQTT_RECONNECT_INTERVAL << shift;
+    if(backoff > ESP_IOTLIB_MQTT_RECONNECT_MAX_INTERVAL || backoff < ESP_IOTLIB_MQTT_RECONNECT_INTERVAL)
+        backoff = ESP_IOTLIB_MQTT_RECONNECT_MAX_INTERVAL;
+    // Equal jitter: wait between half and the full backoff so a fleet does not reconnect in lockstep
+    this->_mqttBackoffDelay = backoff / 2 + random(backoff / 2 + 1);
+    MQTT_LOGW(" -- Connect return: %d // Error: %d, try again in %u ms.\n", this->_mqttClient->returnCode(), this->_mqttClient->lastError(), (unsigned)this->_mqttBackoffDelay);
+    this->_mqttSetState(ESP_IOTLIB_MQTT_BACKOFF);
+}
+
+// (Re)start connecting on the next loop() without waiting for a backoff
+void espIOTLib::_mqttStartConnect(){
+    this->_mqttConnectAttempts = 0;
+    this->_mqttSetState(ESP_IOTLIB_MQTT_DISCONNECTED);
+}
+
+// Clean DISCONNECT, it must not stay in the send buffer because stop() discards it
+bool espIOTLib::_mqttDisconnect(){
+    if(!this->_mqttClient->connected())
+        return false;
+    espIOTLib_netFlushPolicy policy = this->_mqttNetClient->flushPolicy();
+    this->_mqttNetClient->setFlushPolicy(ESP_IOTLIB_NET_FLUSH_PACKET);
+    bool result = this->_mqttClient->disconnect();
+    this->_mqttNetClient->setFlushPolicy(policy);
+    return result;
+}
+
+const char *espIOTLib::_mqttHost(){
+    if(this->_brokers && this->_brokers->get(this->_mqttBroker))
+        return this->_brokers->get(this->_mqttBroker)->host;
+    return this->_mqttConfig->server;
+}
+
+uint16_t espIOTLib::_mqttPort(){
+    if(this->_brokers && this->_brokers->get(this->_mqttBroker))
+        return this->_brokers->get(this->_mqttBroker)->port;
+    return ESP_IOTLIB_MQTT_PORT;
+}
+
+// MQTT 3.1.1 CONNECT with clean session. Written here instead of by MQTTClient::connect(), which waits for the CONNACK
+bool espIOTLib::_mqttSendConnect(){
+    const char *fields[3] = {this->_iotWebConf->getThingName(), this->_mqttConfig->userName, this->_mqttConfig->userPassword};
+    bool hasUserName = fields[1][0] != '\0';
+    bool hasPassword = hasUserName && fields[2][0] != '\0';
+    uint8_t fieldCount = hasPassword ? 3 : (hasUserName ? 2 : 1);
+    uint32_t remaining = 10;
+    for(uint8_t i = 0; i < fieldCount; i++)
+        remaining += 2 + strlen(fields[i]);
+
+    uint8_t header[5 + 10]; // Fixed header, variable header
+    size_t length = 0;
+    header[length++] = 0x10;
+    do{
+        header[length] = remaining & 0x7f;
+        remaining >>= 7;
+        if(remaining > 0)
+            header[length] |= 0x80;
+        length++;
+    } while(remaining > 0);
+    static const uint8_t protocol[] = {0, 4, 'M', 'Q', 'T', 'T', 4};
+    memcpy(header + length, protocol, sizeof(protocol));
+    length += sizeof(protocol);
+    header[length++] = 0x02 | (hasUserName ? 0x80 : 0) | (hasPassword ? 0x40 : 0);
+    header[length++] = ESP_IOTLIB_MQTT_KEEPALIVE >> 8;
+    header[length++] = ESP_IOTLIB_MQTT_KEEPALIVE & 0xff;
+
+    // One segment, even with ESP_IOTLIB_NET_FLUSH_LOOP
+    this->_mqttNetClient->cork();
+    bool ok = this->_mqttNetClient->write(header, length) == length;
+    for(uint8_t i = 0; ok && i < fieldCount; i++){
+        uint16_t fieldLen = strlen(fields[i]);
+        uint8_t prefix[2] = {(uint8_t)(fieldLen >> 8), (uint8_t)(fieldLen & 0xff)};
+        ok = this->_mqttNetClient->write(prefix, 2) == 2 && this->_mqttNetClient->write((const uint8_t *)fields[i], fieldLen) == fieldLen;
+    }
+    return this->_mqttNetClient->uncork() && ok;
+}
+
+void espIOTLib::_mqttSelectBroker(uint8_t index){
+    if(index == this->_mqttBroker)
+        return;
+    this->_mqttBroker = index;
+    this->_mqttFailbackCheck = millis();
+    if(this->_mqttProbe)
+        this->_mqttProbe->cancel();
+    this->_stats.mqttBrokerSwitches++;
+    MQTT_LOGF("Switching to MQTT broker %s:%u\n", this->_mqttHost(), this->_mqttPort());
+}
+
+// Back to the primary once it accepts connections again. The probe only runs while on a backup and never waits,
+// it is polled once per loop. Taken back only between publishes, the outbox and the in-flight window carry over
+// to the new connection anyway, but nothing has to be sent twice
+void espIOTLib::_mqttServiceFailback(){
+    const espIOTLib_broker *primary = this->_brokers->get(0);
+    if(!primary)
+        return;
+    switch (this->_mqttProbe->poll(millis()))
+    {
+    case ESP_IOTLIB_PROBE_IDLE:
+        if(millis() - this->_mqttFailbackCheck < ESP_IOTLIB_MQTT_FAILBACK_INTERVAL)
+            break;
+        this->_mqttFailbackCheck = millis();
+        this->_mqttProbe->start(primary->host, primary->port, ESP_IOTLIB_MQTT_CONNECT_TIMEOUT, millis());
+        break;
+    case ESP_IOTLIB_PROBE_FAILED:
+        this->_mqttProbe->cancel();
+        break;
+    case ESP_IOTLIB_PROBE_REACHABLE:
+        if((this->_inflight && this->_inflight->depth() > 0) || this->_mqttNetClient->pending() > 0)
+            break;
+        this->_mqttProbe->cancel();
+        MQTT_LOGF("Primary MQTT broker is reachable again\n");
+        this->_stats.mqttFailbacks++;
+        this->_brokers->reachable(0);
+        this->_mqttDisconnect();
+        this->_mqttSelectBroker(0);
+        this->_mqttStartConnect();
+        break;
+    default:
+        break;
+    }
 }
 
 const char* espIOTLib::_mqttReturnToString(lwmqtt_return_code_t retval){
@@ -136,24 +331,316 @@ const char* espIOTLib::_mqttErrorToString(lwmqtt_err_t errval){
     }
 }
 
-// Reconnect to MQTT server
+// Hand a publish to the network task if it runs, otherwise publish right away
+bool espIOTLib::_publish(const char *topic, const char *payload, size_t length, uint8_t qos){
+    HEAP_SCOPE(ESP_IOTLIB_HEAP_PUBLISH);
+#ifdef ESP32
+    if(this->_networkTaskRunning){
+        espIOTLib_netMessage *message = this->_publishQueue->back();
+        if(!message || strlen(topic) >= ESP_IOTLIB_OUTBOX_TOPIC_LEN || length > ESP_IOTLIB_NET_QUEUE_PAYLOAD_LEN){
+            MQTT_LOGD(" Network task queue full...\n");
+            this->_stats.mqttPublishDropped++;
+            return false;
+        }
+        strcpy(message->topic, topic);
+        memcpy(message->payload, payload, length);
+        message->payloadLen = length;
+        message->qos = qos;
+        this->_publishQueue->commit();
+        MQTT_LOGD(" Handed over\n");
+        return true;
+    }
+#endif
+    if(qos > 0)
+        return this->_publishQoS1Now(topic, payload, length);
+    return this->_publishNow(topic, payload, length);
+}
+
+// Into the in-flight window, sent right away if connected and retransmitted from loop() until acknowledged
+bool espIOTLib::_publishQoS1Now(const char *topic, const char *payload, size_t length){
+    if(!this->_inflight || !this->_inflight->add(topic, payload, length)){
+        MQTT_LOGD(" QoS 1 window full...\n");
+        this->_stats.mqttPublishDropped++;
+        return false;
+    }
+    MQTT_LOGD(" In flight\n");
+    if(this->_mqttState == ESP_IOTLIB_MQTT_CONNECTED)
+        this->_inflight->service(*this->_mqttNetClient, millis());
+    return true;
+}
+
+void espIOTLib::_mqttAckCB(void *arg, uint16_t packetId){
+    espIOTLib *lib = (espIOTLib *)arg;
+    if(lib->_inflight)
+        lib->_inflight->acknowledge(packetId);
+}
+
+// Publish now if connected, otherwise (or if older publishes are still waiting) queue in the outbox
+bool espIOTLib::_publishNow(const char *topic, const char *payload, size_t length){
+    bool outboxEmpty = !this->_mqttOutbox || this->_mqttOutbox->isEmpty();
+    if (this->_connectedToWifi && this->_mqttClient->connected() && outboxEmpty){
+        if(this->_mqttClient->publish(topic, payload, length)){
+            MQTT_LOGD(" OK\n");
+            this->_stats.mqttPublished++;
+            return true;
+        }
+        this->_stats.mqttPublishFails++;
+    }
+    if(this->_mqttOutbox){
+        MQTT_LOGD(" Queued...\n");
+        if(this->_mqttOutbox->push(topic, payload, length, millis()))
+            return true;
+        if(length > ESP_IOTLIB_OUTBOX_PAYLOAD_LEN)
+            MQTT_LOGW("Outbox: %u byte payload of %s does not fit, dropped\n", (unsigned)length, topic);
+    } else {
+        MQTT_LOGD(" No Connection...\n");
+    }
+    this->_stats.mqttPublishDropped++;
+    return false;
+}
+
+// Send queued publishes, at most _mqttOutboxDrainBudget per call so doLoop() keeps running
+void espIOTLib::_drainOutbox(){
+    if(!this->_mqttOutbox || !this->_connectedToWifi)
+        return;
+    for(uint16_t i = 0; i < this->_mqttOutboxDrainBudget && this->_mqttClient->connected(); i++){
+        const espIOTLib_outboxEntry *entry = this->_mqttOutbox->front(millis());
+        if(!entry)
+            break;
+        if(!this->_mqttClient->publish(entry->topic, entry->payload, entry->payloadLen)){
+            MQTT_LOGW("Outbox publish to %s failed, retry later\n", entry->topic);
+            this->_stats.mqttPublishFails++;
+            break;
+        }
+        this->_stats.mqttPublished++;
+        this->_mqttOutbox->pop();
+    }
+}
+
+#ifdef ESP32
+void espIOTLib::_networkTask(void *arg){
+    espIOTLib *lib = (espIOTLib *)arg;
+    if(lib->_log)
+        lib->_log->setNetworkThread();
+    while(true){
+        lib->_drainPublishQueue();
+        lib->_serviceLoop();
+        espIOTLib_threadSleep(1);
+    }
+}
+
+// Network task side of the publish handover
+void espIOTLib::_drainPublishQueue(){
+    espIOTLib_netMessage *message;
+    while((message = this->_publishQueue->front()) != NULL){
+        if(message->qos > 0)
+            this->_publishQoS1Now(message->topic, message->payload, message->payloadLen);
+        else
+            this->_publishNow(message->topic, message->payload, message->payloadLen);
+        this->_publishQueue->pop();
+    }
+}
+
+// Application side of the inbound handover
+void espIOTLib::_drainInboundQueue(){
+    espIOTLib_netMessage *message;
+    while((message = this->_inboundQueue->front()) != NULL){
+        this->_stats.mqttReceived++;
+        size_t handled = this->_mqttTopicTree.dispatch(this->_mqttClient, message->topic, message->payload, message->payloadLen);
+        if(this->_mqttExtCB){
+            this->_mqttExtCB(this->_mqttClient, message->topic, message->payload, message->payloadLen);
+        } else if(handled == 0){
+            MQTT_LOGW("No handler for message on %s\n", message->topic);
+        }
+        this->_inboundQueue->pop();
+    }
+}
+#endif
+
+// Record the time since stageStart and return the start of the next stage
+uint32_t espIOTLib::_profileStage(espIOTLib_loopStage stage, uint32_t stageStart){
+    uint32_t now = micros();
+#ifdef ESP_IOTLIB_LOOP_PROFILING
+    this->_loopHistograms[stage].record(now - stageStart);
+#else
+    (void)stage;
+    (void)stageStart;
+#endif
+    return now;
+}
+
+// Hand an incoming message to the matching per-topic callbacks and the catch-all callback
+void espIOTLib::_mqttDispatch(MQTTClient *client, char topic[], char bytes[], int length){
+#ifdef ESP32
+    // Called by the network task, the callbacks belong to the application
+    if(this->_networkTaskRunning){
+        espIOTLib_netMessage *message = this->_inboundQueue->back();
+        if(!message || strlen(topic) >= ESP_IOTLIB_OUTBOX_TOPIC_LEN || length > ESP_IOTLIB_NET_QUEUE_PAYLOAD_LEN){
+            MQTT_LOGW("Dropped message on %s, inbound queue full\n", topic);
+            this->_stats.mqttReceiveDropped++;
+            return;
+        }
+        strcpy(message->topic, topic);
+        memcpy(message->payload, bytes, length);
+        message->payload[length] = '\0';
+        message->payloadLen = length;
+        this->_inboundQueue->commit();
+        return;
+    }
+#endif
+    this->_stats.mqttReceived++;
+    size_t handled = this->_mqttTopicTree.dispatch(client, topic, bytes, length);
+    if(this->_mqttExtCB){
+        this->_mqttExtCB(client, topic, bytes, length);
+    } else if(handled == 0){
+        MQTT_LOGW("No handler for message on %s\n", topic);
+    }
+}
+
+// Advance the MQTT connection by at most one step, so no single loop() blocks for a whole connect
 void espIOTLib::_reconnectMQTT(){
-    // Loop until we're reconnected
-    if(this->_doMqtt && this->_connectedToWifi && !this->_mqttClient->connected() && (this->_mqttLastConnectFailTime - millis() > ESP_IOTLIB_MQTT_RECONNECT_INTERVAL)) {
-        MQTT_LOGF(" -- Connect return: %d // Error: %d, try again in 5 seconds.\n", this->_mqttClient->returnCode(), this->_mqttClient->lastError());
-        this->_mqttConnect();
+    HEAP_SCOPE(ESP_IOTLIB_HEAP_MQTT_CONNECT);
+    if(!this->_connectedToWifi)
+        return;
+    switch (this->_mqttState)
+    {
+    case ESP_IOTLIB_MQTT_CONNECTED:
+        if(!this->_mqttClient->connected()){
+            MQTT_LOGW("Lost connection to MQTT server\n");
+            this->_mqttConnectFailed();
+        } else if(this->_brokers && this->_mqttBroker != 0){
+            this->_mqttServiceFailback();
+        }
+        break;
+    case ESP_IOTLIB_MQTT_BACKOFF:
+        if(millis() - this->_mqttStateSince < this->_mqttBackoffDelay)
+            break;
+        // fall through
+    case ESP_IOTLIB_MQTT_DISCONNECTED:
+        if(this->_brokers && !this->_brokers->available(this->_mqttBroker, millis())){
+            int next = this->_brokers->pick(millis());
+            if(next >= 0)
+                this->_mqttSelectBroker(next);
+        }
+        this->_mqttAttemptStart = millis();
+        // DNS and TCP connect run in the background like the failback probe, the socket is kept for the MQTT client
+        if(!this->_mqttConnector->start(this->_mqttHost(), this->_mqttPort(), ESP_IOTLIB_MQTT_CONNECT_TIMEOUT, millis(), true)){
+            MQTT_LOGW("Could not resolve %s\n", this->_mqttHost());
+            this->_mqttConnectFailed();
+            break;
+        }
+        this->_mqttSetState(this->_mqttConnector->state() == ESP_IOTLIB_PROBE_RESOLVING ? ESP_IOTLIB_MQTT_RESOLVING : ESP_IOTLIB_MQTT_TCP_CONNECTING);
+        break;
+    case ESP_IOTLIB_MQTT_RESOLVING:
+    case ESP_IOTLIB_MQTT_TCP_CONNECTING:
+        switch (this->_mqttConnector->poll(millis()))
+        {
+        case ESP_IOTLIB_PROBE_RESOLVING:
+            break;
+        case ESP_IOTLIB_PROBE_CONNECTING:
+            if(this->_mqttState == ESP_IOTLIB_MQTT_RESOLVING){
+                MQTT_LOGF("Resolved %s\n", this->_mqttHost());
+                this->_mqttSetState(ESP_IOTLIB_MQTT_TCP_CONNECTING);
+            }
+            break;
+        case ESP_IOTLIB_PROBE_REACHABLE:
+            if(this->_mqttConnector->attach(this->_wifiClient)){
+                this->_mqttSetState(ESP_IOTLIB_MQTT_CONNECTING);
+                break;
+            }
+            // fall through
+        default:
+            if(this->_mqttState == ESP_IOTLIB_MQTT_RESOLVING){
+                MQTT_LOGW("Could not resolve %s\n", this->_mqttHost());
+            } else {
+                MQTT_LOGW("Could not open TCP connection to MQTT server!!\n");
+            }
+            this->_mqttConnectFailed();
+            break;
+        }
+        break;
+    case ESP_IOTLIB_MQTT_CONNECTING:
+        // Socket is already open, only send CONNECT, the CONNACK is picked up by the next loop() calls
+        if(this->_mqttSendConnect()){
+            this->_mqttSetState(ESP_IOTLIB_MQTT_CONNACK_WAIT);
+        } else {
+            MQTT_LOGW("Could not send CONNECT to MQTT server!!\n");
+            this->_mqttConnectFailed();
+        }
+        break;
+    case ESP_IOTLIB_MQTT_CONNACK_WAIT:
+        // A CONNACK is 4 bytes. Once they are there MQTTClient::connect() reads them without waiting; it cannot be told
+        // that CONNECT is already sent, so its own copy is swallowed
+        if(this->_mqttNetClient->available() >= 4){
+            this->_mqttNetClient->setDiscardWrites(true);
+            bool connected = this->_mqttClient->connect(this->_iotWebConf->getThingName(), this->_mqttConfig->userName, this->_mqttConfig->userPassword, true);
+            this->_mqttNetClient->setDiscardWrites(false);
+            if(connected){
+                MQTT_LOGF("Connected to MQTT\n");
+                if(this->_brokers)
+                    this->_brokers->connected(this->_mqttBroker, millis() - this->_mqttAttemptStart);
+                this->_mqttSubscribeIndex = 0;
+                this->_mqttSetState(ESP_IOTLIB_MQTT_SUBSCRIBING);
+            } else {
+                MQTT_LOGW("Could not connect to MQTT server!!\n");
+                this->_mqttConnectFailed();
+            }
+        } else if(!this->_mqttNetClient->connected() || millis() - this->_mqttStateSince >= ESP_IOTLIB_MQTT_CONNECT_TIMEOUT){
+            MQTT_LOGW("No CONNACK from MQTT server!!\n");
+            this->_mqttConnectFailed();
+        }
+        break;
+    case ESP_IOTLIB_MQTT_SUBSCRIBING:
+        // One topic per loop()
+        if(this->_mqttSubscribeIndex < this->_mqttTopics.size()){
+            const char *topic = this->_mqttTopics[this->_mqttSubscribeIndex].c_str();
+            MQTT_LOGF("Subscribing to topic: %s\n", topic);
+            if(!this->_mqttClient->subscribe(topic)){
+                MQTT_LOGW("Subscribing to %s failed\n", topic);
+                this->_mqttConnectFailed();
+                break;
+            }
+            this->_mqttSubscribeIndex++;
+        } else {
+            this->_stats.mqttConnects++;
+            this->_mqttConnectAttempts = 0;
+            this->_mqttLastConnectFailTime = 0;
+            this->_mqttSetState(ESP_IOTLIB_MQTT_CONNECTED);
+            // Clean session, the broker forgot everything still in flight
+            if(this->_inflight)
+                this->_inflight->reconnected();
+        }
+        break;
     }
 }
 
 void espIOTLib::_wifiConnectCB(){
     this->_connectedToWifi = true;
-    IOT_LOGF("Connected to WiFi \"%s\"\n", this->_iotWebConf->getWifiAuthInfo().ssid);
+    this->_stats.wifiConnects++;
+    this->_stats.wifiConnectMillis = millis() - this->_wifiConnectStart;
+    if(this->_wifiFastAttempt){
+        this->_stats.wifiFastConnects++;
+        this->_wifiFastAttempt = false;
+    }
+    IOT_LOGF("Connected to WiFi \"%s\" in %u ms\n", this->_iotWebConf->getWifiAuthInfo().ssid, this->_stats.wifiConnectMillis);
+    if(this->_wifiCache){
+        this->_wifiCache->store(this->_iotWebConf->getWifiAuthInfo().ssid, WiFi.BSSID(), WiFi.channel(),
+            this->_fastConnectLease && !this->_doStaticIP, WiFi.localIP(), WiFi.gatewayIP(), WiFi.subnetMask(), WiFi.dnsIP());
+    }
     if(this->_doMqtt){
         MQTT_LOGF("\tAttempt connection to MQTT server!\n");
-        this->_mqttClient->setKeepAlive(30); // Send keepalive every 30 seconds
-        this->_mqttClient->begin(this->_mqttServer, ESP_IOTLIB_MQTT_PORT, this->_wifiClient);
-        this->_mqttConnect();
+        this->_mqttClient->setKeepAlive(ESP_IOTLIB_MQTT_KEEPALIVE);
+        this->_mqttClient->begin(this->_mqttConfig->server, ESP_IOTLIB_MQTT_PORT, *this->_mqttNetClient);
+        if(this->_brokers){
+            // The lists may have been changed on the config page
+            this->_brokers->configure(this->_mqttConfig->server, this->_mqttBackupConfig->servers, ESP_IOTLIB_MQTT_PORT);
+            int best = this->_brokers->pick(millis());
+            this->_mqttBroker = best >= 0 ? best : 0;
+            this->_mqttFailbackCheck = millis();
+        }
+        this->_mqttStartConnect();
     }
+#ifndef ESP_IOTLIB_NO_OTA
     if(this->_doOTAUpdate){
         IOT_LOGF("\tStart ArduinoOTA\n");
 #ifdef ESP8266
@@ -162,6 +649,7 @@ void espIOTLib::_wifiConnectCB(){
         ArduinoOTA.begin(); 
 #endif
     }
+#endif
 
     if(this->_extWifiConnectCB){
         IOT_LOGF("\tCall _extWifiConnectCB\n");
@@ -170,19 +658,148 @@ void espIOTLib::_wifiConnectCB(){
 }
 
 void espIOTLib::_connectWifi(const char* ssid, const char* password){
-    this->_ip.fromString(String(this->_ipAddressValue));
-    this->_mask.fromString(String(this->_netmaskValue));
-    this->_gateway.fromString(String(this->_gatewayValue));
-    this->_dns.fromString(String(this->_dnsValue));
+    this->_wifiConnectStart = millis();
+    this->_wifiSSID = ssid;
+    this->_wifiPassword = password;
+    this->_wifiFastAttempt = this->_wifiCache && this->_wifiCache->load(ssid);
+    if(this->_doStaticIP){
+        this->_ip.fromString(String(this->_staticIPConfig->ipAddress));
+        this->_mask.fromString(String(this->_staticIPConfig->netmask));
+        this->_gateway.fromString(String(this->_staticIPConfig->gateway));
+        this->_dns.fromString(String(this->_staticIPConfig->dns));
+#ifdef ESP8266
+        if (! WiFi.config(this->_ip, this->_dns, this->_gateway, this->_mask)) {
+#elif defined(ESP32)
+        if (! WiFi.config(this->_ip, this->_gateway, this->_mask, this->_dns)) {
+#endif
+            IOT_LOGW("STA Failed to configure. Static IP?\n");
+        }
+    } else if(this->_wifiFastAttempt && this->_fastConnectLease && this->_wifiCache->hasLease()){
+        // Last DHCP lease as static config, saves the DHCP exchange
 #ifdef ESP8266
-    if (! WiFi.config(this->_ip, this->_dns, this->_gateway, this->_mask)) {
+        WiFi.config(this->_wifiCache->ip(), this->_wifiCache->dns(), this->_wifiCache->gateway(), this->_wifiCache->mask());
 #elif defined(ESP32)
-    if (! WiFi.config(this->_ip, this->_gateway, this->_mask, this->_dns)) {
+        WiFi.config(this->_wifiCache->ip(), this->_wifiCache->gateway(), this->_wifiCache->mask(), this->_wifiCache->dns());
 #endif
-        IOT_LOGF("STA Failed to configure. Static IP?\n");
     }
     WiFi.mode(WIFI_STA);
-    WiFi.begin(ssid, password);
+    if(this->_wifiFastAttempt){
+        IOT_LOGF("Fast connect to channel %u\n", this->_wifiCache->channel());
+        WiFi.begin(ssid, password, this->_wifiCache->channel(), this->_wifiCache->bssid());
+    } else {
+        WiFi.begin(ssid, password);
+    }
+}
+
+// Move the duty cycle on by the phase that completed since the last loop()
+void espIOTLib::_serviceDutyCycle(){
+    espIOTLib_dutyCycle *cycle = this->_dutyCycle;
+    uint32_t now = millis();
+    if(cycle->sleeping()){
+        if(!cycle->wake(now))
+            return;
+        cycle->begin(now);
+        this->_dutyPublished = false;
+    }
+    switch(cycle->phase()){
+    case ESP_IOTLIB_DUTY_SAMPLE:
+        if(this->_dutySampleCB)
+            this->_dutySampleCB(cycle->wakeReason());
+        cycle->enter(ESP_IOTLIB_DUTY_WIFI, millis());
+        break;
+    case ESP_IOTLIB_DUTY_WIFI:
+        if(WiFi.isConnected())
+            cycle->enter(this->_doMqtt ? ESP_IOTLIB_DUTY_MQTT : ESP_IOTLIB_DUTY_PUBLISH, now);
+        break;
+    case ESP_IOTLIB_DUTY_MQTT:
+        if(this->_mqttState == ESP_IOTLIB_MQTT_CONNECTED)
+            cycle->enter(ESP_IOTLIB_DUTY_PUBLISH, now);
+        break;
+    case ESP_IOTLIB_DUTY_PUBLISH:
+        if(!this->_dutyPublished){
+            this->_dutyPublished = true;
+            this->_dutyReport();
+            if(this->_dutyPublishCB)
+                this->_dutyPublishCB();
+        }
+        // Publishes of the sample callback waited in the outbox for the connection
+        if(!this->_mqttOutbox || this->_mqttOutbox->isEmpty())
+            cycle->enter(ESP_IOTLIB_DUTY_FLUSH, millis());
+        break;
+    case ESP_IOTLIB_DUTY_FLUSH:
+        if(this->_doMqtt){
+            if(this->_inflight && this->_inflight->depth() > 0)
+                break;
+            this->_mqttNetClient->sendBuffered();
+            if(this->_mqttNetClient->pending() > 0)
+                break;
+        }
+        this->_dutySleep(false);
+        return;
+    default:
+        break;
+    }
+    // Stay awake while someone configures the device
+    iotwebconf::NetworkState state = this->_iotWebConf->getState();
+    if(state != iotwebconf::ApMode && state != iotwebconf::NotConfigured && cycle->timedOut(millis()))
+        this->_dutySleep(true);
+}
+
+// The previous cycle, the current one is still running
+void espIOTLib::_dutyReport(){
+    if(!this->_dutyReportTopic || !this->beginRecord(this->_dutyReportTopic))
+        return;
+    espIOTLib_dutyCycle *cycle = this->_dutyCycle;
+    this->recordAddInt("cycle", cycle->cycleCount());
+    this->recordAddStr("wake", espIOTLib_dutyCycle::wakeReasonName(cycle->wakeReason()));
+    this->recordAddInt("timeouts", cycle->timeoutCount());
+    this->recordAddInt("lost", cycle->lostCount());
+    for(uint8_t i = 0; i < ESP_IOTLIB_DUTY_PHASE_COUNT; i++)
+        this->recordAddInt(espIOTLib_dutyCycle::phaseName((espIOTLib_dutyPhase)i), cycle->lastPhaseMillis((espIOTLib_dutyPhase)i));
+    this->recordAddInt("awake", cycle->lastAwakeMillis());
+    this->commitRecord();
+}
+
+void espIOTLib::_dutySleep(bool timedOut){
+    IOT_LOGF("Duty cycle %s after %u ms\n", timedOut ? "timed out" : "done", this->_dutyCycle->awakeMillis(millis()));
+    if(this->_doMqtt){
+        this->_mqttDisconnect();
+        this->_mqttStartConnect();
+    }
+    // Modem sleep: _wifiConnectCB starts MQTT again once the radio is back
+    this->_connectedToWifi = false;
+    // Deep sleep ends with a reset, which would lose what is still queued in RAM. The outbox goes to its spill file,
+    // unacknowledged QoS 1 publishes and whatever does not fit are counted as lost
+    uint32_t lost = 0;
+    if(this->_dutyCycle->mode() == ESP_IOTLIB_SLEEP_DEEP){
+        if(this->_mqttOutbox){
+            this->persistMQTTOutbox();
+            lost += this->_mqttOutbox->size();
+        }
+        if(this->_inflight)
+            lost += this->_inflight->depth();
+        if(lost > 0)
+            IOT_LOGW("Duty cycle: %u publishes lost to deep sleep\n", (unsigned)lost);
+        if(this->_log)
+            this->_log->flush();
+    }
+    this->_dutyCycle->sleep(millis(), timedOut, lost);
+}
+
+// The access point moved or the lease is gone: forget both and connect the slow way
+void espIOTLib::_serviceFastConnect(){
+    if(WiFi.isConnected() || millis() - this->_wifiConnectStart < ESP_IOTLIB_FAST_CONNECT_TIMEOUT)
+        return;
+    IOT_LOGW("Fast connect failed, scanning\n");
+    this->_wifiFastAttempt = false;
+    this->_stats.wifiFastConnectFallbacks++;
+    this->_wifiCache->invalidate();
+    WiFi.disconnect();
+    if(!this->_doStaticIP){
+        // All zero switches back to DHCP
+        WiFi.config(IPAddress(0, 0, 0, 0), IPAddress(0, 0, 0, 0), IPAddress(0, 0, 0, 0), IPAddress(0, 0, 0, 0));
+    }
+    WiFi.begin(this->_wifiSSID, this->_wifiPassword);
 }
 
 /**
@@ -190,251 +807,768 @@ void espIOTLib::_connectWifi(const char* ssid, const char* password){
  */
 void espIOTLib::_handleRoot()
 {
+    HEAP_SCOPE(ESP_IOTLIB_HEAP_PAGES);
     // -- Let this->_iotWebConf test and handle captive portal requests.
     if (this->_iotWebConf->handleCaptivePortal())
     {
         // -- Captive portal request were already served.
         return;
     }
-    String s = "<!DOCTYPE html><html lang=\"en\"><head><meta name=\"viewport\" content=\"width=device-width, initial-scale=1, user-scalable=no\"/>";
-    s += "<title>";
-    s += this->_iotWebConf->getThingName();
-    s += " - Main</title></head><body><div><p>Main page of ";
-    s += this->_iotWebConf->getThingName();
-    s += "</p><p>Using Chip: "; 
-    s += String(CHIP_IDENT);
+    espIOTLib_pageWriter page(this->_localServer);
+    page.begin(200, "text/html");
+    espIOTLib_renderTemplate(page, HTML_ROOT, [this](Print &out, const char *name){ this->_rootPlaceholder(out, name); });
+    page.end();
+}
+
+void espIOTLib::_rootPlaceholder(Print &page, const char *name){
+    if(strcmp_P(name, PSTR("thing")) == 0){
+        page.print(this->_iotWebConf->getThingName());
+    } else if(strcmp_P(name, PSTR("chip")) == 0){
+        page.print(CHIP_IDENT);
 #if defined(ESP32)
-    s += ", Revision: ";
-    s += ESP.getChipRevision();
-    s += ", ";
-    s += ESP.getChipCores();
-    s += " Cores @ ";
-    s += ESP.getCpuFreqMHz();
-    s += " MHz";
-#endif
-    s += "</p><p>SDK Version: ";
-    s += String(ESP.getSdkVersion());
-    s += "</p></div><hr/>";
-    if(this->_doMqtt){
-        s += "<p>MQTT Config: </p>";
-        s += "<ul>";
-        s += "<li>Server: ";
-        s += this->_mqttServer;
-        s += "</li>";
-        s += "<li>User: ";
-        s += this->_mqttUserName;
-        s += "</li>";
-        if(this->_mqttClient->connected()){
-            s += "<li>Connected!</li>";
-        } else {
-            s += "<li>Not Connected</li>";
-        }
-        s += "</ul>";
-        s += "<p>MQTT Defaults: </p>";
-        s += "<ul>";
-        s += "<li>Server: ";
-        s += this->_mqttDefaultServer;
-        s += "</li>";
-        s += "<li>User: ";
-        s += this->_mqttDefaultUserName;
-        s += "</li>";
-        s += "</ul>";
-        s += "<hr/>";
-    }
-    if(this->_doStaticIP){
-        s += "<p>IP Config: </p>";
-        s += "<ul>";
-        s += "<li>IP address: ";
-        s += this->_ipAddressValue;
-        s += "</li>";
-        s += "<li>Gateway: ";
-        s += this->_gatewayValue;
-        s += "</li>";
-        s += "<li>Netmask: ";
-        s += this->_netmaskValue;
-        s += "</li>";
-        s += "<li>DNS address: ";
-        s += this->_dnsValue;
-        s += "</li>";
-        s += "</ul>";
-        s += "<hr/>";
-    }
-    if(this->_doOTAUpdate){
-        s += "<p>OTA update available under: ";
-        s += this->_ip.toString();
-        s += ":";
-        s += String(OTA_PORT);
-        s += "</p>";
-        s += "<hr/>";
-    }
-    s += "<p>Go to <a href='" ESP_IOTLIB_WEB_ENDPOINT "'>configure page</a> to change values.</p>";
-    s += "<p><a href='" ESP_IOTLIB_STATUS_ENDPOINT "'>Status</a> | <a href='" ESP_IOTLIB_RESET_ENDPOINT "'>Reset CPU</a> | <a href='" ESP_IOTLIB_MQTT_DISCONNECT_ENDPOINT "'>Force MQTT Reconnect</a> | </p>";
-    s += "<hr/><p>User Pages:</p><p>";
-    for(espIOTLib_webPage page: this->_webPages){
-        if(page.isShown){
-            s += "<a href='";
-            s += page.uri;
-            s += "'>";
-            s += page.menuName;
-            s += "</a> | ";
+        page.print(F(", Revision: "));
+        page.print(ESP.getChipRevision());
+        page.print(F(", "));
+        page.print(ESP.getChipCores());
+        page.print(F(" Cores @ "));
+        page.print(ESP.getCpuFreqMHz());
+        page.print(F(" MHz"));
+#endif
+    } else if(strcmp_P(name, PSTR("sdk")) == 0){
+        page.print(ESP.getSdkVersion());
+    } else if(strcmp_P(name, PSTR("mqtt")) == 0 && this->_doMqtt){
+        espIOTLib_renderTemplate(page, HTML_ROOT_MQTT, [this](Print &out, const char *name){
+            if(strcmp_P(name, PSTR("server")) == 0)
+                out.print(this->_mqttConfig->server);
+            else if(strcmp_P(name, PSTR("user")) == 0)
+                out.print(this->_mqttConfig->userName);
+            else if(strcmp_P(name, PSTR("connected")) == 0)
+                out.print(this->_mqttClient->connected() ? F("Connected!") : F("Not Connected"));
+            else if(strcmp_P(name, PSTR("defaultServer")) == 0)
+                out.print(this->_mqttConfig->defaultServer);
+            else if(strcmp_P(name, PSTR("defaultUser")) == 0)
+                out.print(this->_mqttConfig->defaultUserName);
+        });
+    } else if(strcmp_P(name, PSTR("ip")) == 0 && this->_doStaticIP){
+        espIOTLib_renderTemplate(page, HTML_ROOT_IP, [this](Print &out, const char *name){
+            if(strcmp_P(name, PSTR("ip")) == 0)
+                out.print(this->_staticIPConfig->ipAddress);
+            else if(strcmp_P(name, PSTR("gateway")) == 0)
+                out.print(this->_staticIPConfig->gateway);
+            else if(strcmp_P(name, PSTR("netmask")) == 0)
+                out.print(this->_staticIPConfig->netmask);
+            else if(strcmp_P(name, PSTR("dns")) == 0)
+                out.print(this->_staticIPConfig->dns);
+        });
+#ifndef ESP_IOTLIB_NO_OTA
+    } else if(strcmp_P(name, PSTR("ota")) == 0 && this->_doOTAUpdate){
+        page.print(F("<p>OTA update available under: "));
+        page.print(this->_ip);
+        page.print(':');
+        page.print(OTA_PORT);
+        page.print(F("</p><hr/>"));
+#endif
+    } else if(strcmp_P(name, PSTR("pages")) == 0){
+        for(const espIOTLib_webPage &webPage: this->_webPages){
+            if(webPage.isShown){
+                page.print(F("<a href='"));
+                page.print(webPage.uri);
+                page.print(F("'>"));
+                page.print(webPage.menuName);
+                page.print(F("</a> | "));
+            }
         }
     }
-
-    s += "</p></body></html>\n";
-
-    this->_localServer->send(200, "text/html", s);
 }
 
 void espIOTLib::_handleStatus(){
+    HEAP_SCOPE(ESP_IOTLIB_HEAP_PAGES);
     // -- Let this->_iotWebConf test and handle captive portal requests.
     if (this->_iotWebConf->handleCaptivePortal())
     {
         // -- Captive portal request were already served.
         return;
     }
+    espIOTLib_pageWriter page(this->_localServer);
+    page.begin(200, "text/html");
+    espIOTLib_renderTemplate(page, HTML_STATUS, [this](Print &out, const char *name){ this->_statusPlaceholder(out, name); });
+    page.end();
+}
 
-    String s = "<!DOCTYPE html><html lang=\"en\"><head><meta name=\"viewport\" content=\"width=device-width, initial-scale=1, user-scalable=no\"/>";
-    s += "<title>";
-    s += this->_iotWebConf->getThingName();
-    s += " - Status</title></head><body><div><p>Status page of ";
-    s += this->_iotWebConf->getThingName();
-    s += "</p>"; 
-    s += "</p><p>Using Chip: "; 
-    s += String(CHIP_IDENT);
-    s += " @ SDK Version: ";
-    s += String(ESP.getSdkVersion());
-    s += "</p>";
-    s += "<hr/>";
-
-    s += "<h3>Free Memory</h3>";
-    s += "<ul>";
-    s += "<li>Heap: ";
-    s += String(ESP.getFreeHeap()/1024.0);
-    s += " kB</li><li>Flash: ";
-    s += String(ESP.getFreeSketchSpace()/1024.0);
-    s += " kB</li>";
+void espIOTLib::_statusPlaceholder(Print &page, const char *name){
+    if(strcmp_P(name, PSTR("thing")) == 0){
+        page.print(this->_iotWebConf->getThingName());
+    } else if(strcmp_P(name, PSTR("chip")) == 0){
+        page.print(CHIP_IDENT);
+    } else if(strcmp_P(name, PSTR("sdk")) == 0){
+        page.print(ESP.getSdkVersion());
+    } else if(strcmp_P(name, PSTR("memory")) == 0){
+        this->_heapStats.sample(millis());
+        page.print(F("<ul><li>Heap: "));
+        page.print(ESP.getFreeHeap()/1024.0);
+        page.print(F(" kB (min. "));
+        page.print(this->_heapStats.minFreeHeap()/1024.0);
+        page.print(F(" kB since boot)</li><li>Largest block: "));
+        page.print(this->_heapStats.largestBlock()/1024.0);
+        page.print(F(" kB (min. "));
+        page.print(this->_heapStats.minLargestBlock()/1024.0);
+        page.print(F(" kB)</li><li>Fragmentation: "));
+        page.print(this->_heapStats.fragmentation());
+        page.print(F(" % (max. "));
+        page.print(this->_heapStats.maxFragmentation());
+        page.print(F(" %)</li><li>Pages / topics: "));
+        page.print(this->getWebPagesHeapBytes());
+        page.print(F(" / "));
+        page.print(this->getMQTTTopicsHeapBytes());
+        page.print(F(" Bytes</li><li>Flash: "));
+        page.print(ESP.getFreeSketchSpace()/1024.0);
+        page.print(F(" kB</li>"));
 #ifdef ESP8266
-    s += "<li>Stack: ";
-    s += String(ESP.getFreeContStack());
-    s += " Bytes</li>";
+        page.print(F("<li>Stack: "));
+        page.print(ESP.getFreeContStack());
+        page.print(F(" Bytes</li>"));
 #elif defined(ESP32)
-    s += "<li>PSRAM: ";
-    s += String(ESP.getFreePsram()/1024.0);
-    s += " kB</li>";
-#endif
-    s += "</ul></div><hr/>";
-
-    s += "<h3>Connection Status</h3><ul>";
-    s += "<li>WiFi: ";
-    if(WiFi.isConnected()){
-        s += "Connected</li>";
-        s += "<li>SSID: ";
-        s += WiFi.SSID();
-        s += "</li><li>IP: ";
-        s += WiFi.localIP().toString();
-        s += "</li><li>Mask: ";
-        s += WiFi.subnetMask().toString();
-        s += "</li><li>DNS: ";
-        s += WiFi.dnsIP().toString();
-        s += "</li><li>Broadcast: ";
-        s += WiFi.broadcastIP().toString();
-        s += "</li><li>MAC: ";
-        s += WiFi.macAddress();
-        s += "</li></ul>";
-    } else {
-        s += "Not Connected";
-        s += "</li><li>MAC: ";
-        s += WiFi.macAddress();
-        s += "</li></ul>";
-    }
-    s += "<hr/>";
-
-    if(this->_doMqtt){
-        s += "<h3>MQTT Status</h3><ul>";
-        s += "<li>Server: ";
-        s += this->_mqttServer;
-        s += "</li><li>User: ";
-        s += this->_mqttUserName;
-        s += "</li>";
+        page.print(F("<li>PSRAM: "));
+        page.print(ESP.getFreePsram()/1024.0);
+        page.print(F(" kB</li>"));
+#endif
+        page.print(F("</ul>"));
+#ifdef ESP_IOTLIB_HEAP_ACCOUNTING
+        page.print(F("<table><tr><th>Code path</th><th>Calls</th><th>Grew heap</th><th>Retained</th><th>Released</th><th>Max retained</th></tr>"));
+        for(uint8_t i = 0; i < ESP_IOTLIB_HEAP_SCOPE_COUNT; i++){
+            const espIOTLib_heapScopeStats *scope = this->_heapStats.scope((espIOTLib_heapScopeId)i);
+            page.print(F("<tr><td>"));
+            page.print(espIOTLib_heapStats::scopeName((espIOTLib_heapScopeId)i));
+            page.print(F("</td><td>"));
+            page.print(scope->calls);
+            page.print(F("</td><td>"));
+            page.print(scope->growths);
+            page.print(F("</td><td>"));
+            page.print(scope->retainedBytes);
+            page.print(F(" B</td><td>"));
+            page.print(scope->releasedBytes);
+            page.print(F(" B</td><td>"));
+            page.print(scope->maxRetained);
+            page.print(F(" B</td></tr>"));
+        }
+        page.print(F("</table>"));
+#endif
+    } else if(strcmp_P(name, PSTR("connection")) == 0){
+        uint8_t mac[6];
+        WiFi.macAddress(mac);
+        page.print(F("<ul><li>WiFi: "));
+        if(WiFi.isConnected()){
+            page.print(F("Connected</li><li>SSID: "));
+            page.print(this->_iotWebConf->getWifiAuthInfo().ssid);
+            page.print(F("</li><li>IP: "));
+            page.print(WiFi.localIP());
+            page.print(F("</li><li>Mask: "));
+            page.print(WiFi.subnetMask());
+            page.print(F("</li><li>DNS: "));
+            page.print(WiFi.dnsIP());
+            page.print(F("</li><li>Broadcast: "));
+            page.print(WiFi.broadcastIP());
+            page.print(F("</li><li>Connect time: "));
+            page.print(this->_stats.wifiConnectMillis);
+            page.print(F(" ms"));
+            if(this->_wifiCache){
+                page.print(F("</li><li>Fast connects: "));
+                page.print(this->_stats.wifiFastConnects);
+                page.print(F(", fallbacks: "));
+                page.print(this->_stats.wifiFastConnectFallbacks);
+                page.print(F(", cached channel: "));
+                page.print(this->_wifiCache->valid() ? this->_wifiCache->channel() : 0);
+            }
+        } else {
+            page.print(F("Not Connected"));
+        }
+        page.print(F("</li><li>MAC: "));
+        espIOTLib_pageWriter::printMAC(page, mac);
+        page.print(F("</li></ul>"));
+    } else if(strcmp_P(name, PSTR("duty")) == 0 && this->_dutyCycle){
+        uint32_t now = millis();
+        page.print(F("<h3>Duty Cycle</h3><ul><li>Period: "));
+        page.print(this->_dutyCycle->period());
+        page.print(this->_dutyCycle->mode() == ESP_IOTLIB_SLEEP_DEEP ? F(" ms, deep sleep") : F(" ms, modem sleep"));
+        page.print(F("</li><li>Cycles: "));
+        page.print(this->_dutyCycle->cycleCount());
+        page.print(F(", timed out: "));
+        page.print(this->_dutyCycle->timeoutCount());
+        page.print(F(", publishes lost: "));
+        page.print(this->_dutyCycle->lostCount());
+        page.print(F("</li><li>Woken by: "));
+        page.print(espIOTLib_dutyCycle::wakeReasonName(this->_dutyCycle->wakeReason()));
+        page.print(F("</li><li>Phase: "));
+        page.print(espIOTLib_dutyCycle::phaseName(this->_dutyCycle->phase()));
+        page.print(F("</li></ul><table><tr><th>Phase</th><th>This cycle</th><th>Last cycle</th></tr>"));
+        for(uint8_t i = 0; i < ESP_IOTLIB_DUTY_PHASE_COUNT; i++){
+            page.print(F("<tr><td>"));
+            page.print(espIOTLib_dutyCycle::phaseName((espIOTLib_dutyPhase)i));
+            page.print(F("</td><td>"));
+            page.print(this->_dutyCycle->phaseMillis((espIOTLib_dutyPhase)i, now));
+            page.print(F(" ms</td><td>"));
+            page.print(this->_dutyCycle->lastPhaseMillis((espIOTLib_dutyPhase)i));
+            page.print(F(" ms</td></tr>"));
+        }
+        page.print(F("<tr><td>awake</td><td>"));
+        page.print(this->_dutyCycle->awakeMillis(now));
+        page.print(F(" ms</td><td>"));
+        page.print(this->_dutyCycle->lastAwakeMillis());
+        page.print(F(" ms</td></tr></table><hr/>"));
+    } else if(strcmp_P(name, PSTR("mqtt")) == 0 && this->_doMqtt){
+        page.print(F("<h3>MQTT Status</h3><ul><li>Server: "));
+        page.print(this->_mqttHost());
+        page.print(':');
+        page.print(this->_mqttPort());
+        if(this->_brokers && this->_mqttBroker != 0)
+            page.print(F(" (backup)"));
+        page.print(F("</li><li>User: "));
+        page.print(this->_mqttConfig->userName);
+        page.print(F("</li>"));
         if(this->_mqttClient->connected()){
-            s += "<li>Connected!</li>";
+            page.print(F("<li>Connected!</li>"));
         } else {
-            s += "<li>Not Connected</li>";
+            page.print(F("<li>Not Connected</li>"));
         }
         if(this->_mqttForceDisconnect){
-            s += "<li>Force Disconnect!</li>";
+            page.print(F("<li>Force Disconnect!</li>"));
+        }
+        if(this->_mqttOutbox){
+            page.print(F("<li>Outbox: "));
+            page.print(this->_mqttOutbox->size());
+            page.print(F(" / "));
+            page.print(this->_mqttOutbox->capacity());
+            page.print(F(" queued, "));
+            page.print(this->_mqttOutbox->sentCount());
+            page.print(F(" sent, "));
+            page.print(this->_mqttOutbox->droppedCount());
+            page.print(F(" dropped, "));
+            page.print(this->_mqttOutbox->coalescedCount());
+            page.print(F(" coalesced, "));
+            page.print(this->_mqttOutbox->spilledCount());
+            page.print(F(" spilled, "));
+            page.print(this->_mqttOutbox->oversizedCount());
+            page.print(F(" too long, "));
+            page.print(this->_mqttOutbox->spillLostBytesCount());
+            page.print(F(" spill bytes lost</li>"));
+        }
+        page.print(F("<li>Network: "));
+        page.print(this->_mqttNetClient->packetCount());
+        page.print(F(" packets, "));
+        page.print(this->_mqttNetClient->bytesCount());
+        page.print(F(" bytes in "));
+        page.print(this->_mqttNetClient->writeCount());
+        page.print(F(" writes, sent as "));
+        page.print(this->_mqttNetClient->segmentCount());
+        page.print(F(" segments</li>"));
+        if(this->_inflight){
+            page.print(F("<li>QoS 1: "));
+            page.print(this->_inflight->depth());
+            page.print(F(" / "));
+            page.print(this->_inflight->window());
+            page.print(F(" in flight, "));
+            page.print(this->_inflight->ackedCount());
+            page.print(F(" acked, "));
+            page.print(this->_inflight->retransmitCount());
+            page.print(F(" retransmits, "));
+            page.print(this->_inflight->windowFullCount());
+            page.print(F(" window full</li>"));
+        }
+        if(this->_publishFilter){
+            page.print(F("<li>Publish filter: "));
+            page.print(this->_publishFilter->size());
+            page.print(F(" topics, "));
+            page.print(this->_publishFilter->passedCount());
+            page.print(F(" passed, "));
+            page.print(this->_publishFilter->suppressedDeadbandCount());
+            page.print(F(" in deadband, "));
+            page.print(this->_publishFilter->suppressedRateCount());
+            page.print(F(" rate limited, "));
+            page.print(this->_publishFilter->heartbeatCount());
+            page.print(F(" heartbeats</li>"));
         }
-        s += "<li>Return Code: ";
-        s += this->_mqttReturnToString(this->_mqttClient->returnCode());
-        s += "</li><li>Last Error: ";
-        s += this->_mqttErrorToString(this->_mqttClient->lastError());
-        s += "</li>";
-        s += "</ul>";
-        s += "<hr/>";
+        this->_printMQTTResult(page);
+        page.print(F("</ul>"));
+        if(this->_brokers){
+            page.print(F("<table><tr><th>Broker</th><th>Connects</th><th>Failures</th><th>Recent failures</th><th>Last / avg. latency</th><th>Score</th></tr>"));
+            for(uint8_t i = 0; i < this->_brokers->count(); i++){
+                const espIOTLib_broker *broker = this->_brokers->get(i);
+                page.print(F("<tr><td>"));
+                if(i == this->_mqttBroker)
+                    page.print(F("<b>"));
+                page.print(broker->host);
+                page.print(':');
+                page.print(broker->port);
+                if(i == this->_mqttBroker)
+                    page.print(F("</b>"));
+                page.print(F("</td><td>"));
+                page.print(broker->connects);
+                page.print(F("</td><td>"));
+                page.print(broker->failures);
+                page.print(F("</td><td>"));
+                page.print(this->_brokers->recentFailures(i));
+                page.print(F(" / 8</td><td>"));
+                page.print(broker->lastLatency);
+                page.print(F(" / "));
+                page.print(broker->avgLatency);
+                page.print(F(" ms</td><td>"));
+                page.print(this->_brokers->score(i));
+                page.print(F("</td></tr>"));
+            }
+            page.print(F("</table><p>Switches: "));
+            page.print(this->_stats.mqttBrokerSwitches);
+            page.print(F(", fail backs: "));
+            page.print(this->_stats.mqttFailbacks);
+            page.print(F("</p>"));
+        }
+        page.print(F("<hr/>"));
+    } else if(strcmp_P(name, PSTR("loop")) == 0){
+        page.print(F("<ul><li>Loops: "));
+        page.print(this->_stats.loops);
+        page.print(F("</li><li>Last / Max: "));
+        page.print(this->_stats.loopLastMicros);
+        page.print(F(" / "));
+        page.print(this->_stats.loopMaxMicros);
+        page.print(F(" us</li><li>Slow loops (&gt; "));
+        page.print(this->_slowLoopThreshold);
+        page.print(F(" us): "));
+        page.print(this->_stats.slowLoops);
+        page.print(F("</li></ul>"));
+#ifdef ESP_IOTLIB_LOOP_PROFILING
+        page.print(F("<table><tr><th>Stage</th><th>Count</th><th>Mean</th><th>p99</th><th>Max</th></tr>"));
+        for(uint8_t i = 0; i < ESP_IOTLIB_STAGE_COUNT; i++){
+            const espIOTLib_histogram &histogram = this->_loopHistograms[i];
+            page.print(F("<tr><td>"));
+            page.print(loopStageName((espIOTLib_loopStage)i));
+            page.print(F("</td><td>"));
+            page.print(histogram.count());
+            page.print(F("</td><td>"));
+            page.print(histogram.mean());
+            page.print(F(" us</td><td>"));
+            page.print(histogram.percentile(99));
+            page.print(F(" us</td><td>"));
+            page.print(histogram.max());
+            page.print(F(" us</td></tr>"));
+        }
+        page.print(F("</table>"));
+#endif
+    } else if(strcmp_P(name, PSTR("events")) == 0 && this->_eventStream){
+        page.print(F("<h3>Event Stream</h3><ul><li>Clients: "));
+        page.print(this->_eventStream->connected());
+        page.print(F(" / "));
+        page.print(ESP_IOTLIB_SSE_CLIENTS);
+        page.print(F(" ("));
+        page.print(this->_eventStream->rejectedCount());
+        page.print(F(" rejected, "));
+        page.print(this->_eventStream->stalledCount());
+        page.print(F(" stalled)</li><li>Events: "));
+        page.print(this->_eventStream->eventCount());
+        page.print(F(" ("));
+        page.print(this->_eventStream->droppedCount());
+        page.print(F(" dropped)</li></ul><hr/>"));
+    } else if(strcmp_P(name, PSTR("history")) == 0 && this->_timeSeries){
+        page.print(F("<h3>History</h3><ul><li>Series: "));
+        page.print(this->_timeSeries->size());
+        page.print(F(" / "));
+        page.print(this->_timeSeries->capacity());
+        page.print(F("</li><li>Recorded: "));
+        page.print(this->_timeSeries->recordedCount());
+        page.print(F("</li><li>Untracked: "));
+        page.print(this->_timeSeries->untrackedCount());
+        page.print(F("</li></ul><hr/>"));
+    } else if(strcmp_P(name, PSTR("assets")) == 0 && this->_assets){
+        page.print(F("<h3>Static Assets</h3><table><tr><th>URI</th><th>Size</th><th>Requests</th><th>Not modified</th></tr>"));
+        for(size_t i = 0; i < this->_assets->size(); i++){
+            const espIOTLib_asset *asset = this->_assets->get(i);
+            page.print(F("<tr><td>"));
+            page.print(asset->uri);
+            if(asset->gzip)
+                page.print(F(" (gzip)"));
+            page.print(F("</td><td>"));
+            page.print(asset->length);
+            page.print(F(" B</td><td>"));
+            page.print(asset->requests);
+            page.print(F("</td><td>"));
+            page.print(asset->notModified);
+            page.print(F("</td></tr>"));
+        }
+        page.print(F("</table><p>Sent: "));
+        page.print(this->_assets->bytesSentCount());
+        page.print(F(" Bytes</p><hr/>"));
+    } else if(strcmp_P(name, PSTR("log")) == 0 && this->_log){
+        page.print(F("<h3>Log</h3><ul><li>Messages: "));
+        page.print(this->_log->loggedCount());
+        page.print(F(" ("));
+        page.print(this->_log->droppedCount());
+        page.print(F(" dropped, "));
+        page.print(this->_log->pending());
+        page.print(F(" pending)</li><li>Levels:"));
+        for(uint8_t i = 0; i < ESP_IOTLIB_LOG_SUBSYSTEM_COUNT; i++){
+            page.print(' ');
+            page.print(espIOTLib_log::subsystemName((espIOTLib_logSubsystem)i));
+            page.print('=');
+            page.print(espIOTLib_log::levelName(this->_log->getLevel((espIOTLib_logSubsystem)i)));
+        }
+        page.print(F("</li></ul><p><a href='" ESP_IOTLIB_LOG_ENDPOINT "'>Recent output</a></p><hr/>"));
+    } else if(strcmp_P(name, PSTR("tasks")) == 0 && this->_scheduler){
+        page.print(F("<h3>Tasks</h3><table><tr><th>Task</th><th>Period</th><th>Runs</th><th>Overruns</th><th>Skipped</th><th>Max Runtime</th><th>Mean / Max Lateness</th></tr>"));
+        for(size_t i = 0; i < this->_scheduler->size(); i++){
+            const espIOTLib_task *task = this->_scheduler->get(i);
+            page.print(F("<tr><td>"));
+            page.print(task->name);
+            if(!task->enabled)
+                page.print(F(" (disabled)"));
+            page.print(F("</td><td>"));
+            page.print(task->period);
+            page.print(F(" ms</td><td>"));
+            page.print(task->runs);
+            page.print(F("</td><td>"));
+            page.print(task->overruns);
+            page.print(F("</td><td>"));
+            page.print(task->skipped);
+            page.print(F("</td><td>"));
+            page.print(task->maxRuntime);
+            page.print(F(" us</td><td>"));
+            page.print(task->runs > 0 ? task->totalLateness / task->runs : 0);
+            page.print(F(" / "));
+            page.print(task->maxLateness);
+            page.print(F(" ms</td></tr>"));
+        }
+        page.print(F("</table><hr/>"));
+    }
+}
+
+// Recorded history, ?topic=<topic>&level=<0 raw, 1, 2>&format=<csv|json>, without topic the list of series
+void espIOTLib::_handleHistory(){
+    HEAP_SCOPE(ESP_IOTLIB_HEAP_PAGES);
+    bool json = this->_localServer->arg("format") != "csv";
+    espIOTLib_timeSeriesFormat format = json ? ESP_IOTLIB_TS_JSON : ESP_IOTLIB_TS_CSV;
+    const char *contentType = json ? "application/json" : "text/csv";
+    espIOTLib_pageWriter page(this->_localServer);
+    if(!this->_localServer->hasArg("topic")){
+        page.begin(200, contentType);
+        this->_timeSeries->writeIndex(page, format);
+        page.end();
+        return;
+    }
+    String topic = this->_localServer->arg("topic");
+    long level = this->_localServer->arg("level").toInt();
+    if(level < 0 || level >= ESP_IOTLIB_TS_LEVELS || !this->_timeSeries->contains(topic.c_str())){
+        this->_localServer->send(404, "text/plain", "Unknown topic or level");
+        return;
+    }
+    page.begin(200, contentType);
+    this->_timeSeries->write(page, topic.c_str(), level, format, millis());
+    page.end();
+}
+
+// Hands the connection to the event stream, it stays open after the handler returns
+void espIOTLib::_handleEvents(){
+    if(!this->_eventStream->accept(this->_localServer->client(), millis())){
+        this->_localServer->send(503, "text/plain", "Too many event stream clients");
+        return;
+    }
+    // New clients start with all status values
+    this->_eventStatusFull = true;
+}
+
+// Recent log output, ?<subsystem>=<level> changes the level first, e.g. ?mqtt=warn
+void espIOTLib::_handleLog(){
+    HEAP_SCOPE(ESP_IOTLIB_HEAP_PAGES);
+    for(uint8_t i = 0; i < ESP_IOTLIB_LOG_SUBSYSTEM_COUNT; i++){
+        const char *subsystem = espIOTLib_log::subsystemName((espIOTLib_logSubsystem)i);
+        if(!this->_localServer->hasArg(subsystem))
+            continue;
+        espIOTLib_logLevel level = espIOTLib_log::parseLevel(this->_localServer->arg(subsystem).c_str());
+        if(level == ESP_IOTLIB_LOG_LEVEL_COUNT){
+            this->_localServer->send(400, "text/plain", "Unknown level, use off, error, warn, info or debug");
+            return;
+        }
+        this->_log->setLevel((espIOTLib_logSubsystem)i, level);
     }
+    espIOTLib_pageWriter page(this->_localServer);
+    page.begin(200, "text/plain");
+    page.print(F("# Levels:"));
+    for(uint8_t i = 0; i < ESP_IOTLIB_LOG_SUBSYSTEM_COUNT; i++){
+        page.print(' ');
+        page.print(espIOTLib_log::subsystemName((espIOTLib_logSubsystem)i));
+        page.print('=');
+        page.print(espIOTLib_log::levelName(this->_log->getLevel((espIOTLib_logSubsystem)i)));
+    }
+    page.print(F(", "));
+    page.print(this->_log->loggedCount());
+    page.print(F(" messages, "));
+    page.print(this->_log->droppedCount());
+    page.print(F(" dropped\n"));
+    this->_log->writeHistory(page);
+    page.end();
+}
 
-    s += "<p><a href='/'>HOME</a></p>";
-    s += "</body></html>\n";
-    this->_localServer->send(200, "text/html", s);
+// Status values that changed since the last event, at most every ESP_IOTLIB_SSE_STATUS_INTERVAL
+void espIOTLib::_streamStatus(){
+    if(!this->_eventStream || this->_eventStream->connected() == 0)
+        return;
+    uint32_t now = millis();
+    if(now - this->_eventStatusSent < ESP_IOTLIB_SSE_STATUS_INTERVAL)
+        return;
+    this->_eventStatusSent = now;
+    int32_t values[ESP_IOTLIB_SSE_STATUS_FIELDS] = {
+        (int32_t)ESP.getFreeHeap(),
+        (int32_t)MAX_FREE_BLOCK(),
+        WiFi.isConnected(),
+        WiFi.RSSI(),
+        this->_doMqtt ? (int32_t)this->_mqttState : -1,
+        (int32_t)this->_stats.mqttPublished,
+        (int32_t)this->_stats.mqttPublishDropped,
+        (int32_t)this->_stats.mqttReceived,
+        (int32_t)this->_stats.slowLoops
+    };
+    bool full = this->_eventStatusFull;
+    this->_eventStatusFull = false;
+    char data[ESP_IOTLIB_SSE_EVENT_LEN];
+    espIOTLib_encoder json((uint8_t *)data, sizeof(data), ESP_IOTLIB_PAYLOAD_TEXT);
+    json.beginMap();
+    uint8_t changed = 0;
+    for(uint8_t i = 0; i < ESP_IOTLIB_SSE_STATUS_FIELDS; i++){
+        if(!full && values[i] == this->_eventStatus[i])
+            continue;
+        this->_eventStatus[i] = values[i];
+        json.key(SSE_STATUS_NAMES[i]);
+        json.encodeInt(values[i]);
+        changed++;
+    }
+    if(json.endMap() && changed > 0)
+        this->_eventStream->send("status", data, json.length());
+}
+
+// Machine readable counterpart of the status page, Prometheus text or JSON
+void espIOTLib::_handleMetrics(bool json){
+    HEAP_SCOPE(ESP_IOTLIB_HEAP_PAGES);
+    espIOTLib_pageWriter page(this->_localServer);
+    page.begin(200, json ? "application/json" : "text/plain; version=0.0.4");
+    espIOTLib_metricsWriter metrics(page, json ? ESP_IOTLIB_METRICS_JSON : ESP_IOTLIB_METRICS_PROMETHEUS);
+    metrics.begin();
+    metrics.metric(ESP_IOTLIB_METRIC_COUNTER, F("uptime_seconds"), (uint32_t)(millis() / 1000));
+    metrics.metric(ESP_IOTLIB_METRIC_GAUGE, F("free_heap_bytes"), (uint32_t)ESP.getFreeHeap());
+    metrics.metric(ESP_IOTLIB_METRIC_GAUGE, F("max_free_block_bytes"), (uint32_t)MAX_FREE_BLOCK());
+    this->_heapStats.sample(millis());
+    metrics.metric(ESP_IOTLIB_METRIC_GAUGE, F("heap_fragmentation_percent"), (uint32_t)this->_heapStats.fragmentation());
+    metrics.metric(ESP_IOTLIB_METRIC_GAUGE, F("heap_max_fragmentation_percent"), (uint32_t)this->_heapStats.maxFragmentation());
+    metrics.metric(ESP_IOTLIB_METRIC_GAUGE, F("min_free_heap_bytes"), this->_heapStats.minFreeHeap());
+    metrics.metric(ESP_IOTLIB_METRIC_GAUGE, F("min_max_free_block_bytes"), this->_heapStats.minLargestBlock());
+    metrics.metric(ESP_IOTLIB_METRIC_GAUGE, F("web_pages_heap_bytes"), (uint32_t)this->getWebPagesHeapBytes());
+    metrics.metric(ESP_IOTLIB_METRIC_GAUGE, F("mqtt_topics_heap_bytes"), (uint32_t)this->getMQTTTopicsHeapBytes());
+#ifdef ESP32
+    metrics.metric(ESP_IOTLIB_METRIC_GAUGE, F("free_psram_bytes"), (uint32_t)ESP.getFreePsram());
+#endif
+    metrics.metric(ESP_IOTLIB_METRIC_GAUGE, F("wifi_connected"), (uint32_t)WiFi.isConnected());
+    metrics.metric(ESP_IOTLIB_METRIC_GAUGE, F("wifi_rssi_dbm"), (int32_t)WiFi.RSSI());
+    metrics.metric(ESP_IOTLIB_METRIC_COUNTER, F("wifi_connects_total"), this->_stats.wifiConnects);
+    metrics.metric(ESP_IOTLIB_METRIC_GAUGE, F("wifi_connect_time_ms"), this->_stats.wifiConnectMillis);
+    if(this->_wifiCache){
+        metrics.metric(ESP_IOTLIB_METRIC_COUNTER, F("wifi_fast_connects_total"), this->_stats.wifiFastConnects);
+        metrics.metric(ESP_IOTLIB_METRIC_COUNTER, F("wifi_fast_connect_fallbacks_total"), this->_stats.wifiFastConnectFallbacks);
+    }
+    if(this->_dutyCycle){
+        metrics.metric(ESP_IOTLIB_METRIC_COUNTER, F("duty_cycles_total"), this->_dutyCycle->cycleCount());
+        metrics.metric(ESP_IOTLIB_METRIC_COUNTER, F("duty_cycle_timeouts_total"), this->_dutyCycle->timeoutCount());
+        metrics.metric(ESP_IOTLIB_METRIC_COUNTER, F("duty_cycle_lost_publishes_total"), this->_dutyCycle->lostCount());
+        metrics.metric(ESP_IOTLIB_METRIC_GAUGE, F("duty_cycle_wake_reason"), (uint32_t)this->_dutyCycle->wakeReason());
+        metrics.metric(ESP_IOTLIB_METRIC_GAUGE, F("duty_cycle_last_awake_ms"), this->_dutyCycle->lastAwakeMillis());
+    }
+    if(this->_doMqtt){
+        metrics.metric(ESP_IOTLIB_METRIC_GAUGE, F("mqtt_connected"), (uint32_t)this->_mqttClient->connected());
+        metrics.metric(ESP_IOTLIB_METRIC_GAUGE, F("mqtt_state"), (uint32_t)this->_mqttState);
+        metrics.metric(ESP_IOTLIB_METRIC_GAUGE, F("mqtt_failed_attempts"), this->_mqttConnectAttempts);
+        metrics.metric(ESP_IOTLIB_METRIC_GAUGE, F("mqtt_return_code"), (int32_t)this->_mqttClient->returnCode());
+        metrics.metric(ESP_IOTLIB_METRIC_GAUGE, F("mqtt_last_error"), (int32_t)this->_mqttClient->lastError());
+        metrics.metric(ESP_IOTLIB_METRIC_COUNTER, F("mqtt_connects_total"), this->_stats.mqttConnects);
+        metrics.metric(ESP_IOTLIB_METRIC_COUNTER, F("mqtt_connect_failures_total"), this->_stats.mqttConnectFails);
+        if(this->_brokers){
+            metrics.metric(ESP_IOTLIB_METRIC_GAUGE, F("mqtt_broker_index"), (uint32_t)this->_mqttBroker);
+            metrics.metric(ESP_IOTLIB_METRIC_COUNTER, F("mqtt_broker_switches_total"), this->_stats.mqttBrokerSwitches);
+            metrics.metric(ESP_IOTLIB_METRIC_COUNTER, F("mqtt_failbacks_total"), this->_stats.mqttFailbacks);
+        }
+        metrics.metric(ESP_IOTLIB_METRIC_COUNTER, F("mqtt_published_total"), this->_stats.mqttPublished);
+        metrics.metric(ESP_IOTLIB_METRIC_COUNTER, F("mqtt_publish_failures_total"), this->_stats.mqttPublishFails);
+        metrics.metric(ESP_IOTLIB_METRIC_COUNTER, F("mqtt_publish_dropped_total"), this->_stats.mqttPublishDropped);
+        metrics.metric(ESP_IOTLIB_METRIC_COUNTER, F("mqtt_received_total"), this->_stats.mqttReceived);
+        metrics.metric(ESP_IOTLIB_METRIC_COUNTER, F("mqtt_receive_dropped_total"), this->_stats.mqttReceiveDropped);
+        metrics.metric(ESP_IOTLIB_METRIC_COUNTER, F("mqtt_batches_total"), this->_stats.mqttBatches);
+        if(this->_mqttOutbox){
+            metrics.metric(ESP_IOTLIB_METRIC_GAUGE, F("outbox_queued"), (uint32_t)this->_mqttOutbox->size());
+            metrics.metric(ESP_IOTLIB_METRIC_GAUGE, F("outbox_oldest_age_ms"), this->_mqttOutbox->oldestAge(millis()));
+            metrics.metric(ESP_IOTLIB_METRIC_COUNTER, F("outbox_sent_total"), this->_mqttOutbox->sentCount());
+            metrics.metric(ESP_IOTLIB_METRIC_COUNTER, F("outbox_dropped_total"), this->_mqttOutbox->droppedCount());
+            metrics.metric(ESP_IOTLIB_METRIC_COUNTER, F("outbox_coalesced_total"), this->_mqttOutbox->coalescedCount());
+            metrics.metric(ESP_IOTLIB_METRIC_COUNTER, F("outbox_spilled_total"), this->_mqttOutbox->spilledCount());
+            metrics.metric(ESP_IOTLIB_METRIC_COUNTER, F("outbox_oversized_total"), this->_mqttOutbox->oversizedCount());
+            metrics.metric(ESP_IOTLIB_METRIC_COUNTER, F("outbox_spill_lost_bytes_total"), this->_mqttOutbox->spillLostBytesCount());
+        }
+        metrics.metric(ESP_IOTLIB_METRIC_COUNTER, F("mqtt_net_bytes_total"), this->_mqttNetClient->bytesCount());
+        metrics.metric(ESP_IOTLIB_METRIC_COUNTER, F("mqtt_net_writes_total"), this->_mqttNetClient->writeCount());
+        metrics.metric(ESP_IOTLIB_METRIC_COUNTER, F("mqtt_net_packets_total"), this->_mqttNetClient->packetCount());
+        metrics.metric(ESP_IOTLIB_METRIC_COUNTER, F("mqtt_net_segments_total"), this->_mqttNetClient->segmentCount());
+        metrics.metric(ESP_IOTLIB_METRIC_COUNTER, F("mqtt_net_flushes_total"), this->_mqttNetClient->flushCount());
+        if(this->_inflight){
+            metrics.metric(ESP_IOTLIB_METRIC_GAUGE, F("qos1_inflight"), (uint32_t)this->_inflight->depth());
+            metrics.metric(ESP_IOTLIB_METRIC_COUNTER, F("qos1_published_total"), this->_inflight->publishedCount());
+            metrics.metric(ESP_IOTLIB_METRIC_COUNTER, F("qos1_acked_total"), this->_inflight->ackedCount());
+            metrics.metric(ESP_IOTLIB_METRIC_COUNTER, F("qos1_retransmits_total"), this->_inflight->retransmitCount());
+            metrics.metric(ESP_IOTLIB_METRIC_COUNTER, F("qos1_window_full_total"), this->_inflight->windowFullCount());
+            metrics.metric(ESP_IOTLIB_METRIC_COUNTER, F("qos1_unknown_acks_total"), this->_inflight->unknownAckCount());
+        }
+        if(this->_publishFilter){
+            metrics.metric(ESP_IOTLIB_METRIC_GAUGE, F("publish_filter_topics"), (uint32_t)this->_publishFilter->size());
+            metrics.metric(ESP_IOTLIB_METRIC_COUNTER, F("publish_filter_passed_total"), this->_publishFilter->passedCount());
+            metrics.metric(ESP_IOTLIB_METRIC_COUNTER, F("publish_filter_deadband_total"), this->_publishFilter->suppressedDeadbandCount());
+            metrics.metric(ESP_IOTLIB_METRIC_COUNTER, F("publish_filter_rate_limited_total"), this->_publishFilter->suppressedRateCount());
+            metrics.metric(ESP_IOTLIB_METRIC_COUNTER, F("publish_filter_heartbeats_total"), this->_publishFilter->heartbeatCount());
+            metrics.metric(ESP_IOTLIB_METRIC_COUNTER, F("publish_filter_untracked_total"), this->_publishFilter->untrackedCount());
+        }
+    }
+    if(this->_eventStream){
+        metrics.metric(ESP_IOTLIB_METRIC_GAUGE, F("sse_clients"), (uint32_t)this->_eventStream->connected());
+        metrics.metric(ESP_IOTLIB_METRIC_COUNTER, F("sse_accepted_total"), this->_eventStream->acceptedCount());
+        metrics.metric(ESP_IOTLIB_METRIC_COUNTER, F("sse_rejected_total"), this->_eventStream->rejectedCount());
+        metrics.metric(ESP_IOTLIB_METRIC_COUNTER, F("sse_stalled_total"), this->_eventStream->stalledCount());
+        metrics.metric(ESP_IOTLIB_METRIC_COUNTER, F("sse_events_total"), this->_eventStream->eventCount());
+        metrics.metric(ESP_IOTLIB_METRIC_COUNTER, F("sse_dropped_total"), this->_eventStream->droppedCount());
+    }
+    if(this->_log){
+        metrics.metric(ESP_IOTLIB_METRIC_COUNTER, F("log_messages_total"), this->_log->loggedCount());
+        metrics.metric(ESP_IOTLIB_METRIC_COUNTER, F("log_dropped_total"), this->_log->droppedCount());
+        metrics.metric(ESP_IOTLIB_METRIC_GAUGE, F("log_pending"), (uint32_t)this->_log->pending());
+    }
+    if(this->_assets){
+        metrics.metric(ESP_IOTLIB_METRIC_COUNTER, F("asset_requests_total"), this->_assets->requestCount());
+        metrics.metric(ESP_IOTLIB_METRIC_COUNTER, F("asset_not_modified_total"), this->_assets->notModifiedCount());
+        metrics.metric(ESP_IOTLIB_METRIC_COUNTER, F("asset_sent_bytes_total"), this->_assets->bytesSentCount());
+    }
+    if(this->_timeSeries){
+        metrics.metric(ESP_IOTLIB_METRIC_GAUGE, F("timeseries_series"), (uint32_t)this->_timeSeries->size());
+        metrics.metric(ESP_IOTLIB_METRIC_COUNTER, F("timeseries_recorded_total"), this->_timeSeries->recordedCount());
+        metrics.metric(ESP_IOTLIB_METRIC_COUNTER, F("timeseries_untracked_total"), this->_timeSeries->untrackedCount());
+    }
+    metrics.metric(ESP_IOTLIB_METRIC_COUNTER, F("loops_total"), this->_stats.loops);
+    metrics.metric(ESP_IOTLIB_METRIC_GAUGE, F("loop_last_microseconds"), this->_stats.loopLastMicros);
+    metrics.metric(ESP_IOTLIB_METRIC_GAUGE, F("loop_max_microseconds"), this->_stats.loopMaxMicros);
+    metrics.metric(ESP_IOTLIB_METRIC_COUNTER, F("slow_loops_total"), this->_stats.slowLoops);
+#ifdef ESP_IOTLIB_LOOP_PROFILING
+    for(uint8_t i = 0; i < ESP_IOTLIB_STAGE_COUNT; i++)
+        metrics.metric(ESP_IOTLIB_METRIC_COUNTER, F("loop_stage_count"), this->_loopHistograms[i].count(), loopStageName((espIOTLib_loopStage)i));
+    for(uint8_t i = 0; i < ESP_IOTLIB_STAGE_COUNT; i++)
+        metrics.metric(ESP_IOTLIB_METRIC_GAUGE, F("loop_stage_mean_microseconds"), this->_loopHistograms[i].mean(), loopStageName((espIOTLib_loopStage)i));
+    for(uint8_t i = 0; i < ESP_IOTLIB_STAGE_COUNT; i++)
+        metrics.metric(ESP_IOTLIB_METRIC_GAUGE, F("loop_stage_p99_microseconds"), this->_loopHistograms[i].percentile(99), loopStageName((espIOTLib_loopStage)i));
+    for(uint8_t i = 0; i < ESP_IOTLIB_STAGE_COUNT; i++)
+        metrics.metric(ESP_IOTLIB_METRIC_GAUGE, F("loop_stage_max_microseconds"), this->_loopHistograms[i].max(), loopStageName((espIOTLib_loopStage)i));
+#endif
+    if(this->_scheduler){
+        metrics.setLabelKey(F("task"));
+        size_t tasks = this->_scheduler->size();
+        for(size_t i = 0; i < tasks; i++)
+            metrics.metric(ESP_IOTLIB_METRIC_COUNTER, F("task_runs_total"), this->_scheduler->get(i)->runs, this->_scheduler->get(i)->name);
+        for(size_t i = 0; i < tasks; i++)
+            metrics.metric(ESP_IOTLIB_METRIC_COUNTER, F("task_overruns_total"), this->_scheduler->get(i)->overruns, this->_scheduler->get(i)->name);
+        for(size_t i = 0; i < tasks; i++)
+            metrics.metric(ESP_IOTLIB_METRIC_COUNTER, F("task_skipped_total"), this->_scheduler->get(i)->skipped, this->_scheduler->get(i)->name);
+        for(size_t i = 0; i < tasks; i++)
+            metrics.metric(ESP_IOTLIB_METRIC_GAUGE, F("task_max_runtime_microseconds"), this->_scheduler->get(i)->maxRuntime, this->_scheduler->get(i)->name);
+        for(size_t i = 0; i < tasks; i++)
+            metrics.metric(ESP_IOTLIB_METRIC_GAUGE, F("task_max_lateness_milliseconds"), this->_scheduler->get(i)->maxLateness, this->_scheduler->get(i)->name);
+    }
+    if(this->_brokers){
+        metrics.setLabelKey(F("broker"));
+        uint8_t brokers = this->_brokers->count();
+        for(uint8_t i = 0; i < brokers; i++)
+            metrics.metric(ESP_IOTLIB_METRIC_COUNTER, F("mqtt_broker_connects_total"), this->_brokers->get(i)->connects, this->_brokers->get(i)->host);
+        for(uint8_t i = 0; i < brokers; i++)
+            metrics.metric(ESP_IOTLIB_METRIC_COUNTER, F("mqtt_broker_failures_total"), this->_brokers->get(i)->failures, this->_brokers->get(i)->host);
+        for(uint8_t i = 0; i < brokers; i++)
+            metrics.metric(ESP_IOTLIB_METRIC_GAUGE, F("mqtt_broker_recent_failures"), (uint32_t)this->_brokers->recentFailures(i), this->_brokers->get(i)->host);
+        for(uint8_t i = 0; i < brokers; i++)
+            metrics.metric(ESP_IOTLIB_METRIC_GAUGE, F("mqtt_broker_latency_ms"), this->_brokers->get(i)->avgLatency, this->_brokers->get(i)->host);
+    }
+    if(this->_dutyCycle){
+        metrics.setLabelKey(F("phase"));
+        for(uint8_t i = 0; i < ESP_IOTLIB_DUTY_PHASE_COUNT; i++)
+            metrics.metric(ESP_IOTLIB_METRIC_GAUGE, F("duty_cycle_last_phase_ms"), this->_dutyCycle->lastPhaseMillis((espIOTLib_dutyPhase)i), espIOTLib_dutyCycle::phaseName((espIOTLib_dutyPhase)i));
+    }
+#ifdef ESP_IOTLIB_HEAP_ACCOUNTING
+    metrics.setLabelKey(F("scope"));
+    for(uint8_t i = 0; i < ESP_IOTLIB_HEAP_SCOPE_COUNT; i++)
+        metrics.metric(ESP_IOTLIB_METRIC_COUNTER, F("heap_scope_calls_total"), this->_heapStats.scope((espIOTLib_heapScopeId)i)->calls, espIOTLib_heapStats::scopeName((espIOTLib_heapScopeId)i));
+    for(uint8_t i = 0; i < ESP_IOTLIB_HEAP_SCOPE_COUNT; i++)
+        metrics.metric(ESP_IOTLIB_METRIC_COUNTER, F("heap_scope_retained_bytes_total"), this->_heapStats.scope((espIOTLib_heapScopeId)i)->retainedBytes, espIOTLib_heapStats::scopeName((espIOTLib_heapScopeId)i));
+    for(uint8_t i = 0; i < ESP_IOTLIB_HEAP_SCOPE_COUNT; i++)
+        metrics.metric(ESP_IOTLIB_METRIC_COUNTER, F("heap_scope_released_bytes_total"), this->_heapStats.scope((espIOTLib_heapScopeId)i)->releasedBytes, espIOTLib_heapStats::scopeName((espIOTLib_heapScopeId)i));
+#endif
+    metrics.end();
+    page.end();
 }
 
 void espIOTLib::_handleResetReq(){
-    this->_localServer->send(200, "text/html", "<!DOCTYPE html><html lang=\"en\"><head><meta name=\"viewport\" content=\"width=device-width, initial-scale=1, user-scalable=no\"/><title>Resetting...</title></head><body><div><p>Resetting...</p></div><hr /><p><a href='/'>HOME</a></p></body></html>\n");
+    this->_localServer->send_P(200, PSTR("text/html"), HTML_RESET);
+    this->persistMQTTOutbox();
     delay(500);
     ESP.restart(); // Works for ESP8266 and ESP32
 }
-void espIOTLib::_handleMQTTDisconnReq(){
-    String s = "<!DOCTYPE html><html lang=\"en\"><head><meta name=\"viewport\" content=\"width=device-width, initial-scale=1, user-scalable=no\"/>";
-    s += "<title>MQTT Disconnect...</title></head><body><div><p>Trying MQTT Disconnect...</p>";
-    bool result = this->_mqttClient->disconnect();
-    if(result){
-        s += "<p>MQTT Disconnected!</p>";
-        this->_mqttForceDisconnect = true;
-    } else {
-        s += "<p>MQTT Disconnect failed!</p>";
-    }
 
-    s += "<ul><li>Return Code: ";
-    s += this->_mqttReturnToString(this->_mqttClient->returnCode());
-    s += "</li><li>Last Error: ";
-    s += this->_mqttErrorToString(this->_mqttClient->lastError());
-    s += "</li>";
-    if(this->_mqttClient->connected()){
-        s += "<li>Still Connected!</li>";
-    } else {
-        s += "<li>Not Connected</li>";
+// Return code / last error list items shared by the MQTT pages
+void espIOTLib::_printMQTTResult(Print &page){
+    page.print(F("<li>State: "));
+    page.print(mqttStateName(this->_mqttState));
+    if(this->_mqttState == ESP_IOTLIB_MQTT_BACKOFF){
+        page.print(F(", retry in "));
+        page.print((this->_mqttBackoffDelay - (millis() - this->_mqttStateSince)) / 1000);
+        page.print(F(" s"));
     }
-    s += "</ul>";
-
-    s += "</div><hr /><p>Go <a href='" ESP_IOTLIB_MQTT_CONNECT_ENDPOINT "'>here</a> to connect again</p></body></html>\n";
-    this->_localServer->send(200, "text/html", s);
+    page.print(F("</li><li>Failed attempts: "));
+    page.print(this->_mqttConnectAttempts);
+    page.print(F("</li><li>Return Code: "));
+    page.print(this->_mqttReturnToString(this->_mqttClient->returnCode()));
+    page.print(F("</li><li>Last Error: "));
+    page.print(this->_mqttErrorToString(this->_mqttClient->lastError()));
+    page.print(F("</li>"));
 }
 
-void espIOTLib::_handleMQTTConnReq(){
-    String s = "<!DOCTYPE html><html lang=\"en\"><head><meta name=\"viewport\" content=\"width=device-width, initial-scale=1, user-scalable=no\"/>";
-    s += "<title>MQTT Connect...</title></head><body><div><p>Trying MQTT Connect...</p>";
-    this->_mqttConnect();
-    delay(200);
-    bool result = this->_mqttClient->connected();
+void espIOTLib::_handleMQTTDisconnReq(){
+    bool result = this->_mqttDisconnect();
     if(result){
-        s += "<p>MQTT Connected!</p>";
-        this->_mqttForceDisconnect = false;
-    } else {
-        s += "<p>MQTT Connect failed!</p>";
+        this->_mqttForceDisconnect = true;
+        this->_mqttSetState(ESP_IOTLIB_MQTT_DISCONNECTED);
     }
+    espIOTLib_pageWriter page(this->_localServer);
+    page.begin(200, "text/html");
+    espIOTLib_renderTemplate(page, HTML_MQTT_DISCONNECT, [this, result](Print &out, const char *name){
+        if(strcmp_P(name, PSTR("result")) == 0)
+            out.print(result ? F("MQTT Disconnected!") : F("MQTT Disconnect failed!"));
+        else if(strcmp_P(name, PSTR("mqtt")) == 0)
+            this->_printMQTTResult(out);
+        else if(strcmp_P(name, PSTR("connected")) == 0)
+            out.print(this->_mqttClient->connected() ? F("Still Connected!") : F("Not Connected"));
+    });
+    page.end();
+}
 
-    s += "<ul><li>Return Code: ";
-    s += this->_mqttReturnToString(this->_mqttClient->returnCode());
-    s += "</li><li>Last Error: ";
-    s += this->_mqttErrorToString(this->_mqttClient->lastError());
-    s += "</li>";
-    s += "<li> mqttLastConnectFailTime (0 if not failed): ";
-    s += this->_mqttLastConnectFailTime;
-    s += "</li>";
-    s += "</ul>";
-
-    s += "</div><hr /><p><a href='/'>HOME</a></p></body></html>\n";
-    this->_localServer->send(200, "text/html", s);
+void espIOTLib::_handleMQTTConnReq(){
+    // Connecting happens step by step in loop(), this only restarts it without backoff
+    this->_mqttForceDisconnect = false;
+    bool connected = this->_mqttClient->connected();
+    if(!connected)
+        this->_mqttStartConnect();
+    espIOTLib_pageWriter page(this->_localServer);
+    page.begin(200, "text/html");
+    espIOTLib_renderTemplate(page, HTML_MQTT_CONNECT, [this, connected](Print &out, const char *name){
+        if(strcmp_P(name, PSTR("result")) == 0)
+            out.print(connected ? F("MQTT Connected!") : F("MQTT Connect started, see <a href='" ESP_IOTLIB_STATUS_ENDPOINT "'>status</a> for the result"));
+        else if(strcmp_P(name, PSTR("mqtt")) == 0)
+            this->_printMQTTResult(out);
+        else if(strcmp_P(name, PSTR("failTime")) == 0)
+            out.print(this->_mqttLastConnectFailTime);
+    });
+    page.end();
 }
 
 
@@ -447,9 +1581,12 @@ espIOTLib::espIOTLib(const char *deviceName, const char *version) {
     // Init espIOTLib
     this->_localServer = new WebServer(80);
     if(!this->_localServer || !deviceName || !version){
-        IOT_LOGF("LibInit: Invalid parameters!\n");
+        IOT_LOGE("LibInit: Invalid parameters!\n");
         return;
     }
+#if defined(ESP_IOTLIB_MQTT_LOG) || defined(ESP_IOTLIB_IOT_LOG)
+    this->enableLog();
+#endif
     IOT_LOGF("Initializing espIOTLib for %s at %s (Chip: %s)!\n", deviceName, version, CHIP_IDENT);
     IOT_LOGF("Free MEM %u, FLASH %u", ESP.getFreeHeap(), ESP.getFreeSketchSpace());
 
@@ -462,20 +1599,22 @@ espIOTLib::espIOTLib(const char *deviceName, const char *version) {
 
     this->_iotWebConf = new IotWebConf(deviceName, &(this->_dnsServer), this->_localServer, ESP_IOTLIB_AP_DEFAULT_PWD, version);
     this->_iotWebConf->setApTimeoutMs(30000);
+#ifndef ESP_IOTLIB_NO_HTTP_UPDATE
     this->_iotWebConf->setupUpdateServer(
         [this](const char* updatePath) { this->_httpUpdater.setup(this->_localServer, updatePath); },
         [this](const char* userName, char* password) { this->_httpUpdater.updateCredentials(userName, password); }
     );
+#endif
     this->_localServer->on("/", std::bind(&espIOTLib::_handleRoot, this));
     this->_localServer->on(ESP_IOTLIB_WEB_ENDPOINT, [this](){ this->_iotWebConf->handleConfig(); });
     this->_localServer->on(ESP_IOTLIB_RESET_ENDPOINT, std::bind(&espIOTLib::_handleResetReq, this));
     this->_localServer->on(ESP_IOTLIB_STATUS_ENDPOINT, std::bind(&espIOTLib::_handleStatus, this));
+    this->_localServer->on(ESP_IOTLIB_METRICS_ENDPOINT, [this](){ this->_handleMetrics(false); });
+    this->_localServer->on(ESP_IOTLIB_METRICS_JSON_ENDPOINT, [this](){ this->_handleMetrics(true); });
     this->_localServer->onNotFound([this](){ this->_iotWebConf->handleNotFound(); });
     this->_iotWebConf->setWifiConnectionCallback(std::bind(&espIOTLib::_wifiConnectCB, this));
+    this->_iotWebConf->setWifiConnectionHandler(std::bind(&espIOTLib::_connectWifi, this, std::placeholders::_1, std::placeholders::_2));
 
-    this->_mqttDefaultServer[0] = '\0';
-    this->_mqttDefaultUserName[0] = '\0';
-    this->_mqttDefaultUserPassword[0] = '\0';
     IOT_LOGF("\tespIOTLib initialized!\n");
 }
 
@@ -492,56 +1631,335 @@ void espIOTLib::start(){
     if (!validWebConfig){
         IOT_LOGF("Loading defaults\n");
         if(this->_doMqtt){
-            strncpy(this->_mqttServer, this->_mqttDefaultServer, ESP_IOTLIB_MQTT_TOPIC_BUFFER_LEN);
-            strncpy(this->_mqttUserName, this->_mqttDefaultUserName, ESP_IOTLIB_MQTT_TOPIC_BUFFER_LEN);
-            strncpy(this->_mqttUserPassword, this->_mqttDefaultUserPassword, ESP_IOTLIB_MQTT_TOPIC_BUFFER_LEN);
-            MQTT_LOGF("Set MQTT Defaults: %s@%s\n", this->_mqttUserName, this->_mqttServer);
+            strncpy(this->_mqttConfig->server, this->_mqttConfig->defaultServer, ESP_IOTLIB_MQTT_TOPIC_BUFFER_LEN);
+            strncpy(this->_mqttConfig->userName, this->_mqttConfig->defaultUserName, ESP_IOTLIB_MQTT_TOPIC_BUFFER_LEN);
+            strncpy(this->_mqttConfig->userPassword, this->_mqttConfig->defaultUserPassword, ESP_IOTLIB_MQTT_TOPIC_BUFFER_LEN);
+            MQTT_LOGF("Set MQTT Defaults: %s@%s\n", this->_mqttConfig->userName, this->_mqttConfig->server);
+            if(this->_mqttBackupConfig)
+                strncpy(this->_mqttBackupConfig->servers, this->_mqttBackupConfig->defaultServers, ESP_IOTLIB_MQTT_TOPIC_BUFFER_LEN);
         }
         
         if(this->_doStaticIP){
-            strncpy(this->_ipAddressValue, this->_ip.toString().c_str(), ESP_IOTLIB_IP_ADDRESS_BUFFER_LEN);
-            strncpy(this->_gatewayValue, this->_gateway.toString().c_str(), ESP_IOTLIB_IP_ADDRESS_BUFFER_LEN);
-            strncpy(this->_netmaskValue, this->_mask.toString().c_str(), ESP_IOTLIB_IP_ADDRESS_BUFFER_LEN);
-            strncpy(this->_dnsValue, this->_dns.toString().c_str(), ESP_IOTLIB_IP_ADDRESS_BUFFER_LEN);
+            strncpy(this->_staticIPConfig->ipAddress, this->_ip.toString().c_str(), ESP_IOTLIB_IP_ADDRESS_BUFFER_LEN);
+            strncpy(this->_staticIPConfig->gateway, this->_gateway.toString().c_str(), ESP_IOTLIB_IP_ADDRESS_BUFFER_LEN);
+            strncpy(this->_staticIPConfig->netmask, this->_mask.toString().c_str(), ESP_IOTLIB_IP_ADDRESS_BUFFER_LEN);
+            strncpy(this->_staticIPConfig->dns, this->_dns.toString().c_str(), ESP_IOTLIB_IP_ADDRESS_BUFFER_LEN);
         }
 
     }
 }
 
 void espIOTLib::configureStaticIP(IPAddress default_ip, IPAddress default_gateway, IPAddress default_mask, IPAddress default_dns){
+    if(!this->_staticIPConfig)
+        this->_staticIPConfig = new espIOTLib_staticIPConfig();
     this->_ip = default_ip;
     this->_gateway = default_gateway;
     this->_mask = default_mask;
     this->_dns = default_dns;
 
+    if(this->_doStaticIP)
+        return;
     this->_doStaticIP = true;
-    // TODO: Initalize strings?
     IOT_LOGF("Enabled Static IP, default: %s\n", default_ip.toString().c_str());
 
-    this->_connGroup.addItem(&this->_ipAddressParam);
-    this->_connGroup.addItem(&this->_gatewayParam);
-    this->_connGroup.addItem(&this->_netmaskParam);
-    this->_connGroup.addItem(&this->_dnsParam);
-    this->_iotWebConf->addParameterGroup(&(this->_connGroup));
-    
-    this->_iotWebConf->setWifiConnectionHandler(std::bind(&espIOTLib::_connectWifi, this, std::placeholders::_1, std::placeholders::_2));
+    this->_staticIPConfig->group.addItem(&this->_staticIPConfig->ipAddressParam);
+    this->_staticIPConfig->group.addItem(&this->_staticIPConfig->gatewayParam);
+    this->_staticIPConfig->group.addItem(&this->_staticIPConfig->netmaskParam);
+    this->_staticIPConfig->group.addItem(&this->_staticIPConfig->dnsParam);
+    this->_iotWebConf->addParameterGroup(&(this->_staticIPConfig->group));
 }
 
-void espIOTLib::loop(){
-    if(this->_iotWebConf)
+void espIOTLib::enableFastConnect(bool reuseLease){
+    this->_fastConnectLease = reuseLease;
+    if(this->_wifiCache)
+        return;
+    this->_wifiCache = new espIOTLib_wifiCache();
+    // Without this IotWebConf waits in AP mode for the AP timeout after every boot
+    this->_iotWebConf->skipApStartup();
+    IOT_LOGF("Enabled fast connect%s\n", reuseLease ? " with lease reuse" : "");
+}
+
+espIOTLib_wifiCache *espIOTLib::getWifiCache(){
+    return this->_wifiCache;
+}
+
+void espIOTLib::enableDutyCycle(uint32_t period, espIOTLibWakeCB sampleCB, espIOTLibCB publishCB, espIOTLib_sleepMode mode, uint32_t awakeTimeout){
+    this->_dutySampleCB = sampleCB;
+    this->_dutyPublishCB = publishCB;
+    if(this->_dutyCycle)
+        return;
+    this->_dutyCycle = new espIOTLib_dutyCycle(period, mode, awakeTimeout);
+    this->_dutyCycle->begin(millis());
+    // Every cycle of a deep sleeping device is a boot, it must not wait in AP mode
+    this->_iotWebConf->skipApStartup();
+    IOT_LOGF("Enabled duty cycle of %u ms, woken by %s\n", period, espIOTLib_dutyCycle::wakeReasonName(this->_dutyCycle->wakeReason()));
+}
+
+void espIOTLib::setDutyCycleReportTopic(const char *topic){
+    this->_dutyReportTopic = topic;
+}
+
+espIOTLib_dutyCycle *espIOTLib::getDutyCycle(){
+    return this->_dutyCycle;
+}
+
+// One pass over all network work. Called from loop(), or from _networkTask once that is running
+void espIOTLib::_serviceLoop(){
+    uint32_t loopStart = micros();
+    uint32_t stageStart = loopStart;
+    uint32_t taskMicros = 0;
+    (void)stageStart;
+    (void)taskMicros;
+    bool runTasks = this->_scheduler && !this->_networkTaskRunning;
+    this->_heapStats.sample(millis());
+    if(this->_iotWebConf){
         this->_iotWebConf->doLoop();
+        if(this->_wifiFastAttempt)
+            this->_serviceFastConnect();
+        PROFILE_STAGE(ESP_IOTLIB_STAGE_WEBCONF, stageStart);
+        if(this->_eventStream){
+            this->_eventStream->service(millis());
+            PROFILE_STAGE(ESP_IOTLIB_STAGE_EVENTS, stageStart);
+        }
+    }
+    if(runTasks){
+        this->_scheduler->run(millis(), ESP_IOTLIB_SCHEDULER_RUNS_PER_SLOT);
+        PROFILE_ADD(taskMicros, stageStart);
+    }
     if(this->_doMqtt){
-        if(!this->_mqttForceDisconnect)
+        if(!this->_mqttForceDisconnect){
             this->_reconnectMQTT();
+            PROFILE_STAGE(ESP_IOTLIB_STAGE_MQTT_RECONNECT, stageStart);
+        }
         if (this->_mqttClient->connected()){
             this->_mqttClient->loop();
+            PROFILE_STAGE(ESP_IOTLIB_STAGE_MQTT_LOOP, stageStart);
+            this->_drainOutbox();
+            if(this->_inflight && this->_mqttState == ESP_IOTLIB_MQTT_CONNECTED)
+                this->_inflight->service(*this->_mqttNetClient, millis());
+        }
+        // Socket writes of the publishes held back during this loop
+        this->_mqttNetClient->sendBuffered();
+        PROFILE_STAGE(ESP_IOTLIB_STAGE_OUTBOX, stageStart);
+        // Second slot, so a backlog of due tasks does not wait a whole loop behind the network work
+        if(runTasks){
+            this->_scheduler->run(millis(), ESP_IOTLIB_SCHEDULER_RUNS_PER_SLOT);
+            PROFILE_ADD(taskMicros, stageStart);
         }
     }
+    // Both slots as one sample, so the count stays one per loop
+    if(runTasks){
+        PROFILE_RECORD(ESP_IOTLIB_STAGE_TASKS, taskMicros);
+    }
+#ifndef ESP_IOTLIB_NO_OTA
     if(this->_doOTAUpdate){
         ArduinoOTA.handle();
+        PROFILE_STAGE(ESP_IOTLIB_STAGE_OTA, stageStart);
+    }
+#endif
+    if(this->_log){
+        this->_log->drain();
+        PROFILE_STAGE(ESP_IOTLIB_STAGE_LOG, stageStart);
+    }
+    uint32_t loopTime = micros() - loopStart;
+    this->_stats.loops++;
+    this->_stats.loopLastMicros = loopTime;
+    if(loopTime > this->_stats.loopMaxMicros)
+        this->_stats.loopMaxMicros = loopTime;
+    if(loopTime > this->_slowLoopThreshold)
+        this->_stats.slowLoops++;
+#ifdef ESP_IOTLIB_LOOP_PROFILING
+    this->_loopHistograms[ESP_IOTLIB_STAGE_TOTAL].record(loopTime);
+#endif
+}
+
+void espIOTLib::loop(){
+    // Producer side of the event stream stays in the application's context, like the publishes
+    this->_streamStatus();
+    if(this->_dutyCycle){
+        this->_serviceDutyCycle();
+        if(this->_dutyCycle->sleeping()){
+            // Modem sleep, only the scheduled tasks run until the radio is back
+            if(this->_scheduler)
+                this->_scheduler->run(millis(), 2 * ESP_IOTLIB_SCHEDULER_RUNS_PER_SLOT);
+            if(this->_log)
+                this->_log->drain();
+            return;
+        }
+    }
+#ifdef ESP32
+    if(this->_networkTaskRunning){
+        // Network work happens in _networkTask, only callbacks and tasks run in the application's context
+        this->_drainInboundQueue();
+        if(this->_scheduler)
+            this->_scheduler->run(millis(), 2 * ESP_IOTLIB_SCHEDULER_RUNS_PER_SLOT);
+        return;
+    }
+#endif
+    this->_serviceLoop();
+}
+
+#ifdef ESP32
+bool espIOTLib::startNetworkTask(int core, uint32_t stackSize, uint8_t priority){
+    if(!this->_doMqtt || this->_networkTaskRunning || this->_dutyCycle)
+        return false;
+    this->_publishQueue = new espIOTLib_spscQueue<espIOTLib_netMessage>(ESP_IOTLIB_NET_QUEUE_ENTRIES);
+    this->_inboundQueue = new espIOTLib_spscQueue<espIOTLib_netMessage>(ESP_IOTLIB_NET_QUEUE_ENTRIES);
+    // Set before the task exists, so both sides agree on the mode from the first loop on
+    this->_networkTaskRunning = true;
+    if(!espIOTLib_startThread("espIOTLibNet", &espIOTLib::_networkTask, this, stackSize, priority, core)){
+        IOT_LOGE("Could not start network task\n");
+        this->_networkTaskRunning = false;
+        delete this->_publishQueue;
+        delete this->_inboundQueue;
+        this->_publishQueue = NULL;
+        this->_inboundQueue = NULL;
+        return false;
+    }
+    IOT_LOGF("Started network task on core %d\n", core);
+    return true;
+}
+#endif
+
+const espIOTLib_stats &espIOTLib::getStats(){
+    return this->_stats;
+}
+
+void espIOTLib::setSlowLoopThreshold(uint32_t micros){
+    this->_slowLoopThreshold = micros;
+}
+
+const espIOTLib_histogram *espIOTLib::getLoopHistogram(espIOTLib_loopStage stage){
+#ifdef ESP_IOTLIB_LOOP_PROFILING
+    if(stage < ESP_IOTLIB_STAGE_COUNT)
+        return &this->_loopHistograms[stage];
+#else
+    (void)stage;
+#endif
+    return NULL;
+}
+
+espIOTLib_mqttState espIOTLib::getMQTTState(){
+    return this->_mqttState;
+}
+
+uint32_t espIOTLib::getMQTTConnectAttempts(){
+    return this->_mqttConnectAttempts;
+}
+
+const char *espIOTLib::mqttStateName(espIOTLib_mqttState state){
+    switch (state)
+    {
+    case ESP_IOTLIB_MQTT_DISCONNECTED:
+        return "Disconnected";
+    case ESP_IOTLIB_MQTT_BACKOFF:
+        return "Waiting to retry";
+    case ESP_IOTLIB_MQTT_RESOLVING:
+        return "Resolving server";
+    case ESP_IOTLIB_MQTT_TCP_CONNECTING:
+        return "TCP connecting";
+    case ESP_IOTLIB_MQTT_CONNECTING:
+        return "MQTT connecting";
+    case ESP_IOTLIB_MQTT_CONNACK_WAIT:
+        return "Waiting for CONNACK";
+    case ESP_IOTLIB_MQTT_SUBSCRIBING:
+        return "Subscribing";
+    case ESP_IOTLIB_MQTT_CONNECTED:
+        return "Connected";
+
+    default:
+        return "Unknown";
+    }
+}
+
+void espIOTLib::enableLog(Print *output){
+    if(this->_log){
+        this->_log->setOutput(output);
+        return;
+    }
+    // Both sides of the network task queue have to exist before it runs
+    if(this->_networkTaskRunning)
+        return;
+    this->_log = new espIOTLib_log(output);
+    this->addWebPage(ESP_IOTLIB_LOG_ENDPOINT, "Log", std::bind(&espIOTLib::_handleLog, this));
+}
+espIOTLib_log *espIOTLib::getLog(){
+    return this->_log;
+}
+void espIOTLib::setLogLevel(espIOTLib_logSubsystem subsystem, espIOTLib_logLevel level){
+    if(this->_log)
+        this->_log->setLevel(subsystem, level);
+}
+void espIOTLib::log(espIOTLib_logLevel level, PGM_P format, ...){
+    if(!this->_log)
+        return;
+    va_list args;
+    va_start(args, format);
+    this->_log->vlog(ESP_IOTLIB_LOG_APP, level, format, args);
+    va_end(args);
+}
+
+espIOTLib_heapStats *espIOTLib::getHeapStats(){
+    return &this->_heapStats;
+}
+size_t espIOTLib::getWebPagesHeapBytes(){
+    size_t bytes = this->_webPages.capacity() * sizeof(espIOTLib_webPage);
+    for(const espIOTLib_webPage &page : this->_webPages)
+        bytes += page.uri.length() + 1 + (page.menuName.length() > 0 ? page.menuName.length() + 1 : 0);
+    return bytes;
+}
+size_t espIOTLib::getMQTTTopicsHeapBytes(){
+    size_t bytes = this->_mqttTopics.capacity() * sizeof(String);
+    for(const String &topic : this->_mqttTopics)
+        bytes += topic.length() + 1;
+    return bytes;
+}
+const char *espIOTLib::loopStageName(espIOTLib_loopStage stage){
+    switch (stage)
+    {
+    case ESP_IOTLIB_STAGE_WEBCONF:
+        return "webconf";
+    case ESP_IOTLIB_STAGE_EVENTS:
+        return "events";
+    case ESP_IOTLIB_STAGE_MQTT_RECONNECT:
+        return "mqtt_reconnect";
+    case ESP_IOTLIB_STAGE_MQTT_LOOP:
+        return "mqtt_loop";
+    case ESP_IOTLIB_STAGE_OUTBOX:
+        return "outbox";
+    case ESP_IOTLIB_STAGE_OTA:
+        return "ota";
+    case ESP_IOTLIB_STAGE_TASKS:
+        return "tasks";
+    case ESP_IOTLIB_STAGE_LOG:
+        return "log";
+    case ESP_IOTLIB_STAGE_TOTAL:
+        return "total";
+
+    default:
+        return "unknown";
     }
 }
 
+int espIOTLib::addTask(const char *name, espIOTLibTaskCB callback, uint32_t period, uint32_t phase, uint32_t budget){
+    if(!this->_scheduler)
+        this->_scheduler = new espIOTLib_scheduler();
+    int id = this->_scheduler->add(name, callback, period, phase, budget, millis());
+    IOT_LOGF("Added task %s every %u ms as %d\n", name, (unsigned)period, id);
+    return id;
+}
+
+void espIOTLib::setTaskEnabled(int id, bool enabled){
+    if(this->_scheduler)
+        this->_scheduler->setEnabled(id, enabled);
+}
+
+const espIOTLib_task *espIOTLib::getTask(int id){
+    if(!this->_scheduler)
+        return NULL;
+    return this->_scheduler->get(id);
+}
+
 bool espIOTLib::isConnectedToWifi(){
     return this->_connectedToWifi;
 }
@@ -567,12 +1985,13 @@ void espIOTLib::setConfigPin(int pin){
 }
 
 bool espIOTLib::addWebPage(const char *uri, WebServer::THandlerFunction handler){
+    HEAP_SCOPE(ESP_IOTLIB_HEAP_WEB_PAGES);
     if(!uri || !handler)
         return false;
     
     espIOTLib_webPage newPage;
     newPage.uri = uri;
-    for(espIOTLib_webPage page: this->_webPages){
+    for(const espIOTLib_webPage &page: this->_webPages){
         if(newPage == page){
             return false;
         }
@@ -582,6 +2001,7 @@ bool espIOTLib::addWebPage(const char *uri, WebServer::THandlerFunction handler)
     return true;
 }
 bool espIOTLib::addWebPage(const char *uri, const char *menuName, WebServer::THandlerFunction handler){
+    HEAP_SCOPE(ESP_IOTLIB_HEAP_WEB_PAGES);
     if(!uri || !handler || !menuName)
         return false;
     
@@ -589,7 +2009,7 @@ bool espIOTLib::addWebPage(const char *uri, const char *menuName, WebServer::THa
     newPage.uri = uri;
     newPage.menuName = menuName;
     newPage.isShown = true;
-    for(espIOTLib_webPage page: this->_webPages){
+    for(const espIOTLib_webPage &page: this->_webPages){
         if(newPage == page){
             return false;
         }
@@ -599,6 +2019,45 @@ bool espIOTLib::addWebPage(const char *uri, const char *menuName, WebServer::THa
     return true;
 }
 
+void espIOTLib::_enableAssets(){
+    if(this->_assets)
+        return;
+    this->_assets = new espIOTLib_assets();
+    // The server only keeps the request headers it was told to
+    const char *headers[] = {"If-None-Match"};
+    this->_localServer->collectHeaders(headers, 1);
+}
+
+bool espIOTLib::addStaticAsset(const char *uri, const char *contentType, const uint8_t *data, size_t length, bool gzip, uint32_t maxAge){
+    HEAP_SCOPE(ESP_IOTLIB_HEAP_WEB_PAGES);
+    this->_enableAssets();
+    int index = this->_assets->add(uri, contentType, data, length, gzip, maxAge);
+    if(index < 0)
+        return false;
+    return this->addWebPage(uri, [this, index](){ this->_assets->serve(this->_localServer, index); });
+}
+
+bool espIOTLib::addStaticFile(const char *uri, const char *contentType, const char *path, bool gzip, uint32_t maxAge){
+    HEAP_SCOPE(ESP_IOTLIB_HEAP_WEB_PAGES);
+    this->_enableAssets();
+    int index = this->_assets->addFile(uri, contentType, path, gzip, maxAge);
+    if(index < 0)
+        return false;
+    return this->addWebPage(uri, [this, index](){ this->_assets->serve(this->_localServer, index); });
+}
+
+espIOTLib_assets *espIOTLib::getAssets(){
+    return this->_assets;
+}
+
+void espIOTLib::sendTemplate(PGM_P tmpl, espIOTLibTemplateCB callback, int code, const char *contentType){
+    HEAP_SCOPE(ESP_IOTLIB_HEAP_PAGES);
+    espIOTLib_pageWriter page(this->_localServer);
+    page.begin(code, contentType);
+    espIOTLib_renderTemplate(page, tmpl, callback);
+    page.end();
+}
+
     // MQTT
 MQTTClient *espIOTLib::getMQTTClient(){
     if(!this->_doMqtt)
@@ -606,85 +2065,678 @@ MQTTClient *espIOTLib::getMQTTClient(){
     return this->_mqttClient;
 }
 void espIOTLib::enableMQTT(const char *server, const char *username, const char *password){
+    if(this->_doMqtt)
+        return;
+    // Only allocated when used, a sketch without MQTT pays for a pointer instead of the buffers
+    this->_mqttConfig = new espIOTLib_mqttConfig();
     if(server && strlen(server) < ESP_IOTLIB_MQTT_TOPIC_BUFFER_LEN)
-        strncpy(this->_mqttDefaultServer, server, ESP_IOTLIB_MQTT_TOPIC_BUFFER_LEN);
+        strncpy(this->_mqttConfig->defaultServer, server, ESP_IOTLIB_MQTT_TOPIC_BUFFER_LEN);
     if(username && strlen(username) < ESP_IOTLIB_MQTT_TOPIC_BUFFER_LEN)
-        strncpy(this->_mqttDefaultUserName, username, ESP_IOTLIB_MQTT_TOPIC_BUFFER_LEN);
+        strncpy(this->_mqttConfig->defaultUserName, username, ESP_IOTLIB_MQTT_TOPIC_BUFFER_LEN);
     if(password && strlen(password) < ESP_IOTLIB_MQTT_TOPIC_BUFFER_LEN)
-        strncpy(this->_mqttDefaultUserPassword, password, ESP_IOTLIB_MQTT_TOPIC_BUFFER_LEN);
-    MQTT_LOGF("Enabled MQTT, default server: %s\n", this->_mqttDefaultServer);
+        strncpy(this->_mqttConfig->defaultUserPassword, password, ESP_IOTLIB_MQTT_TOPIC_BUFFER_LEN);
+    MQTT_LOGF("Enabled MQTT, default server: %s\n", this->_mqttConfig->defaultServer);
     this->_doMqtt = true;
     this->_mqttClient = new MQTTClient(ESP_IOTLIB_MQTT_BUFFER_SIZE);
-    this->_mqttGroup.addItem(&this->_mqttServerParam);
-    this->_mqttGroup.addItem(&this->_mqttUserNameParam);
-    this->_mqttGroup.addItem(&this->_mqttUserPasswordParam);
-    this->_iotWebConf->addParameterGroup(&this->_mqttGroup);
+    this->_mqttNetClient = new espIOTLib_bufferedClient(&this->_wifiClient);
+    this->_mqttConnector = new espIOTLib_tcpProbe();
+    this->_mqttClient->onMessageAdvanced([this](MQTTClient *client, char topic[], char bytes[], int length){
+        this->_mqttDispatch(client, topic, bytes, length);
+    });
+    this->_mqttConfig->group.addItem(&this->_mqttConfig->serverParam);
+    this->_mqttConfig->group.addItem(&this->_mqttConfig->userNameParam);
+    this->_mqttConfig->group.addItem(&this->_mqttConfig->userPasswordParam);
+    this->_iotWebConf->addParameterGroup(&this->_mqttConfig->group);
     this->_localServer->on(ESP_IOTLIB_MQTT_DISCONNECT_ENDPOINT, std::bind(&espIOTLib::_handleMQTTDisconnReq, this));
     this->_localServer->on(ESP_IOTLIB_MQTT_CONNECT_ENDPOINT, std::bind(&espIOTLib::_handleMQTTConnReq, this));
 }
+void espIOTLib::enableMQTTFailover(const char *backupServers){
+    if(!this->_doMqtt || this->_brokers)
+        return;
+    this->_mqttBackupConfig = new espIOTLib_mqttBackupConfig();
+    if(backupServers && strlen(backupServers) < ESP_IOTLIB_MQTT_TOPIC_BUFFER_LEN)
+        strncpy(this->_mqttBackupConfig->defaultServers, backupServers, ESP_IOTLIB_MQTT_TOPIC_BUFFER_LEN);
+    this->_mqttConfig->group.addItem(&this->_mqttBackupConfig->serversParam);
+    this->_brokers = new espIOTLib_brokerSet();
+    this->_mqttProbe = new espIOTLib_tcpProbe();
+    MQTT_LOGF("Enabled MQTT failover, default backups: %s\n", this->_mqttBackupConfig->defaultServers);
+}
+espIOTLib_brokerSet *espIOTLib::getMQTTBrokers(){
+    return this->_brokers;
+}
+uint8_t espIOTLib::getMQTTBrokerIndex(){
+    return this->_mqttBroker;
+}
+void espIOTLib::enableMQTTOutbox(size_t entries, espIOTLib_outboxPolicy policy, uint16_t drainBudget, const char *spillFile){
+    // The network task drains the outbox on ESP32, and a second call would throw the queued backlog away
+    if(this->_mqttOutbox || this->_networkTaskRunning){
+        MQTT_LOGW("MQTT outbox already enabled or network task running, not changed\n");
+        return;
+    }
+    this->_mqttOutbox = new espIOTLib_outbox(entries, policy);
+    this->_mqttOutboxDrainBudget = drainBudget > 0 ? drainBudget : 1;
+    MQTT_LOGF("Enabled MQTT outbox with %u entries\n", (unsigned)entries);
+#ifdef ESP_IOTLIB_OUTBOX_SPILL
+    if(spillFile && !this->_mqttOutbox->setSpillFile(spillFile, ESP_IOTLIB_OUTBOX_SPILL_MAX_BYTES)){
+        MQTT_LOGW("Could not open outbox spill file %s\n", spillFile);
+    }
+#else
+    (void)spillFile;
+#endif
+}
+espIOTLib_outbox *espIOTLib::getMQTTOutbox(){
+    return this->_mqttOutbox;
+}
+bool espIOTLib::persistMQTTOutbox(){
+#ifdef ESP_IOTLIB_OUTBOX_SPILL
+    if(!this->_mqttOutbox)
+        return false;
+    if(!this->_mqttOutbox->persist(millis())){
+        MQTT_LOGW("Outbox: %u entries could not be persisted\n", (unsigned)this->_mqttOutbox->size());
+        return false;
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+void espIOTLib::enablePublishFilter(float absDeadband, float relDeadband, uint32_t minInterval, uint32_t maxInterval, size_t topics){
+    espIOTLib_publishFilterConfig config;
+    config.absDeadband = absDeadband;
+    config.relDeadband = relDeadband;
+    config.minInterval = minInterval;
+    config.maxInterval = maxInterval;
+    if(this->_publishFilter)
+        delete this->_publishFilter;
+    this->_publishFilter = new espIOTLib_publishFilter(topics, config);
+    MQTT_LOGF("Enabled publish filter for %u topics\n", (unsigned)topics);
+}
+bool espIOTLib::setPublishFilter(const char *topic, float absDeadband, float relDeadband, uint32_t minInterval, uint32_t maxInterval){
+    if(!this->_publishFilter)
+        return false;
+    espIOTLib_publishFilterConfig config;
+    config.absDeadband = absDeadband;
+    config.relDeadband = relDeadband;
+    config.minInterval = minInterval;
+    config.maxInterval = maxInterval;
+    return this->_publishFilter->configure(topic, config);
+}
+espIOTLib_publishFilter *espIOTLib::getPublishFilter(){
+    return this->_publishFilter;
+}
+void espIOTLib::enableBatchPublish(size_t bufferLen){
+    if(!this->_doMqtt || this->_batch)
+        return;
+    this->_batch = new espIOTLib_batch();
+    this->_batch->buffer = new char[bufferLen];
+    this->_batch->bufferLen = bufferLen;
+    MQTT_LOGF("Enabled batch publish with %u bytes\n", (unsigned)bufferLen);
+}
+bool espIOTLib::beginBatch(const char *prefix, espIOTLib_batchMode mode){
+    if(!this->_batch || this->_batch->open || !prefix)
+        return false;
+    espIOTLib_batch *batch = this->_batch;
+    batch->prefix = prefix;
+    batch->mode = mode;
+    batch->count = 0;
+    batch->overflow = false;
+    batch->open = true;
+    if(mode == ESP_IOTLIB_BATCH_PIPELINE){
+        // Every publish until commitBatch() ends up in the same socket write (as long as it fits the buffer).
+        // With the network task the socket belongs to it, there the handover queue batches instead
+        if(!this->_networkTaskRunning)
+            this->_mqttNetClient->cork();
+    } else {
+        batch->buffer[0] = '{';
+        batch->used = 1;
+    }
+    return true;
+}
+// prefix/key in the batch buffer, pipeline mode only
+const char *espIOTLib::_batchTopic(const char *key){
+    espIOTLib_batch *batch = this->_batch;
+    int length = snprintf(batch->buffer, batch->bufferLen, "%s/%s", batch->prefix, key);
+    if(length < 0 || (size_t)length >= batch->bufferLen){
+        batch->overflow = true;
+        return NULL;
+    }
+    return batch->buffer;
+}
+// Append "key":value to the JSON object, strings get quoted and escaped. Keeps one byte for the closing brace
+bool espIOTLib::_batchAppend(const char *key, const char *value, bool quote){
+    espIOTLib_batch *batch = this->_batch;
+    if(batch->overflow)
+        return false;
+    size_t limit = batch->bufferLen - 1;
+    size_t used = batch->used;
+    auto put = [&](char c){
+        if(used < limit)
+            batch->buffer[used] = c;
+        used++;
+    };
+    auto putString = [&](const char *text){
+        put('"');
+        for(const char *c = text; *c; c++){
+            if(*c == '"' || *c == '\\'){
+                put('\\');
+            } else if((uint8_t)*c < 0x20){
+                // Control characters are not allowed in JSON strings
+                put(' ');
+                continue;
+            }
+            put(*c);
+        }
+        put('"');
+    };
+    if(batch->count > 0)
+        put(',');
+    putString(key);
+    put(':');
+    if(quote){
+        putString(value);
+    } else {
+        for(const char *c = value; *c; c++)
+            put(*c);
+    }
+    if(used > limit){
+        batch->overflow = true;
+        return false;
+    }
+    batch->used = used;
+    batch->count++;
+    return true;
+}
+bool espIOTLib::batchAddInt(const char *key, int64_t value){
+    if(!this->_batch || !this->_batch->open || !key)
+        return false;
+    if(this->_batch->mode == ESP_IOTLIB_BATCH_PIPELINE){
+        const char *topic = this->_batchTopic(key);
+        if(!topic)
+            return false;
+        this->publishInt(topic, (long long)value);
+        return true;
+    }
+    char payload[ESP_IOTLIB_MQTT_DATA_BUFFER_LEN];
+    espIOTLib_formatInt64(payload, ESP_IOTLIB_MQTT_DATA_BUFFER_LEN, value);
+    return this->_batchAppend(key, payload, false);
+}
+bool espIOTLib::batchAddFloat(const char *key, double value){
+    if(!this->_batch || !this->_batch->open || !key)
+        return false;
+    if(this->_batch->mode == ESP_IOTLIB_BATCH_PIPELINE){
+        const char *topic = this->_batchTopic(key);
+        if(!topic)
+            return false;
+        this->publishFloat(topic, value);
+        return true;
+    }
+    char payload[ESP_IOTLIB_MQTT_DATA_BUFFER_LEN];
+    if(espIOTLib_formatFloat(payload, ESP_IOTLIB_MQTT_DATA_BUFFER_LEN, value, ESP_IOTLIB_MQTT_FLOAT_PRECISION) == 0)
+        return false;
+    return this->_batchAppend(key, payload, false);
+}
+bool espIOTLib::batchAddStr(const char *key, const char *value){
+    if(!this->_batch || !this->_batch->open || !key || !value)
+        return false;
+    if(this->_batch->mode == ESP_IOTLIB_BATCH_PIPELINE){
+        const char *topic = this->_batchTopic(key);
+        if(!topic)
+            return false;
+        MQTT_LOGD("MQTT pub: %s STR: %s", topic, value);
+        return this->_publish(topic, value, strlen(value));
+    }
+    return this->_batchAppend(key, value, true);
+}
+void espIOTLib::enableQoS1(uint8_t window, uint32_t retransmitTimeout){
+    if(!this->_doMqtt || this->_inflight || this->_networkTaskRunning)
+        return;
+    this->_inflight = new espIOTLib_inflight(window, retransmitTimeout);
+    this->_mqttNetClient->setAckCallback(&espIOTLib::_mqttAckCB, this);
+    MQTT_LOGF("Enabled QoS 1 with a window of %u\n", window);
+}
+espIOTLib_inflight *espIOTLib::getQoS1Inflight(){
+    return this->_inflight;
+}
+void espIOTLib::enableTimeSeries(bool fromPublish, size_t series, const char *uri){
+    if(!this->_timeSeries){
+        this->_timeSeries = new espIOTLib_timeSeries(series);
+        this->addWebPage(uri ? uri : ESP_IOTLIB_HISTORY_ENDPOINT, "History", std::bind(&espIOTLib::_handleHistory, this));
+    }
+    this->_timeSeriesFromPublish = fromPublish;
+    IOT_LOGF("Enabled time series for %u topics\n", (unsigned)series);
+}
+bool espIOTLib::recordValue(const char *topic, float value){
+    if(!this->_timeSeries)
+        return false;
+    return this->_timeSeries->record(topic, value, millis());
+}
+espIOTLib_timeSeries *espIOTLib::getTimeSeries(){
+    return this->_timeSeries;
+}
+void espIOTLib::enableEventStream(){
+    if(this->_eventStream)
+        return;
+    this->_eventStream = new espIOTLib_eventStream();
+    this->addWebPage(ESP_IOTLIB_EVENTS_ENDPOINT, std::bind(&espIOTLib::_handleEvents, this));
+    // Static, so the browser only revalidates it
+    this->_enableAssets();
+    int live = this->_assets->add(ESP_IOTLIB_LIVE_ENDPOINT, "text/html", (const uint8_t *)HTML_LIVE, sizeof(HTML_LIVE) - 1, false, 0);
+    this->addWebPage(ESP_IOTLIB_LIVE_ENDPOINT, "Live", [this, live](){ this->_assets->serve(this->_localServer, live); });
+    IOT_LOGF("Enabled event stream for %u clients\n", ESP_IOTLIB_SSE_CLIENTS);
+}
+espIOTLib_eventStream *espIOTLib::getEventStream(){
+    return this->_eventStream;
+}
+void espIOTLib::setMQTTFlushPolicy(espIOTLib_netFlushPolicy policy){
+    if(this->_mqttNetClient)
+        this->_mqttNetClient->setFlushPolicy(policy);
+}
+espIOTLib_bufferedClient *espIOTLib::getMQTTNetClient(){
+    return this->_mqttNetClient;
+}
+bool espIOTLib::commitBatch(){
+    if(!this->_batch || !this->_batch->open)
+        return false;
+    espIOTLib_batch *batch = this->_batch;
+    batch->open = false;
+    this->_stats.mqttBatches++;
+    if(batch->mode == ESP_IOTLIB_BATCH_PIPELINE){
+        if(!this->_networkTaskRunning && !this->_mqttNetClient->uncork()){
+            MQTT_LOGW("Batch write failed\n");
+            this->_stats.mqttPublishFails++;
+            return false;
+        }
+        return !batch->overflow;
+    }
+    if(batch->overflow){
+        MQTT_LOGW("Batch for %s does not fit into %u bytes, dropped\n", batch->prefix, (unsigned)batch->bufferLen);
+        this->_stats.mqttPublishDropped++;
+        return false;
+    }
+    batch->buffer[batch->used++] = '}';
+    MQTT_LOGD("MQTT pub: %s Batch of %u", batch->prefix, batch->count);
+    return this->_publish(batch->prefix, batch->buffer, batch->used);
+}
 void espIOTLib::addMQTTSubscribeCB(espIOTLibMQTTCB mqttCB){
     MQTT_LOGF("Adding MQTT subscribe CB at %p\n", mqttCB);
     if(mqttCB && this->_doMqtt)
-        this->_mqttClient->onMessageAdvanced(mqttCB);
+        this->_mqttExtCB = mqttCB;
 }
 
 
 void espIOTLib::subscribeMQTT(const char* topic){
-    if(!topic || !this->_doMqtt)
-        return;
-    String topicStr = String(topic);
-    if(topicStr.length() > 0){
-        this->_mqttTopics.push_back(topicStr);
+    this->subscribeMQTT(topic, NULL);
+}
+bool espIOTLib::subscribeMQTT(const char* topic, espIOTLibMQTTCB mqttCB){
+    HEAP_SCOPE(ESP_IOTLIB_HEAP_MQTT_TOPICS);
+    if(!this->_doMqtt || !espIOTLib_topicTree::isValidFilter(topic))
+        return false;
+    if(this->_networkTaskRunning){
+        MQTT_LOGW("Subscribe to %s after the network task started\n", topic);
+        return false;
+    }
+    if(mqttCB)
+        this->_mqttTopicTree.add(topic, mqttCB);
+    // The topic list is what gets subscribed on every (re)connect
+    for(const String &known : this->_mqttTopics){
+        if(known == topic)
+            return true;
     }
+    this->_mqttTopics.push_back(String(topic));
+    if(this->_mqttState == ESP_IOTLIB_MQTT_CONNECTED){
+        MQTT_LOGF("Subscribing to topic: %s\n", topic);
+        this->_mqttClient->subscribe(topic);
+    }
+    return true;
+}
+// Local consumers of published values: history and live event stream
+void espIOTLib::_observeInt(const char *topic, int64_t value){
+    if(this->_timeSeriesFromPublish)
+        this->_timeSeries->record(topic, value, millis());
+    if(this->_eventStream && this->_eventStream->connected() > 0){
+        char data[ESP_IOTLIB_SSE_EVENT_LEN];
+        espIOTLib_encoder json((uint8_t *)data, sizeof(data), ESP_IOTLIB_PAYLOAD_TEXT);
+        json.beginMap();
+        json.key("topic");
+        json.encodeStr(topic);
+        json.key("value");
+        json.encodeInt(value);
+        if(json.endMap())
+            this->_eventStream->send("value", data, json.length());
+    }
+}
+void espIOTLib::_observeFloat(const char *topic, double value){
+    if(this->_timeSeriesFromPublish)
+        this->_timeSeries->record(topic, value, millis());
+    if(this->_eventStream && this->_eventStream->connected() > 0){
+        char data[ESP_IOTLIB_SSE_EVENT_LEN];
+        espIOTLib_encoder json((uint8_t *)data, sizeof(data), ESP_IOTLIB_PAYLOAD_TEXT);
+        json.setFloatPrecision(ESP_IOTLIB_MQTT_FLOAT_PRECISION);
+        json.beginMap();
+        json.key("topic");
+        json.encodeStr(topic);
+        json.key("value");
+        json.encodeDouble(value);
+        if(json.endMap())
+            this->_eventStream->send("value", data, json.length());
+    }
+}
+void espIOTLib::_observeStr(const char *topic, const char *value){
+    if(this->_eventStream && this->_eventStream->connected() > 0){
+        char data[ESP_IOTLIB_SSE_EVENT_LEN];
+        espIOTLib_encoder json((uint8_t *)data, sizeof(data), ESP_IOTLIB_PAYLOAD_TEXT);
+        json.beginMap();
+        json.key("topic");
+        json.encodeStr(topic);
+        json.key("value");
+        json.encodeStr(value);
+        if(json.endMap())
+            this->_eventStream->send("value", data, json.length());
+    }
+}
+
+// Text or CBOR/MessagePack as set for the topic, looked up only once per-topic formats are used
+espIOTLib_payloadFormat espIOTLib::_topicPayloadFormat(const char *topic){
+    if(this->_topicFormatCount == 0)
+        return this->_payloadFormat;
+    uint32_t hash = espIOTLib_topicHash(topic);
+    for(size_t i = 0; i < this->_topicFormatCount; i++){
+        if(this->_topicFormats[i].topicHash == hash && strcmp(this->_topicFormats[i].topic, topic) == 0)
+            return this->_topicFormats[i].format;
+    }
+    return this->_payloadFormat;
+}
+// Encode a number into _mqttDataBuffer, values that fit into 32 bit take the cheaper text formatter. Returns the length, 0 on failure
+size_t espIOTLib::_encodeSigned(const char *topic, int64_t value){
+    espIOTLib_payloadFormat format = this->_topicPayloadFormat(topic);
+    if(format != ESP_IOTLIB_PAYLOAD_TEXT){
+        espIOTLib_encoder encoder((uint8_t *)this->_mqttDataBuffer, ESP_IOTLIB_MQTT_DATA_BUFFER_LEN, format);
+        encoder.encodeInt(value);
+        MQTT_LOGD("MQTT pub: %s Int: %u bytes", topic, (unsigned)encoder.length());
+        return encoder.length();
+    }
+    size_t length;
+    if(value >= INT32_MIN && value <= INT32_MAX)
+        length = espIOTLib_formatInt(this->_mqttDataBuffer, ESP_IOTLIB_MQTT_DATA_BUFFER_LEN, (int32_t)value);
+    else
+        length = espIOTLib_formatInt64(this->_mqttDataBuffer, ESP_IOTLIB_MQTT_DATA_BUFFER_LEN, value);
+    MQTT_LOGD("MQTT pub: %s Int: %s", topic, this->_mqttDataBuffer);
+    return length;
+}
+size_t espIOTLib::_encodeUnsigned(const char *topic, uint64_t value){
+    espIOTLib_payloadFormat format = this->_topicPayloadFormat(topic);
+    if(format != ESP_IOTLIB_PAYLOAD_TEXT){
+        espIOTLib_encoder encoder((uint8_t *)this->_mqttDataBuffer, ESP_IOTLIB_MQTT_DATA_BUFFER_LEN, format);
+        encoder.encodeUInt(value);
+        MQTT_LOGD("MQTT pub: %s Int: %u bytes", topic, (unsigned)encoder.length());
+        return encoder.length();
+    }
+    size_t length;
+    if(value <= UINT32_MAX)
+        length = espIOTLib_formatUInt(this->_mqttDataBuffer, ESP_IOTLIB_MQTT_DATA_BUFFER_LEN, (uint32_t)value);
+    else
+        length = espIOTLib_formatUInt64(this->_mqttDataBuffer, ESP_IOTLIB_MQTT_DATA_BUFFER_LEN, value);
+    MQTT_LOGD("MQTT pub: %s Int: %s", topic, this->_mqttDataBuffer);
+    return length;
+}
+// Single precision values stay single precision, in text as well as binary
+size_t espIOTLib::_encodeFloat(const char *topic, double value, bool single){
+    espIOTLib_payloadFormat format = this->_topicPayloadFormat(topic);
+    if(format != ESP_IOTLIB_PAYLOAD_TEXT){
+        espIOTLib_encoder encoder((uint8_t *)this->_mqttDataBuffer, ESP_IOTLIB_MQTT_DATA_BUFFER_LEN, format);
+        if(single)
+            encoder.encodeFloat((float)value);
+        else
+            encoder.encodeDouble(value);
+        MQTT_LOGD("MQTT pub: %s Float: %u bytes", topic, (unsigned)encoder.length());
+        return encoder.length();
+    }
+    size_t length;
+    if(single)
+        length = espIOTLib_formatFloat(this->_mqttDataBuffer, ESP_IOTLIB_MQTT_DATA_BUFFER_LEN, (float)value, ESP_IOTLIB_MQTT_FLOAT_PRECISION);
+    else
+        length = espIOTLib_formatFloat(this->_mqttDataBuffer, ESP_IOTLIB_MQTT_DATA_BUFFER_LEN, value, ESP_IOTLIB_MQTT_FLOAT_PRECISION);
+    if(length == 0){
+        // Out of the fixed point range (or inf), nothing to send
+        MQTT_LOGW("MQTT pub: %s Float out of range, dropped\n", topic);
+        this->_stats.mqttPublishDropped++;
+        return 0;
+    }
+    MQTT_LOGD("MQTT pub: %s Float: %s", topic, this->_mqttDataBuffer);
+    return length;
 }
 // Publish int value to MQTT
-void espIOTLib::publishInt(const char *topic, uint32_t value){
+void espIOTLib::_publishSigned(const char *topic, int64_t value){
+    this->_observeInt(topic, value);
     if(!this->_doMqtt)
         return;
-    // Turn int into string
-    snprintf(this->_mqttDataBuffer, ESP_IOTLIB_MQTT_DATA_BUFFER_LEN-1, "%d", value);
-    MQTT_LOGF("MQTT pub: %s Int: %s", topic, this->_mqttDataBuffer);
-    // Publish if connected
-    if (this->_connectedToWifi && this->_mqttClient->connected()){
-        MQTT_LOGF(" OK\n");
-        this->_mqttClient->publish(topic, this->_mqttDataBuffer);
-    } else {
-        MQTT_LOGF(" No Connection...\n");
-    }
+    if(this->_publishFilter && !this->_publishFilter->check(topic, value, millis()))
+        return;
+    size_t length = this->_encodeSigned(topic, value);
+    if(length > 0)
+        this->_publish(topic, this->_mqttDataBuffer, length);
+}
+void espIOTLib::_publishUnsigned(const char *topic, uint64_t value){
+    this->_observeInt(topic, value);
+    if(!this->_doMqtt)
+        return;
+    if(this->_publishFilter && !this->_publishFilter->check(topic, value, millis()))
+        return;
+    size_t length = this->_encodeUnsigned(topic, value);
+    if(length > 0)
+        this->_publish(topic, this->_mqttDataBuffer, length);
+}
+void espIOTLib::publishInt(const char *topic, int value){
+    this->_publishSigned(topic, value);
+}
+void espIOTLib::publishInt(const char *topic, unsigned int value){
+    this->_publishUnsigned(topic, value);
+}
+void espIOTLib::publishInt(const char *topic, long value){
+    this->_publishSigned(topic, value);
+}
+void espIOTLib::publishInt(const char *topic, unsigned long value){
+    this->_publishUnsigned(topic, value);
+}
+void espIOTLib::publishInt(const char *topic, long long value){
+    this->_publishSigned(topic, value);
+}
+void espIOTLib::publishInt(const char *topic, unsigned long long value){
+    this->_publishUnsigned(topic, value);
 }
 // Publish str value to MQTT (value _must_ be null terminated)
 void espIOTLib::publishStr(const char *topic, char *value){
+    if(!value)
+        return;
+    this->_observeStr(topic, value);
     if(!this->_doMqtt)
         return;
-    MQTT_LOGF("MQTT pub: %s STR: %s", topic, value);
-    // Publish if connected
-    if (this->_connectedToWifi && this->_mqttClient->connected()){
-        MQTT_LOGF(" OK\n");
-        this->_mqttClient->publish(topic, value);
-    } else {
-        MQTT_LOGF(" No Connection...\n");
-    }
+    MQTT_LOGD("MQTT pub: %s STR: %s", topic, value);
+    this->_publish(topic, value, strlen(value));
 }
 // Publish float value to MQTT
-void espIOTLib::publishFloat(const char *topic, double value){
+void espIOTLib::publishFloat(const char *topic, float value){
+    // Check for nan
+    if(isnan(value)){
+        return;
+    }
+    this->_observeFloat(topic, value);
     if(!this->_doMqtt)
         return;
+    if(this->_publishFilter && !this->_publishFilter->check(topic, value, millis()))
+        return;
+    size_t length = this->_encodeFloat(topic, value, true);
+    if(length > 0)
+        this->_publish(topic, this->_mqttDataBuffer, length);
+}
+void espIOTLib::publishFloat(const char *topic, double value){
     // Check for nan
     if(isnan(value)){
         return;
     }
-    // Turn float into string
-    dtostrf( value, ESP_IOTLIB_MQTT_DATA_BUFFER_LEN-1, ESP_IOTLIB_MQTT_FLOAT_PRECISION, this->_mqttDataBuffer);
-    MQTT_LOGF("MQTT pub: %s Float: %s", topic, this->_mqttDataBuffer);
-    // Publish if connected
-    if (this->_connectedToWifi && this->_mqttClient->connected()){
-        MQTT_LOGF(" OK\n");
-        this->_mqttClient->publish(topic, this->_mqttDataBuffer);
-    } else {
-        MQTT_LOGF(" No Connection...\n");
+    this->_observeFloat(topic, value);
+    if(!this->_doMqtt)
+        return;
+    if(this->_publishFilter && !this->_publishFilter->check(topic, value, millis()))
+        return;
+    size_t length = this->_encodeFloat(topic, value, false);
+    if(length > 0)
+        this->_publish(topic, this->_mqttDataBuffer, length);
+}
+void espIOTLib::publishFloat(const char *topic, int value){
+    this->publishFloat(topic, (double)value);
+}
+void espIOTLib::publishFloat(const char *topic, unsigned int value){
+    this->publishFloat(topic, (double)value);
+}
+void espIOTLib::publishFloat(const char *topic, long value){
+    this->publishFloat(topic, (double)value);
+}
+void espIOTLib::publishFloat(const char *topic, unsigned long value){
+    this->publishFloat(topic, (double)value);
+}
+void espIOTLib::publishFloat(const char *topic, long long value){
+    this->publishFloat(topic, (double)value);
+}
+void espIOTLib::publishFloat(const char *topic, unsigned long long value){
+    this->publishFloat(topic, (double)value);
+}
+// QoS 1 variants, the value is encoded and observed the same way but not filtered
+bool espIOTLib::publishIntQoS1(const char *topic, long long value){
+    this->_observeInt(topic, value);
+    if(!this->_doMqtt)
+        return false;
+    size_t length = this->_encodeSigned(topic, value);
+    if(length == 0)
+        return false;
+    return this->_publish(topic, this->_mqttDataBuffer, length, 1);
+}
+bool espIOTLib::publishStrQoS1(const char *topic, const char *value){
+    if(!value)
+        return false;
+    this->_observeStr(topic, value);
+    if(!this->_doMqtt)
+        return false;
+    MQTT_LOGD("MQTT pub QoS 1: %s STR: %s", topic, value);
+    return this->_publish(topic, value, strlen(value), 1);
+}
+bool espIOTLib::publishFloatQoS1(const char *topic, float value){
+    if(isnan(value))
+        return false;
+    this->_observeFloat(topic, value);
+    if(!this->_doMqtt)
+        return false;
+    size_t length = this->_encodeFloat(topic, value, true);
+    if(length == 0)
+        return false;
+    return this->_publish(topic, this->_mqttDataBuffer, length, 1);
+}
+bool espIOTLib::publishFloatQoS1(const char *topic, double value){
+    if(isnan(value))
+        return false;
+    this->_observeFloat(topic, value);
+    if(!this->_doMqtt)
+        return false;
+    size_t length = this->_encodeFloat(topic, value, false);
+    if(length == 0)
+        return false;
+    return this->_publish(topic, this->_mqttDataBuffer, length, 1);
+}
+bool espIOTLib::publishFloatQoS1(const char *topic, int value){
+    return this->publishFloatQoS1(topic, (double)value);
+}
+bool espIOTLib::publishFloatQoS1(const char *topic, unsigned int value){
+    return this->publishFloatQoS1(topic, (double)value);
+}
+bool espIOTLib::publishFloatQoS1(const char *topic, long value){
+    return this->publishFloatQoS1(topic, (double)value);
+}
+bool espIOTLib::publishFloatQoS1(const char *topic, unsigned long value){
+    return this->publishFloatQoS1(topic, (double)value);
+}
+bool espIOTLib::publishFloatQoS1(const char *topic, long long value){
+    return this->publishFloatQoS1(topic, (double)value);
+}
+bool espIOTLib::publishFloatQoS1(const char *topic, unsigned long long value){
+    return this->publishFloatQoS1(topic, (double)value);
+}
+
+    // Payload encoding
+void espIOTLib::setPayloadFormat(espIOTLib_payloadFormat format){
+    this->_payloadFormat = format;
+}
+bool espIOTLib::setPayloadFormat(const char *topic, espIOTLib_payloadFormat format){
+    if(!topic)
+        return false;
+    uint32_t hash = espIOTLib_topicHash(topic);
+    for(size_t i = 0; i < this->_topicFormatCount; i++){
+        if(this->_topicFormats[i].topicHash == hash && strcmp(this->_topicFormats[i].topic, topic) == 0){
+            this->_topicFormats[i].format = format;
+            return true;
+        }
+    }
+    if(this->_topicFormatCount >= ESP_IOTLIB_PAYLOAD_FORMAT_TOPICS || strlen(topic) >= ESP_IOTLIB_PAYLOAD_FORMAT_TOPIC_LEN)
+        return false;
+    if(!this->_topicFormats)
+        this->_topicFormats = new espIOTLib_topicFormat[ESP_IOTLIB_PAYLOAD_FORMAT_TOPICS];
+    this->_topicFormats[this->_topicFormatCount].topicHash = hash;
+    this->_topicFormats[this->_topicFormatCount].format = format;
+    strcpy(this->_topicFormats[this->_topicFormatCount].topic, topic);
+    this->_topicFormatCount++;
+    return true;
+}
+espIOTLib_payloadFormat espIOTLib::getPayloadFormat(const char *topic){
+    return topic ? this->_topicPayloadFormat(topic) : this->_payloadFormat;
+}
+bool espIOTLib::beginRecord(const char *topic){
+    if(!this->_doMqtt || !topic || this->_recordTopic)
+        return false;
+    if(!this->_record){
+        this->_recordBuffer = new uint8_t[ESP_IOTLIB_RECORD_BUFFER_LEN];
+        this->_record = new espIOTLib_encoder(this->_recordBuffer, ESP_IOTLIB_RECORD_BUFFER_LEN, ESP_IOTLIB_PAYLOAD_TEXT);
+        this->_record->setFloatPrecision(ESP_IOTLIB_MQTT_FLOAT_PRECISION);
     }
+    this->_record->reset(this->_topicPayloadFormat(topic));
+    this->_record->beginMap();
+    this->_recordTopic = topic;
+    return true;
+}
+bool espIOTLib::recordAddInt(const char *key, int64_t value){
+    if(!this->_recordTopic || !key)
+        return false;
+    this->_record->key(key);
+    this->_record->encodeInt(value);
+    return !this->_record->overflow();
+}
+bool espIOTLib::recordAddFloat(const char *key, double value){
+    if(!this->_recordTopic || !key)
+        return false;
+    this->_record->key(key);
+    this->_record->encodeDouble(value);
+    return !this->_record->overflow();
+}
+bool espIOTLib::recordAddStr(const char *key, const char *value){
+    if(!this->_recordTopic || !key || !value)
+        return false;
+    this->_record->key(key);
+    this->_record->encodeStr(value);
+    return !this->_record->overflow();
+}
+bool espIOTLib::commitRecord(){
+    if(!this->_recordTopic)
+        return false;
+    const char *topic = this->_recordTopic;
+    this->_recordTopic = NULL;
+    if(!this->_record->endMap()){
+        MQTT_LOGW("MQTT record for %s does not fit into %u bytes\n", topic, ESP_IOTLIB_RECORD_BUFFER_LEN);
+        this->_stats.mqttPublishDropped++;
+        return false;
+    }
+    MQTT_LOGD("MQTT pub: %s Record: %u bytes", topic, (unsigned)this->_record->length());
+    return this->_publish(topic, (const char *)this->_record->data(), this->_record->length());
 }
 
+#ifndef ESP_IOTLIB_NO_OTA
     // OTA
 void espIOTLib::enableOTA(const char *md5Password){
     // Port defaults to 8266
@@ -693,6 +2745,9 @@ void espIOTLib::enableOTA(const char *md5Password){
     ArduinoOTA.setHostname(this->_iotWebConf->getThingName());
     // Password set with it's md5 value
     ArduinoOTA.setPasswordHash(md5Password);
+    // The update ends in a reboot, keep the queued publishes
+    ArduinoOTA.onEnd([this](){ this->persistMQTTOutbox(); });
     this->_doOTAUpdate = true;
     IOT_LOGF("Enabling OTA at port %d\n", OTA_PORT);
-}
\ No newline at end of file
+}
+#endif
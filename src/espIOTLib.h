@@ -17,14 +17,41 @@
 #include <vector>
 
 #include <IotWebConf.h>
+#ifndef ESP_IOTLIB_NO_HTTP_UPDATE
 # ifdef ESP8266
 #  include <ESP8266HTTPUpdateServer.h>
 # elif defined(ESP32)
    // For ESP32 IotWebConf provides a drop-in replacement for UpdateServer.
 #  include <IotWebConfESP32HTTPUpdateServer.h>
 # endif
+#endif
 #include <IotWebConfUsing.h> // This loads aliases fosr easier class names.
 #include <MQTT.h>
+
+#include "espIOTLib_outbox.h"
+#include "espIOTLib_inflight.h"
+#include "espIOTLib_publishFilter.h"
+#include "espIOTLib_timeSeries.h"
+#include "espIOTLib_eventStream.h"
+#include "espIOTLib_format.h"
+#include "espIOTLib_encoder.h"
+#include "espIOTLib_bufferedClient.h"
+#include "espIOTLib_scheduler.h"
+#ifdef ESP32
+#include "espIOTLib_spscQueue.h"
+#include "espIOTLib_thread.h"
+#endif
+#include "espIOTLib_histogram.h"
+#include "espIOTLib_heapStats.h"
+#include "espIOTLib_wifiCache.h"
+#include "espIOTLib_dutyCycle.h"
+#include "espIOTLib_brokerSet.h"
+#include "espIOTLib_tcpProbe.h"
+#include "espIOTLib_topicTree.h"
+#include "espIOTLib_pageWriter.h"
+#include "espIOTLib_template.h"
+#include "espIOTLib_assets.h"
+#include "espIOTLib_log.h"
 // --- Defines ---
 #ifndef ESP_IOTLIB_AP_DEFAULT_PWD
     #define ESP_IOTLIB_AP_DEFAULT_PWD "1234paul"
@@ -35,7 +62,7 @@
     #define ESP_IOTLIB_MQTT_BUFFER_SIZE 512
 #endif
 #ifndef ESP_IOTLIB_MQTT_DATA_BUFFER_LEN
-    #define ESP_IOTLIB_MQTT_DATA_BUFFER_LEN 20
+    #define ESP_IOTLIB_MQTT_DATA_BUFFER_LEN 24
 #endif
 #ifndef ESP_IOTLIB_MQTT_TOPIC_BUFFER_LEN
     #define ESP_IOTLIB_MQTT_TOPIC_BUFFER_LEN 255
@@ -49,11 +76,57 @@
 #ifndef ESP_IOTLIB_MQTT_RECONNECT_INTERVAL
     #define ESP_IOTLIB_MQTT_RECONNECT_INTERVAL 5000
 #endif
+#ifndef ESP_IOTLIB_SLOW_LOOP_THRESHOLD_US
+    #define ESP_IOTLIB_SLOW_LOOP_THRESHOLD_US 50000
+#endif
+#ifndef ESP_IOTLIB_MQTT_RECONNECT_MAX_INTERVAL
+    #define ESP_IOTLIB_MQTT_RECONNECT_MAX_INTERVAL 300000
+#endif
+#ifndef ESP_IOTLIB_MQTT_CONNECT_TIMEOUT
+    #define ESP_IOTLIB_MQTT_CONNECT_TIMEOUT 2000
+#endif
+#ifndef ESP_IOTLIB_MQTT_KEEPALIVE
+    #define ESP_IOTLIB_MQTT_KEEPALIVE 30 // s
+#endif
+// While on a backup broker, check this often whether the primary accepts connections again
+#ifndef ESP_IOTLIB_MQTT_FAILBACK_INTERVAL
+    #define ESP_IOTLIB_MQTT_FAILBACK_INTERVAL 300000
+#endif
+#ifndef ESP_IOTLIB_BATCH_BUFFER_LEN
+    #define ESP_IOTLIB_BATCH_BUFFER_LEN 256
+#endif
+#ifndef ESP_IOTLIB_RECORD_BUFFER_LEN
+    // Half the MQTT client buffer, leaves room for topic and packet header
+    #define ESP_IOTLIB_RECORD_BUFFER_LEN (ESP_IOTLIB_MQTT_BUFFER_SIZE / 2)
+#endif
+#ifndef ESP_IOTLIB_SSE_STATUS_INTERVAL
+    #define ESP_IOTLIB_SSE_STATUS_INTERVAL 1000
+#endif
+#define ESP_IOTLIB_SSE_STATUS_FIELDS 9
+#ifndef ESP_IOTLIB_NET_TASK_STACK
+    #define ESP_IOTLIB_NET_TASK_STACK 8192
+#endif
+#ifndef ESP_IOTLIB_NET_TASK_PRIORITY
+    #define ESP_IOTLIB_NET_TASK_PRIORITY 1
+#endif
+#ifndef ESP_IOTLIB_NET_QUEUE_ENTRIES
+    #define ESP_IOTLIB_NET_QUEUE_ENTRIES 16
+#endif
+#ifndef ESP_IOTLIB_NET_QUEUE_PAYLOAD_LEN
+    #define ESP_IOTLIB_NET_QUEUE_PAYLOAD_LEN ESP_IOTLIB_BATCH_BUFFER_LEN
+#endif
 #ifndef ESP_IOTLIB_IP_ADDRESS_BUFFER_LEN
     #define ESP_IOTLIB_IP_ADDRESS_BUFFER_LEN 20
 #endif
 
-//Use these for debug logging
+//Use these to compile out subsystems that are never used
+//#define ESP_IOTLIB_NO_OTA
+//#define ESP_IOTLIB_NO_HTTP_UPDATE
+
+//Use this to record per stage loop() timing histograms
+//#define ESP_IOTLIB_LOOP_PROFILING
+
+//Use these for debug logging, see enableLog()
 //#define ESP_IOTLIB_MQTT_LOG
 //#define ESP_IOTLIB_IOT_LOG
 
@@ -65,7 +138,35 @@
 
 // --- Typedefs ---
 typedef void (*espIOTLibCB)(void);
-typedef void (*espIOTLibMQTTCB)(MQTTClient *client, char topic[], char bytes[], int length);
+
+typedef enum {
+    ESP_IOTLIB_STAGE_WEBCONF = 0,
+    ESP_IOTLIB_STAGE_EVENTS,
+    ESP_IOTLIB_STAGE_MQTT_RECONNECT,
+    ESP_IOTLIB_STAGE_MQTT_LOOP,
+    ESP_IOTLIB_STAGE_OUTBOX,
+    ESP_IOTLIB_STAGE_OTA,
+    ESP_IOTLIB_STAGE_TASKS,
+    ESP_IOTLIB_STAGE_LOG,
+    ESP_IOTLIB_STAGE_TOTAL,
+    ESP_IOTLIB_STAGE_COUNT
+} espIOTLib_loopStage;
+
+typedef enum {
+    ESP_IOTLIB_MQTT_DISCONNECTED = 0,
+    ESP_IOTLIB_MQTT_BACKOFF,
+    ESP_IOTLIB_MQTT_RESOLVING,
+    ESP_IOTLIB_MQTT_TCP_CONNECTING,
+    ESP_IOTLIB_MQTT_CONNECTING,
+    ESP_IOTLIB_MQTT_SUBSCRIBING,
+    ESP_IOTLIB_MQTT_CONNECTED,
+    ESP_IOTLIB_MQTT_CONNACK_WAIT    // Follows CONNECTING, added last so the mqtt_state metric values stay the same
+} espIOTLib_mqttState;
+
+typedef enum {
+    ESP_IOTLIB_BATCH_JSON = 0,  // One publish to the prefix with a {"key":value,...} payload
+    ESP_IOTLIB_BATCH_PIPELINE   // One publish per value to prefix/key, all sent in one socket write
+} espIOTLib_batchMode;
 
 // --- Public Vars ---
 
@@ -89,6 +190,79 @@ struct espIOTLib_webPage{
     }
 };
 
+// Config storage of optional subsystems, allocated by configureStaticIP / enableMQTT
+struct espIOTLib_staticIPConfig{
+    char ipAddress[ESP_IOTLIB_IP_ADDRESS_BUFFER_LEN] = "";
+    char gateway[ESP_IOTLIB_IP_ADDRESS_BUFFER_LEN] = "";
+    char netmask[ESP_IOTLIB_IP_ADDRESS_BUFFER_LEN] = "";
+    char dns[ESP_IOTLIB_IP_ADDRESS_BUFFER_LEN] = "";
+    IotWebConfParameterGroup group = IotWebConfParameterGroup("conn", "Connection parameters");
+    IotWebConfTextParameter ipAddressParam = IotWebConfTextParameter("IP address", "ipAddress", this->ipAddress, ESP_IOTLIB_IP_ADDRESS_BUFFER_LEN);
+    IotWebConfTextParameter gatewayParam = IotWebConfTextParameter("Gateway", "gateway", this->gateway, ESP_IOTLIB_IP_ADDRESS_BUFFER_LEN);
+    IotWebConfTextParameter netmaskParam = IotWebConfTextParameter("Subnet mask", "netmask", this->netmask, ESP_IOTLIB_IP_ADDRESS_BUFFER_LEN);
+    IotWebConfTextParameter dnsParam = IotWebConfTextParameter("DNS", "dns", this->dns, ESP_IOTLIB_IP_ADDRESS_BUFFER_LEN);
+};
+
+struct espIOTLib_mqttConfig{
+    char defaultServer[ESP_IOTLIB_MQTT_TOPIC_BUFFER_LEN] = "";
+    char defaultUserName[ESP_IOTLIB_MQTT_TOPIC_BUFFER_LEN] = "";
+    char defaultUserPassword[ESP_IOTLIB_MQTT_TOPIC_BUFFER_LEN] = "";
+    char server[ESP_IOTLIB_MQTT_TOPIC_BUFFER_LEN] = "";
+    char userName[ESP_IOTLIB_MQTT_TOPIC_BUFFER_LEN] = "";
+    char userPassword[ESP_IOTLIB_MQTT_TOPIC_BUFFER_LEN] = "";
+    IotWebConfParameterGroup group = IotWebConfParameterGroup("mqtt", "MQTT configuration");
+    IotWebConfTextParameter serverParam = IotWebConfTextParameter("MQTT server", "mqttServer", this->server, ESP_IOTLIB_MQTT_TOPIC_BUFFER_LEN);
+    IotWebConfTextParameter userNameParam = IotWebConfTextParameter("MQTT user", "mqttUser", this->userName, ESP_IOTLIB_MQTT_TOPIC_BUFFER_LEN);
+    IotWebConfPasswordParameter userPasswordParam = IotWebConfPasswordParameter("MQTT password", "mqttPass", this->userPassword, ESP_IOTLIB_MQTT_TOPIC_BUFFER_LEN);
+};
+
+struct espIOTLib_mqttBackupConfig{
+    char defaultServers[ESP_IOTLIB_MQTT_TOPIC_BUFFER_LEN] = "";
+    char servers[ESP_IOTLIB_MQTT_TOPIC_BUFFER_LEN] = "";
+    IotWebConfTextParameter serversParam = IotWebConfTextParameter("MQTT backup servers", "mqttBackup", this->servers, ESP_IOTLIB_MQTT_TOPIC_BUFFER_LEN);
+};
+
+// Open batch of publishBatch*, allocated by enableBatchPublish
+struct espIOTLib_batch{
+    char *buffer = NULL;
+    size_t bufferLen = 0;
+    size_t used = 0;
+    const char *prefix = NULL;
+    espIOTLib_batchMode mode = ESP_IOTLIB_BATCH_JSON;
+    uint16_t count = 0;
+    bool open = false;
+    bool overflow = false;
+};
+
+// Publish or incoming message on its way between application and network task
+struct espIOTLib_netMessage{
+    uint16_t payloadLen;
+    uint8_t qos;
+    char topic[ESP_IOTLIB_OUTBOX_TOPIC_LEN];
+    char payload[ESP_IOTLIB_NET_QUEUE_PAYLOAD_LEN + 1];
+};
+
+struct espIOTLib_stats{
+    uint32_t wifiConnects = 0;
+    uint32_t wifiConnectMillis = 0;     // From WiFi.begin() to connected, last connection
+    uint32_t wifiFastConnects = 0;
+    uint32_t wifiFastConnectFallbacks = 0;
+    uint32_t mqttConnects = 0;
+    uint32_t mqttConnectFails = 0;
+    uint32_t mqttBrokerSwitches = 0;
+    uint32_t mqttFailbacks = 0;
+    uint32_t mqttPublished = 0;
+    uint32_t mqttPublishFails = 0;
+    uint32_t mqttPublishDropped = 0;
+    uint32_t mqttReceived = 0;
+    uint32_t mqttReceiveDropped = 0;
+    uint32_t mqttBatches = 0;
+    uint32_t loops = 0;
+    uint32_t loopLastMicros = 0;
+    uint32_t loopMaxMicros = 0;
+    uint32_t slowLoops = 0;
+};
+
 class espIOTLib
 {
 protected:
@@ -97,72 +271,254 @@ protected:
     DNSServer _dnsServer;
     WebServer *_localServer;
     IotWebConf *_iotWebConf;
+#ifndef ESP_IOTLIB_NO_HTTP_UPDATE
     #ifdef ESP8266
         ESP8266HTTPUpdateServer _httpUpdater;
     #elif defined(ESP32)
         HTTPUpdateServer _httpUpdater;
     #endif
+#endif
     espIOTLibCB _extWifiConnectCB;
     WiFiClient _wifiClient;
     bool _connectedToWifi = false;
     std::vector<espIOTLib_webPage> _webPages;
+    espIOTLib_heapStats _heapStats;
+    espIOTLib_stats _stats;
+    espIOTLib_log *_log = NULL;
+    espIOTLib_scheduler *_scheduler = NULL;
+    bool _networkTaskRunning = false;
+#ifdef ESP32
+    espIOTLib_spscQueue<espIOTLib_netMessage> *_publishQueue = NULL;
+    espIOTLib_spscQueue<espIOTLib_netMessage> *_inboundQueue = NULL;
+#endif
+    uint32_t _slowLoopThreshold = ESP_IOTLIB_SLOW_LOOP_THRESHOLD_US;
+#ifdef ESP_IOTLIB_LOOP_PROFILING
+    espIOTLib_histogram _loopHistograms[ESP_IOTLIB_STAGE_COUNT];
+#endif
 
         // Static IP
     bool _doStaticIP = false;
     IPAddress _ip, _gateway, _mask, _dns;
-    char _ipAddressValue[ESP_IOTLIB_IP_ADDRESS_BUFFER_LEN];
-    char _gatewayValue[ESP_IOTLIB_IP_ADDRESS_BUFFER_LEN];
-    char _netmaskValue[ESP_IOTLIB_IP_ADDRESS_BUFFER_LEN];
-    char _dnsValue[ESP_IOTLIB_IP_ADDRESS_BUFFER_LEN];
-    IotWebConfParameterGroup _connGroup = IotWebConfParameterGroup("conn", "Connection parameters");
-    IotWebConfTextParameter _ipAddressParam = IotWebConfTextParameter("IP address", "ipAddress", this->_ipAddressValue, ESP_IOTLIB_IP_ADDRESS_BUFFER_LEN);
-    IotWebConfTextParameter _gatewayParam = IotWebConfTextParameter("Gateway", "gateway", this->_gatewayValue, ESP_IOTLIB_IP_ADDRESS_BUFFER_LEN);
-    IotWebConfTextParameter _netmaskParam = IotWebConfTextParameter("Subnet mask", "netmask", this->_netmaskValue, ESP_IOTLIB_IP_ADDRESS_BUFFER_LEN);
-    IotWebConfTextParameter _dnsParam = IotWebConfTextParameter("DNS", "dns", this->_dnsValue, ESP_IOTLIB_IP_ADDRESS_BUFFER_LEN);
+    espIOTLib_staticIPConfig *_staticIPConfig = NULL;
+
+        // Fast connect
+    espIOTLib_wifiCache *_wifiCache = NULL;
+    bool _fastConnectLease = false;
+    bool _wifiFastAttempt = false;
+    uint32_t _wifiConnectStart = 0;
+    const char *_wifiSSID = NULL;
+    const char *_wifiPassword = NULL;
+
+        // Duty cycle
+    espIOTLib_dutyCycle *_dutyCycle = NULL;
+    espIOTLibWakeCB _dutySampleCB = NULL;
+    espIOTLibCB _dutyPublishCB = NULL;
+    const char *_dutyReportTopic = NULL;
+    bool _dutyPublished = false;
 
         // MQTT
     bool _doMqtt = false;
     MQTTClient *_mqttClient;
     bool _mqttForceDisconnect = false;
-    char _mqttDefaultServer[ESP_IOTLIB_MQTT_TOPIC_BUFFER_LEN];
-    char _mqttDefaultUserName[ESP_IOTLIB_MQTT_TOPIC_BUFFER_LEN];
-    char _mqttDefaultUserPassword[ESP_IOTLIB_MQTT_TOPIC_BUFFER_LEN];
-    char _mqttServer[ESP_IOTLIB_MQTT_TOPIC_BUFFER_LEN];
-    char _mqttUserName[ESP_IOTLIB_MQTT_TOPIC_BUFFER_LEN];
-    char _mqttUserPassword[ESP_IOTLIB_MQTT_TOPIC_BUFFER_LEN];
-    IotWebConfParameterGroup _mqttGroup = IotWebConfParameterGroup("mqtt", "MQTT configuration");
-    IotWebConfTextParameter _mqttServerParam = IotWebConfTextParameter("MQTT server", "mqttServer", this->_mqttServer, ESP_IOTLIB_MQTT_TOPIC_BUFFER_LEN);
-    IotWebConfTextParameter _mqttUserNameParam = IotWebConfTextParameter("MQTT user", "mqttUser", this->_mqttUserName, ESP_IOTLIB_MQTT_TOPIC_BUFFER_LEN);
-    IotWebConfPasswordParameter _mqttUserPasswordParam = IotWebConfPasswordParameter("MQTT password", "mqttPass", this->_mqttUserPassword, ESP_IOTLIB_MQTT_TOPIC_BUFFER_LEN);
+    espIOTLib_mqttConfig *_mqttConfig = NULL;
+    espIOTLib_mqttBackupConfig *_mqttBackupConfig = NULL;
+    espIOTLib_brokerSet *_brokers = NULL;
+    espIOTLib_tcpProbe *_mqttProbe = NULL;
+    espIOTLib_tcpProbe *_mqttConnector = NULL;
+    uint8_t _mqttBroker = 0;
+    uint32_t _mqttAttemptStart = 0;
+    uint32_t _mqttFailbackCheck = 0;
     char _mqttDataBuffer[ESP_IOTLIB_MQTT_DATA_BUFFER_LEN];
+    espIOTLib_payloadFormat _payloadFormat = ESP_IOTLIB_PAYLOAD_TEXT;
+    espIOTLib_topicFormat *_topicFormats = NULL;
+    size_t _topicFormatCount = 0;
+    uint8_t *_recordBuffer = NULL;
+    espIOTLib_encoder *_record = NULL;
+    const char *_recordTopic = NULL;
     uint32_t _mqttLastConnectFailTime = 0;
+    espIOTLib_mqttState _mqttState = ESP_IOTLIB_MQTT_DISCONNECTED;
+    uint32_t _mqttStateSince = 0;
+    uint32_t _mqttConnectAttempts = 0;
+    uint32_t _mqttBackoffDelay = 0;
+    size_t _mqttSubscribeIndex = 0;
     std::vector<String> _mqttTopics;
+    espIOTLib_topicTree _mqttTopicTree;
+    espIOTLibMQTTCB _mqttExtCB = NULL;
+    espIOTLib_outbox *_mqttOutbox = NULL;
+    uint16_t _mqttOutboxDrainBudget = ESP_IOTLIB_OUTBOX_DRAIN_BUDGET;
+    espIOTLib_publishFilter *_publishFilter = NULL;
+    espIOTLib_timeSeries *_timeSeries = NULL;
+    bool _timeSeriesFromPublish = false;
+    espIOTLib_eventStream *_eventStream = NULL;
+    uint32_t _eventStatusSent = 0;
+    int32_t _eventStatus[ESP_IOTLIB_SSE_STATUS_FIELDS];
+    volatile bool _eventStatusFull = true;
+    espIOTLib_assets *_assets = NULL;
+    espIOTLib_bufferedClient *_mqttNetClient = NULL;
+    espIOTLib_inflight *_inflight = NULL;
+    espIOTLib_batch *_batch = NULL;
 
+#ifndef ESP_IOTLIB_NO_OTA
         // OTA update
     bool _doOTAUpdate = false;
+#endif
     
 
     // --- Private Functions ---
-    void _mqttConnect();
+    void _mqttSetState(espIOTLib_mqttState state);
+    void _mqttConnectFailed();
+    void _mqttStartConnect();
+    bool _mqttDisconnect();
+    const char *_mqttHost();
+    uint16_t _mqttPort();
+    bool _mqttSendConnect();
+    void _mqttSelectBroker(uint8_t index);
+    void _mqttServiceFailback();
+    void _mqttDispatch(MQTTClient *client, char topic[], char bytes[], int length);
     const char* _mqttReturnToString(lwmqtt_return_code_t retval);
     const char* _mqttErrorToString(lwmqtt_err_t errval);
     void _reconnectMQTT();
+    bool _publish(const char *topic, const char *payload, size_t length, uint8_t qos = 0);
+    bool _publishNow(const char *topic, const char *payload, size_t length);
+    bool _publishQoS1Now(const char *topic, const char *payload, size_t length);
+    static void _mqttAckCB(void *arg, uint16_t packetId);
+    espIOTLib_payloadFormat _topicPayloadFormat(const char *topic);
+    size_t _encodeSigned(const char *topic, int64_t value);
+    size_t _encodeUnsigned(const char *topic, uint64_t value);
+    size_t _encodeFloat(const char *topic, double value, bool single);
+    void _publishSigned(const char *topic, int64_t value);
+    void _publishUnsigned(const char *topic, uint64_t value);
+    const char *_batchTopic(const char *key);
+    bool _batchAppend(const char *key, const char *value, bool quote);
+    void _drainOutbox();
     void _wifiConnectCB();
     void _connectWifi(const char* ssid, const char* password);
+    void _serviceFastConnect();
+    void _serviceDutyCycle();
+    void _dutyReport();
+    void _dutySleep(bool timedOut);
     void _handleRoot();
+    void _rootPlaceholder(Print &page, const char *name);
     void _handleStatus();
+    void _statusPlaceholder(Print &page, const char *name);
+    void _handleMetrics(bool json);
+    void _handleHistory();
+    void _handleEvents();
+    void _handleLog();
+    void _enableAssets();
+    void _streamStatus();
+    void _observeInt(const char *topic, int64_t value);
+    void _observeFloat(const char *topic, double value);
+    void _observeStr(const char *topic, const char *value);
+    uint32_t _profileStage(espIOTLib_loopStage stage, uint32_t stageStart);
+    void _serviceLoop();
+#ifdef ESP32
+    static void _networkTask(void *arg);
+    void _drainPublishQueue();
+    void _drainInboundQueue();
+#endif
     void _handleResetReq();
     void _handleMQTTDisconnReq();
     void _handleMQTTConnReq();
+    void _printMQTTResult(Print &page);
 
 public:
     espIOTLib(const char *deviceName, const char *version);
     ~espIOTLib();
 
     void start();
+#ifdef ESP32
+    /**
+     * @brief Move WebConf, web server, MQTT and OTA servicing to a FreeRTOS task on the given core.
+     * Call after start() and after all subscribeMQTT()/addWebPage() calls. Afterwards loop() only
+     * delivers incoming messages to the MQTT callbacks and runs the scheduled tasks, publishes are
+     * handed over through a lock-free queue. The MQTT client must not be used directly anymore
+     * 
+     * @param core Core of the network task, 0 keeps it next to the WiFi stack and away from loop() on core 1
+     * @return false if MQTT is not enabled or the task could not be started
+     */
+    bool startNetworkTask(int core = 0, uint32_t stackSize = ESP_IOTLIB_NET_TASK_STACK, uint8_t priority = ESP_IOTLIB_NET_TASK_PRIORITY);
+#endif
     void configureStaticIP(IPAddress default_ip, IPAddress default_gateway, IPAddress default_mask, IPAddress default_dns);
+    /**
+     * @brief Connect to the access point and channel of the last connection without scanning, and without DHCP
+     * by reusing the last lease (not with configureStaticIP). Falls back to a full scan and DHCP if that did not
+     * connect within ESP_IOTLIB_FAST_CONNECT_TIMEOUT ms. Also skips the AP at boot if the config is valid.
+     * Call before start()
+     * 
+     * @param reuseLease false to only skip the scan, e.g. when the DHCP server hands out short leases
+     */
+    void enableFastConnect(bool reuseLease = true);
+    espIOTLib_wifiCache *getWifiCache();
+    /**
+     * @brief Run as wake, publish, sleep cycle instead of always on. Every cycle sampleCB is called before WiFi is started
+     * and publishCB once MQTT is connected. When the outbox is drained, all QoS 1 publishes are acknowledged and the
+     * MQTT connection is closed, the device sleeps for the rest of the period. The time of each phase is measured.
+     * Call before start(), does not work together with startNetworkTask()
+     * 
+     * @param period Wake to wake in ms
+     * @param sampleCB Read the sensors, gets the wake reason. Publishes from here are only kept with enableMQTTOutbox()
+     * @param publishCB Publish the readings
+     * @param mode Deep sleep (reset on wake) or modem sleep (only the radio off)
+     * @param awakeTimeout Sleep after this many ms even if not everything was sent
+     */
+    void enableDutyCycle(uint32_t period, espIOTLibWakeCB sampleCB, espIOTLibCB publishCB, espIOTLib_sleepMode mode = ESP_IOTLIB_SLEEP_DEEP, uint32_t awakeTimeout = ESP_IOTLIB_DUTY_AWAKE_TIMEOUT);
+    /**
+     * @brief Publish cycle count, wake reason and the phase times of the previous cycle as record to topic every cycle
+     */
+    void setDutyCycleReportTopic(const char *topic);
+    espIOTLib_dutyCycle *getDutyCycle();
     bool isConnectedToWifi();
     void loop();
+    const espIOTLib_stats &getStats();
+    void setSlowLoopThreshold(uint32_t micros);
+    /**
+     * @brief Timing histogram of one loop() stage
+     * 
+     * @return NULL if not compiled with ESP_IOTLIB_LOOP_PROFILING
+     */
+    const espIOTLib_histogram *getLoopHistogram(espIOTLib_loopStage stage);
+    static const char *loopStageName(espIOTLib_loopStage stage);
+    /**
+     * @brief Largest free block, fragmentation and their worst values since boot, sampled every loop().
+     * With ESP_IOTLIB_HEAP_ACCOUNTING also the heap kept or returned per espIOTLib code path
+     */
+    espIOTLib_heapStats *getHeapStats();
+    /**
+     * @brief Heap held by the user page list and the subscribed topic list
+     */
+    size_t getWebPagesHeapBytes();
+    size_t getMQTTTopicsHeapBytes();
+    /**
+     * @brief Run callback every period ms from loop(), between the WebConf and MQTT work.
+     * Due tasks run in deadline order, a few per slot, and keep their interval without drifting
+     * 
+     * @param name Shown on the status page and in the metrics
+     * @param phase Delay of the first run in ms, to keep tasks with the same period apart
+     * @param budget Expected max. run time in us, 0 for none. Longer runs are counted as overrun
+     * @return Task id for setTaskEnabled/getTask, -1 on error
+     */
+    int addTask(const char *name, espIOTLibTaskCB callback, uint32_t period, uint32_t phase = 0, uint32_t budget = 0);
+    void setTaskEnabled(int id, bool enabled);
+    const espIOTLib_task *getTask(int id);
+
+        // Log
+    /**
+     * @brief Queue log messages instead of printing them right away; they are printed to output from loop()
+     * as far as its send buffer has room, and the recent ones are served on /espIOTWeb/log.
+     * Enabled by the constructor if ESP_IOTLIB_MQTT_LOG or ESP_IOTLIB_IOT_LOG is defined. Call before startNetworkTask()
+     * 
+     * @param output NULL to only keep the history for the web page
+     */
+    void enableLog(Print *output = &Serial);
+    espIOTLib_log *getLog();
+    void setLogLevel(espIOTLib_logSubsystem subsystem, espIOTLib_logLevel level);
+    /**
+     * @brief Application message in the espIOTLib log, needs enableLog(). Only from the application's loop() context
+     * 
+     * @param format Printed later, must be a string literal, e.g. iot.log(ESP_IOTLIB_LOG_INFO, PSTR("Temp %d\n"), temp);
+     */
+    void log(espIOTLib_logLevel level, PGM_P format, ...);
 
         // Web Config
     WebServer *getWebServer();
@@ -172,23 +528,239 @@ public:
     void setConfigPin(int pin);
     bool addWebPage(const char *uri, WebServer::THandlerFunction handler);
     bool addWebPage(const char *uri, const char *menuName, WebServer::THandlerFunction handler);
+    /**
+     * @brief Answer the current request with a PROGMEM template, for addWebPage() handlers.
+     * The page is streamed in chunks, {{name}} markers are replaced by what callback prints for them
+     * 
+     * @param tmpl PROGMEM string, e.g. static const char PAGE[] PROGMEM = "<p>Temp: {{temp}}</p>";
+     * @param callback Prints the value of a placeholder
+     */
+    void sendTemplate(PGM_P tmpl, espIOTLibTemplateCB callback, int code = 200, const char *contentType = "text/html");
+    /**
+     * @brief Serve a static file from flash under uri, with ETag and Cache-Control. Requests from a browser
+     * that already has it are answered with 304
+     * 
+     * @param data PROGMEM content, e.g. the output of gzip -9 as byte array
+     * @param gzip data is gzip compressed
+     * @param maxAge Seconds the browser may use its copy without asking, 0 to revalidate every time
+     * @return false if uri is already used
+     */
+    bool addStaticAsset(const char *uri, const char *contentType, const uint8_t *data, size_t length, bool gzip = true, uint32_t maxAge = ESP_IOTLIB_ASSET_MAX_AGE);
+    /**
+     * @brief Same from a LittleFS file (needs ESP_IOTLIB_ASSETS_FS), e.g. "/style.css.gz"
+     * 
+     * @return false if uri is already used or the file does not exist
+     */
+    bool addStaticFile(const char *uri, const char *contentType, const char *path, bool gzip = true, uint32_t maxAge = ESP_IOTLIB_ASSET_MAX_AGE);
+    espIOTLib_assets *getAssets();
 
         // MQTT
     void enableMQTT(const char *server, const char *username, const char *password);
     MQTTClient *getMQTTClient();
+    /**
+     * @brief Set a callback that receives every incoming message, in addition to the per-topic ones
+     */
     void addMQTTSubscribeCB(espIOTLibMQTTCB mqttCB);
     /**
-     * @brief Subscribe to a MQTT topic. Must be called in setup
+     * @brief Subscribe to a MQTT topic, messages only go to the addMQTTSubscribeCB callback
      * 
      * @param topic (char *) String of topic to subscribe to
      */
     void subscribeMQTT(const char* topic);
-    void publishInt(const char *topic, uint32_t value);
+    /**
+     * @brief Subscribe to a MQTT topic filter and call mqttCB for each message matching it.
+     * Filters may contain "+" and "#" wildcards. Subscribed right away if connected, otherwise on (re)connect
+     * 
+     * @param topic (char *) Topic filter
+     * @param mqttCB Callback for matching messages, NULL to only subscribe
+     * @return false if the filter is invalid
+     */
+    bool subscribeMQTT(const char* topic, espIOTLibMQTTCB mqttCB);
+    espIOTLib_mqttState getMQTTState();
+    /**
+     * @brief Number of failed connection attempts since the last successful connect
+     */
+    uint32_t getMQTTConnectAttempts();
+    static const char *mqttStateName(espIOTLib_mqttState state);
+    /**
+     * @brief Fail over to backup brokers (same user and password) when the server does not accept connections.
+     * The server and the backups may be given as "host" or "host:port"; the backups are separated by ',' and can be
+     * changed in the MQTT group of the config page. The broker with the fewest recent failures and the lowest
+     * connect latency is used; while on a backup the primary is checked every ESP_IOTLIB_MQTT_FAILBACK_INTERVAL ms
+     * and taken back once it is reachable and nothing is in flight. Call after enableMQTT() and before start().
+     * Adds a config parameter, change the config version of existing devices
+     * 
+     * @param backupServers Default backups, up to ESP_IOTLIB_MQTT_BROKERS - 1 are used
+     */
+    void enableMQTTFailover(const char *backupServers);
+    espIOTLib_brokerSet *getMQTTBrokers();
+    /**
+     * @brief Index of the broker in use in getMQTTBrokers(), 0 is the primary
+     */
+    uint8_t getMQTTBrokerIndex();
+    // Overloads on the fundamental types so every (u)int8..64_t has an exact match
+    void publishInt(const char *topic, int value);
+    void publishInt(const char *topic, unsigned int value);
+    void publishInt(const char *topic, long value);
+    void publishInt(const char *topic, unsigned long value);
+    void publishInt(const char *topic, long long value);
+    void publishInt(const char *topic, unsigned long long value);
     void publishStr(const char *topic, char *value);
+    /**
+     * @brief Publish with ESP_IOTLIB_MQTT_FLOAT_PRECISION digits after the decimal point.
+     * nan, inf and values beyond +-1.8e19 / 10^precision are not published, the latter are counted as dropped.
+     * Integer values are published as double, so calls with an int keep compiling next to the float/double pair
+     */
+    void publishFloat(const char *topic, float value);
     void publishFloat(const char *topic, double value);
+    void publishFloat(const char *topic, int value);
+    void publishFloat(const char *topic, unsigned int value);
+    void publishFloat(const char *topic, long value);
+    void publishFloat(const char *topic, unsigned long value);
+    void publishFloat(const char *topic, long long value);
+    void publishFloat(const char *topic, unsigned long long value);
+    /**
+     * @brief Payload encoding of publishInt/publishFloat and records, text by default.
+     * The topic variant overrides the global one for up to ESP_IOTLIB_PAYLOAD_FORMAT_TOPICS topics
+     * shorter than ESP_IOTLIB_PAYLOAD_FORMAT_TOPIC_LEN, it returns false for any further topic
+     */
+    void setPayloadFormat(espIOTLib_payloadFormat format);
+    bool setPayloadFormat(const char *topic, espIOTLib_payloadFormat format);
+    espIOTLib_payloadFormat getPayloadFormat(const char *topic);
+    /**
+     * @brief Start a structured record, sent as one map (JSON object in text format) to topic
+     * 
+     * @param topic Must stay valid until commitRecord()
+     * @return false if MQTT is not enabled or a record is already open
+     */
+    bool beginRecord(const char *topic);
+    bool recordAddInt(const char *key, int64_t value);
+    bool recordAddFloat(const char *key, double value);
+    bool recordAddStr(const char *key, const char *value);
+    /**
+     * @brief Publish the record
+     * 
+     * @return false if it did not fit into ESP_IOTLIB_RECORD_BUFFER_LEN (nothing is sent) or could not be published
+     */
+    bool commitRecord();
+    /**
+     * @brief Publish with QoS 1, needs enableQoS1(). The publish stays in the in-flight window
+     * (and is retransmitted) until the broker acknowledges it, also across reconnects. Values reach the time series
+     * and the event stream like with the QoS 0 calls, but are not filtered
+     * 
+     * @return false if the window is full
+     */
+    bool publishIntQoS1(const char *topic, long long value);
+    bool publishStrQoS1(const char *topic, const char *value);
+    bool publishFloatQoS1(const char *topic, float value);
+    bool publishFloatQoS1(const char *topic, double value);
+    bool publishFloatQoS1(const char *topic, int value);
+    bool publishFloatQoS1(const char *topic, unsigned int value);
+    bool publishFloatQoS1(const char *topic, long value);
+    bool publishFloatQoS1(const char *topic, unsigned long value);
+    bool publishFloatQoS1(const char *topic, long long value);
+    bool publishFloatQoS1(const char *topic, unsigned long long value);
+    /**
+     * @brief Allocate the in-flight table for publish*QoS1, call after enableMQTT and before startNetworkTask()
+     * 
+     * @param window Max. number of unacknowledged QoS 1 publishes
+     * @param retransmitTimeout ms without PUBACK before a publish is sent again with DUP set
+     */
+    void enableQoS1(uint8_t window = ESP_IOTLIB_QOS1_WINDOW, uint32_t retransmitTimeout = ESP_IOTLIB_QOS1_RETRANSMIT_TIMEOUT);
+    espIOTLib_inflight *getQoS1Inflight();
+    /**
+     * @brief Queue publishes while WiFi or MQTT is down and send them once reconnected.
+     * The queue is allocated once here, call after enableMQTT and before startNetworkTask(), later calls are ignored. Entries hold ESP_IOTLIB_OUTBOX_PAYLOAD_LEN (32) bytes of payload,
+     * longer payloads such as JSON batches and records are dropped unless that is raised
+     * 
+     * @param entries Number of publishes held in RAM
+     * @param policy What to do when the queue is full
+     * @param drainBudget Max. number of queued publishes sent per loop()
+     * @param spillFile LittleFS path the queue overflows into (needs ESP_IOTLIB_OUTBOX_SPILL), NULL for RAM only
+     */
+    void enableMQTTOutbox(size_t entries = ESP_IOTLIB_OUTBOX_ENTRIES, espIOTLib_outboxPolicy policy = ESP_IOTLIB_OUTBOX_DROP_OLDEST, uint16_t drainBudget = ESP_IOTLIB_OUTBOX_DRAIN_BUDGET, const char *spillFile = NULL);
+    espIOTLib_outbox *getMQTTOutbox();
+    /**
+     * @brief Move the queued publishes from RAM to the spill file (needs ESP_IOTLIB_OUTBOX_SPILL and a spill file).
+     * Done by the library before the /reset reboot, a duty cycle deep sleep and at the end of an OTA update, call it before your own ESP.restart().
+     * Call from loop(), not while startNetworkTask() runs, the network task owns the outbox then
+     * 
+     * @return false if nothing could be persisted or the spill file is full
+     */
+    bool persistMQTTOutbox();
+    /**
+     * @brief Only send publishInt/publishFloat values that changed. A value is suppressed if it is within
+     * the deadband of the last published value of its topic, or if the topic was published less than minInterval ago.
+     * An unchanged value is still sent once maxInterval has passed. Pass all zeros for plain change detection
+     * 
+     * @param absDeadband Absolute deadband
+     * @param relDeadband Deadband relative to the last published value (0.01 = 1%)
+     * @param minInterval Min. time between publishes of one topic in ms
+     * @param maxInterval Heartbeat, max. time between publishes of one topic in ms, 0 to disable
+     * @param topics Number of topics tracked, further topics are published unfiltered
+     */
+    void enablePublishFilter(float absDeadband = 0, float relDeadband = 0, uint32_t minInterval = 0, uint32_t maxInterval = 0, size_t topics = ESP_IOTLIB_PUBLISH_FILTER_TOPICS);
+    /**
+     * @brief Override the enablePublishFilter defaults for one topic
+     * 
+     * @return false if the filter is not enabled or the topic table is full
+     */
+    bool setPublishFilter(const char *topic, float absDeadband, float relDeadband, uint32_t minInterval, uint32_t maxInterval);
+    espIOTLib_publishFilter *getPublishFilter();
+    /**
+     * @brief Keep a local history of numeric readings and serve it as CSV/JSON web page
+     * 
+     * @param fromPublish Record every publishInt/publishFloat value (before the publish filter)
+     * @param series Number of topics kept, each one takes sizeof(espIOTLib_tsSeries) on its first value
+     * @param uri Page to register, NULL for /espIOTWeb/history
+     */
+    void enableTimeSeries(bool fromPublish = true, size_t series = ESP_IOTLIB_TS_SERIES, const char *uri = NULL);
+    /**
+     * @brief Add a reading to the history without publishing it
+     */
+    bool recordValue(const char *topic, float value);
+    espIOTLib_timeSeries *getTimeSeries();
+    /**
+     * @brief Push every value handed to publishInt/publishFloat/publishStr and changes of the status values
+     * to browsers as Server-Sent Events on /espIOTWeb/events, and add a "Live" page that shows them
+     */
+    void enableEventStream();
+    espIOTLib_eventStream *getEventStream();
+    /**
+     * @brief Allocate the buffer used by beginBatch(), call after enableMQTT
+     * 
+     * @param bufferLen Max. JSON payload (or prefix/key topic in pipeline mode) length
+     */
+    void enableBatchPublish(size_t bufferLen = ESP_IOTLIB_BATCH_BUFFER_LEN);
+    /**
+     * @brief Start collecting values for one publish cycle
+     * 
+     * @param prefix Device topic, must stay valid until commitBatch()
+     * @param mode ESP_IOTLIB_BATCH_JSON to send one JSON object to prefix,
+     *  ESP_IOTLIB_BATCH_PIPELINE to send each value to prefix/key but in a single socket write
+     * @return false if batching is not enabled or a batch is already open
+     */
+    bool beginBatch(const char *prefix, espIOTLib_batchMode mode = ESP_IOTLIB_BATCH_JSON);
+    bool batchAddInt(const char *key, int64_t value);
+    bool batchAddFloat(const char *key, double value);
+    bool batchAddStr(const char *key, const char *value);
+    /**
+     * @brief Send the batch
+     * 
+     * @return false if it did not fit into the buffer (nothing is sent) or could not be published
+     */
+    bool commitBatch();
+    /**
+     * @brief When coalesced MQTT writes go out: after every complete packet (default)
+     * or once at the end of loop(), which packs all publishes of one cycle into as few TCP segments as possible
+     */
+    void setMQTTFlushPolicy(espIOTLib_netFlushPolicy policy);
+    espIOTLib_bufferedClient *getMQTTNetClient();
     
+#ifndef ESP_IOTLIB_NO_OTA
         // OTA
     void enableOTA(const char *md5Password);
+#endif
 };
 
 #endif /* ESPIOTLIB_H */
\ No newline at end of file
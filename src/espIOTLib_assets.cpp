@@ -0,0 +1,198 @@
+/**
+ * @file espIOTLib_assets.cpp
+ * @author Paul Schlarmann (paul.schlarmann@makerspace-minden.de)
+ * @brief Static files served from flash or LittleFS, pre-compressed, with ETag and Cache-Control
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) Paul Schlarmann 2023
+ *
+ */
+
+// --- Includes ---
+#include "espIOTLib_assets.h"
+#include "espIOTLib_format.h"
+
+#ifdef ESP_IOTLIB_ASSETS_FS
+#include <LittleFS.h>
+#endif
+
+// --- Defines ---
+// Quotes and 8 hex digits
+#define ASSET_ETAG_LEN 10
+#define FNV_OFFSET 2166136261UL
+#define FNV_PRIME 16777619UL
+
+// --- Private Functions ---
+static uint32_t hashProgmem(const uint8_t *data, size_t length){
+    uint32_t hash = FNV_OFFSET;
+    for(size_t i = 0; i < length; i++){
+        hash ^= pgm_read_byte(data + i);
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+#ifdef ESP_IOTLIB_ASSETS_FS
+static uint32_t hashFile(File &file){
+    uint8_t buffer[ESP_IOTLIB_ASSET_CHUNK];
+    uint32_t hash = FNV_OFFSET;
+    size_t length;
+    while((length = file.read(buffer, sizeof(buffer))) > 0){
+        for(size_t i = 0; i < length; i++){
+            hash ^= buffer[i];
+            hash *= FNV_PRIME;
+        }
+    }
+    return hash;
+}
+#endif
+
+void espIOTLib_assets::_formatETag(char *buffer, uint32_t etag){
+    buffer[0] = '"';
+    for(uint8_t i = 0; i < 8; i++)
+        buffer[1 + i] = "0123456789abcdef"[(etag >> (28 - 4 * i)) & 0x0F];
+    buffer[9] = '"';
+    buffer[ASSET_ETAG_LEN] = '\0';
+}
+
+// If-None-Match may list several tags, weak ones with W/ in front
+bool espIOTLib_assets::_matches(WebServer *server, const char *etag){
+    if(!server->hasHeader(F("If-None-Match")))
+        return false;
+    String header = server->header(F("If-None-Match"));
+    return header == "*" || strstr(header.c_str(), etag) != NULL;
+}
+
+int espIOTLib_assets::_add(const espIOTLib_asset &asset){
+    if(!asset.uri || !asset.contentType)
+        return -1;
+    for(const espIOTLib_asset &other: this->_assets){
+        if(strcmp(other.uri, asset.uri) == 0)
+            return -1;
+    }
+    this->_assets.push_back(asset);
+    return this->_assets.size() - 1;
+}
+
+// --- Public Functions ---
+int espIOTLib_assets::add(const char *uri, const char *contentType, const uint8_t *data, size_t length, bool gzip, uint32_t maxAge){
+    if(!data)
+        return -1;
+    espIOTLib_asset asset;
+    memset(&asset, 0, sizeof(espIOTLib_asset));
+    asset.uri = uri;
+    asset.contentType = contentType;
+    asset.data = data;
+    asset.length = length;
+    asset.etag = hashProgmem(data, length);
+    asset.maxAge = maxAge;
+    asset.gzip = gzip;
+    return this->_add(asset);
+}
+
+int espIOTLib_assets::addFile(const char *uri, const char *contentType, const char *path, bool gzip, uint32_t maxAge){
+#ifdef ESP_IOTLIB_ASSETS_FS
+    if(!path || !LittleFS.begin())
+        return -1;
+    File file = LittleFS.open(path, "r");
+    if(!file)
+        return -1;
+    espIOTLib_asset asset;
+    memset(&asset, 0, sizeof(espIOTLib_asset));
+    asset.uri = uri;
+    asset.contentType = contentType;
+    asset.path = path;
+    asset.length = file.size();
+    asset.etag = hashFile(file);
+    asset.maxAge = maxAge;
+    asset.gzip = gzip;
+    file.close();
+    return this->_add(asset);
+#else
+    (void)uri;
+    (void)contentType;
+    (void)path;
+    (void)gzip;
+    (void)maxAge;
+    return -1;
+#endif
+}
+
+void espIOTLib_assets::serve(WebServer *server, size_t index){
+    if(index >= this->_assets.size()){
+        server->send(404, "text/plain", "Not found");
+        return;
+    }
+    espIOTLib_asset *asset = &this->_assets[index];
+#ifdef ESP_IOTLIB_ASSETS_FS
+    File file;
+    if(!asset->data){
+        file = LittleFS.open(asset->path, "r");
+        if(!file){
+            server->send(404, "text/plain", "Not found");
+            return;
+        }
+        // Hashed on every request, a replaced file of the same size must not keep the old ETag
+        asset->length = file.size();
+        asset->etag = hashFile(file);
+        file.seek(0);
+    }
+#endif
+    asset->requests++;
+    this->_requests++;
+
+    char etag[ASSET_ETAG_LEN + 1];
+    _formatETag(etag, asset->etag);
+    char cacheControl[24];
+    if(asset->maxAge > 0){
+        memcpy(cacheControl, "max-age=", 8);
+        espIOTLib_formatUInt(cacheControl + 8, sizeof(cacheControl) - 8, asset->maxAge);
+    } else {
+        strcpy(cacheControl, "no-cache");
+    }
+    server->sendHeader(F("ETag"), etag);
+    server->sendHeader(F("Cache-Control"), cacheControl);
+    if(_matches(server, etag)){
+        asset->notModified++;
+        this->_notModified++;
+        server->send(304, asset->contentType, "");
+        return;
+    }
+    // Always the same representation, so no Vary: Accept-Encoding
+    if(asset->gzip)
+        server->sendHeader(F("Content-Encoding"), F("gzip"));
+    if(asset->data){
+        server->send_P(200, asset->contentType, (PGM_P)asset->data, asset->length);
+    }
+#ifdef ESP_IOTLIB_ASSETS_FS
+    else {
+        server->setContentLength(asset->length);
+        server->send(200, asset->contentType, "");
+        char buffer[ESP_IOTLIB_ASSET_CHUNK];
+        size_t length;
+        while((length = file.read((uint8_t *)buffer, sizeof(buffer))) > 0)
+            server->sendContent(buffer, length);
+        file.close();
+    }
+#endif
+    this->_bytesSent += asset->length;
+}
+
+size_t espIOTLib_assets::size(){
+    return this->_assets.size();
+}
+const espIOTLib_asset *espIOTLib_assets::get(size_t index){
+    if(index >= this->_assets.size())
+        return NULL;
+    return &this->_assets[index];
+}
+uint32_t espIOTLib_assets::requestCount(){
+    return this->_requests;
+}
+uint32_t espIOTLib_assets::notModifiedCount(){
+    return this->_notModified;
+}
+uint32_t espIOTLib_assets::bytesSentCount(){
+    return this->_bytesSent;
+}
@@ -0,0 +1,92 @@
+/**
+ * @file espIOTLib_assets.h
+ * @author Paul Schlarmann (paul.schlarmann@makerspace-minden.de)
+ * @brief Static files served from flash or LittleFS, pre-compressed, with ETag and Cache-Control
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) Paul Schlarmann 2023
+ *
+ */
+#ifndef ESPIOTLIB_ASSETS_H
+#define ESPIOTLIB_ASSETS_H
+
+// --- Includes ---
+#include <Arduino.h>
+
+#include <vector>
+#include <IotWebConf.h>
+
+// --- Defines ---
+// Cache-Control max-age in s, 0 makes the browser ask every time (and get a 304 if unchanged)
+#ifndef ESP_IOTLIB_ASSET_MAX_AGE
+    #define ESP_IOTLIB_ASSET_MAX_AGE 86400
+#endif
+// Read buffer on the stack when sending a file
+#ifndef ESP_IOTLIB_ASSET_CHUNK
+    #define ESP_IOTLIB_ASSET_CHUNK 512
+#endif
+
+//Define this to allow assets stored as LittleFS files
+//#define ESP_IOTLIB_ASSETS_FS
+
+// --- Typedefs ---
+struct espIOTLib_asset{
+    const char *uri;
+    const char *contentType;
+    const uint8_t *data;            // PROGMEM content, NULL for a file
+    const char *path;               // LittleFS path, NULL for PROGMEM content
+    size_t length;
+    uint32_t etag;                  // Hash of the content as sent
+    uint32_t maxAge;
+    bool gzip;
+    uint32_t requests;
+    uint32_t notModified;
+};
+
+// --- Public Classes ---
+
+/**
+ * @brief Registry of static assets. The content is sent as it is stored, so a gzip asset is compressed once
+ * at build time and not on the device. The ETag is a hash of the content, a browser that already has it
+ * gets a 304 without body; with a max-age it does not even ask until that is over.
+ */
+class espIOTLib_assets
+{
+protected:
+    std::vector<espIOTLib_asset> _assets;
+    uint32_t _requests = 0;
+    uint32_t _notModified = 0;
+    uint32_t _bytesSent = 0;
+
+    static void _formatETag(char *buffer, uint32_t etag);
+    static bool _matches(WebServer *server, const char *etag);
+    int _add(const espIOTLib_asset &asset);
+
+public:
+    /**
+     * @param data PROGMEM content, must stay valid
+     * @param gzip Content is gzip compressed, sent with Content-Encoding: gzip
+     * @return Index for serve(), -1 if the uri is already used
+     */
+    int add(const char *uri, const char *contentType, const uint8_t *data, size_t length, bool gzip, uint32_t maxAge);
+    /**
+     * @brief Asset stored as LittleFS file (needs ESP_IOTLIB_ASSETS_FS). The file is hashed again on every request,
+     * so a replaced file gets a new ETag; that reads it twice, which is cheap for the small files this is meant for
+     *
+     * @return Index for serve(), -1 if the uri is already used or the file does not exist
+     */
+    int addFile(const char *uri, const char *contentType, const char *path, bool gzip, uint32_t maxAge);
+    /**
+     * @brief Answer the current request with asset index, or with 304 if the browser has it already
+     */
+    void serve(WebServer *server, size_t index);
+
+    size_t size();
+    const espIOTLib_asset *get(size_t index);
+    uint32_t requestCount();
+    uint32_t notModifiedCount();
+    uint32_t bytesSentCount();
+};
+
+#endif /* ESPIOTLIB_ASSETS_H */
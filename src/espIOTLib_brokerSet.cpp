@@ -0,0 +1,149 @@
+/**
+ * @file espIOTLib_brokerSet.cpp
+ * @author Paul Schlarmann (paul.schlarmann@makerspace-minden.de)
+ * @brief Primary and backup MQTT brokers with connect latency and failure history
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) Paul Schlarmann 2023
+ *
+ */
+
+// --- Includes ---
+#include "espIOTLib_brokerSet.h"
+
+// --- Private Functions ---
+bool espIOTLib_brokerSet::_parse(const char *entry, size_t length, uint16_t defaultPort, espIOTLib_broker *broker){
+    memset(broker, 0, sizeof(espIOTLib_broker));
+    broker->port = defaultPort;
+    const char *colon = (const char *)memchr(entry, ':', length);
+    if(colon){
+        uint32_t port = 0;
+        for(const char *c = colon + 1; c < entry + length; c++){
+            if(*c < '0' || *c > '9')
+                return false;
+            port = port * 10 + (*c - '0');
+            if(port > 65535)
+                return false;
+        }
+        if(port == 0)
+            return false;
+        broker->port = port;
+        length = colon - entry;
+    }
+    if(length == 0 || length >= ESP_IOTLIB_MQTT_HOST_LEN)
+        return false;
+    memcpy(broker->host, entry, length);
+    broker->host[length] = '\0';
+    return true;
+}
+
+uint32_t espIOTLib_brokerSet::_cooldown(uint8_t index){
+    uint8_t shift = this->_brokers[index].consecutiveFailures - 1;
+    if(shift > 16)
+        shift = 16;
+    uint32_t cooldown = (uint32_t)ESP_IOTLIB_BROKER_COOLDOWN << shift;
+    if(cooldown > ESP_IOTLIB_BROKER_MAX_COOLDOWN || cooldown < ESP_IOTLIB_BROKER_COOLDOWN)
+        cooldown = ESP_IOTLIB_BROKER_MAX_COOLDOWN;
+    return cooldown;
+}
+
+// --- Public Functions ---
+uint8_t espIOTLib_brokerSet::configure(const char *primary, const char *backups, uint16_t defaultPort){
+    espIOTLib_broker brokers[ESP_IOTLIB_MQTT_BROKERS];
+    uint8_t count = 0;
+    if(primary && _parse(primary, strlen(primary), defaultPort, &brokers[0]))
+        count++;
+    const char *entry = backups;
+    while(entry && *entry && count < ESP_IOTLIB_MQTT_BROKERS){
+        size_t length = strcspn(entry, ", ");
+        if(length > 0 && _parse(entry, length, defaultPort, &brokers[count]))
+            count++;
+        entry += length;
+        entry += strspn(entry, ", ");
+    }
+    // Same host and port, same history
+    for(uint8_t i = 0; i < count; i++){
+        for(uint8_t j = 0; j < this->_count; j++){
+            if(brokers[i].port == this->_brokers[j].port && strcmp(brokers[i].host, this->_brokers[j].host) == 0){
+                brokers[i] = this->_brokers[j];
+                break;
+            }
+        }
+    }
+    memcpy(this->_brokers, brokers, count * sizeof(espIOTLib_broker));
+    this->_count = count;
+    return count;
+}
+
+void espIOTLib_brokerSet::connected(uint8_t index, uint32_t latency){
+    if(index >= this->_count)
+        return;
+    espIOTLib_broker *broker = &this->_brokers[index];
+    broker->connects++;
+    broker->history <<= 1;
+    broker->consecutiveFailures = 0;
+    broker->lastLatency = latency;
+    broker->avgLatency = broker->connects == 1 ? latency : (broker->avgLatency * 3 + latency) / 4;
+}
+
+void espIOTLib_brokerSet::failed(uint8_t index, uint32_t now){
+    if(index >= this->_count)
+        return;
+    espIOTLib_broker *broker = &this->_brokers[index];
+    broker->failures++;
+    broker->history = (broker->history << 1) | 1;
+    if(broker->consecutiveFailures < UINT8_MAX)
+        broker->consecutiveFailures++;
+    broker->lastFailure = now;
+}
+
+void espIOTLib_brokerSet::reachable(uint8_t index){
+    if(index >= this->_count)
+        return;
+    this->_brokers[index].consecutiveFailures = 0;
+}
+
+bool espIOTLib_brokerSet::available(uint8_t index, uint32_t now){
+    if(index >= this->_count)
+        return false;
+    return this->_brokers[index].consecutiveFailures == 0 || now - this->_brokers[index].lastFailure >= this->_cooldown(index);
+}
+
+uint32_t espIOTLib_brokerSet::score(uint8_t index){
+    if(index >= this->_count)
+        return UINT32_MAX;
+    uint32_t latency = this->_brokers[index].connects > 0 ? this->_brokers[index].avgLatency : ESP_IOTLIB_BROKER_UNTRIED_LATENCY;
+    return this->recentFailures(index) * ESP_IOTLIB_BROKER_FAILURE_PENALTY + latency;
+}
+
+int espIOTLib_brokerSet::pick(uint32_t now){
+    int best = -1;
+    uint32_t bestScore = UINT32_MAX;
+    for(uint8_t i = 0; i < this->_count; i++){
+        if(!this->available(i, now))
+            continue;
+        uint32_t score = this->score(i);
+        if(best < 0 || score < bestScore){
+            best = i;
+            bestScore = score;
+        }
+    }
+    return best;
+}
+
+uint8_t espIOTLib_brokerSet::count(){
+    return this->_count;
+}
+
+const espIOTLib_broker *espIOTLib_brokerSet::get(uint8_t index){
+    if(index >= this->_count)
+        return NULL;
+    return &this->_brokers[index];
+}
+
+uint8_t espIOTLib_brokerSet::recentFailures(uint8_t index){
+    if(index >= this->_count)
+        return 0;
+    return __builtin_popcount(this->_brokers[index].history);
+}
@@ -0,0 +1,99 @@
+/**
+ * @file espIOTLib_brokerSet.h
+ * @author Paul Schlarmann (paul.schlarmann@makerspace-minden.de)
+ * @brief Primary and backup MQTT brokers with connect latency and failure history
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) Paul Schlarmann 2023
+ *
+ */
+#ifndef ESPIOTLIB_BROKERSET_H
+#define ESPIOTLIB_BROKERSET_H
+
+// --- Includes ---
+#include <Arduino.h>
+
+// --- Defines ---
+// Primary plus backups
+#ifndef ESP_IOTLIB_MQTT_BROKERS
+    #define ESP_IOTLIB_MQTT_BROKERS 3
+#endif
+#ifndef ESP_IOTLIB_MQTT_HOST_LEN
+    #define ESP_IOTLIB_MQTT_HOST_LEN 64
+#endif
+// A broker that failed is skipped for this long, doubled with every further failure in a row
+#ifndef ESP_IOTLIB_BROKER_COOLDOWN
+    #define ESP_IOTLIB_BROKER_COOLDOWN 5000
+#endif
+#ifndef ESP_IOTLIB_BROKER_MAX_COOLDOWN
+    #define ESP_IOTLIB_BROKER_MAX_COOLDOWN 300000
+#endif
+// Score of one failure among the last 8 attempts, in ms of connect latency
+#ifndef ESP_IOTLIB_BROKER_FAILURE_PENALTY
+    #define ESP_IOTLIB_BROKER_FAILURE_PENALTY 1000
+#endif
+// Assumed latency of a broker that was never connected
+#ifndef ESP_IOTLIB_BROKER_UNTRIED_LATENCY
+    #define ESP_IOTLIB_BROKER_UNTRIED_LATENCY 2000
+#endif
+
+// --- Typedefs ---
+struct espIOTLib_broker{
+    char host[ESP_IOTLIB_MQTT_HOST_LEN];
+    uint16_t port;
+    uint32_t connects;
+    uint32_t failures;
+    uint8_t history;                // Last 8 attempts, newest in bit 0, set = failed
+    uint8_t consecutiveFailures;
+    uint32_t lastFailure;
+    uint32_t lastLatency;           // ms from resolve to CONNACK
+    uint32_t avgLatency;            // Moving average, 1/4 weight for the newest
+};
+
+// --- Public Classes ---
+
+/**
+ * @brief Picks the broker to connect to. The score adds a penalty for every failure in the recent history
+ * to the average connect latency, lower is better; brokers that just failed are skipped until their cooldown is over.
+ * Ties go to the lower index, so the primary wins among equally healthy brokers.
+ */
+class espIOTLib_brokerSet
+{
+protected:
+    espIOTLib_broker _brokers[ESP_IOTLIB_MQTT_BROKERS];
+    uint8_t _count = 0;
+
+    static bool _parse(const char *entry, size_t length, uint16_t defaultPort, espIOTLib_broker *broker);
+    uint32_t _cooldown(uint8_t index);
+
+public:
+    /**
+     * @brief Set the broker list, the stats of brokers that were already in it are kept
+     *
+     * @param primary "host" or "host:port"
+     * @param backups Same, separated by ',' or ' '
+     * @return Number of brokers
+     */
+    uint8_t configure(const char *primary, const char *backups, uint16_t defaultPort);
+    void connected(uint8_t index, uint32_t latency);
+    void failed(uint8_t index, uint32_t now);
+    /**
+     * @brief The broker accepted a TCP connection, end its cooldown
+     */
+    void reachable(uint8_t index);
+    bool available(uint8_t index, uint32_t now);
+    uint32_t score(uint8_t index);
+    /**
+     * @brief Healthiest available broker
+     *
+     * @return -1 if all are cooling down
+     */
+    int pick(uint32_t now);
+
+    uint8_t count();
+    const espIOTLib_broker *get(uint8_t index);
+    uint8_t recentFailures(uint8_t index);
+};
+
+#endif /* ESPIOTLIB_BROKERSET_H */
@@ -0,0 +1,299 @@
+/**
+ * @file espIOTLib_bufferedClient.cpp
+ * @author Paul Schlarmann (paul.schlarmann@makerspace-minden.de)
+ * @brief Write coalescing Client wrapper for the MQTT connection
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) Paul Schlarmann 2023
+ *
+ */
+
+// --- Includes ---
+#include "espIOTLib_bufferedClient.h"
+
+// --- Defines ---
+#define FRAME_TYPE 0
+#define FRAME_LENGTH 1
+#define FRAME_BODY 2
+#define MQTT_PUBACK 0x4
+
+// --- Private Functions ---
+bool espIOTLib_bufferedClient::_send(){
+    if(this->_used == 0)
+        return true;
+    size_t written = this->_client->write(this->_buffer, this->_used);
+    bool ok = written == this->_used;
+    // A partial write leaves the MQTT stream broken anyway, the connection gets dropped by the caller
+    this->_used = 0;
+    this->_segments++;
+    this->_flushes++;
+    return ok;
+}
+
+// Follow type byte, remaining length and body of each packet. Returns true if the data ends on a packet boundary
+bool espIOTLib_bufferedClient::_track(const uint8_t *buffer, size_t size){
+    size_t i = 0;
+    while(i < size){
+        switch (this->_frameState)
+        {
+        case FRAME_TYPE:
+            this->_frameState = FRAME_LENGTH;
+            this->_frameShift = 0;
+            this->_frameRemaining = 0;
+            i++;
+            break;
+        case FRAME_LENGTH: {
+            uint8_t b = buffer[i++];
+            this->_frameRemaining |= (uint32_t)(b & 0x7F) << this->_frameShift;
+            this->_frameShift += 7;
+            // Remaining length has at most 4 bytes, resync on anything longer
+            if(b & 0x80 && this->_frameShift < 28)
+                break;
+            if(this->_frameRemaining == 0){
+                this->_frameState = FRAME_TYPE;
+                this->_packets++;
+            } else {
+                this->_frameState = FRAME_BODY;
+            }
+            break;
+        }
+        case FRAME_BODY: {
+            size_t n = size - i;
+            if(n > this->_frameRemaining)
+                n = this->_frameRemaining;
+            i += n;
+            this->_frameRemaining -= n;
+            if(this->_frameRemaining == 0){
+                this->_frameState = FRAME_TYPE;
+                this->_packets++;
+            }
+            break;
+        }
+        }
+    }
+    return this->_frameState == FRAME_TYPE;
+}
+
+// Same framing for the incoming stream, reports the packet id of each PUBACK
+void espIOTLib_bufferedClient::_trackIn(const uint8_t *buffer, size_t size){
+    for(size_t i = 0; i < size; i++){
+        uint8_t b = buffer[i];
+        switch (this->_inState)
+        {
+        case FRAME_TYPE:
+            this->_inType = b >> 4;
+            this->_inState = FRAME_LENGTH;
+            this->_inShift = 0;
+            this->_inRemaining = 0;
+            break;
+        case FRAME_LENGTH:
+            this->_inRemaining |= (uint32_t)(b & 0x7F) << this->_inShift;
+            this->_inShift += 7;
+            if(b & 0x80 && this->_inShift < 28)
+                break;
+            this->_inPos = 0;
+            this->_inId = 0;
+            this->_inState = this->_inRemaining > 0 ? FRAME_BODY : FRAME_TYPE;
+            break;
+        case FRAME_BODY:
+            if(this->_inPos < 2){
+                this->_inId = (this->_inId << 8) | b;
+                this->_inPos++;
+            } else {
+                // Skip the rest of long packets (e.g. incoming publishes) in one go
+                size_t skip = this->_inRemaining - this->_inPos;
+                if(skip > size - i)
+                    skip = size - i;
+                i += skip - 1;
+                this->_inPos += skip;
+            }
+            if(this->_inPos < this->_inRemaining)
+                break;
+            this->_inState = FRAME_TYPE;
+            if(this->_inType == MQTT_PUBACK && this->_inRemaining == 2 && this->_ackCB)
+                this->_ackCB(this->_ackArg, this->_inId);
+            break;
+        }
+    }
+}
+
+// New connection, nothing buffered belongs to it
+void espIOTLib_bufferedClient::_reset(){
+    this->_used = 0;
+    this->_frameState = FRAME_TYPE;
+    this->_inState = FRAME_TYPE;
+}
+
+// --- Public Functions ---
+espIOTLib_bufferedClient::espIOTLib_bufferedClient(Client *client, size_t bufferLen){
+    this->_client = client;
+    this->_bufferLen = bufferLen;
+    this->_buffer = new uint8_t[bufferLen];
+}
+
+espIOTLib_bufferedClient::~espIOTLib_bufferedClient(){
+    delete[] this->_buffer;
+}
+
+void espIOTLib_bufferedClient::cork(){
+    this->_corked++;
+}
+
+bool espIOTLib_bufferedClient::uncork(){
+    if(this->_corked == 0)
+        return true;
+    this->_corked--;
+    if(this->_corked > 0)
+        return true;
+    return this->_send();
+}
+
+bool espIOTLib_bufferedClient::isCorked(){
+    return this->_corked > 0;
+}
+
+size_t espIOTLib_bufferedClient::pending(){
+    return this->_used;
+}
+
+void espIOTLib_bufferedClient::setDiscardWrites(bool discard){
+    this->_discard = discard;
+}
+
+void espIOTLib_bufferedClient::setFlushPolicy(espIOTLib_netFlushPolicy policy){
+    this->_policy = policy;
+}
+
+espIOTLib_netFlushPolicy espIOTLib_bufferedClient::flushPolicy(){
+    return this->_policy;
+}
+
+void espIOTLib_bufferedClient::setAckCallback(espIOTLibAckCB callback, void *arg){
+    this->_ackCB = callback;
+    this->_ackArg = arg;
+}
+
+bool espIOTLib_bufferedClient::sendBuffered(){
+    return this->_send();
+}
+
+uint32_t espIOTLib_bufferedClient::bytesCount(){
+    return this->_bytes;
+}
+uint32_t espIOTLib_bufferedClient::writeCount(){
+    return this->_writes;
+}
+uint32_t espIOTLib_bufferedClient::packetCount(){
+    return this->_packets;
+}
+uint32_t espIOTLib_bufferedClient::segmentCount(){
+    return this->_segments;
+}
+uint32_t espIOTLib_bufferedClient::flushCount(){
+    return this->_flushes;
+}
+
+int espIOTLib_bufferedClient::connect(IPAddress ip, uint16_t port){
+    this->_reset();
+    return this->_client->connect(ip, port);
+}
+
+int espIOTLib_bufferedClient::connect(const char *host, uint16_t port){
+    this->_reset();
+    return this->_client->connect(host, port);
+}
+
+#ifdef ESP32
+int espIOTLib_bufferedClient::connect(IPAddress ip, uint16_t port, int32_t timeout){
+    this->_reset();
+    return this->_client->connect(ip, port, timeout);
+}
+
+int espIOTLib_bufferedClient::connect(const char *host, uint16_t port, int32_t timeout){
+    this->_reset();
+    return this->_client->connect(host, port, timeout);
+}
+#endif
+
+size_t espIOTLib_bufferedClient::write(uint8_t c){
+    return this->write(&c, 1);
+}
+
+size_t espIOTLib_bufferedClient::write(const uint8_t *buffer, size_t size){
+    if(this->_discard)
+        return size;
+    this->_writes++;
+    this->_bytes += size;
+    bool boundary = this->_track(buffer, size);
+    if(this->_used + size > this->_bufferLen && !this->_send())
+        return 0;
+    if(size > this->_bufferLen){
+        this->_segments++;
+        return this->_client->write(buffer, size);
+    }
+    memcpy(this->_buffer + this->_used, buffer, size);
+    this->_used += size;
+    if(boundary && this->_corked == 0 && this->_policy == ESP_IOTLIB_NET_FLUSH_PACKET && !this->_send())
+        return 0;
+    return size;
+}
+
+// Anything that waits for the broker has to send what is held back first
+int espIOTLib_bufferedClient::available(){
+    this->_send();
+    return this->_client->available();
+}
+
+int espIOTLib_bufferedClient::read(){
+    this->_send();
+    int c = this->_client->read();
+    if(c >= 0 && this->_ackCB){
+        uint8_t b = c;
+        this->_trackIn(&b, 1);
+    }
+    return c;
+}
+
+int espIOTLib_bufferedClient::read(uint8_t *buffer, size_t size){
+    this->_send();
+    int n = this->_client->read(buffer, size);
+    if(n > 0 && this->_ackCB)
+        this->_trackIn(buffer, n);
+    return n;
+}
+
+int espIOTLib_bufferedClient::peek(){
+    this->_send();
+    return this->_client->peek();
+}
+
+#ifdef ESP8266
+bool espIOTLib_bufferedClient::flush(unsigned int maxWaitMs){
+    this->_send();
+    return this->_client->flush(maxWaitMs);
+}
+
+bool espIOTLib_bufferedClient::stop(unsigned int maxWaitMs){
+    this->_reset();
+    return this->_client->stop(maxWaitMs);
+}
+#else
+void espIOTLib_bufferedClient::flush(){
+    this->_send();
+    this->_client->flush();
+}
+
+void espIOTLib_bufferedClient::stop(){
+    this->_reset();
+    this->_client->stop();
+}
+#endif
+
+uint8_t espIOTLib_bufferedClient::connected(){
+    return this->_client->connected();
+}
+
+espIOTLib_bufferedClient::operator bool(){
+    return this->_client->operator bool();
+}
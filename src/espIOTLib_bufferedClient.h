@@ -0,0 +1,140 @@
+/**
+ * @file espIOTLib_bufferedClient.h
+ * @author Paul Schlarmann (paul.schlarmann@makerspace-minden.de)
+ * @brief Write coalescing Client wrapper for the MQTT connection
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) Paul Schlarmann 2023
+ *
+ */
+#ifndef ESPIOTLIB_BUFFEREDCLIENT_H
+#define ESPIOTLIB_BUFFEREDCLIENT_H
+
+// --- Includes ---
+#include <Arduino.h>
+#include <Client.h>
+
+// --- Defines ---
+#ifndef ESP_IOTLIB_NET_BUFFER_LEN
+    #define ESP_IOTLIB_NET_BUFFER_LEN 536 // Default TCP MSS of lwIP
+#endif
+
+// --- Typedefs ---
+typedef enum {
+    ESP_IOTLIB_NET_FLUSH_PACKET = 0,    // Send as soon as a complete MQTT packet is buffered
+    ESP_IOTLIB_NET_FLUSH_LOOP           // Hold complete packets until sendBuffered() at the end of loop()
+} espIOTLib_netFlushPolicy;
+
+// Called for every incoming PUBACK with its packet id
+typedef void (*espIOTLibAckCB)(void *arg, uint16_t packetId);
+
+// --- Public Classes ---
+
+/**
+ * @brief Sits between the MQTT client and the WiFiClient and gathers writes in a preallocated buffer.
+ * The MQTT fixed header is followed through the stream, so a packet written in pieces still leaves
+ * as one socket write. Buffered data is sent on a packet boundary (depending on the flush policy),
+ * when the buffer is full, on sendBuffered() and before anything is read, so waits for
+ * CONNACK/SUBACK/PINGRESP always see their request sent.
+ * While corked nothing is sent before uncork() unless the buffer runs full.
+ */
+class espIOTLib_bufferedClient : public Client
+{
+protected:
+    Client *_client;
+    uint8_t *_buffer;
+    size_t _bufferLen;
+    size_t _used = 0;
+    uint8_t _corked = 0;
+    bool _discard = false;
+    espIOTLib_netFlushPolicy _policy = ESP_IOTLIB_NET_FLUSH_PACKET;
+
+    // MQTT framing of the outgoing stream
+    uint8_t _frameState = 0;
+    uint8_t _frameShift = 0;
+    uint32_t _frameRemaining = 0;
+    uint8_t _inState = 0;
+    uint8_t _inShift = 0;
+    uint8_t _inType = 0;
+    uint32_t _inRemaining = 0;
+    uint32_t _inPos = 0;
+    uint16_t _inId = 0;
+    espIOTLibAckCB _ackCB = NULL;
+    void *_ackArg = NULL;
+
+    uint32_t _bytes = 0;
+    uint32_t _writes = 0;
+    uint32_t _packets = 0;
+    uint32_t _segments = 0;
+    uint32_t _flushes = 0;
+
+    bool _send();
+    bool _track(const uint8_t *buffer, size_t size);
+    void _trackIn(const uint8_t *buffer, size_t size);
+    void _reset();
+
+public:
+    espIOTLib_bufferedClient(Client *client, size_t bufferLen = ESP_IOTLIB_NET_BUFFER_LEN);
+    ~espIOTLib_bufferedClient();
+
+    /**
+     * @brief Hold back writes until the matching uncork(), calls may be nested
+     */
+    void cork();
+    /**
+     * @brief Send everything held back once the outermost cork is released
+     * 
+     * @return false if the held back data could not be written
+     */
+    bool uncork();
+    bool isCorked();
+    size_t pending();
+    void setFlushPolicy(espIOTLib_netFlushPolicy policy);
+    espIOTLib_netFlushPolicy flushPolicy();
+    /**
+     * @brief Watch the incoming stream for PUBACKs, the packets are still passed on to the MQTT client unchanged
+     */
+    void setAckCallback(espIOTLibAckCB callback, void *arg);
+    /**
+     * @brief Swallow writes without sending or counting them, for a packet that was already sent another way
+     */
+    void setDiscardWrites(bool discard);
+    /**
+     * @brief Send whatever is buffered
+     * 
+     * @return false if the socket did not take all of it
+     */
+    bool sendBuffered();
+
+    uint32_t bytesCount();      // Bytes written by the MQTT client
+    uint32_t writeCount();      // write() calls of the MQTT client
+    uint32_t packetCount();     // Complete MQTT packets
+    uint32_t segmentCount();    // Writes to the socket
+    uint32_t flushCount();      // Buffer flushes
+
+    int connect(IPAddress ip, uint16_t port) override;
+    int connect(const char *host, uint16_t port) override;
+#ifdef ESP32
+    int connect(IPAddress ip, uint16_t port, int32_t timeout) override;
+    int connect(const char *host, uint16_t port, int32_t timeout) override;
+#endif
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t *buffer, size_t size) override;
+    using Print::write;
+    int available() override;
+    int read() override;
+    int read(uint8_t *buffer, size_t size) override;
+    int peek() override;
+#ifdef ESP8266
+    bool flush(unsigned int maxWaitMs = 0) override;
+    bool stop(unsigned int maxWaitMs = 0) override;
+#else
+    void flush() override;
+    void stop() override;
+#endif
+    uint8_t connected() override;
+    operator bool() override;
+};
+
+#endif /* ESPIOTLIB_BUFFEREDCLIENT_H */
@@ -0,0 +1,263 @@
+/**
+ * @file espIOTLib_dutyCycle.cpp
+ * @author Paul Schlarmann (paul.schlarmann@makerspace-minden.de)
+ * @brief Wake, publish, sleep cycle for battery powered devices, with time per phase and wake reason
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) Paul Schlarmann 2023
+ *
+ */
+
+// --- Includes ---
+#include "espIOTLib_dutyCycle.h"
+
+#ifdef ESP8266
+#include <ESP8266WiFi.h>
+#elif defined(ESP32)
+#include <WiFi.h>
+#include <esp_sleep.h>
+#include <esp_system.h>
+#endif
+
+// --- Defines ---
+#ifdef ESP32
+RTC_DATA_ATTR static espIOTLib_dutyCycleRecord rtcRecord;
+#endif
+
+// --- Private Functions ---
+uint32_t espIOTLib_dutyCycle::_crc(const espIOTLib_dutyCycleRecord *record){
+    const uint8_t *data = (const uint8_t *)&record->cycles;
+    const uint8_t *end = (const uint8_t *)record + sizeof(espIOTLib_dutyCycleRecord);
+    uint32_t hash = 2166136261UL;
+    while(data < end){
+        hash ^= *data++;
+        hash *= 16777619UL;
+    }
+    return hash;
+}
+
+espIOTLib_wakeReason espIOTLib_dutyCycle::_readWakeReason(){
+#ifdef ESP8266
+    switch(ESP.getResetInfoPtr()->reason){
+    case REASON_DEFAULT_RST:
+        return ESP_IOTLIB_WAKE_POWER_ON;
+    case REASON_DEEP_SLEEP_AWAKE:
+        return ESP_IOTLIB_WAKE_TIMER;
+    case REASON_EXT_SYS_RST:
+        return ESP_IOTLIB_WAKE_EXTERNAL;
+    case REASON_SOFT_RESTART:
+        return ESP_IOTLIB_WAKE_RESTART;
+    case REASON_WDT_RST:
+    case REASON_EXCEPTION_RST:
+    case REASON_SOFT_WDT_RST:
+        return ESP_IOTLIB_WAKE_WATCHDOG;
+    default:
+        return ESP_IOTLIB_WAKE_OTHER;
+    }
+#elif defined(ESP32)
+    switch(esp_sleep_get_wakeup_cause()){
+    case ESP_SLEEP_WAKEUP_TIMER:
+        return ESP_IOTLIB_WAKE_TIMER;
+    case ESP_SLEEP_WAKEUP_EXT0:
+    case ESP_SLEEP_WAKEUP_EXT1:
+    case ESP_SLEEP_WAKEUP_GPIO:
+    case ESP_SLEEP_WAKEUP_TOUCHPAD:
+        return ESP_IOTLIB_WAKE_EXTERNAL;
+    case ESP_SLEEP_WAKEUP_UNDEFINED:
+        break;
+    default:
+        return ESP_IOTLIB_WAKE_OTHER;
+    }
+    // Not woken from sleep, so it was a reset
+    switch(esp_reset_reason()){
+    case ESP_RST_POWERON:
+        return ESP_IOTLIB_WAKE_POWER_ON;
+    case ESP_RST_EXT:
+        return ESP_IOTLIB_WAKE_EXTERNAL;
+    case ESP_RST_SW:
+        return ESP_IOTLIB_WAKE_RESTART;
+    case ESP_RST_PANIC:
+    case ESP_RST_INT_WDT:
+    case ESP_RST_TASK_WDT:
+    case ESP_RST_WDT:
+        return ESP_IOTLIB_WAKE_WATCHDOG;
+    default:
+        return ESP_IOTLIB_WAKE_OTHER;
+    }
+#endif
+}
+
+void espIOTLib_dutyCycle::_load(){
+#ifdef ESP8266
+    if(!ESP.rtcUserMemoryRead(ESP_IOTLIB_DUTY_RTC_OFFSET, (uint32_t *)&this->_record, sizeof(espIOTLib_dutyCycleRecord)))
+        this->_record.magic = 0;
+#elif defined(ESP32)
+    memcpy(&this->_record, &rtcRecord, sizeof(espIOTLib_dutyCycleRecord));
+#endif
+    // Random content after power on
+    if(this->_record.magic != ESP_IOTLIB_DUTY_MAGIC || this->_record.crc != _crc(&this->_record))
+        memset(&this->_record, 0, sizeof(espIOTLib_dutyCycleRecord));
+}
+
+void espIOTLib_dutyCycle::_save(){
+    this->_record.magic = ESP_IOTLIB_DUTY_MAGIC;
+    this->_record.crc = _crc(&this->_record);
+#ifdef ESP8266
+    ESP.rtcUserMemoryWrite(ESP_IOTLIB_DUTY_RTC_OFFSET, (uint32_t *)&this->_record, sizeof(espIOTLib_dutyCycleRecord));
+#elif defined(ESP32)
+    memcpy(&rtcRecord, &this->_record, sizeof(espIOTLib_dutyCycleRecord));
+#endif
+}
+
+// --- Public Functions ---
+espIOTLib_dutyCycle::espIOTLib_dutyCycle(uint32_t period, espIOTLib_sleepMode mode, uint32_t awakeTimeout){
+    this->_period = period;
+    this->_mode = mode;
+    this->_awakeTimeout = awakeTimeout;
+    this->_wakeReason = _readWakeReason();
+    this->_load();
+    memset(this->_phaseMillis, 0, sizeof(this->_phaseMillis));
+}
+
+void espIOTLib_dutyCycle::begin(uint32_t now){
+    memset(this->_phaseMillis, 0, sizeof(this->_phaseMillis));
+    this->_phase = ESP_IOTLIB_DUTY_SAMPLE;
+    // After deep sleep the cycle started with the reset, not with the first loop()
+    this->_cycleStart = this->_mode == ESP_IOTLIB_SLEEP_DEEP ? 0 : now;
+    this->_phaseStart = this->_cycleStart;
+}
+
+void espIOTLib_dutyCycle::enter(espIOTLib_dutyPhase phase, uint32_t now){
+    this->_phaseMillis[this->_phase] += now - this->_phaseStart;
+    this->_phase = phase;
+    this->_phaseStart = now;
+}
+
+bool espIOTLib_dutyCycle::timedOut(uint32_t now){
+    return now - this->_cycleStart >= this->_awakeTimeout;
+}
+
+void espIOTLib_dutyCycle::sleep(uint32_t now, bool timedOut, uint32_t lost){
+    this->_phaseMillis[this->_phase] += now - this->_phaseStart;
+    memcpy(this->_record.phaseMillis, this->_phaseMillis, sizeof(this->_phaseMillis));
+    this->_record.awakeMillis = now - this->_cycleStart;
+    this->_record.cycles++;
+    if(timedOut)
+        this->_record.timeouts++;
+    this->_record.lost += lost;
+    // Keep the period from wake to wake
+    this->_sleepMillis = this->_record.awakeMillis + ESP_IOTLIB_DUTY_MIN_SLEEP < this->_period
+        ? this->_period - this->_record.awakeMillis : ESP_IOTLIB_DUTY_MIN_SLEEP;
+    this->_sleepStart = now;
+    this->_sleeping = true;
+    if(this->_mode == ESP_IOTLIB_SLEEP_DEEP){
+        this->_save();
+#ifdef ESP8266
+        uint64_t sleepMicros = (uint64_t)this->_sleepMillis * 1000;
+        if(sleepMicros > ESP.deepSleepMax())
+            sleepMicros = ESP.deepSleepMax();
+        ESP.deepSleep(sleepMicros);
+#elif defined(ESP32)
+        esp_sleep_enable_timer_wakeup((uint64_t)this->_sleepMillis * 1000);
+        esp_deep_sleep_start();
+#endif
+        return;
+    }
+    WiFi.disconnect();
+#ifdef ESP8266
+    WiFi.forceSleepBegin();
+#elif defined(ESP32)
+    WiFi.mode(WIFI_OFF);
+#endif
+}
+
+bool espIOTLib_dutyCycle::wake(uint32_t now){
+    if(!this->_sleeping || now - this->_sleepStart < this->_sleepMillis)
+        return false;
+#ifdef ESP8266
+    WiFi.forceSleepWake();
+#elif defined(ESP32)
+    WiFi.mode(WIFI_STA);
+#endif
+    this->_sleeping = false;
+    this->_wakeReason = ESP_IOTLIB_WAKE_TIMER;
+    return true;
+}
+
+espIOTLib_dutyPhase espIOTLib_dutyCycle::phase(){
+    return this->_phase;
+}
+bool espIOTLib_dutyCycle::sleeping(){
+    return this->_sleeping;
+}
+espIOTLib_sleepMode espIOTLib_dutyCycle::mode(){
+    return this->_mode;
+}
+uint32_t espIOTLib_dutyCycle::period(){
+    return this->_period;
+}
+espIOTLib_wakeReason espIOTLib_dutyCycle::wakeReason(){
+    return this->_wakeReason;
+}
+uint32_t espIOTLib_dutyCycle::phaseMillis(espIOTLib_dutyPhase phase, uint32_t now){
+    if(phase >= ESP_IOTLIB_DUTY_PHASE_COUNT)
+        return 0;
+    if(phase == this->_phase && !this->_sleeping)
+        return this->_phaseMillis[phase] + now - this->_phaseStart;
+    return this->_phaseMillis[phase];
+}
+uint32_t espIOTLib_dutyCycle::awakeMillis(uint32_t now){
+    return this->_sleeping ? this->_record.awakeMillis : now - this->_cycleStart;
+}
+uint32_t espIOTLib_dutyCycle::lastPhaseMillis(espIOTLib_dutyPhase phase){
+    if(phase >= ESP_IOTLIB_DUTY_PHASE_COUNT)
+        return 0;
+    return this->_record.phaseMillis[phase];
+}
+uint32_t espIOTLib_dutyCycle::lastAwakeMillis(){
+    return this->_record.awakeMillis;
+}
+uint32_t espIOTLib_dutyCycle::cycleCount(){
+    return this->_record.cycles;
+}
+uint32_t espIOTLib_dutyCycle::timeoutCount(){
+    return this->_record.timeouts;
+}
+uint32_t espIOTLib_dutyCycle::lostCount(){
+    return this->_record.lost;
+}
+
+const char *espIOTLib_dutyCycle::phaseName(espIOTLib_dutyPhase phase){
+    switch(phase){
+    case ESP_IOTLIB_DUTY_SAMPLE:
+        return "sample";
+    case ESP_IOTLIB_DUTY_WIFI:
+        return "wifi";
+    case ESP_IOTLIB_DUTY_MQTT:
+        return "mqtt";
+    case ESP_IOTLIB_DUTY_PUBLISH:
+        return "publish";
+    case ESP_IOTLIB_DUTY_FLUSH:
+        return "flush";
+    default:
+        return "unknown";
+    }
+}
+
+const char *espIOTLib_dutyCycle::wakeReasonName(espIOTLib_wakeReason reason){
+    switch(reason){
+    case ESP_IOTLIB_WAKE_POWER_ON:
+        return "power_on";
+    case ESP_IOTLIB_WAKE_TIMER:
+        return "timer";
+    case ESP_IOTLIB_WAKE_EXTERNAL:
+        return "external";
+    case ESP_IOTLIB_WAKE_RESTART:
+        return "restart";
+    case ESP_IOTLIB_WAKE_WATCHDOG:
+        return "watchdog";
+    default:
+        return "other";
+    }
+}
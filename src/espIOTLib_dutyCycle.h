@@ -0,0 +1,149 @@
+/**
+ * @file espIOTLib_dutyCycle.h
+ * @author Paul Schlarmann (paul.schlarmann@makerspace-minden.de)
+ * @brief Wake, publish, sleep cycle for battery powered devices, with time per phase and wake reason
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) Paul Schlarmann 2023
+ *
+ */
+#ifndef ESPIOTLIB_DUTYCYCLE_H
+#define ESPIOTLIB_DUTYCYCLE_H
+
+// --- Includes ---
+#include <Arduino.h>
+
+#include "espIOTLib_wifiCache.h"
+
+// --- Defines ---
+// Max. awake time per cycle, the device goes to sleep afterwards even if not everything was sent
+#ifndef ESP_IOTLIB_DUTY_AWAKE_TIMEOUT
+    #define ESP_IOTLIB_DUTY_AWAKE_TIMEOUT 20000
+#endif
+// Sleep at least this long, even if a cycle took longer than its period
+#ifndef ESP_IOTLIB_DUTY_MIN_SLEEP
+    #define ESP_IOTLIB_DUTY_MIN_SLEEP 1000
+#endif
+// Start of the record in the RTC user memory of the ESP8266, in 4 byte blocks, after the WiFi cache
+#ifndef ESP_IOTLIB_DUTY_RTC_OFFSET
+    #define ESP_IOTLIB_DUTY_RTC_OFFSET (ESP_IOTLIB_WIFI_CACHE_RTC_OFFSET + sizeof(espIOTLib_wifiCacheRecord) / 4)
+#endif
+#define ESP_IOTLIB_DUTY_MAGIC 0x44435932UL
+
+// --- Typedefs ---
+typedef enum {
+    ESP_IOTLIB_DUTY_SAMPLE = 0,     // Sample callback, WiFi is not started yet
+    ESP_IOTLIB_DUTY_WIFI,           // Until WiFi is connected
+    ESP_IOTLIB_DUTY_MQTT,           // Until MQTT is connected and subscribed
+    ESP_IOTLIB_DUTY_PUBLISH,        // Publish callback and outbox drain
+    ESP_IOTLIB_DUTY_FLUSH,          // QoS 1 acknowledgements, send buffer and DISCONNECT
+    ESP_IOTLIB_DUTY_PHASE_COUNT
+} espIOTLib_dutyPhase;
+
+typedef enum {
+    ESP_IOTLIB_SLEEP_DEEP = 0,      // Everything off, the next cycle starts with a reset
+    ESP_IOTLIB_SLEEP_MODEM          // Only the radio off, loop() and the scheduled tasks keep running
+} espIOTLib_sleepMode;
+
+typedef enum {
+    ESP_IOTLIB_WAKE_POWER_ON = 0,
+    ESP_IOTLIB_WAKE_TIMER,          // End of a sleep period
+    ESP_IOTLIB_WAKE_EXTERNAL,       // Reset pin or wakeup pin
+    ESP_IOTLIB_WAKE_RESTART,        // Software restart, e.g. after an update
+    ESP_IOTLIB_WAKE_WATCHDOG,       // Watchdog or crash
+    ESP_IOTLIB_WAKE_OTHER
+} espIOTLib_wakeReason;
+
+typedef void (*espIOTLibWakeCB)(espIOTLib_wakeReason reason);
+
+// Survives deep sleep in RTC memory, multiple of 4 bytes
+struct espIOTLib_dutyCycleRecord{
+    uint32_t magic;
+    uint32_t crc;
+    uint32_t cycles;
+    uint32_t timeouts;
+    uint32_t lost;                                      // Publishes that did not survive a deep sleep
+    uint32_t phaseMillis[ESP_IOTLIB_DUTY_PHASE_COUNT];  // Of the last complete cycle
+    uint32_t awakeMillis;
+};
+
+// --- Public Classes ---
+
+/**
+ * @brief Phase bookkeeping and sleep of the duty cycle, the phases are advanced by espIOTLib.
+ * Counters and the times of the last cycle are kept in RTC memory over deep sleep,
+ * so a cycle can report the one before it, including its flush phase.
+ */
+class espIOTLib_dutyCycle
+{
+protected:
+    espIOTLib_dutyCycleRecord _record;
+    espIOTLib_wakeReason _wakeReason;
+    espIOTLib_sleepMode _mode;
+    uint32_t _period;
+    uint32_t _awakeTimeout;
+    espIOTLib_dutyPhase _phase = ESP_IOTLIB_DUTY_SAMPLE;
+    bool _sleeping = false;
+    uint32_t _cycleStart = 0;
+    uint32_t _phaseStart = 0;
+    uint32_t _sleepStart = 0;
+    uint32_t _sleepMillis = 0;
+    uint32_t _phaseMillis[ESP_IOTLIB_DUTY_PHASE_COUNT];
+
+    static uint32_t _crc(const espIOTLib_dutyCycleRecord *record);
+    static espIOTLib_wakeReason _readWakeReason();
+    void _load();
+    void _save();
+
+public:
+    /**
+     * @param period Cycle period in ms, from wake to wake
+     * @param awakeTimeout Max. awake time per cycle in ms
+     */
+    espIOTLib_dutyCycle(uint32_t period, espIOTLib_sleepMode mode, uint32_t awakeTimeout);
+
+    void begin(uint32_t now);
+    /**
+     * @brief End the current phase and start the next one
+     */
+    void enter(espIOTLib_dutyPhase phase, uint32_t now);
+    bool timedOut(uint32_t now);
+    /**
+     * @brief End the cycle and sleep for the rest of the period. Does not return in deep sleep mode
+     *
+     * @param timedOut The cycle was cut short by the awake timeout
+     * @param lost Publishes that are dropped by going to sleep, added to lostCount()
+     */
+    void sleep(uint32_t now, bool timedOut, uint32_t lost = 0);
+    /**
+     * @brief Modem sleep: switch the radio back on once the period is over
+     *
+     * @return true if a new cycle should begin
+     */
+    bool wake(uint32_t now);
+
+    espIOTLib_dutyPhase phase();
+    bool sleeping();
+    espIOTLib_sleepMode mode();
+    uint32_t period();
+    espIOTLib_wakeReason wakeReason();
+    /**
+     * @brief Time spent in phase during the current cycle, the running phase counts up to now
+     */
+    uint32_t phaseMillis(espIOTLib_dutyPhase phase, uint32_t now);
+    uint32_t awakeMillis(uint32_t now);
+    /**
+     * @brief Time spent in phase during the last complete cycle
+     */
+    uint32_t lastPhaseMillis(espIOTLib_dutyPhase phase);
+    uint32_t lastAwakeMillis();
+    uint32_t cycleCount();
+    uint32_t timeoutCount();
+    uint32_t lostCount();
+
+    static const char *phaseName(espIOTLib_dutyPhase phase);
+    static const char *wakeReasonName(espIOTLib_wakeReason reason);
+};
+
+#endif /* ESPIOTLIB_DUTYCYCLE_H */
@@ -0,0 +1,338 @@
+/**
+ * @file espIOTLib_encoder.cpp
+ * @author Paul Schlarmann (paul.schlarmann@makerspace-minden.de)
+ * @brief Payload encoder for text, CBOR and MessagePack into a caller owned buffer
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) Paul Schlarmann 2023
+ *
+ */
+
+// --- Includes ---
+#include "espIOTLib_encoder.h"
+#include "espIOTLib_format.h"
+
+// --- Defines ---
+#define CBOR_UINT 0
+#define CBOR_NEGINT 1
+#define CBOR_TEXT 3
+#define CBOR_MAP_INDEFINITE 0xbf
+#define CBOR_FLOAT32 0xfa
+#define CBOR_FLOAT64 0xfb
+#define CBOR_BREAK 0xff
+
+#define MSGPACK_UINT8 0xcc
+#define MSGPACK_INT8 0xd0
+#define MSGPACK_FLOAT32 0xca
+#define MSGPACK_FLOAT64 0xcb
+#define MSGPACK_FIXSTR 0xa0
+#define MSGPACK_STR8 0xd9
+#define MSGPACK_MAP16 0xde
+
+// --- Private Functions ---
+uint8_t *espIOTLib_encoder::_reserve(size_t length){
+    if(this->_overflow || this->_length + length > this->_capacity){
+        this->_overflow = true;
+        return NULL;
+    }
+    uint8_t *out = this->_buffer + this->_length;
+    this->_length += length;
+    return out;
+}
+
+void espIOTLib_encoder::_bigEndian(uint64_t value, uint8_t bytes){
+    uint8_t *out = this->_reserve(bytes);
+    if(!out)
+        return;
+    while(bytes-- > 0){
+        out[bytes] = value & 0xFF;
+        value >>= 8;
+    }
+}
+
+// Major type with the argument inline (< 24) or in 1, 2, 4 or 8 following bytes
+void espIOTLib_encoder::_cborHead(uint8_t major, uint64_t value){
+    uint8_t *out = this->_reserve(1);
+    if(!out)
+        return;
+    major <<= 5;
+    if(value < 24){
+        *out = major | value;
+    } else if(value <= 0xFF){
+        *out = major | 24;
+        this->_bigEndian(value, 1);
+    } else if(value <= 0xFFFF){
+        *out = major | 25;
+        this->_bigEndian(value, 2);
+    } else if(value <= 0xFFFFFFFFULL){
+        *out = major | 26;
+        this->_bigEndian(value, 4);
+    } else {
+        *out = major | 27;
+        this->_bigEndian(value, 8);
+    }
+}
+
+void espIOTLib_encoder::_msgpackUInt(uint64_t value){
+    if(value < 0x80){
+        this->_bigEndian(value, 1);
+    } else if(value <= 0xFF){
+        this->_bigEndian(MSGPACK_UINT8, 1);
+        this->_bigEndian(value, 1);
+    } else if(value <= 0xFFFF){
+        this->_bigEndian(MSGPACK_UINT8 + 1, 1);
+        this->_bigEndian(value, 2);
+    } else if(value <= 0xFFFFFFFFULL){
+        this->_bigEndian(MSGPACK_UINT8 + 2, 1);
+        this->_bigEndian(value, 4);
+    } else {
+        this->_bigEndian(MSGPACK_UINT8 + 3, 1);
+        this->_bigEndian(value, 8);
+    }
+}
+
+void espIOTLib_encoder::_raw(const char *value, size_t length){
+    uint8_t *out = this->_reserve(length);
+    if(out)
+        memcpy(out, value, length);
+}
+
+// Text inside a map is a quoted JSON string, a plain payload is sent as is
+void espIOTLib_encoder::_string(const char *value, size_t length){
+    switch(this->_format){
+        case ESP_IOTLIB_PAYLOAD_CBOR:
+            this->_cborHead(CBOR_TEXT, length);
+            break;
+        case ESP_IOTLIB_PAYLOAD_MSGPACK:
+            if(length < 32){
+                this->_bigEndian(MSGPACK_FIXSTR | length, 1);
+            } else if(length <= 0xFF){
+                this->_bigEndian(MSGPACK_STR8, 1);
+                this->_bigEndian(length, 1);
+            } else if(length <= 0xFFFF){
+                this->_bigEndian(MSGPACK_STR8 + 1, 1);
+                this->_bigEndian(length, 2);
+            } else {
+                this->_bigEndian(MSGPACK_STR8 + 2, 1);
+                this->_bigEndian(length, 4);
+            }
+            break;
+        default:
+            if(this->_inMap){
+                this->_raw("\"", 1);
+                for(size_t i = 0; i < length; i++){
+                    if(value[i] == '"' || value[i] == '\\')
+                        this->_raw("\\", 1);
+                    this->_raw(&value[i], 1);
+                }
+                this->_raw("\"", 1);
+                return;
+            }
+            break;
+    }
+    this->_raw(value, length);
+}
+
+// --- Public Functions ---
+espIOTLib_encoder::espIOTLib_encoder(uint8_t *buffer, size_t capacity, espIOTLib_payloadFormat format){
+    this->_buffer = buffer;
+    this->_capacity = capacity;
+    this->_format = format;
+}
+
+void espIOTLib_encoder::reset(espIOTLib_payloadFormat format){
+    this->_format = format;
+    this->_length = 0;
+    this->_overflow = false;
+    this->_inMap = false;
+    this->_mapCount = 0;
+}
+
+void espIOTLib_encoder::setFloatPrecision(uint8_t precision){
+    this->_precision = precision;
+}
+
+// Keys are counted as they come, so the map header is patched (MessagePack) or open ended (CBOR)
+bool espIOTLib_encoder::beginMap(){
+    if(this->_inMap)
+        return false;
+    this->_mapStart = this->_length;
+    this->_mapCount = 0;
+    switch(this->_format){
+        case ESP_IOTLIB_PAYLOAD_CBOR:
+            this->_bigEndian(CBOR_MAP_INDEFINITE, 1);
+            break;
+        case ESP_IOTLIB_PAYLOAD_MSGPACK:
+            this->_bigEndian(MSGPACK_MAP16, 1);
+            this->_bigEndian(0, 2);
+            break;
+        default:
+            this->_bigEndian('{', 1);
+            break;
+    }
+    this->_inMap = true;
+    return !this->_overflow;
+}
+
+bool espIOTLib_encoder::endMap(){
+    if(!this->_inMap)
+        return false;
+    switch(this->_format){
+        case ESP_IOTLIB_PAYLOAD_CBOR:
+            this->_bigEndian(CBOR_BREAK, 1);
+            break;
+        case ESP_IOTLIB_PAYLOAD_MSGPACK:
+            if(!this->_overflow){
+                this->_buffer[this->_mapStart + 1] = this->_mapCount >> 8;
+                this->_buffer[this->_mapStart + 2] = this->_mapCount & 0xFF;
+            }
+            break;
+        default:
+            this->_bigEndian('}', 1);
+            break;
+    }
+    this->_inMap = false;
+    return !this->_overflow;
+}
+
+void espIOTLib_encoder::key(const char *key){
+    if(this->_format == ESP_IOTLIB_PAYLOAD_TEXT && this->_mapCount > 0)
+        this->_bigEndian(',', 1);
+    this->_string(key, strlen(key));
+    if(this->_format == ESP_IOTLIB_PAYLOAD_TEXT)
+        this->_bigEndian(':', 1);
+    this->_mapCount++;
+}
+
+void espIOTLib_encoder::encodeInt(int64_t value){
+    switch(this->_format){
+        case ESP_IOTLIB_PAYLOAD_CBOR:
+            if(value >= 0)
+                this->_cborHead(CBOR_UINT, value);
+            else
+                this->_cborHead(CBOR_NEGINT, (uint64_t)(-(value + 1)));
+            break;
+        case ESP_IOTLIB_PAYLOAD_MSGPACK:
+            if(value >= 0){
+                this->_msgpackUInt(value);
+            } else if(value >= -32){
+                this->_bigEndian((uint8_t)value, 1);
+            } else if(value >= INT8_MIN){
+                this->_bigEndian(MSGPACK_INT8, 1);
+                this->_bigEndian((uint8_t)value, 1);
+            } else if(value >= INT16_MIN){
+                this->_bigEndian(MSGPACK_INT8 + 1, 1);
+                this->_bigEndian((uint16_t)value, 2);
+            } else if(value >= INT32_MIN){
+                this->_bigEndian(MSGPACK_INT8 + 2, 1);
+                this->_bigEndian((uint32_t)value, 4);
+            } else {
+                this->_bigEndian(MSGPACK_INT8 + 3, 1);
+                this->_bigEndian((uint64_t)value, 8);
+            }
+            break;
+        default: {
+            if(this->_overflow)
+                return;
+            size_t length = espIOTLib_formatInt64((char *)this->_buffer + this->_length, this->_capacity - this->_length, value);
+            if(length == 0)
+                this->_overflow = true;
+            this->_length += length;
+            break;
+        }
+    }
+}
+
+void espIOTLib_encoder::encodeUInt(uint64_t value){
+    switch(this->_format){
+        case ESP_IOTLIB_PAYLOAD_CBOR:
+            this->_cborHead(CBOR_UINT, value);
+            break;
+        case ESP_IOTLIB_PAYLOAD_MSGPACK:
+            this->_msgpackUInt(value);
+            break;
+        default: {
+            if(this->_overflow)
+                return;
+            size_t length = espIOTLib_formatUInt64((char *)this->_buffer + this->_length, this->_capacity - this->_length, value);
+            if(length == 0)
+                this->_overflow = true;
+            this->_length += length;
+            break;
+        }
+    }
+}
+
+void espIOTLib_encoder::encodeFloat(float value){
+    uint32_t bits;
+    switch(this->_format){
+        case ESP_IOTLIB_PAYLOAD_CBOR:
+        case ESP_IOTLIB_PAYLOAD_MSGPACK:
+            memcpy(&bits, &value, sizeof(bits));
+            this->_bigEndian(this->_format == ESP_IOTLIB_PAYLOAD_CBOR ? CBOR_FLOAT32 : MSGPACK_FLOAT32, 1);
+            this->_bigEndian(bits, 4);
+            break;
+        default: {
+            if(this->_overflow)
+                return;
+            if(isnan(value) || isinf(value)){
+                // No JSON representation
+                this->_raw("null", 4);
+                return;
+            }
+            size_t length = espIOTLib_formatFloat((char *)this->_buffer + this->_length, this->_capacity - this->_length, value, this->_precision);
+            if(length == 0)
+                this->_overflow = true;
+            this->_length += length;
+            break;
+        }
+    }
+}
+
+void espIOTLib_encoder::encodeDouble(double value){
+    uint64_t bits;
+    switch(this->_format){
+        case ESP_IOTLIB_PAYLOAD_CBOR:
+        case ESP_IOTLIB_PAYLOAD_MSGPACK:
+            // Most readings come from float sensors, half the bytes on the wire if nothing is lost
+            if(isnan(value) || (double)(float)value == value){
+                this->encodeFloat((float)value);
+                return;
+            }
+            memcpy(&bits, &value, sizeof(bits));
+            this->_bigEndian(this->_format == ESP_IOTLIB_PAYLOAD_CBOR ? CBOR_FLOAT64 : MSGPACK_FLOAT64, 1);
+            this->_bigEndian(bits, 8);
+            break;
+        default: {
+            if(this->_overflow)
+                return;
+            if(isnan(value) || isinf(value)){
+                this->_raw("null", 4);
+                return;
+            }
+            size_t length = espIOTLib_formatFloat((char *)this->_buffer + this->_length, this->_capacity - this->_length, value, this->_precision);
+            if(length == 0)
+                this->_overflow = true;
+            this->_length += length;
+            break;
+        }
+    }
+}
+
+void espIOTLib_encoder::encodeStr(const char *value){
+    this->_string(value, strlen(value));
+}
+
+const uint8_t *espIOTLib_encoder::data(){
+    return this->_buffer;
+}
+size_t espIOTLib_encoder::length(){
+    return this->_length;
+}
+bool espIOTLib_encoder::overflow(){
+    return this->_overflow;
+}
+espIOTLib_payloadFormat espIOTLib_encoder::format(){
+    return this->_format;
+}
@@ -0,0 +1,105 @@
+/**
+ * @file espIOTLib_encoder.h
+ * @author Paul Schlarmann (paul.schlarmann@makerspace-minden.de)
+ * @brief Payload encoder for text, CBOR and MessagePack into a caller owned buffer
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) Paul Schlarmann 2023
+ *
+ */
+#ifndef ESPIOTLIB_ENCODER_H
+#define ESPIOTLIB_ENCODER_H
+
+// --- Includes ---
+#if defined(ARDUINO)
+#include <Arduino.h>
+#else
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#endif
+
+// --- Defines ---
+#ifndef ESP_IOTLIB_PAYLOAD_FORMAT_TOPICS
+    #define ESP_IOTLIB_PAYLOAD_FORMAT_TOPICS 8
+#endif
+#ifndef ESP_IOTLIB_PAYLOAD_FORMAT_TOPIC_LEN
+    #define ESP_IOTLIB_PAYLOAD_FORMAT_TOPIC_LEN 48
+#endif
+// Largest encoded scalar: type byte + 8 byte value
+#define ESP_IOTLIB_ENCODED_SCALAR_LEN 9
+
+// --- Typedefs ---
+typedef enum {
+    ESP_IOTLIB_PAYLOAD_TEXT = 0,    // Numbers as text, records as JSON object
+    ESP_IOTLIB_PAYLOAD_CBOR,        // RFC 8949
+    ESP_IOTLIB_PAYLOAD_MSGPACK
+} espIOTLib_payloadFormat;
+
+struct espIOTLib_topicFormat{
+    uint32_t topicHash;
+    espIOTLib_payloadFormat format;
+    char topic[ESP_IOTLIB_PAYLOAD_FORMAT_TOPIC_LEN];
+};
+
+// --- Public Classes ---
+
+/**
+ * @brief Writes one payload straight into a fixed buffer, which is then published as is.
+ * Integers use the smallest encoding that holds them, doubles are sent as single precision if that is exact.
+ * A record is one flat map of key/value pairs between beginMap() and endMap().
+ * Once anything did not fit, overflow() is set and the content must not be sent.
+ *
+ *     uint8_t buffer[64];
+ *     espIOTLib_encoder encoder(buffer, sizeof(buffer), ESP_IOTLIB_PAYLOAD_CBOR);
+ *     encoder.beginMap();
+ *     encoder.key("temp");
+ *     encoder.encodeFloat(21.5f);
+ *     encoder.endMap();
+ */
+class espIOTLib_encoder
+{
+protected:
+    uint8_t *_buffer;
+    size_t _capacity;
+    size_t _length = 0;
+    espIOTLib_payloadFormat _format;
+    uint8_t _precision = 3;
+    bool _overflow = false;
+    bool _inMap = false;
+    size_t _mapStart = 0;
+    uint16_t _mapCount = 0;
+
+    uint8_t *_reserve(size_t length);
+    void _bigEndian(uint64_t value, uint8_t bytes);
+    void _cborHead(uint8_t major, uint64_t value);
+    void _msgpackUInt(uint64_t value);
+    void _raw(const char *value, size_t length);
+    void _string(const char *value, size_t length);
+
+public:
+    espIOTLib_encoder(uint8_t *buffer, size_t capacity, espIOTLib_payloadFormat format);
+
+    void reset(espIOTLib_payloadFormat format);
+    /**
+     * @brief Digits after the decimal point for floats in text format
+     */
+    void setFloatPrecision(uint8_t precision);
+
+    bool beginMap();
+    bool endMap();
+    void key(const char *key);
+    void encodeInt(int64_t value);
+    void encodeUInt(uint64_t value);
+    void encodeFloat(float value);
+    void encodeDouble(double value);
+    void encodeStr(const char *value);
+
+    const uint8_t *data();
+    size_t length();
+    bool overflow();
+    espIOTLib_payloadFormat format();
+};
+
+#endif /* ESPIOTLIB_ENCODER_H */
@@ -0,0 +1,183 @@
+/**
+ * @file espIOTLib_eventStream.cpp
+ * @author Paul Schlarmann (paul.schlarmann@makerspace-minden.de)
+ * @brief Server-Sent Events to a few browsers, with a send buffer per client
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) Paul Schlarmann 2023
+ *
+ */
+
+// --- Includes ---
+#include "espIOTLib_eventStream.h"
+
+#ifdef ESP32
+#include <lwip/sockets.h>
+#endif
+
+// --- Defines ---
+static const char SSE_HEADERS[] PROGMEM = "HTTP/1.1 200 OK\r\n"
+    "Content-Type: text/event-stream\r\n"
+    "Cache-Control: no-cache\r\n"
+    "Connection: keep-alive\r\n"
+    "Access-Control-Allow-Origin: *\r\n\r\n"
+    "retry: 5000\n\n";
+
+// --- Private Functions ---
+static uint16_t sseCopy(espIOTLib_sseClient *slot, uint16_t position, const char *data, size_t length){
+    while(length > 0){
+        size_t chunk = ESP_IOTLIB_SSE_BUFFER_LEN - position;
+        if(chunk > length)
+            chunk = length;
+        memcpy(slot->buffer + position, data, chunk);
+        position = (position + chunk) % ESP_IOTLIB_SSE_BUFFER_LEN;
+        data += chunk;
+        length -= chunk;
+    }
+    return position;
+}
+
+// Only what the socket takes right away. On ESP32 WiFiClient::write() waits for send space up to 10 times 1 s,
+// so the socket is written directly with MSG_DONTWAIT
+static size_t sseWrite(WiFiClient &client, const uint8_t *data, size_t length){
+#ifdef ESP32
+    int sent = send(client.fd(), data, length, MSG_DONTWAIT);
+    return sent > 0 ? sent : 0;
+#else
+    size_t room = client.availableForWrite();
+    if(length > room)
+        length = room;
+    return length > 0 ? client.write(data, length) : 0;
+#endif
+}
+
+// All or nothing, the reader only sees the event once head moves past it
+bool espIOTLib_eventStream::_put(espIOTLib_sseClient *slot, const char *event, const char *data, size_t length){
+    uint16_t head = slot->head.load(std::memory_order_relaxed);
+    uint16_t tail = slot->tail.load(std::memory_order_acquire);
+    size_t used = (head + ESP_IOTLIB_SSE_BUFFER_LEN - tail) % ESP_IOTLIB_SSE_BUFFER_LEN;
+    size_t eventLen = strlen(event);
+    if(used + 7 + eventLen + 7 + length + 2 >= ESP_IOTLIB_SSE_BUFFER_LEN)
+        return false;
+    head = sseCopy(slot, head, "event: ", 7);
+    head = sseCopy(slot, head, event, eventLen);
+    head = sseCopy(slot, head, "\ndata: ", 7);
+    head = sseCopy(slot, head, data, length);
+    head = sseCopy(slot, head, "\n\n", 2);
+    slot->head.store(head, std::memory_order_release);
+    return true;
+}
+
+void espIOTLib_eventStream::_close(espIOTLib_sseClient *slot){
+    slot->client.stop();
+    slot->active.store(false, std::memory_order_release);
+    this->_connected--;
+}
+
+// --- Public Functions ---
+espIOTLib_eventStream::espIOTLib_eventStream(){
+    this->_clients = new espIOTLib_sseClient[ESP_IOTLIB_SSE_CLIENTS];
+    for(uint8_t i = 0; i < ESP_IOTLIB_SSE_CLIENTS; i++){
+        this->_clients[i].active.store(false);
+        this->_clients[i].head.store(0);
+        this->_clients[i].tail.store(0);
+    }
+    this->_connected.store(0);
+}
+
+espIOTLib_eventStream::~espIOTLib_eventStream(){
+    delete[] this->_clients;
+}
+
+bool espIOTLib_eventStream::accept(WiFiClient &client, uint32_t now){
+    for(uint8_t i = 0; i < ESP_IOTLIB_SSE_CLIENTS; i++){
+        espIOTLib_sseClient *slot = &this->_clients[i];
+        if(slot->active.load(std::memory_order_acquire))
+            continue;
+        // The copy keeps the connection open after the web server is done with the request
+        slot->client = client;
+        slot->client.setNoDelay(true);
+#ifdef ESP8266
+        // Only availableForWrite() bytes are written, never wait for the peer's ack
+        slot->client.setSync(false);
+#endif
+        slot->client.print(FPSTR(SSE_HEADERS));
+        // Anything a sender put in while the slot was closing is discarded
+        slot->tail.store(slot->head.load(std::memory_order_acquire), std::memory_order_release);
+        slot->lastProgress = now;
+        slot->dropped = 0;
+        slot->active.store(true, std::memory_order_release);
+        this->_connected++;
+        this->_accepted++;
+        return true;
+    }
+    this->_rejected++;
+    return false;
+}
+
+bool espIOTLib_eventStream::send(const char *event, const char *data, size_t length){
+    this->_events++;
+    if(this->_connected.load(std::memory_order_relaxed) == 0)
+        return true;
+    bool sent = true;
+    for(uint8_t i = 0; i < ESP_IOTLIB_SSE_CLIENTS; i++){
+        espIOTLib_sseClient *slot = &this->_clients[i];
+        if(!slot->active.load(std::memory_order_acquire))
+            continue;
+        if(!this->_put(slot, event, data, length)){
+            slot->dropped++;
+            this->_dropped++;
+            sent = false;
+        }
+    }
+    return sent;
+}
+
+void espIOTLib_eventStream::service(uint32_t now){
+    for(uint8_t i = 0; i < ESP_IOTLIB_SSE_CLIENTS; i++){
+        espIOTLib_sseClient *slot = &this->_clients[i];
+        if(!slot->active.load(std::memory_order_acquire))
+            continue;
+        if(!slot->client.connected()){
+            this->_close(slot);
+            continue;
+        }
+        uint16_t tail = slot->tail.load(std::memory_order_relaxed);
+        uint16_t head = slot->head.load(std::memory_order_acquire);
+        if(head == tail){
+            // Comment line, keeps proxies and the browser from timing out an idle stream
+            if(now - slot->lastProgress > ESP_IOTLIB_SSE_KEEPALIVE && sseWrite(slot->client, (const uint8_t *)":\n\n", 3) > 0)
+                slot->lastProgress = now;
+            continue;
+        }
+        size_t chunk = head > tail ? head - tail : ESP_IOTLIB_SSE_BUFFER_LEN - tail;
+        size_t written = sseWrite(slot->client, slot->buffer + tail, chunk);
+        if(written > 0){
+            slot->tail.store((tail + written) % ESP_IOTLIB_SSE_BUFFER_LEN, std::memory_order_release);
+            slot->lastProgress = now;
+        } else if(now - slot->lastProgress > ESP_IOTLIB_SSE_STALL_TIMEOUT){
+            this->_stalled++;
+            this->_close(slot);
+        }
+    }
+}
+
+uint8_t espIOTLib_eventStream::connected(){
+    return this->_connected.load(std::memory_order_relaxed);
+}
+uint32_t espIOTLib_eventStream::acceptedCount(){
+    return this->_accepted;
+}
+uint32_t espIOTLib_eventStream::rejectedCount(){
+    return this->_rejected;
+}
+uint32_t espIOTLib_eventStream::eventCount(){
+    return this->_events;
+}
+uint32_t espIOTLib_eventStream::droppedCount(){
+    return this->_dropped;
+}
+uint32_t espIOTLib_eventStream::stalledCount(){
+    return this->_stalled;
+}
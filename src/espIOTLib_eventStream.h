@@ -0,0 +1,106 @@
+/**
+ * @file espIOTLib_eventStream.h
+ * @author Paul Schlarmann (paul.schlarmann@makerspace-minden.de)
+ * @brief Server-Sent Events to a few browsers, with a send buffer per client
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) Paul Schlarmann 2023
+ *
+ */
+#ifndef ESPIOTLIB_EVENTSTREAM_H
+#define ESPIOTLIB_EVENTSTREAM_H
+
+// --- Includes ---
+#include <Arduino.h>
+#include <atomic>
+
+#ifdef ESP8266
+#include <ESP8266WiFi.h>
+#elif defined(ESP32)
+#include <WiFi.h>
+#endif
+
+// --- Defines ---
+#ifndef ESP_IOTLIB_SSE_CLIENTS
+    #define ESP_IOTLIB_SSE_CLIENTS 2
+#endif
+#ifndef ESP_IOTLIB_SSE_BUFFER_LEN
+    #define ESP_IOTLIB_SSE_BUFFER_LEN 1024
+#endif
+// Max. length of one event including "event:"/"data:" framing
+#ifndef ESP_IOTLIB_SSE_EVENT_LEN
+    #define ESP_IOTLIB_SSE_EVENT_LEN 192
+#endif
+#ifndef ESP_IOTLIB_SSE_KEEPALIVE
+    #define ESP_IOTLIB_SSE_KEEPALIVE 15000
+#endif
+// A client that could not take a single byte for this long is dropped
+#ifndef ESP_IOTLIB_SSE_STALL_TIMEOUT
+    #define ESP_IOTLIB_SSE_STALL_TIMEOUT 30000
+#endif
+
+// --- Typedefs ---
+// Byte ring written by send() and drained by service(), each side owns one index
+struct espIOTLib_sseClient{
+    WiFiClient client;
+    std::atomic<bool> active;
+    std::atomic<uint16_t> head;
+    std::atomic<uint16_t> tail;
+    uint32_t lastProgress;
+    uint32_t dropped;
+    uint8_t buffer[ESP_IOTLIB_SSE_BUFFER_LEN];
+};
+
+// --- Public Classes ---
+
+/**
+ * @brief Keeps up to ESP_IOTLIB_SSE_CLIENTS event-stream connections open.
+ * send() only copies a complete event into the buffer of each client and never touches a socket;
+ * if a buffer has no room the event is dropped for that client, so a slow browser costs events, not loop time.
+ * service() writes as much as each socket takes without blocking.
+ * send() and accept()/service() may run in different tasks (application and network task on an ESP32).
+ */
+class espIOTLib_eventStream
+{
+protected:
+    espIOTLib_sseClient *_clients;
+    std::atomic<uint8_t> _connected;
+
+    uint32_t _accepted = 0;
+    uint32_t _rejected = 0;
+    uint32_t _events = 0;
+    uint32_t _dropped = 0;
+    uint32_t _stalled = 0;
+
+    bool _put(espIOTLib_sseClient *slot, const char *event, const char *data, size_t length);
+    void _close(espIOTLib_sseClient *slot);
+
+public:
+    espIOTLib_eventStream();
+    ~espIOTLib_eventStream();
+
+    /**
+     * @brief Take over the connection of the current request and send the event-stream headers
+     *
+     * @return false if all slots are in use, the caller should answer the request then
+     */
+    bool accept(WiFiClient &client, uint32_t now);
+    /**
+     * @brief Queue one event for every connected client
+     *
+     * @param data Single line, e.g. JSON
+     * @return false if it was dropped for at least one client
+     */
+    bool send(const char *event, const char *data, size_t length);
+    void service(uint32_t now);
+
+    uint8_t connected();
+    uint32_t acceptedCount();
+    uint32_t rejectedCount();
+    uint32_t eventCount();
+    uint32_t droppedCount();
+    uint32_t stalledCount();
+};
+
+#endif /* ESPIOTLIB_EVENTSTREAM_H */
@@ -0,0 +1,152 @@
+/**
+ * @file espIOTLib_format.cpp
+ * @author Paul Schlarmann (paul.schlarmann@makerspace-minden.de)
+ * @brief printf-free number formatting for MQTT payloads
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) Paul Schlarmann 2023
+ *
+ */
+
+// --- Includes ---
+#include "espIOTLib_format.h"
+
+// --- Defines ---
+#define FORMAT_CHUNK 1000000000UL
+#define FORMAT_CHUNK_DIGITS 9
+
+static const uint32_t _pow10[ESP_IOTLIB_FORMAT_MAX_PRECISION + 1] = {
+    1UL, 10UL, 100UL, 1000UL, 10000UL, 100000UL, 1000000UL, 10000000UL, 100000000UL, 1000000000UL
+};
+
+// --- Private Functions ---
+// Write digits of value backwards ending at end, zero padded to minDigits. Returns the first written char
+static char *_writeDigits(char *end, uint32_t value, uint8_t minDigits){
+    uint8_t digits = 0;
+    do {
+        *--end = '0' + (value % 10);
+        value /= 10;
+        digits++;
+    } while(value > 0);
+    while(digits++ < minDigits)
+        *--end = '0';
+    return end;
+}
+
+// Digits of a 64 bit value. Split into 9 digit chunks so only two 64 bit divisions are needed
+static char *_writeDigits64(char *end, uint64_t value){
+    while(value > 0xFFFFFFFFULL){
+        uint64_t upper = value / FORMAT_CHUNK;
+        end = _writeDigits(end, (uint32_t)(value - upper * FORMAT_CHUNK), FORMAT_CHUNK_DIGITS);
+        value = upper;
+    }
+    return _writeDigits(end, (uint32_t)value, 0);
+}
+
+static size_t _fail(char *buffer, size_t length){
+    if(buffer && length > 0)
+        buffer[0] = '\0';
+    return 0;
+}
+
+static size_t _copyOut(char *buffer, size_t length, const char *start, const char *end, bool negative){
+    size_t len = (end - start) + (negative ? 1 : 0);
+    if(!buffer || len + 1 > length)
+        return _fail(buffer, length);
+    char *out = buffer;
+    if(negative)
+        *out++ = '-';
+    memcpy(out, start, end - start);
+    buffer[len] = '\0';
+    return len;
+}
+
+// Round to an integer, ties to even like printf
+static bool _round(double magnitude, uint64_t *scaled){
+    if(magnitude >= 18446744073709551616.0)
+        return false;
+    *scaled = (uint64_t)magnitude;
+    double rest = magnitude - (double)*scaled;
+    if(rest > 0.5 || (rest == 0.5 && (*scaled & 1)))
+        (*scaled)++;
+    return true;
+}
+
+// integer part and fraction of an already scaled and rounded value
+static size_t _formatFixed(char *buffer, size_t length, uint64_t scaled, uint8_t precision, bool negative){
+    char tmp[24 + ESP_IOTLIB_FORMAT_MAX_PRECISION];
+    char *end = tmp + sizeof(tmp);
+    char *start = end;
+    uint64_t integer = scaled;
+    if(precision > 0){
+        uint32_t fraction;
+        if(scaled <= 0xFFFFFFFFULL){
+            // 32 bit division is a lot cheaper on these cores
+            integer = (uint32_t)scaled / _pow10[precision];
+            fraction = (uint32_t)scaled - (uint32_t)integer * _pow10[precision];
+        } else {
+            integer = scaled / _pow10[precision];
+            fraction = (uint32_t)(scaled - integer * _pow10[precision]);
+        }
+        start = _writeDigits(start, fraction, precision);
+        *--start = '.';
+    }
+    start = _writeDigits64(start, integer);
+    // No "-0.000"
+    return _copyOut(buffer, length, start, end, negative && scaled > 0);
+}
+
+// --- Public Functions ---
+size_t espIOTLib_formatUInt(char *buffer, size_t length, uint32_t value){
+    char tmp[10];
+    char *end = tmp + sizeof(tmp);
+    return _copyOut(buffer, length, _writeDigits(end, value, 0), end, false);
+}
+
+size_t espIOTLib_formatInt(char *buffer, size_t length, int32_t value){
+    char tmp[10];
+    char *end = tmp + sizeof(tmp);
+    // Negate in unsigned, -INT32_MIN does not fit into int32_t
+    uint32_t magnitude = value < 0 ? 0UL - (uint32_t)value : (uint32_t)value;
+    return _copyOut(buffer, length, _writeDigits(end, magnitude, 0), end, value < 0);
+}
+
+size_t espIOTLib_formatUInt64(char *buffer, size_t length, uint64_t value){
+    char tmp[20];
+    char *end = tmp + sizeof(tmp);
+    return _copyOut(buffer, length, _writeDigits64(end, value), end, false);
+}
+
+size_t espIOTLib_formatInt64(char *buffer, size_t length, int64_t value){
+    char tmp[20];
+    char *end = tmp + sizeof(tmp);
+    uint64_t magnitude = value < 0 ? 0ULL - (uint64_t)value : (uint64_t)value;
+    return _copyOut(buffer, length, _writeDigits64(end, magnitude), end, value < 0);
+}
+
+size_t espIOTLib_formatFloat(char *buffer, size_t length, double value, uint8_t precision){
+    if(precision > ESP_IOTLIB_FORMAT_MAX_PRECISION)
+        precision = ESP_IOTLIB_FORMAT_MAX_PRECISION;
+    if(isnan(value) || isinf(value))
+        return _fail(buffer, length);
+    bool negative = value < 0;
+    uint64_t scaled;
+    if(!_round((negative ? -value : value) * _pow10[precision], &scaled))
+        return _fail(buffer, length);
+    return _formatFixed(buffer, length, scaled, precision, negative);
+}
+
+size_t espIOTLib_formatFloat(char *buffer, size_t length, float value, uint8_t precision){
+    if(precision > ESP_IOTLIB_FORMAT_MAX_PRECISION)
+        precision = ESP_IOTLIB_FORMAT_MAX_PRECISION;
+    if(isnan(value) || isinf(value))
+        return _fail(buffer, length);
+    bool negative = value < 0;
+    // Scaling in float loses digits once value * 10^precision passes 2^24. In double it is exact,
+    // a 24 bit mantissa times 5^precision fits into 53 bits
+    uint64_t scaled;
+    if(!_round((double)(negative ? -value : value) * _pow10[precision], &scaled))
+        return _fail(buffer, length);
+    return _formatFixed(buffer, length, scaled, precision, negative);
+}
@@ -0,0 +1,47 @@
+/**
+ * @file espIOTLib_format.h
+ * @author Paul Schlarmann (paul.schlarmann@makerspace-minden.de)
+ * @brief printf-free number formatting for MQTT payloads
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) Paul Schlarmann 2023
+ *
+ */
+#ifndef ESPIOTLIB_FORMAT_H
+#define ESPIOTLIB_FORMAT_H
+
+// --- Includes ---
+#if defined(ARDUINO)
+#include <Arduino.h>
+#else
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <math.h>
+#endif
+
+// --- Defines ---
+// Max. digits after the decimal point, the fraction is kept in an uint32_t
+#define ESP_IOTLIB_FORMAT_MAX_PRECISION 9
+
+// --- Public Functions ---
+/*
+ * All formatters write a null terminated string without padding into buffer and return its length.
+ * If the number does not fit into length bytes (including the terminator) nothing usable is written and 0 is returned.
+ * A buffer of 21 bytes fits every 64 bit integer.
+ */
+size_t espIOTLib_formatUInt(char *buffer, size_t length, uint32_t value);
+size_t espIOTLib_formatInt(char *buffer, size_t length, int32_t value);
+size_t espIOTLib_formatUInt64(char *buffer, size_t length, uint64_t value);
+size_t espIOTLib_formatInt64(char *buffer, size_t length, int64_t value);
+/**
+ * @brief Fixed point formatting with precision digits after the decimal point, exact ties are rounded to even like printf.
+ * The float version scales in double, so it prints the same digits as printf("%.*f") for every float.
+ * 
+ * @return 0 for nan, inf and values whose scaled magnitude exceeds 64 bit
+ */
+size_t espIOTLib_formatFloat(char *buffer, size_t length, double value, uint8_t precision);
+size_t espIOTLib_formatFloat(char *buffer, size_t length, float value, uint8_t precision);
+
+#endif /* ESPIOTLIB_FORMAT_H */
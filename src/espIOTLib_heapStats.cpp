@@ -0,0 +1,121 @@
+/**
+ * @file espIOTLib_heapStats.cpp
+ * @author Paul Schlarmann (paul.schlarmann@makerspace-minden.de)
+ * @brief Heap fragmentation, low watermarks and per code path heap accounting
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) Paul Schlarmann 2023
+ *
+ */
+
+// --- Includes ---
+#include "espIOTLib_heapStats.h"
+
+// --- Private Functions ---
+void espIOTLib_heapStats::_walk(){
+#ifdef ESP8266
+    uint32_t freeHeap;
+    uint32_t largestBlock;
+    uint8_t fragmentation;
+    // One pass over the heap for all three values
+    ESP.getHeapStats(&freeHeap, &largestBlock, &fragmentation);
+    this->_freeHeap = freeHeap;
+    this->_largestBlock = largestBlock;
+    this->_fragmentation = fragmentation;
+#elif defined(ESP32)
+    this->_freeHeap = ESP.getFreeHeap();
+    this->_largestBlock = ESP.getMaxAllocHeap();
+    this->_fragmentation = this->_freeHeap > 0 ? 100 - (uint64_t)this->_largestBlock * 100 / this->_freeHeap : 0;
+#endif
+    if(this->_largestBlock < this->_minLargestBlock)
+        this->_minLargestBlock = this->_largestBlock;
+    if(this->_fragmentation > this->_maxFragmentation)
+        this->_maxFragmentation = this->_fragmentation;
+}
+
+// --- Public Functions ---
+void espIOTLib_heapStats::sample(uint32_t now){
+    if(!this->_walked || now - this->_lastWalk >= ESP_IOTLIB_HEAP_SAMPLE_INTERVAL){
+        this->_walk();
+        this->_lastWalk = now;
+        this->_walked = true;
+    } else {
+        this->_freeHeap = ESP.getFreeHeap();
+    }
+#ifdef ESP32
+    this->_minFreeHeap = ESP.getMinFreeHeap();
+#else
+    if(this->_freeHeap < this->_minFreeHeap)
+        this->_minFreeHeap = this->_freeHeap;
+#endif
+}
+
+uint32_t espIOTLib_heapStats::freeHeap(){
+    return this->_freeHeap;
+}
+uint32_t espIOTLib_heapStats::largestBlock(){
+    return this->_largestBlock;
+}
+uint8_t espIOTLib_heapStats::fragmentation(){
+    return this->_fragmentation;
+}
+uint32_t espIOTLib_heapStats::minFreeHeap(){
+    return this->_minFreeHeap;
+}
+uint32_t espIOTLib_heapStats::minLargestBlock(){
+    return this->_minLargestBlock;
+}
+uint8_t espIOTLib_heapStats::maxFragmentation(){
+    return this->_maxFragmentation;
+}
+
+#ifdef ESP_IOTLIB_HEAP_ACCOUNTING
+void espIOTLib_heapStats::account(espIOTLib_heapScopeId scope, uint32_t freeBefore, uint32_t freeAfter){
+    espIOTLib_heapScopeStats *stats = &this->_scopes[scope];
+    stats->calls++;
+    if(freeAfter < freeBefore){
+        uint32_t retained = freeBefore - freeAfter;
+        stats->growths++;
+        stats->retainedBytes += retained;
+        if(retained > stats->maxRetained)
+            stats->maxRetained = retained;
+    } else {
+        stats->releasedBytes += freeAfter - freeBefore;
+    }
+    if(freeAfter < this->_minFreeHeap)
+        this->_minFreeHeap = freeAfter;
+}
+
+const espIOTLib_heapScopeStats *espIOTLib_heapStats::scope(espIOTLib_heapScopeId scope){
+    if(scope >= ESP_IOTLIB_HEAP_SCOPE_COUNT)
+        return NULL;
+    return &this->_scopes[scope];
+}
+
+espIOTLib_heapScope::espIOTLib_heapScope(espIOTLib_heapStats &stats, espIOTLib_heapScopeId scope) : _stats(stats){
+    this->_scope = scope;
+    this->_freeBefore = ESP.getFreeHeap();
+}
+
+espIOTLib_heapScope::~espIOTLib_heapScope(){
+    this->_stats.account(this->_scope, this->_freeBefore, ESP.getFreeHeap());
+}
+#endif
+
+const char *espIOTLib_heapStats::scopeName(espIOTLib_heapScopeId scope){
+    switch(scope){
+    case ESP_IOTLIB_HEAP_PAGES:
+        return "pages";
+    case ESP_IOTLIB_HEAP_WEB_PAGES:
+        return "web_pages";
+    case ESP_IOTLIB_HEAP_MQTT_TOPICS:
+        return "mqtt_topics";
+    case ESP_IOTLIB_HEAP_MQTT_CONNECT:
+        return "mqtt_connect";
+    case ESP_IOTLIB_HEAP_PUBLISH:
+        return "publish";
+    default:
+        return "unknown";
+    }
+}
@@ -0,0 +1,106 @@
+/**
+ * @file espIOTLib_heapStats.h
+ * @author Paul Schlarmann (paul.schlarmann@makerspace-minden.de)
+ * @brief Heap fragmentation, low watermarks and per code path heap accounting
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) Paul Schlarmann 2023
+ *
+ */
+#ifndef ESPIOTLIB_HEAPSTATS_H
+#define ESPIOTLIB_HEAPSTATS_H
+
+// --- Includes ---
+#include <Arduino.h>
+
+// --- Defines ---
+// Largest block and fragmentation need a walk over the heap, they are sampled at this interval
+#ifndef ESP_IOTLIB_HEAP_SAMPLE_INTERVAL
+    #define ESP_IOTLIB_HEAP_SAMPLE_INTERVAL 100
+#endif
+
+//Define this to account heap use per espIOTLib code path (debug builds)
+//#define ESP_IOTLIB_HEAP_ACCOUNTING
+
+// --- Typedefs ---
+typedef enum {
+    ESP_IOTLIB_HEAP_PAGES = 0,      // Rendering built-in pages
+    ESP_IOTLIB_HEAP_WEB_PAGES,      // addWebPage()
+    ESP_IOTLIB_HEAP_MQTT_TOPICS,    // subscribeMQTT()
+    ESP_IOTLIB_HEAP_MQTT_CONNECT,   // Connection state machine
+    ESP_IOTLIB_HEAP_PUBLISH,        // publish*() up to the socket or outbox
+    ESP_IOTLIB_HEAP_SCOPE_COUNT
+} espIOTLib_heapScopeId;
+
+struct espIOTLib_heapScopeStats{
+    uint32_t calls = 0;
+    uint32_t growths = 0;       // Calls that left the heap smaller than they found it
+    uint32_t retainedBytes = 0; // Sum of what those calls kept
+    uint32_t releasedBytes = 0; // Sum of what calls returned
+    uint32_t maxRetained = 0;
+};
+
+// --- Public Classes ---
+
+/**
+ * @brief Tracks what getFreeHeap() alone does not show: the largest allocatable block, fragmentation in percent
+ * and the lowest values since boot. The free heap watermark is taken from the allocator where it keeps one (ESP32),
+ * otherwise from sample(), which is cheap enough to run every loop.
+ */
+class espIOTLib_heapStats
+{
+protected:
+    uint32_t _freeHeap = 0;
+    uint32_t _largestBlock = 0;
+    uint8_t _fragmentation = 0;
+    uint32_t _minFreeHeap = UINT32_MAX;
+    uint32_t _minLargestBlock = UINT32_MAX;
+    uint8_t _maxFragmentation = 0;
+    uint32_t _lastWalk = 0;
+    bool _walked = false;
+#ifdef ESP_IOTLIB_HEAP_ACCOUNTING
+    espIOTLib_heapScopeStats _scopes[ESP_IOTLIB_HEAP_SCOPE_COUNT];
+#endif
+
+    void _walk();
+
+public:
+    void sample(uint32_t now);
+
+    uint32_t freeHeap();
+    uint32_t largestBlock();
+    /**
+     * @brief 0 = all free memory in one block, 100 = no usable block left
+     */
+    uint8_t fragmentation();
+    uint32_t minFreeHeap();
+    uint32_t minLargestBlock();
+    uint8_t maxFragmentation();
+
+#ifdef ESP_IOTLIB_HEAP_ACCOUNTING
+    void account(espIOTLib_heapScopeId scope, uint32_t freeBefore, uint32_t freeAfter);
+    const espIOTLib_heapScopeStats *scope(espIOTLib_heapScopeId scope);
+#endif
+    static const char *scopeName(espIOTLib_heapScopeId scope);
+};
+
+#ifdef ESP_IOTLIB_HEAP_ACCOUNTING
+/**
+ * @brief Attributes the change of free heap between construction and destruction to a code path.
+ * Other tasks allocating at the same time (e.g. WiFi on ESP32) show up as noise.
+ */
+class espIOTLib_heapScope
+{
+protected:
+    espIOTLib_heapStats &_stats;
+    espIOTLib_heapScopeId _scope;
+    uint32_t _freeBefore;
+
+public:
+    espIOTLib_heapScope(espIOTLib_heapStats &stats, espIOTLib_heapScopeId scope);
+    ~espIOTLib_heapScope();
+};
+#endif
+
+#endif /* ESPIOTLIB_HEAPSTATS_H */
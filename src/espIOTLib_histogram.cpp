@@ -0,0 +1,75 @@
+/**
+ * @file espIOTLib_histogram.cpp
+ * @author Paul Schlarmann (paul.schlarmann@makerspace-minden.de)
+ * @brief Fixed bucket log2 histogram for micros() durations
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) Paul Schlarmann 2023
+ *
+ */
+
+// --- Includes ---
+#include "espIOTLib_histogram.h"
+
+// --- Public Functions ---
+espIOTLib_histogram::espIOTLib_histogram(){
+    this->reset();
+}
+
+void espIOTLib_histogram::record(uint32_t value){
+    uint8_t index = 0;
+    while(value >> index && index < ESP_IOTLIB_HISTOGRAM_BUCKETS - 1)
+        index++;
+    this->_buckets[index]++;
+    this->_count++;
+    this->_sum += value;
+    this->_last = value;
+    if(value > this->_max)
+        this->_max = value;
+}
+
+void espIOTLib_histogram::reset(){
+    memset(this->_buckets, 0, sizeof(this->_buckets));
+    this->_count = 0;
+    this->_max = 0;
+    this->_last = 0;
+    this->_sum = 0;
+}
+
+uint32_t espIOTLib_histogram::count() const {
+    return this->_count;
+}
+uint32_t espIOTLib_histogram::max() const {
+    return this->_max;
+}
+uint32_t espIOTLib_histogram::last() const {
+    return this->_last;
+}
+uint32_t espIOTLib_histogram::mean() const {
+    if(this->_count == 0)
+        return 0;
+    return this->_sum / this->_count;
+}
+
+uint32_t espIOTLib_histogram::percentile(uint8_t percentile) const {
+    if(this->_count == 0)
+        return 0;
+    // Rank of the sample we are looking for, rounded up
+    uint64_t rank = ((uint64_t)this->_count * percentile + 99) / 100;
+    uint64_t seen = 0;
+    for(uint8_t i = 0; i < ESP_IOTLIB_HISTOGRAM_BUCKETS; i++){
+        seen += this->_buckets[i];
+        if(seen >= rank && seen > 0){
+            uint32_t upper = (i == 0) ? 0 : ((1UL << i) - 1);
+            return upper < this->_max ? upper : this->_max;
+        }
+    }
+    return this->_max;
+}
+
+uint32_t espIOTLib_histogram::bucket(uint8_t index) const {
+    if(index >= ESP_IOTLIB_HISTOGRAM_BUCKETS)
+        return 0;
+    return this->_buckets[index];
+}
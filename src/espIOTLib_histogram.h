@@ -0,0 +1,50 @@
+/**
+ * @file espIOTLib_histogram.h
+ * @author Paul Schlarmann (paul.schlarmann@makerspace-minden.de)
+ * @brief Fixed bucket log2 histogram for micros() durations
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) Paul Schlarmann 2023
+ *
+ */
+#ifndef ESPIOTLIB_HISTOGRAM_H
+#define ESPIOTLIB_HISTOGRAM_H
+
+// --- Includes ---
+#include <Arduino.h>
+
+// --- Defines ---
+// Bucket 0 holds 0us, bucket i holds [2^(i-1), 2^i) us, the last one everything from ~4s up
+#define ESP_IOTLIB_HISTOGRAM_BUCKETS 24
+
+// --- Public Classes ---
+class espIOTLib_histogram
+{
+protected:
+    uint32_t _buckets[ESP_IOTLIB_HISTOGRAM_BUCKETS];
+    uint32_t _count = 0;
+    uint32_t _max = 0;
+    uint32_t _last = 0;
+    uint64_t _sum = 0;
+
+public:
+    espIOTLib_histogram();
+
+    void record(uint32_t value);
+    void reset();
+
+    uint32_t count() const;
+    uint32_t max() const;
+    uint32_t last() const;
+    uint32_t mean() const;
+    /**
+     * @brief Upper bound of the bucket holding the given percentile, capped at max()
+     * 
+     * @param percentile 0 - 100, e.g. 99 for p99
+     */
+    uint32_t percentile(uint8_t percentile) const;
+    uint32_t bucket(uint8_t index) const;
+};
+
+#endif /* ESPIOTLIB_HISTOGRAM_H */
@@ -0,0 +1,151 @@
+/**
+ * @file espIOTLib_inflight.cpp
+ * @author Paul Schlarmann (paul.schlarmann@makerspace-minden.de)
+ * @brief In-flight table for QoS 1 publishes with PUBACK matching and retransmission
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) Paul Schlarmann 2023
+ *
+ */
+
+// --- Includes ---
+#include "espIOTLib_inflight.h"
+
+// --- Defines ---
+#define MQTT_PUBLISH_QOS1 0x32
+#define MQTT_PUBLISH_DUP 0x08
+#define INFLIGHT_FIRST_ID 0x8000
+
+// --- Private Functions ---
+uint16_t espIOTLib_inflight::_newId(){
+    uint16_t id = this->_nextId;
+    this->_nextId = this->_nextId == 0xFFFF ? INFLIGHT_FIRST_ID : this->_nextId + 1;
+    return id;
+}
+
+// Fixed header, topic and packet id in one write, payload in a second one. The buffered client keeps them together
+bool espIOTLib_inflight::_send(Client &client, espIOTLib_inflightEntry *entry, bool dup, uint32_t now){
+    uint8_t header[5 + 2 + ESP_IOTLIB_QOS1_TOPIC_LEN + 2];
+    size_t topicLen = strlen(entry->topic);
+    uint32_t remaining = 2 + topicLen + 2 + entry->payloadLen;
+    size_t pos = 0;
+    header[pos++] = MQTT_PUBLISH_QOS1 | (dup ? MQTT_PUBLISH_DUP : 0);
+    do {
+        uint8_t b = remaining & 0x7F;
+        remaining >>= 7;
+        header[pos++] = b | (remaining > 0 ? 0x80 : 0);
+    } while(remaining > 0);
+    header[pos++] = topicLen >> 8;
+    header[pos++] = topicLen & 0xFF;
+    memcpy(header + pos, entry->topic, topicLen);
+    pos += topicLen;
+    header[pos++] = entry->packetId >> 8;
+    header[pos++] = entry->packetId & 0xFF;
+
+    entry->sent = true;
+    entry->sentAt = now;
+    if(client.write(header, pos) != pos)
+        return false;
+    return entry->payloadLen == 0 || client.write((const uint8_t *)entry->payload, entry->payloadLen) == entry->payloadLen;
+}
+
+// --- Public Functions ---
+espIOTLib_inflight::espIOTLib_inflight(uint8_t window, uint32_t retransmitTimeout){
+    this->_window = window > 0 ? window : 1;
+    this->_timeout = retransmitTimeout;
+    this->_entries = new espIOTLib_inflightEntry[this->_window];
+    for(uint8_t i = 0; i < this->_window; i++)
+        this->_entries[i].packetId = 0;
+}
+
+espIOTLib_inflight::~espIOTLib_inflight(){
+    delete[] this->_entries;
+}
+
+bool espIOTLib_inflight::add(const char *topic, const char *payload, size_t length){
+    if(!topic || !payload || strlen(topic) >= ESP_IOTLIB_QOS1_TOPIC_LEN || length > ESP_IOTLIB_QOS1_PAYLOAD_LEN)
+        return false;
+    for(uint8_t i = 0; i < this->_window; i++){
+        espIOTLib_inflightEntry *entry = &this->_entries[i];
+        if(entry->packetId != 0)
+            continue;
+        entry->packetId = this->_newId();
+        entry->sent = false;
+        entry->retries = 0;
+        entry->payloadLen = length;
+        strcpy(entry->topic, topic);
+        memcpy(entry->payload, payload, length);
+        this->_published++;
+        return true;
+    }
+    this->_windowFull++;
+    return false;
+}
+
+void espIOTLib_inflight::acknowledge(uint16_t packetId){
+    for(uint8_t i = 0; i < this->_window; i++){
+        if(this->_entries[i].packetId == packetId && packetId != 0){
+            this->_entries[i].packetId = 0;
+            this->_acked++;
+            return;
+        }
+    }
+    // Duplicate ack of a retransmitted publish
+    this->_unknownAcks++;
+}
+
+void espIOTLib_inflight::service(Client &client, uint32_t now){
+    for(uint8_t i = 0; i < this->_window; i++){
+        espIOTLib_inflightEntry *entry = &this->_entries[i];
+        if(entry->packetId == 0)
+            continue;
+        if(!entry->sent){
+            if(!this->_send(client, entry, entry->retries > 0, now))
+                return;
+        } else if(now - entry->sentAt >= this->_timeout){
+            entry->retries++;
+            this->_retransmits++;
+            if(!this->_send(client, entry, true, now))
+                return;
+        }
+    }
+}
+
+void espIOTLib_inflight::reconnected(){
+    for(uint8_t i = 0; i < this->_window; i++){
+        espIOTLib_inflightEntry *entry = &this->_entries[i];
+        if(entry->packetId != 0 && entry->sent){
+            entry->sent = false;
+            entry->retries++;
+            this->_retransmits++;
+        }
+    }
+}
+
+uint8_t espIOTLib_inflight::depth(){
+    uint8_t depth = 0;
+    for(uint8_t i = 0; i < this->_window; i++){
+        if(this->_entries[i].packetId != 0)
+            depth++;
+    }
+    return depth;
+}
+uint8_t espIOTLib_inflight::window(){
+    return this->_window;
+}
+uint32_t espIOTLib_inflight::publishedCount(){
+    return this->_published;
+}
+uint32_t espIOTLib_inflight::ackedCount(){
+    return this->_acked;
+}
+uint32_t espIOTLib_inflight::retransmitCount(){
+    return this->_retransmits;
+}
+uint32_t espIOTLib_inflight::windowFullCount(){
+    return this->_windowFull;
+}
+uint32_t espIOTLib_inflight::unknownAckCount(){
+    return this->_unknownAcks;
+}
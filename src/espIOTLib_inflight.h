@@ -0,0 +1,98 @@
+/**
+ * @file espIOTLib_inflight.h
+ * @author Paul Schlarmann (paul.schlarmann@makerspace-minden.de)
+ * @brief In-flight table for QoS 1 publishes with PUBACK matching and retransmission
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) Paul Schlarmann 2023
+ *
+ */
+#ifndef ESPIOTLIB_INFLIGHT_H
+#define ESPIOTLIB_INFLIGHT_H
+
+// --- Includes ---
+#include <Arduino.h>
+#include <Client.h>
+
+// --- Defines ---
+#ifndef ESP_IOTLIB_QOS1_WINDOW
+    #define ESP_IOTLIB_QOS1_WINDOW 8
+#endif
+#ifndef ESP_IOTLIB_QOS1_RETRANSMIT_TIMEOUT
+    #define ESP_IOTLIB_QOS1_RETRANSMIT_TIMEOUT 5000 // ms
+#endif
+#ifndef ESP_IOTLIB_QOS1_TOPIC_LEN
+    #define ESP_IOTLIB_QOS1_TOPIC_LEN 64
+#endif
+#ifndef ESP_IOTLIB_QOS1_PAYLOAD_LEN
+    #define ESP_IOTLIB_QOS1_PAYLOAD_LEN 64
+#endif
+
+// --- Typedefs ---
+struct espIOTLib_inflightEntry{
+    uint16_t packetId;          // 0 = free slot
+    bool sent;
+    uint8_t retries;
+    uint32_t sentAt;
+    uint16_t payloadLen;
+    char topic[ESP_IOTLIB_QOS1_TOPIC_LEN];
+    char payload[ESP_IOTLIB_QOS1_PAYLOAD_LEN];
+};
+
+// --- Public Classes ---
+
+/**
+ * @brief Holds QoS 1 publishes until their PUBACK arrives. Up to window publishes are in flight at once,
+ * so throughput is not limited to one message per round trip.
+ * PUBLISH packets are serialized here and written to the Client directly, the packet ids (0x8000 and up)
+ * stay clear of the ones the MQTT library hands out for its own subscribes.
+ * Entries survive a reconnect and are sent again with the DUP flag, publishes added while offline go out once connected.
+ */
+class espIOTLib_inflight
+{
+protected:
+    espIOTLib_inflightEntry *_entries;
+    uint8_t _window;
+    uint32_t _timeout;
+    uint16_t _nextId = 0x8000;
+
+    uint32_t _published = 0;
+    uint32_t _acked = 0;
+    uint32_t _retransmits = 0;
+    uint32_t _windowFull = 0;
+    uint32_t _unknownAcks = 0;
+
+    uint16_t _newId();
+    bool _send(Client &client, espIOTLib_inflightEntry *entry, bool dup, uint32_t now);
+
+public:
+    espIOTLib_inflight(uint8_t window, uint32_t retransmitTimeout);
+    ~espIOTLib_inflight();
+
+    /**
+     * @brief Take a publish into the window
+     * 
+     * @return false if the window is full or topic/payload are too long
+     */
+    bool add(const char *topic, const char *payload, size_t length);
+    void acknowledge(uint16_t packetId);
+    /**
+     * @brief Send new entries and retransmit the ones whose PUBACK is overdue
+     */
+    void service(Client &client, uint32_t now);
+    /**
+     * @brief The connection was re-established, everything unacknowledged goes out again (with DUP)
+     */
+    void reconnected();
+
+    uint8_t depth();
+    uint8_t window();
+    uint32_t publishedCount();
+    uint32_t ackedCount();
+    uint32_t retransmitCount();
+    uint32_t windowFullCount();
+    uint32_t unknownAckCount();
+};
+
+#endif /* ESPIOTLIB_INFLIGHT_H */
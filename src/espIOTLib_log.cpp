@@ -0,0 +1,391 @@
+/**
+ * @file espIOTLib_log.cpp
+ * @author Paul Schlarmann (paul.schlarmann@makerspace-minden.de)
+ * @brief Non-blocking log: messages are queued unformatted and printed from loop() as the UART has room
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) Paul Schlarmann 2023
+ *
+ */
+
+// --- Includes ---
+#include "espIOTLib_log.h"
+#include "espIOTLib_thread.h"
+
+// --- Defines ---
+// "%", flags, width, precision, length and conversion
+#define LOG_SPEC_LEN 16
+// Max. time flush() waits for the output
+#define LOG_FLUSH_TIMEOUT 1000
+
+// --- Private Vars ---
+static const char *const LOG_IDENTS[ESP_IOTLIB_LOG_SUBSYSTEM_COUNT] = { "[i] ", "[m] ", "[a] " };
+
+// --- Private Functions ---
+// Copies the conversion spec starting after a '%' into spec, size is the byte size of an integer argument
+PGM_P espIOTLib_log::_parseSpec(PGM_P p, char *spec, char *conversion, uint8_t *size){
+    size_t length = 0;
+    spec[length++] = '%';
+    *conversion = '\0';
+    *size = sizeof(int);
+    char c = pgm_read_byte(p);
+    while(c != '\0' && strchr("-+ #0123456789.", c) && length < LOG_SPEC_LEN - 5){
+        spec[length++] = c;
+        c = pgm_read_byte(++p);
+    }
+    uint8_t longs = 0;
+    while(c == 'h' || c == 'l' || c == 'z'){
+        if(c == 'l')
+            longs++;
+        else if(c == 'z')
+            *size = sizeof(size_t);
+        if(length < LOG_SPEC_LEN - 2)
+            spec[length++] = c;
+        c = pgm_read_byte(++p);
+    }
+    if(longs == 1)
+        *size = sizeof(long);
+    else if(longs > 1)
+        *size = sizeof(long long);
+    if(c != '\0'){
+        *conversion = c;
+        spec[length++] = c;
+        p++;
+    }
+    spec[length] = '\0';
+    return p;
+}
+
+// Same walk over the format as _format(), only storing instead of printing
+void espIOTLib_log::_capture(espIOTLib_logEntry *entry, PGM_P format, va_list args){
+    entry->argWords = 0;
+    entry->textLength = 0;
+    char spec[LOG_SPEC_LEN];
+    char conversion;
+    uint8_t size;
+    PGM_P p = format;
+    char c;
+    while((c = pgm_read_byte(p)) != '\0'){
+        p++;
+        if(c != '%')
+            continue;
+        p = _parseSpec(p, spec, &conversion, &size);
+        uint8_t words = 0;
+        uint64_t value = 0;
+        switch(conversion){
+        case '%':
+            continue;
+        case 's': {
+            const char *text = va_arg(args, const char *);
+            if(!text)
+                text = "(null)";
+            size_t room = ESP_IOTLIB_LOG_TEXT_LEN - entry->textLength;
+            if(room == 0)
+                return;
+            size_t length = strnlen(text, room - 1);
+            memcpy(entry->text + entry->textLength, text, length);
+            entry->text[entry->textLength + length] = '\0';
+            entry->textLength += length + 1;
+            continue;
+        }
+        case 'f': case 'e': case 'g': case 'E': case 'G': {
+            double number = va_arg(args, double);
+            memcpy(&value, &number, sizeof(double));
+            words = 2;
+            break;
+        }
+        case 'p':
+            value = (uintptr_t)va_arg(args, void *);
+            words = sizeof(void *) / 4;
+            break;
+        case 'd': case 'i': case 'u': case 'x': case 'X': case 'o': case 'c':
+            if(size > 4){
+                value = va_arg(args, unsigned long long);
+                words = 2;
+            } else {
+                value = va_arg(args, unsigned int);
+                words = 1;
+            }
+            break;
+        default:
+            // Unknown conversion, the rest of the arguments can not be found
+            return;
+        }
+        if(entry->argWords + words > ESP_IOTLIB_LOG_ARGS)
+            return;
+        memcpy(&entry->args[entry->argWords], &value, words * 4);
+        entry->argWords += words;
+    }
+}
+
+void espIOTLib_log::_lineText(const char *text, size_t length){
+    size_t room = ESP_IOTLIB_LOG_LINE_LEN - 1 - this->_lineLength;
+    if(length > room)
+        length = room;
+    memcpy(this->_line + this->_lineLength, text, length);
+    this->_lineLength += length;
+}
+
+size_t espIOTLib_log::_format(const espIOTLib_logEntry *entry){
+    this->_lineLength = 0;
+    this->_lineText(LOG_IDENTS[entry->subsystem], strlen(LOG_IDENTS[entry->subsystem]));
+    char spec[LOG_SPEC_LEN];
+    char conversion;
+    uint8_t size;
+    uint8_t word = 0;
+    size_t textPos = 0;
+    PGM_P p = entry->format;
+    char c;
+    while((c = pgm_read_byte(p)) != '\0' && this->_lineLength < ESP_IOTLIB_LOG_LINE_LEN - 1){
+        p++;
+        if(c != '%'){
+            this->_line[this->_lineLength++] = c;
+            continue;
+        }
+        p = _parseSpec(p, spec, &conversion, &size);
+        char *out = this->_line + this->_lineLength;
+        size_t room = ESP_IOTLIB_LOG_LINE_LEN - this->_lineLength;
+        uint8_t words = conversion == 'p' ? sizeof(void *) / 4 : size > 4 ? 2 : 1;
+        uint64_t value = 0;
+        int length = -1;
+        switch(conversion){
+        case '%':
+            this->_line[this->_lineLength++] = '%';
+            continue;
+        case 's':
+            if(textPos < entry->textLength){
+                length = snprintf(out, room, spec, entry->text + textPos);
+                textPos += strlen(entry->text + textPos) + 1;
+            }
+            break;
+        case 'f': case 'e': case 'g': case 'E': case 'G':
+            if(word + 2 <= entry->argWords){
+                double number;
+                memcpy(&number, &entry->args[word], sizeof(double));
+                word += 2;
+                length = snprintf(out, room, spec, number);
+            }
+            break;
+        default:
+            if(word + words <= entry->argWords){
+                memcpy(&value, &entry->args[word], words * 4);
+                word += words;
+                if(conversion == 'p')
+                    length = snprintf(out, room, spec, (void *)(uintptr_t)value);
+                else if(words == 2)
+                    length = snprintf(out, room, spec, (unsigned long long)value);
+                else
+                    length = snprintf(out, room, spec, (unsigned int)value);
+            }
+            break;
+        }
+        if(length < 0){
+            // Not captured
+            this->_lineText("?", 1);
+            continue;
+        }
+        this->_lineLength += (size_t)length < room ? length : room - 1;
+    }
+    return this->_lineLength;
+}
+
+void espIOTLib_log::_record(){
+    for(size_t i = 0; i < this->_lineLength; i++){
+        this->_history[this->_historyPos++] = this->_line[i];
+        if(this->_historyPos >= ESP_IOTLIB_LOG_HISTORY_LEN){
+            this->_historyPos = 0;
+            this->_historyFull = true;
+        }
+    }
+}
+
+// Formats the next queued message into _line, false if there is none
+bool espIOTLib_log::_next(){
+    espIOTLib_spscQueue<espIOTLib_logEntry> *queue = &this->_queue;
+    espIOTLib_logEntry *entry = queue->front();
+    if(!entry && this->_netQueue){
+        queue = this->_netQueue;
+        entry = queue->front();
+    }
+    if(!entry)
+        return false;
+    this->_format(entry);
+    queue->pop();
+    return true;
+}
+
+// --- Public Functions ---
+espIOTLib_log::espIOTLib_log(Print *output) : _queue(ESP_IOTLIB_LOG_ENTRIES){
+    this->_output = output;
+    for(uint8_t i = 0; i < ESP_IOTLIB_LOG_SUBSYSTEM_COUNT; i++)
+        this->_levels[i] = ESP_IOTLIB_LOG_DEFAULT_LEVEL;
+}
+
+void espIOTLib_log::log(espIOTLib_logSubsystem subsystem, espIOTLib_logLevel level, PGM_P format, ...){
+    va_list args;
+    va_start(args, format);
+    this->vlog(subsystem, level, format, args);
+    va_end(args);
+}
+
+void espIOTLib_log::vlog(espIOTLib_logSubsystem subsystem, espIOTLib_logLevel level, PGM_P format, va_list args){
+    if(!format || !this->enabled(subsystem, level))
+        return;
+    bool net = this->_netQueue && espIOTLib_threadId() == this->_netThread;
+    espIOTLib_spscQueue<espIOTLib_logEntry> *queue = net ? this->_netQueue : &this->_queue;
+    espIOTLib_logEntry *entry = queue->back();
+    if(!entry){
+        if(net)
+            this->_netDropped++;
+        else
+            this->_dropped++;
+        return;
+    }
+    entry->format = format;
+    entry->subsystem = subsystem;
+    entry->level = level;
+    va_list copy;
+    va_copy(copy, args);
+    _capture(entry, format, copy);
+    va_end(copy);
+    queue->commit();
+    if(net)
+        this->_netLogged++;
+    else
+        this->_logged++;
+}
+
+bool espIOTLib_log::enabled(espIOTLib_logSubsystem subsystem, espIOTLib_logLevel level){
+    return subsystem < ESP_IOTLIB_LOG_SUBSYSTEM_COUNT && level != ESP_IOTLIB_LOG_OFF && level <= this->_levels[subsystem];
+}
+
+void espIOTLib_log::setNetworkThread(){
+    this->_netThread = espIOTLib_threadId();
+    if(!this->_netQueue)
+        this->_netQueue = new espIOTLib_spscQueue<espIOTLib_logEntry>(ESP_IOTLIB_LOG_NET_ENTRIES);
+}
+
+bool espIOTLib_log::drain(){
+    size_t budget = ESP_IOTLIB_LOG_DRAIN_BUDGET;
+    while(true){
+        // Rest of the last message first, as much as fits into the UART buffer
+        if(this->_linePos < this->_lineLength){
+            if(this->_output){
+                int room = this->_output->availableForWrite();
+                if(room <= 0)
+                    return false;
+                size_t length = this->_lineLength - this->_linePos;
+                if(length > (size_t)room)
+                    length = room;
+                this->_linePos += this->_output->write((const uint8_t *)this->_line + this->_linePos, length);
+                if(this->_linePos < this->_lineLength)
+                    return false;
+            } else {
+                this->_linePos = this->_lineLength;
+            }
+        }
+        if(budget == 0)
+            return this->pending() == 0 && this->droppedCount() == this->_droppedReported;
+        if(!this->_next()){
+            // Messages were dropped while the queue was full, so after what is queued
+            uint32_t dropped = this->droppedCount();
+            if(dropped == this->_droppedReported)
+                return true;
+            int length = snprintf(this->_line, ESP_IOTLIB_LOG_LINE_LEN, "[!] %u log messages dropped\n", (unsigned)(dropped - this->_droppedReported));
+            this->_lineLength = length > 0 ? length : 0;
+            this->_droppedReported = dropped;
+        }
+        this->_record();
+        this->_linePos = 0;
+        budget = this->_lineLength < budget ? budget - this->_lineLength : 0;
+    }
+}
+
+void espIOTLib_log::flush(){
+    for(uint16_t i = 0; i < LOG_FLUSH_TIMEOUT && !this->drain(); i++)
+        delay(1);
+}
+
+void espIOTLib_log::writeHistory(Print &out){
+    if(!this->_historyFull){
+        out.write((const uint8_t *)this->_history, this->_historyPos);
+        return;
+    }
+    // The oldest message was partly overwritten, start after its end
+    size_t start = this->_historyPos;
+    for(size_t i = 0; i < ESP_IOTLIB_LOG_HISTORY_LEN; i++){
+        size_t index = (this->_historyPos + i) % ESP_IOTLIB_LOG_HISTORY_LEN;
+        if(this->_history[index] == '\n'){
+            start = (index + 1) % ESP_IOTLIB_LOG_HISTORY_LEN;
+            break;
+        }
+    }
+    if(start >= this->_historyPos){
+        out.write((const uint8_t *)this->_history + start, ESP_IOTLIB_LOG_HISTORY_LEN - start);
+        out.write((const uint8_t *)this->_history, this->_historyPos);
+    } else {
+        out.write((const uint8_t *)this->_history + start, this->_historyPos - start);
+    }
+}
+
+void espIOTLib_log::setLevel(espIOTLib_logSubsystem subsystem, espIOTLib_logLevel level){
+    if(subsystem >= ESP_IOTLIB_LOG_SUBSYSTEM_COUNT || level >= ESP_IOTLIB_LOG_LEVEL_COUNT)
+        return;
+    this->_levels[subsystem] = level;
+}
+espIOTLib_logLevel espIOTLib_log::getLevel(espIOTLib_logSubsystem subsystem){
+    if(subsystem >= ESP_IOTLIB_LOG_SUBSYSTEM_COUNT)
+        return ESP_IOTLIB_LOG_OFF;
+    return (espIOTLib_logLevel)this->_levels[subsystem];
+}
+void espIOTLib_log::setOutput(Print *output){
+    this->_output = output;
+}
+uint32_t espIOTLib_log::loggedCount(){
+    return this->_logged + this->_netLogged;
+}
+uint32_t espIOTLib_log::droppedCount(){
+    return this->_dropped + this->_netDropped;
+}
+size_t espIOTLib_log::pending(){
+    return this->_queue.size() + (this->_netQueue ? this->_netQueue->size() : 0);
+}
+
+const char *espIOTLib_log::levelName(espIOTLib_logLevel level){
+    switch(level){
+    case ESP_IOTLIB_LOG_OFF:
+        return "off";
+    case ESP_IOTLIB_LOG_ERROR:
+        return "error";
+    case ESP_IOTLIB_LOG_WARN:
+        return "warn";
+    case ESP_IOTLIB_LOG_INFO:
+        return "info";
+    case ESP_IOTLIB_LOG_DEBUG:
+        return "debug";
+    default:
+        return "unknown";
+    }
+}
+
+const char *espIOTLib_log::subsystemName(espIOTLib_logSubsystem subsystem){
+    switch(subsystem){
+    case ESP_IOTLIB_LOG_IOT:
+        return "iot";
+    case ESP_IOTLIB_LOG_MQTT:
+        return "mqtt";
+    case ESP_IOTLIB_LOG_APP:
+        return "app";
+    default:
+        return "unknown";
+    }
+}
+
+espIOTLib_logLevel espIOTLib_log::parseLevel(const char *name){
+    for(uint8_t i = 0; i < ESP_IOTLIB_LOG_LEVEL_COUNT; i++){
+        if(strcmp(name, levelName((espIOTLib_logLevel)i)) == 0)
+            return (espIOTLib_logLevel)i;
+    }
+    return ESP_IOTLIB_LOG_LEVEL_COUNT;
+}
@@ -0,0 +1,164 @@
+/**
+ * @file espIOTLib_log.h
+ * @author Paul Schlarmann (paul.schlarmann@makerspace-minden.de)
+ * @brief Non-blocking log: messages are queued unformatted and printed from loop() as the UART has room
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) Paul Schlarmann 2023
+ *
+ */
+#ifndef ESPIOTLIB_LOG_H
+#define ESPIOTLIB_LOG_H
+
+// --- Includes ---
+#include <Arduino.h>
+
+#include "espIOTLib_spscQueue.h"
+
+// --- Defines ---
+#ifndef ESP_IOTLIB_LOG_ENTRIES
+    #define ESP_IOTLIB_LOG_ENTRIES 32
+#endif
+// Network task queue on ESP32, only allocated once the task runs
+#ifndef ESP_IOTLIB_LOG_NET_ENTRIES
+    #define ESP_IOTLIB_LOG_NET_ENTRIES 16
+#endif
+// 4 byte words for the numeric arguments of a message, 64 bit values and doubles take two
+#ifndef ESP_IOTLIB_LOG_ARGS
+    #define ESP_IOTLIB_LOG_ARGS 4
+#endif
+// Copy of the string arguments of a message, longer ones are cut
+#ifndef ESP_IOTLIB_LOG_TEXT_LEN
+    #define ESP_IOTLIB_LOG_TEXT_LEN 32
+#endif
+// Longest formatted message
+#ifndef ESP_IOTLIB_LOG_LINE_LEN
+    #define ESP_IOTLIB_LOG_LINE_LEN 128
+#endif
+// Max. bytes formatted per drain() call
+#ifndef ESP_IOTLIB_LOG_DRAIN_BUDGET
+    #define ESP_IOTLIB_LOG_DRAIN_BUDGET 256
+#endif
+// Formatted output kept for the log page
+#ifndef ESP_IOTLIB_LOG_HISTORY_LEN
+    #define ESP_IOTLIB_LOG_HISTORY_LEN 1024
+#endif
+#ifndef ESP_IOTLIB_LOG_DEFAULT_LEVEL
+    #define ESP_IOTLIB_LOG_DEFAULT_LEVEL ESP_IOTLIB_LOG_DEBUG
+#endif
+
+// --- Typedefs ---
+typedef enum {
+    ESP_IOTLIB_LOG_OFF = 0,
+    ESP_IOTLIB_LOG_ERROR,
+    ESP_IOTLIB_LOG_WARN,
+    ESP_IOTLIB_LOG_INFO,
+    ESP_IOTLIB_LOG_DEBUG,
+    ESP_IOTLIB_LOG_LEVEL_COUNT
+} espIOTLib_logLevel;
+
+typedef enum {
+    ESP_IOTLIB_LOG_IOT = 0,         // WiFi, web and lifecycle
+    ESP_IOTLIB_LOG_MQTT,
+    ESP_IOTLIB_LOG_APP,             // espIOTLib::log() of the application
+    ESP_IOTLIB_LOG_SUBSYSTEM_COUNT
+} espIOTLib_logSubsystem;
+
+struct espIOTLib_logEntry{
+    PGM_P format;
+    uint8_t subsystem;
+    uint8_t level;
+    uint8_t argWords;
+    uint8_t textLength;
+    uint32_t args[ESP_IOTLIB_LOG_ARGS];
+    char text[ESP_IOTLIB_LOG_TEXT_LEN];     // String arguments, each null terminated
+};
+
+// --- Public Classes ---
+
+/**
+ * @brief A message costs a level check, a walk over its format string and a copy of the arguments into a queue entry.
+ * Formatting and output happen in drain(), at most ESP_IOTLIB_LOG_DRAIN_BUDGET bytes per call and only as much as
+ * the output can take without blocking; the rest waits for the next call. A full queue drops new messages and counts them.
+ * Formats must stay valid until they are printed, i.e. be string literals (PSTR on ESP8266).
+ * Supported conversions: d i u x X o c s p f e g with flags, width, precision and the h, l, ll, z length modifiers.
+ *
+ * Each producing thread has its own single producer queue: one for the application's loop(), one for the
+ * ESP32 network task (setNetworkThread()). drain() and writeHistory() have to run on the thread that runs the network work.
+ */
+class espIOTLib_log
+{
+protected:
+    espIOTLib_spscQueue<espIOTLib_logEntry> _queue;
+    espIOTLib_spscQueue<espIOTLib_logEntry> *_netQueue = NULL;
+    uintptr_t _netThread = 0;
+    Print *_output;
+    uint8_t _levels[ESP_IOTLIB_LOG_SUBSYSTEM_COUNT];
+    volatile uint32_t _logged = 0;
+    volatile uint32_t _dropped = 0;
+    volatile uint32_t _netLogged = 0;
+    volatile uint32_t _netDropped = 0;
+    uint32_t _droppedReported = 0;
+    char _line[ESP_IOTLIB_LOG_LINE_LEN];
+    size_t _lineLength = 0;
+    size_t _linePos = 0;
+    char _history[ESP_IOTLIB_LOG_HISTORY_LEN];
+    size_t _historyPos = 0;
+    bool _historyFull = false;
+
+    static PGM_P _parseSpec(PGM_P p, char *spec, char *conversion, uint8_t *size);
+    static void _capture(espIOTLib_logEntry *entry, PGM_P format, va_list args);
+    size_t _format(const espIOTLib_logEntry *entry);
+    void _lineText(const char *text, size_t length);
+    void _record();
+    bool _next();
+
+public:
+    /**
+     * @param output Where drain() prints to, NULL to only keep the history
+     */
+    espIOTLib_log(Print *output);
+
+    /**
+     * @brief Queue a message if level is enabled for subsystem. Does not block
+     */
+    void log(espIOTLib_logSubsystem subsystem, espIOTLib_logLevel level, PGM_P format, ...);
+    void vlog(espIOTLib_logSubsystem subsystem, espIOTLib_logLevel level, PGM_P format, va_list args);
+    bool enabled(espIOTLib_logSubsystem subsystem, espIOTLib_logLevel level);
+    /**
+     * @brief Messages of the calling thread go to a queue of their own from now on, call on the network task
+     */
+    void setNetworkThread();
+
+    /**
+     * @brief Format and print queued messages, within the byte budget and without blocking
+     *
+     * @return true if nothing is left
+     */
+    bool drain();
+    /**
+     * @brief Print everything queued, blocking, e.g. before deep sleep
+     */
+    void flush();
+    /**
+     * @brief Recent output, oldest first, starting at a message boundary
+     */
+    void writeHistory(Print &out);
+
+    void setLevel(espIOTLib_logSubsystem subsystem, espIOTLib_logLevel level);
+    espIOTLib_logLevel getLevel(espIOTLib_logSubsystem subsystem);
+    void setOutput(Print *output);
+    uint32_t loggedCount();
+    uint32_t droppedCount();
+    size_t pending();
+
+    static const char *levelName(espIOTLib_logLevel level);
+    static const char *subsystemName(espIOTLib_logSubsystem subsystem);
+    /**
+     * @return ESP_IOTLIB_LOG_LEVEL_COUNT if name is unknown
+     */
+    static espIOTLib_logLevel parseLevel(const char *name);
+};
+
+#endif /* ESPIOTLIB_LOG_H */
@@ -0,0 +1,114 @@
+/**
+ * @file espIOTLib_metricsWriter.cpp
+ * @author Paul Schlarmann (paul.schlarmann@makerspace-minden.de)
+ * @brief Writes metrics as Prometheus text or JSON without allocating
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) Paul Schlarmann 2023
+ *
+ */
+
+// --- Includes ---
+#include "espIOTLib_metricsWriter.h"
+
+// --- Private Functions ---
+
+// Label values are task names, broker hosts etc., escaped for a Prometheus label value and a JSON key alike
+void espIOTLib_metricsWriter::_label(const char *label){
+    for(const char *c = label; *c; c++){
+        if(*c == '"' || *c == '\\'){
+            this->_out.print('\\');
+            this->_out.print(*c);
+        } else if(*c == '\n'){
+            this->_out.print(F("\\n"));
+        } else if((uint8_t)*c < 0x20){
+            this->_out.print(' ');
+        } else {
+            this->_out.print(*c);
+        }
+    }
+}
+
+// Writes everything in front of the value. The optional label becomes {key="label"} or a "name_label" key.
+void espIOTLib_metricsWriter::_name(espIOTLib_metricKind kind, const __FlashStringHelper *name, const char *label){
+    if(this->_format == ESP_IOTLIB_METRICS_JSON){
+        this->_out.print(this->_first ? F("\"") : F(",\""));
+        this->_out.print(name);
+        if(label){
+            this->_out.print('_');
+            this->_label(label);
+        }
+        this->_out.print(F("\":"));
+    } else {
+        // Only one TYPE line per metric family, labelled series of a family are written back to back
+        if(name != this->_lastName){
+            this->_out.print(F("# TYPE espiotlib_"));
+            this->_out.print(name);
+            this->_out.print(kind == ESP_IOTLIB_METRIC_COUNTER ? F(" counter\n") : F(" gauge\n"));
+        }
+        this->_out.print(F("espiotlib_"));
+        this->_out.print(name);
+        if(label){
+            this->_out.print('{');
+            this->_out.print(this->_labelKey);
+            this->_out.print(F("=\""));
+            this->_label(label);
+            this->_out.print(F("\"}"));
+        }
+        this->_out.print(' ');
+    }
+    this->_first = false;
+    this->_lastName = name;
+}
+
+// --- Public Functions ---
+espIOTLib_metricsWriter::espIOTLib_metricsWriter(Print &out, espIOTLib_metricsFormat format) : _out(out){
+    this->_format = format;
+    this->_labelKey = F("stage");
+}
+
+void espIOTLib_metricsWriter::begin(){
+    this->_first = true;
+    if(this->_format == ESP_IOTLIB_METRICS_JSON)
+        this->_out.print('{');
+}
+
+void espIOTLib_metricsWriter::setLabelKey(const __FlashStringHelper *key){
+    this->_labelKey = key;
+}
+
+void espIOTLib_metricsWriter::metric(espIOTLib_metricKind kind, const __FlashStringHelper *name, uint32_t value, const char *label){
+    this->_name(kind, name, label);
+    this->_out.print(value);
+    if(this->_format == ESP_IOTLIB_METRICS_PROMETHEUS)
+        this->_out.print('\n');
+}
+
+void espIOTLib_metricsWriter::metric(espIOTLib_metricKind kind, const __FlashStringHelper *name, int32_t value, const char *label){
+    this->_name(kind, name, label);
+    this->_out.print(value);
+    if(this->_format == ESP_IOTLIB_METRICS_PROMETHEUS)
+        this->_out.print('\n');
+}
+
+void espIOTLib_metricsWriter::metric(espIOTLib_metricKind kind, const __FlashStringHelper *name, float value, const char *label){
+    this->_name(kind, name, label);
+    if(this->_format == ESP_IOTLIB_METRICS_JSON && !isfinite(value)){
+        // JSON has no NaN or Infinity
+        this->_out.print(F("null"));
+    } else if(isnan(value)){
+        this->_out.print(F("NaN"));
+    } else if(isinf(value)){
+        this->_out.print(value > 0 ? F("+Inf") : F("-Inf"));
+    } else {
+        this->_out.print(value, 3);
+    }
+    if(this->_format == ESP_IOTLIB_METRICS_PROMETHEUS)
+        this->_out.print('\n');
+}
+
+void espIOTLib_metricsWriter::end(){
+    if(this->_format == ESP_IOTLIB_METRICS_JSON)
+        this->_out.print(F("}\n"));
+}
@@ -0,0 +1,58 @@
+/**
+ * @file espIOTLib_metricsWriter.h
+ * @author Paul Schlarmann (paul.schlarmann@makerspace-minden.de)
+ * @brief Writes metrics as Prometheus text or JSON without allocating
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) Paul Schlarmann 2023
+ *
+ */
+#ifndef ESPIOTLIB_METRICSWRITER_H
+#define ESPIOTLIB_METRICSWRITER_H
+
+// --- Includes ---
+#include <Arduino.h>
+
+// --- Typedefs ---
+typedef enum {
+    ESP_IOTLIB_METRICS_PROMETHEUS = 0,
+    ESP_IOTLIB_METRICS_JSON
+} espIOTLib_metricsFormat;
+
+typedef enum {
+    ESP_IOTLIB_METRIC_GAUGE = 0,
+    ESP_IOTLIB_METRIC_COUNTER
+} espIOTLib_metricKind;
+
+// --- Public Classes ---
+
+/**
+ * @brief Formats name/value pairs straight into a Print (usually an espIOTLib_pageWriter).
+ * Names are flash strings without prefix, Prometheus output gets "espiotlib_" prepended.
+ * Labelled series of one family must be written back to back using the same name pointer.
+ */
+class espIOTLib_metricsWriter
+{
+protected:
+    Print &_out;
+    espIOTLib_metricsFormat _format;
+    bool _first = true;
+    const __FlashStringHelper *_lastName = NULL;
+    const __FlashStringHelper *_labelKey;
+
+    void _label(const char *label);
+    void _name(espIOTLib_metricKind kind, const __FlashStringHelper *name, const char *label);
+
+public:
+    espIOTLib_metricsWriter(Print &out, espIOTLib_metricsFormat format);
+
+    void begin();
+    void setLabelKey(const __FlashStringHelper *key);
+    void metric(espIOTLib_metricKind kind, const __FlashStringHelper *name, uint32_t value, const char *label = NULL);
+    void metric(espIOTLib_metricKind kind, const __FlashStringHelper *name, int32_t value, const char *label = NULL);
+    void metric(espIOTLib_metricKind kind, const __FlashStringHelper *name, float value, const char *label = NULL);
+    void end();
+};
+
+#endif /* ESPIOTLIB_METRICSWRITER_H */
@@ -0,0 +1,305 @@
+/**
+ * @file espIOTLib_outbox.cpp
+ * @author Paul Schlarmann (paul.schlarmann@makerspace-minden.de)
+ * @brief Store-and-forward queue for MQTT publishes while offline
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) Paul Schlarmann 2023
+ *
+ */
+
+// --- Includes ---
+#include "espIOTLib_outbox.h"
+
+#ifdef ESP_IOTLIB_OUTBOX_SPILL
+#include <LittleFS.h>
+#endif
+
+// --- Defines ---
+// Spill record: age (4), topic length (1), payload length (2), topic, payload
+#define OUTBOX_SPILL_HEADER_LEN 7
+
+// --- Private Functions ---
+espIOTLib_outboxEntry *espIOTLib_outbox::_at(size_t index){
+    return &this->_entries[(this->_head + index) % this->_capacity];
+}
+
+// Free one slot in a full ring, returns false if the new entry has to be dropped
+bool espIOTLib_outbox::_makeRoom(uint32_t now){
+#ifdef ESP_IOTLIB_OUTBOX_SPILL
+    if(this->_spillPath && this->_spillWrite(this->_at(0), now)){
+        this->_head = (this->_head + 1) % this->_capacity;
+        this->_count--;
+        this->_spilled++;
+        return true;
+    }
+#else
+    (void)now;
+#endif
+    if(this->_policy == ESP_IOTLIB_OUTBOX_DROP_NEWEST){
+        this->_dropped++;
+        return false;
+    }
+    // Drop oldest, coalesce falls back to this if no entry matched
+    this->_head = (this->_head + 1) % this->_capacity;
+    this->_count--;
+    this->_dropped++;
+    return true;
+}
+
+#ifdef ESP_IOTLIB_OUTBOX_SPILL
+bool espIOTLib_outbox::_spillWrite(const espIOTLib_outboxEntry *entry, uint32_t now){
+    uint8_t topicLen = strlen(entry->topic);
+    size_t recordLen = OUTBOX_SPILL_HEADER_LEN + topicLen + entry->payloadLen;
+    if(this->_spillSize + recordLen > this->_spillMaxBytes)
+        return false;
+    // Write after the last complete record, not at the end of the file: a record that was cut short
+    // by a full flash is overwritten instead of shifting every later record
+    File file = LittleFS.open(this->_spillPath, this->_spillSize > 0 ? "r+" : "w");
+    if(!file)
+        return false;
+    if(!file.seek(this->_spillSize)){
+        file.close();
+        return false;
+    }
+    uint8_t header[OUTBOX_SPILL_HEADER_LEN];
+    uint32_t age = now - entry->timestamp;
+    memcpy(header, &age, 4);
+    header[4] = topicLen;
+    memcpy(header + 5, &entry->payloadLen, 2);
+    size_t written = file.write(header, OUTBOX_SPILL_HEADER_LEN);
+    written += file.write((const uint8_t *)entry->topic, topicLen);
+    written += file.write((const uint8_t *)entry->payload, entry->payloadLen);
+    if(written != recordLen){
+#ifdef ESP8266
+        file.truncate(this->_spillSize);
+#endif
+        file.close();
+        return false;
+    }
+    file.close();
+    this->_spillSize += recordLen;
+    return true;
+}
+
+bool espIOTLib_outbox::_spillLoad(uint32_t now){
+    File file = LittleFS.open(this->_spillPath, "r");
+    if(!file){
+        this->_spillSize = 0;
+        this->_spillReadPos = 0;
+        return false;
+    }
+    uint8_t header[OUTBOX_SPILL_HEADER_LEN];
+    bool valid = file.seek(this->_spillReadPos) && file.read(header, OUTBOX_SPILL_HEADER_LEN) == OUTBOX_SPILL_HEADER_LEN;
+    uint32_t age = 0;
+    uint8_t topicLen = 0;
+    uint16_t payloadLen = 0;
+    if(valid){
+        memcpy(&age, header, 4);
+        topicLen = header[4];
+        memcpy(&payloadLen, header + 5, 2);
+        valid = topicLen < ESP_IOTLIB_OUTBOX_TOPIC_LEN && payloadLen <= ESP_IOTLIB_OUTBOX_PAYLOAD_LEN
+            && file.read((uint8_t *)this->_spillEntry.topic, topicLen) == topicLen
+            && file.read((uint8_t *)this->_spillEntry.payload, payloadLen) == payloadLen;
+    }
+    file.close();
+    if(!valid){
+        // Truncated or corrupt file, nothing after this point can be trusted. The record count is unknown, so
+        // this counts one dropped publish and every byte that was left
+        LittleFS.remove(this->_spillPath);
+        this->_dropped++;
+        this->_spillLostBytes += this->_spillSize - this->_spillReadPos;
+        this->_spillSize = 0;
+        this->_spillReadPos = 0;
+        return false;
+    }
+    this->_spillEntry.topic[topicLen] = '\0';
+    this->_spillEntry.payloadLen = payloadLen;
+    this->_spillEntry.timestamp = now - age;
+    this->_spillEntryLoaded = true;
+    return true;
+}
+#endif
+
+// --- Public Functions ---
+espIOTLib_outbox::espIOTLib_outbox(size_t capacity, espIOTLib_outboxPolicy policy){
+    this->_capacity = capacity > 0 ? capacity : 1;
+    this->_policy = policy;
+    this->_entries = new espIOTLib_outboxEntry[this->_capacity];
+}
+
+espIOTLib_outbox::~espIOTLib_outbox(){
+    delete[] this->_entries;
+}
+
+bool espIOTLib_outbox::push(const char *topic, const char *payload, size_t length, uint32_t now){
+    if(!topic || !payload)
+        return false;
+    size_t topicLen = strlen(topic);
+    if(topicLen >= ESP_IOTLIB_OUTBOX_TOPIC_LEN || length > ESP_IOTLIB_OUTBOX_PAYLOAD_LEN){
+        this->_oversized++;
+        this->_dropped++;
+        return false;
+    }
+
+    espIOTLib_outboxEntry *entry = NULL;
+    if(this->_count == this->_capacity){
+        if(this->_policy == ESP_IOTLIB_OUTBOX_COALESCE){
+            for(size_t i = 0; i < this->_count; i++){
+                if(strcmp(this->_at(i)->topic, topic) == 0){
+                    entry = this->_at(i);
+                    this->_coalesced++;
+                    break;
+                }
+            }
+        }
+        if(!entry && !this->_makeRoom(now))
+            return false;
+    }
+    if(!entry){
+        entry = this->_at(this->_count);
+        memcpy(entry->topic, topic, topicLen + 1);
+        this->_count++;
+    }
+    memcpy(entry->payload, payload, length);
+    entry->payloadLen = length;
+    entry->timestamp = now;
+    this->_queued++;
+    return true;
+}
+
+const espIOTLib_outboxEntry *espIOTLib_outbox::front(uint32_t now){
+#ifdef ESP_IOTLIB_OUTBOX_SPILL
+    // Spilled entries are always older than the ones in RAM
+    if(this->_spillEntryLoaded)
+        return &this->_spillEntry;
+    if(this->_spillPath && this->_spillReadPos < this->_spillSize && this->_spillLoad(now))
+        return &this->_spillEntry;
+#else
+    (void)now;
+#endif
+    if(this->_count == 0)
+        return NULL;
+    return this->_at(0);
+}
+
+void espIOTLib_outbox::pop(){
+#ifdef ESP_IOTLIB_OUTBOX_SPILL
+    if(this->_spillEntryLoaded){
+        this->_spillEntryLoaded = false;
+        this->_spillReadPos += OUTBOX_SPILL_HEADER_LEN + strlen(this->_spillEntry.topic) + this->_spillEntry.payloadLen;
+        if(this->_spillReadPos >= this->_spillSize){
+            LittleFS.remove(this->_spillPath);
+            this->_spillSize = 0;
+            this->_spillReadPos = 0;
+        }
+        this->_sent++;
+        return;
+    }
+#endif
+    if(this->_count == 0)
+        return;
+    this->_head = (this->_head + 1) % this->_capacity;
+    this->_count--;
+    this->_sent++;
+}
+
+void espIOTLib_outbox::clear(){
+    this->_head = 0;
+    this->_count = 0;
+#ifdef ESP_IOTLIB_OUTBOX_SPILL
+    // Otherwise the spilled backlog would be replayed after the clear
+    if(this->_spillPath && (this->_spillSize > 0 || this->_spillEntryLoaded))
+        LittleFS.remove(this->_spillPath);
+    this->_spillEntryLoaded = false;
+    this->_spillSize = 0;
+    this->_spillReadPos = 0;
+#endif
+}
+
+bool espIOTLib_outbox::isEmpty(){
+#ifdef ESP_IOTLIB_OUTBOX_SPILL
+    if(this->_spillEntryLoaded || this->_spillReadPos < this->_spillSize)
+        return false;
+#endif
+    return this->_count == 0;
+}
+
+size_t espIOTLib_outbox::size(){
+    return this->_count;
+}
+
+size_t espIOTLib_outbox::capacity(){
+    return this->_capacity;
+}
+
+uint32_t espIOTLib_outbox::oldestAge(uint32_t now){
+#ifdef ESP_IOTLIB_OUTBOX_SPILL
+    if(this->_spillEntryLoaded)
+        return now - this->_spillEntry.timestamp;
+#endif
+    if(this->_count == 0)
+        return 0;
+    return now - this->_at(0)->timestamp;
+}
+
+uint32_t espIOTLib_outbox::queuedCount(){
+    return this->_queued;
+}
+uint32_t espIOTLib_outbox::sentCount(){
+    return this->_sent;
+}
+uint32_t espIOTLib_outbox::droppedCount(){
+    return this->_dropped;
+}
+uint32_t espIOTLib_outbox::coalescedCount(){
+    return this->_coalesced;
+}
+uint32_t espIOTLib_outbox::spilledCount(){
+    return this->_spilled;
+}
+uint32_t espIOTLib_outbox::oversizedCount(){
+    return this->_oversized;
+}
+uint32_t espIOTLib_outbox::spillLostBytesCount(){
+    return this->_spillLostBytes;
+}
+
+#ifdef ESP_IOTLIB_OUTBOX_SPILL
+bool espIOTLib_outbox::setSpillFile(const char *path, size_t maxBytes){
+    if(!path || !LittleFS.begin())
+        return false;
+    this->_spillPath = path;
+    this->_spillMaxBytes = maxBytes;
+    this->_spillReadPos = 0;
+    this->_spillEntryLoaded = false;
+    this->_spillSize = 0;
+    // Pick up a backlog left over from before the last reboot
+    if(LittleFS.exists(path)){
+        File file = LittleFS.open(path, "r");
+        if(file){
+            this->_spillSize = file.size();
+            file.close();
+        }
+    }
+    return true;
+}
+
+bool espIOTLib_outbox::persist(uint32_t now){
+    if(!this->_spillPath)
+        return false;
+    while(this->_count > 0){
+        if(!this->_spillWrite(this->_at(0), now))
+            return false;
+        this->_head = (this->_head + 1) % this->_capacity;
+        this->_count--;
+        this->_spilled++;
+    }
+    return true;
+}
+
+size_t espIOTLib_outbox::spillSize(){
+    return this->_spillSize - this->_spillReadPos;
+}
+#endif
@@ -0,0 +1,138 @@
+/**
+ * @file espIOTLib_outbox.h
+ * @author Paul Schlarmann (paul.schlarmann@makerspace-minden.de)
+ * @brief Store-and-forward queue for MQTT publishes while offline
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) Paul Schlarmann 2023
+ *
+ */
+#ifndef ESPIOTLIB_OUTBOX_H
+#define ESPIOTLIB_OUTBOX_H
+
+// --- Includes ---
+#include <Arduino.h>
+
+// --- Defines ---
+#ifndef ESP_IOTLIB_OUTBOX_ENTRIES
+    #define ESP_IOTLIB_OUTBOX_ENTRIES 16
+#endif
+#ifndef ESP_IOTLIB_OUTBOX_TOPIC_LEN
+    #define ESP_IOTLIB_OUTBOX_TOPIC_LEN 64
+#endif
+// Fits any publishInt/publishFloat payload; batches and records are usually longer, see push()
+#ifndef ESP_IOTLIB_OUTBOX_PAYLOAD_LEN
+    #define ESP_IOTLIB_OUTBOX_PAYLOAD_LEN 32
+#endif
+#ifndef ESP_IOTLIB_OUTBOX_DRAIN_BUDGET
+    #define ESP_IOTLIB_OUTBOX_DRAIN_BUDGET 4
+#endif
+#ifndef ESP_IOTLIB_OUTBOX_SPILL_MAX_BYTES
+    #define ESP_IOTLIB_OUTBOX_SPILL_MAX_BYTES 16384
+#endif
+
+//Define this to allow the outbox to spill into a LittleFS file
+//#define ESP_IOTLIB_OUTBOX_SPILL
+
+// --- Typedefs ---
+typedef enum {
+    ESP_IOTLIB_OUTBOX_DROP_OLDEST = 0,
+    ESP_IOTLIB_OUTBOX_DROP_NEWEST,
+    ESP_IOTLIB_OUTBOX_COALESCE
+} espIOTLib_outboxPolicy;
+
+struct espIOTLib_outboxEntry{
+    uint32_t timestamp;
+    uint16_t payloadLen;
+    char topic[ESP_IOTLIB_OUTBOX_TOPIC_LEN];
+    char payload[ESP_IOTLIB_OUTBOX_PAYLOAD_LEN];
+};
+
+// --- Public Classes ---
+
+/**
+ * @brief Fixed capacity ring buffer of pending publishes.
+ * All entries are allocated once in the constructor; push() never allocates.
+ * With a spill file set, entries that overflow the RAM ring are appended to
+ * flash instead of being dropped and are drained before the RAM entries.
+ */
+class espIOTLib_outbox
+{
+protected:
+    espIOTLib_outboxEntry *_entries;
+    size_t _capacity;
+    size_t _head = 0;
+    size_t _count = 0;
+    espIOTLib_outboxPolicy _policy;
+
+    uint32_t _queued = 0;
+    uint32_t _sent = 0;
+    uint32_t _dropped = 0;
+    uint32_t _coalesced = 0;
+    uint32_t _spilled = 0;
+    uint32_t _oversized = 0;
+    uint32_t _spillLostBytes = 0;
+
+#ifdef ESP_IOTLIB_OUTBOX_SPILL
+    const char *_spillPath = NULL;
+    size_t _spillMaxBytes = 0;
+    size_t _spillReadPos = 0;
+    size_t _spillSize = 0;
+    bool _spillEntryLoaded = false;
+    espIOTLib_outboxEntry _spillEntry;
+
+    bool _spillWrite(const espIOTLib_outboxEntry *entry, uint32_t now);
+    bool _spillLoad(uint32_t now);
+#endif
+
+    espIOTLib_outboxEntry *_at(size_t index);
+    bool _makeRoom(uint32_t now);
+
+public:
+    espIOTLib_outbox(size_t capacity, espIOTLib_outboxPolicy policy);
+    ~espIOTLib_outbox();
+
+    /**
+     * @brief Queue a publish, copying topic and payload into a preallocated entry.
+     * Payloads longer than ESP_IOTLIB_OUTBOX_PAYLOAD_LEN and topics of ESP_IOTLIB_OUTBOX_TOPIC_LEN or more can not be queued:
+     * they are dropped and counted in oversizedCount(). JSON batches and records only survive an outage if
+     * ESP_IOTLIB_OUTBOX_PAYLOAD_LEN is raised to their size, e.g. to ESP_IOTLIB_BATCH_BUFFER_LEN, at the cost of RAM per entry
+     * 
+     * @return false if the publish was dropped
+     */
+    bool push(const char *topic, const char *payload, size_t length, uint32_t now);
+    const espIOTLib_outboxEntry *front(uint32_t now);
+    void pop();
+    /**
+     * @brief Drop everything queued, including the spill file
+     */
+    void clear();
+
+    bool isEmpty();
+    size_t size();
+    size_t capacity();
+    uint32_t oldestAge(uint32_t now);
+
+    uint32_t queuedCount();
+    uint32_t sentCount();
+    uint32_t droppedCount();
+    uint32_t coalescedCount();
+    uint32_t spilledCount();
+    uint32_t oversizedCount();
+    // Bytes of spilled records lost to a truncated or corrupt spill file
+    uint32_t spillLostBytesCount();
+
+#ifdef ESP_IOTLIB_OUTBOX_SPILL
+    bool setSpillFile(const char *path, size_t maxBytes);
+    /**
+     * @brief Move all RAM entries to the spill file, so they survive a reboot
+     * 
+     * @return false if no spill file is set or the file is full, the remaining entries stay in RAM
+     */
+    bool persist(uint32_t now);
+    size_t spillSize();
+#endif
+};
+
+#endif /* ESPIOTLIB_OUTBOX_H */
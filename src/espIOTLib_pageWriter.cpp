@@ -0,0 +1,77 @@
+/**
+ * @file espIOTLib_pageWriter.cpp
+ * @author Paul Schlarmann (paul.schlarmann@makerspace-minden.de)
+ * @brief Streams chunked HTTP responses through a fixed stack buffer
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) Paul Schlarmann 2023
+ *
+ */
+
+// --- Includes ---
+#include "espIOTLib_pageWriter.h"
+
+// --- Public Functions ---
+espIOTLib_pageWriter::espIOTLib_pageWriter(WebServer *server){
+    this->_server = server;
+}
+
+espIOTLib_pageWriter::~espIOTLib_pageWriter(){
+    this->end();
+}
+
+void espIOTLib_pageWriter::begin(int code, const char *contentType){
+    this->_server->setContentLength(CONTENT_LENGTH_UNKNOWN);
+    this->_server->send(code, contentType, "");
+    this->_length = 0;
+    this->_started = true;
+}
+
+size_t espIOTLib_pageWriter::write(uint8_t c){
+    if(this->_length >= ESP_IOTLIB_PAGE_BUFFER_LEN)
+        this->flush();
+    this->_buffer[this->_length++] = c;
+    return 1;
+}
+
+size_t espIOTLib_pageWriter::write(const uint8_t *buffer, size_t size){
+    size_t remaining = size;
+    while(remaining > 0){
+        if(this->_length >= ESP_IOTLIB_PAGE_BUFFER_LEN)
+            this->flush();
+        size_t chunk = ESP_IOTLIB_PAGE_BUFFER_LEN - this->_length;
+        if(chunk > remaining)
+            chunk = remaining;
+        memcpy(this->_buffer + this->_length, buffer, chunk);
+        this->_length += chunk;
+        buffer += chunk;
+        remaining -= chunk;
+    }
+    return size;
+}
+
+void espIOTLib_pageWriter::flush(){
+    // An empty chunk terminates the response, so never send one here
+    if(!this->_started || this->_length == 0)
+        return;
+    this->_server->sendContent(this->_buffer, this->_length);
+    this->_length = 0;
+}
+
+void espIOTLib_pageWriter::end(){
+    if(!this->_started)
+        return;
+    this->flush();
+    this->_server->sendContent(this->_buffer, 0);
+    this->_started = false;
+}
+
+void espIOTLib_pageWriter::printMAC(Print &out, const uint8_t *mac){
+    for(uint8_t i = 0; i < 6; i++){
+        if(i > 0)
+            out.write(':');
+        out.write("0123456789ABCDEF"[mac[i] >> 4]);
+        out.write("0123456789ABCDEF"[mac[i] & 0x0F]);
+    }
+}
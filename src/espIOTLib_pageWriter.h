@@ -0,0 +1,60 @@
+/**
+ * @file espIOTLib_pageWriter.h
+ * @author Paul Schlarmann (paul.schlarmann@makerspace-minden.de)
+ * @brief Streams chunked HTTP responses through a fixed stack buffer
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) Paul Schlarmann 2023
+ *
+ */
+#ifndef ESPIOTLIB_PAGEWRITER_H
+#define ESPIOTLIB_PAGEWRITER_H
+
+// --- Includes ---
+#include <Arduino.h>
+
+#include <IotWebConf.h>
+
+// --- Defines ---
+#ifndef ESP_IOTLIB_PAGE_BUFFER_LEN
+    #define ESP_IOTLIB_PAGE_BUFFER_LEN 256
+#endif
+
+// --- Public Classes ---
+
+/**
+ * @brief Print target that sends a page as chunked transfer encoding.
+ * Output is collected in a fixed buffer and sent with sendContent() whenever it fills up,
+ * so the heap cost of a page does not depend on its size. Meant to live on the stack of a handler:
+ * 
+ *     espIOTLib_pageWriter page(server);
+ *     page.begin(200, "text/html");
+ *     page.print(F("<p>Heap: "));
+ *     page.print(ESP.getFreeHeap());
+ *     page.end();
+ */
+class espIOTLib_pageWriter : public Print
+{
+protected:
+    WebServer *_server;
+    char _buffer[ESP_IOTLIB_PAGE_BUFFER_LEN];
+    size_t _length = 0;
+    bool _started = false;
+
+public:
+    espIOTLib_pageWriter(WebServer *server);
+    ~espIOTLib_pageWriter();
+
+    void begin(int code, const char *contentType);
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t *buffer, size_t size) override;
+    using Print::write;
+    void flush() override;
+    void end();
+
+    // Works on any Print, so template placeholders can use it on their output
+    static void printMAC(Print &out, const uint8_t *mac);
+};
+
+#endif /* ESPIOTLIB_PAGEWRITER_H */
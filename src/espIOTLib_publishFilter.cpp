@@ -0,0 +1,112 @@
+/**
+ * @file espIOTLib_publishFilter.cpp
+ * @author Paul Schlarmann (paul.schlarmann@makerspace-minden.de)
+ * @brief Per-topic change detection, deadband and rate limit for numeric publishes
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) Paul Schlarmann 2023
+ *
+ */
+
+// --- Includes ---
+#include "espIOTLib_publishFilter.h"
+
+// --- Public Functions ---
+uint32_t espIOTLib_topicHash(const char *topic){
+    uint32_t hash = 2166136261UL;
+    while(*topic){
+        hash ^= (uint8_t)*topic++;
+        hash *= 16777619UL;
+    }
+    return hash;
+}
+
+// --- Private Functions ---
+// Hash first, the string compare only runs on a hit
+espIOTLib_publishFilterEntry *espIOTLib_publishFilter::_get(const char *topic){
+    uint32_t hash = espIOTLib_topicHash(topic);
+    for(size_t i = 0; i < this->_count; i++){
+        if(this->_entries[i].topicHash == hash && strcmp(this->_entries[i].topic, topic) == 0)
+            return &this->_entries[i];
+    }
+    if(this->_count >= this->_capacity || strlen(topic) >= ESP_IOTLIB_PUBLISH_FILTER_TOPIC_LEN)
+        return NULL;
+    espIOTLib_publishFilterEntry *entry = &this->_entries[this->_count++];
+    entry->topicHash = hash;
+    strcpy(entry->topic, topic);
+    entry->lastPublish = 0;
+    entry->lastValue = NAN;
+    entry->config = this->_defaultConfig;
+    return entry;
+}
+
+// --- Public Functions ---
+espIOTLib_publishFilter::espIOTLib_publishFilter(size_t capacity, const espIOTLib_publishFilterConfig &defaultConfig){
+    this->_capacity = capacity;
+    this->_defaultConfig = defaultConfig;
+    this->_entries = new espIOTLib_publishFilterEntry[capacity];
+}
+
+espIOTLib_publishFilter::~espIOTLib_publishFilter(){
+    delete[] this->_entries;
+}
+
+bool espIOTLib_publishFilter::configure(const char *topic, const espIOTLib_publishFilterConfig &config){
+    if(!topic)
+        return false;
+    espIOTLib_publishFilterEntry *entry = this->_get(topic);
+    if(!entry)
+        return false;
+    entry->config = config;
+    return true;
+}
+
+bool espIOTLib_publishFilter::check(const char *topic, double value, uint32_t now){
+    espIOTLib_publishFilterEntry *entry = this->_get(topic);
+    if(!entry){
+        // Table full or topic too long, topic is not filtered
+        this->_untracked++;
+        return true;
+    }
+
+    if(!isnan(entry->lastValue)){
+        uint32_t elapsed = now - entry->lastPublish;
+        const espIOTLib_publishFilterConfig &config = entry->config;
+        if(config.maxInterval > 0 && elapsed >= config.maxInterval){
+            this->_heartbeats++;
+        } else if(elapsed < config.minInterval){
+            this->_suppressedRate++;
+            return false;
+        } else {
+            double delta = fabs(value - entry->lastValue);
+            if(delta <= config.absDeadband || delta <= config.relDeadband * fabs(entry->lastValue)){
+                this->_suppressedDeadband++;
+                return false;
+            }
+        }
+    }
+    entry->lastValue = value;
+    entry->lastPublish = now;
+    this->_passed++;
+    return true;
+}
+
+size_t espIOTLib_publishFilter::size(){
+    return this->_count;
+}
+uint32_t espIOTLib_publishFilter::passedCount(){
+    return this->_passed;
+}
+uint32_t espIOTLib_publishFilter::suppressedDeadbandCount(){
+    return this->_suppressedDeadband;
+}
+uint32_t espIOTLib_publishFilter::suppressedRateCount(){
+    return this->_suppressedRate;
+}
+uint32_t espIOTLib_publishFilter::heartbeatCount(){
+    return this->_heartbeats;
+}
+uint32_t espIOTLib_publishFilter::untrackedCount(){
+    return this->_untracked;
+}
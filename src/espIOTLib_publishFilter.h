@@ -0,0 +1,90 @@
+/**
+ * @file espIOTLib_publishFilter.h
+ * @author Paul Schlarmann (paul.schlarmann@makerspace-minden.de)
+ * @brief Per-topic change detection, deadband and rate limit for numeric publishes
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) Paul Schlarmann 2023
+ *
+ */
+#ifndef ESPIOTLIB_PUBLISHFILTER_H
+#define ESPIOTLIB_PUBLISHFILTER_H
+
+// --- Includes ---
+#include <Arduino.h>
+
+// --- Defines ---
+#ifndef ESP_IOTLIB_PUBLISH_FILTER_TOPICS
+    #define ESP_IOTLIB_PUBLISH_FILTER_TOPICS 16
+#endif
+// Longer topics are published unfiltered
+#ifndef ESP_IOTLIB_PUBLISH_FILTER_TOPIC_LEN
+    #define ESP_IOTLIB_PUBLISH_FILTER_TOPIC_LEN 48
+#endif
+
+// --- Typedefs ---
+struct espIOTLib_publishFilterConfig{
+    float absDeadband = 0;      // Suppress if |value - last| <= absDeadband
+    float relDeadband = 0;      // Suppress if |value - last| <= relDeadband * |last|
+    uint32_t minInterval = 0;   // ms, never publish more often than this
+    uint32_t maxInterval = 0;   // ms, publish at least this often even if unchanged, 0 = never
+};
+
+struct espIOTLib_publishFilterEntry{
+    uint32_t topicHash;
+    uint32_t lastPublish;
+    double lastValue;               // Exact for integers up to 2^53
+    espIOTLib_publishFilterConfig config;
+    char topic[ESP_IOTLIB_PUBLISH_FILTER_TOPIC_LEN];
+};
+
+// --- Public Functions ---
+/**
+ * @brief 32 bit FNV-1a hash of a topic, used as compact key for per-topic tables
+ */
+uint32_t espIOTLib_topicHash(const char *topic);
+
+// --- Public Classes ---
+
+/**
+ * @brief Remembers the last published value per topic and decides whether a new one is worth sending.
+ * Values are compared against the last *published* value, so slow drifts still get through once they leave the deadband.
+ */
+class espIOTLib_publishFilter
+{
+protected:
+    espIOTLib_publishFilterEntry *_entries;
+    size_t _capacity;
+    size_t _count = 0;
+    espIOTLib_publishFilterConfig _defaultConfig;
+
+    uint32_t _passed = 0;
+    uint32_t _suppressedDeadband = 0;
+    uint32_t _suppressedRate = 0;
+    uint32_t _heartbeats = 0;
+    uint32_t _untracked = 0;
+
+    espIOTLib_publishFilterEntry *_get(const char *topic);
+
+public:
+    espIOTLib_publishFilter(size_t capacity, const espIOTLib_publishFilterConfig &defaultConfig);
+    ~espIOTLib_publishFilter();
+
+    bool configure(const char *topic, const espIOTLib_publishFilterConfig &config);
+    /**
+     * @brief Check a value and remember it as published if it passes
+     * 
+     * @return true if the value should be published
+     */
+    bool check(const char *topic, double value, uint32_t now);
+
+    size_t size();
+    uint32_t passedCount();
+    uint32_t suppressedDeadbandCount();
+    uint32_t suppressedRateCount();
+    uint32_t heartbeatCount();
+    uint32_t untrackedCount();
+};
+
+#endif /* ESPIOTLIB_PUBLISHFILTER_H */
@@ -0,0 +1,127 @@
+/**
+ * @file espIOTLib_scheduler.cpp
+ * @author Paul Schlarmann (paul.schlarmann@makerspace-minden.de)
+ * @brief Cooperative periodic task scheduler run from espIOTLib::loop()
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) Paul Schlarmann 2023
+ *
+ */
+
+// --- Includes ---
+#include "espIOTLib_scheduler.h"
+
+// --- Defines ---
+#define SCHEDULER_MAX_TASKS 255
+
+// --- Private Functions ---
+// Deadline order that survives the millis() wrap
+bool espIOTLib_scheduler::_before(uint8_t a, uint8_t b){
+    return (int32_t)(this->_tasks[a].nextRun - this->_tasks[b].nextRun) < 0;
+}
+
+void espIOTLib_scheduler::_siftUp(size_t pos){
+    while(pos > 0){
+        size_t parent = (pos - 1) / 2;
+        if(!this->_before(this->_heap[pos], this->_heap[parent]))
+            break;
+        std::swap(this->_heap[pos], this->_heap[parent]);
+        pos = parent;
+    }
+}
+
+void espIOTLib_scheduler::_siftDown(size_t pos){
+    size_t count = this->_heap.size();
+    while(true){
+        size_t smallest = pos;
+        size_t left = 2 * pos + 1;
+        size_t right = left + 1;
+        if(left < count && this->_before(this->_heap[left], this->_heap[smallest]))
+            smallest = left;
+        if(right < count && this->_before(this->_heap[right], this->_heap[smallest]))
+            smallest = right;
+        if(smallest == pos)
+            break;
+        std::swap(this->_heap[pos], this->_heap[smallest]);
+        pos = smallest;
+    }
+}
+
+// --- Public Functions ---
+int espIOTLib_scheduler::add(const char *name, espIOTLibTaskCB callback, uint32_t period, uint32_t phase, uint32_t budget, uint32_t now){
+    if(!callback || period == 0 || this->_tasks.size() >= SCHEDULER_MAX_TASKS)
+        return -1;
+    espIOTLib_task task;
+    task.name = name ? name : "";
+    task.callback = callback;
+    task.period = period;
+    task.budget = budget;
+    task.nextRun = now + phase;
+    this->_tasks.push_back(task);
+    this->_heap.push_back(this->_tasks.size() - 1);
+    this->_siftUp(this->_heap.size() - 1);
+    return this->_tasks.size() - 1;
+}
+
+void espIOTLib_scheduler::setEnabled(int id, bool enabled){
+    if(id >= 0 && (size_t)id < this->_tasks.size())
+        this->_tasks[id].enabled = enabled;
+}
+
+uint8_t espIOTLib_scheduler::run(uint32_t now, uint8_t maxRuns){
+    uint8_t runs = 0;
+    while(runs < maxRuns && !this->_heap.empty()){
+        uint8_t id = this->_heap[0];
+        uint32_t lateness = now - this->_tasks[id].nextRun;
+        if((int32_t)lateness < 0)
+            break;
+        // Take the task out of the heap while it runs, so it may add tasks itself
+        this->_heap[0] = this->_heap.back();
+        this->_heap.pop_back();
+        this->_siftDown(0);
+
+        if(this->_tasks[id].enabled){
+            uint32_t start = micros();
+            this->_tasks[id].callback();
+            uint32_t runtime = micros() - start;
+            espIOTLib_task &task = this->_tasks[id];
+            task.lastRuntime = runtime;
+            task.runs++;
+            if(runtime > task.maxRuntime)
+                task.maxRuntime = runtime;
+            if(task.budget > 0 && runtime > task.budget)
+                task.overruns++;
+            if(lateness > task.maxLateness)
+                task.maxLateness = lateness;
+            task.totalLateness += lateness;
+            runs++;
+        }
+        // Next deadline on the original grid, skipping periods that are already over
+        espIOTLib_task &task = this->_tasks[id];
+        uint32_t missed = lateness / task.period;
+        if(task.enabled)
+            task.skipped += missed;
+        task.nextRun += (missed + 1) * task.period;
+        this->_heap.push_back(id);
+        this->_siftUp(this->_heap.size() - 1);
+    }
+    return runs;
+}
+
+uint32_t espIOTLib_scheduler::timeToNext(uint32_t now){
+    if(this->_heap.empty())
+        return UINT32_MAX;
+    int32_t remaining = this->_tasks[this->_heap[0]].nextRun - now;
+    return remaining > 0 ? remaining : 0;
+}
+
+size_t espIOTLib_scheduler::size(){
+    return this->_tasks.size();
+}
+
+const espIOTLib_task *espIOTLib_scheduler::get(int id){
+    if(id < 0 || (size_t)id >= this->_tasks.size())
+        return NULL;
+    return &this->_tasks[id];
+}
@@ -0,0 +1,88 @@
+/**
+ * @file espIOTLib_scheduler.h
+ * @author Paul Schlarmann (paul.schlarmann@makerspace-minden.de)
+ * @brief Cooperative periodic task scheduler run from espIOTLib::loop()
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) Paul Schlarmann 2023
+ *
+ */
+#ifndef ESPIOTLIB_SCHEDULER_H
+#define ESPIOTLIB_SCHEDULER_H
+
+// --- Includes ---
+#include <Arduino.h>
+#include <vector>
+
+// --- Defines ---
+#ifndef ESP_IOTLIB_SCHEDULER_RUNS_PER_SLOT
+    #define ESP_IOTLIB_SCHEDULER_RUNS_PER_SLOT 2 // Max. tasks run between two pieces of network work
+#endif
+
+// --- Typedefs ---
+typedef void (*espIOTLibTaskCB)(void);
+
+struct espIOTLib_task{
+    const char *name;
+    espIOTLibTaskCB callback;
+    uint32_t period;        // ms
+    uint32_t budget;        // us, 0 = no budget
+    uint32_t nextRun;       // millis() deadline
+    bool enabled = true;
+
+    uint32_t runs = 0;
+    uint32_t overruns = 0;      // Runs that took longer than budget
+    uint32_t skipped = 0;       // Periods missed completely
+    uint32_t lastRuntime = 0;   // us
+    uint32_t maxRuntime = 0;    // us
+    uint32_t maxLateness = 0;   // ms after the deadline the task started
+    uint32_t totalLateness = 0; // ms, for the mean
+};
+
+// --- Public Classes ---
+
+/**
+ * @brief Runs registered tasks in deadline order, kept in a binary min-heap on the next deadline.
+ * Deadlines advance by whole periods from the first one, so intervals do not drift with run time;
+ * a task that fell more than a period behind skips the missed periods instead of running in a burst.
+ */
+class espIOTLib_scheduler
+{
+protected:
+    std::vector<espIOTLib_task> _tasks;
+    std::vector<uint8_t> _heap;
+
+    bool _before(uint8_t a, uint8_t b);
+    void _siftUp(size_t pos);
+    void _siftDown(size_t pos);
+
+public:
+    /**
+     * @brief Register a task
+     * 
+     * @param name Shown on the status page, must stay valid
+     * @param period Interval in ms
+     * @param phase Offset of the first run from now in ms, to spread tasks with equal periods
+     * @param budget Expected max. run time in us, longer runs count as overrun
+     * @return Task id, -1 if the task could not be added
+     */
+    int add(const char *name, espIOTLibTaskCB callback, uint32_t period, uint32_t phase, uint32_t budget, uint32_t now);
+    void setEnabled(int id, bool enabled);
+    /**
+     * @brief Run due tasks
+     * 
+     * @param maxRuns Max. number of tasks to run in this call
+     * @return Number of tasks run
+     */
+    uint8_t run(uint32_t now, uint8_t maxRuns);
+    /**
+     * @brief ms until the next deadline, 0 if one is due
+     */
+    uint32_t timeToNext(uint32_t now);
+
+    size_t size();
+    const espIOTLib_task *get(int id);
+};
+
+#endif /* ESPIOTLIB_SCHEDULER_H */
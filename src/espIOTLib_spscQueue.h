@@ -0,0 +1,98 @@
+/**
+ * @file espIOTLib_spscQueue.h
+ * @author Paul Schlarmann (paul.schlarmann@makerspace-minden.de)
+ * @brief Lock-free single producer / single consumer queue
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) Paul Schlarmann 2023
+ *
+ */
+#ifndef ESPIOTLIB_SPSCQUEUE_H
+#define ESPIOTLIB_SPSCQUEUE_H
+
+// --- Includes ---
+#include <stddef.h>
+#include <atomic>
+
+// --- Public Classes ---
+
+/**
+ * @brief Fixed capacity ring between exactly one producer and one consumer thread.
+ * Slots are filled and read in place (back()/commit(), front()/pop()), so large entries are never copied.
+ * Only depends on <atomic>, so it can be built and benchmarked on a host as well.
+ */
+template <typename T>
+class espIOTLib_spscQueue
+{
+protected:
+    T *_entries;
+    size_t _slots;                  // capacity + 1, one slot always stays free
+    std::atomic<size_t> _head;      // Written by the consumer
+    std::atomic<size_t> _tail;      // Written by the producer
+
+    size_t _next(size_t index){
+        return index + 1 == this->_slots ? 0 : index + 1;
+    }
+
+public:
+    espIOTLib_spscQueue(size_t capacity){
+        this->_slots = (capacity > 0 ? capacity : 1) + 1;
+        this->_entries = new T[this->_slots];
+        this->_head.store(0, std::memory_order_relaxed);
+        this->_tail.store(0, std::memory_order_relaxed);
+    }
+    ~espIOTLib_spscQueue(){
+        delete[] this->_entries;
+    }
+
+        // Producer
+    /**
+     * @brief Free slot to fill, NULL if the queue is full. Becomes visible to the consumer on commit()
+     */
+    T *back(){
+        size_t tail = this->_tail.load(std::memory_order_relaxed);
+        if(this->_next(tail) == this->_head.load(std::memory_order_acquire))
+            return NULL;
+        return &this->_entries[tail];
+    }
+    void commit(){
+        size_t tail = this->_tail.load(std::memory_order_relaxed);
+        this->_tail.store(this->_next(tail), std::memory_order_release);
+    }
+    bool push(const T &value){
+        T *slot = this->back();
+        if(!slot)
+            return false;
+        *slot = value;
+        this->commit();
+        return true;
+    }
+
+        // Consumer
+    /**
+     * @brief Oldest entry, NULL if the queue is empty. Stays valid until pop()
+     */
+    T *front(){
+        size_t head = this->_head.load(std::memory_order_relaxed);
+        if(head == this->_tail.load(std::memory_order_acquire))
+            return NULL;
+        return &this->_entries[head];
+    }
+    void pop(){
+        size_t head = this->_head.load(std::memory_order_relaxed);
+        this->_head.store(this->_next(head), std::memory_order_release);
+    }
+
+        // Either side, only a snapshot while the other side is running
+    size_t size(){
+        size_t head = this->_head.load(std::memory_order_acquire);
+        size_t tail = this->_tail.load(std::memory_order_acquire);
+        return tail >= head ? tail - head : tail + this->_slots - head;
+    }
+    size_t capacity(){
+        return this->_slots - 1;
+    }
+};
+
+#endif /* ESPIOTLIB_SPSCQUEUE_H */
@@ -0,0 +1,259 @@
+/**
+ * @file espIOTLib_tcpProbe.cpp
+ * @author Paul Schlarmann (paul.schlarmann@makerspace-minden.de)
+ * @brief Non-blocking check whether a host accepts TCP connections
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) Paul Schlarmann 2023
+ *
+ */
+
+// --- Includes ---
+#include "espIOTLib_tcpProbe.h"
+
+#include <lwip/dns.h>
+#ifdef ESP8266
+#include <lwip/tcp.h>
+#include <include/ClientContext.h>
+#elif defined(ESP32)
+#include <lwip/sockets.h>
+#include <lwip/tcpip.h>
+#endif
+
+// --- Private Classes ---
+#ifdef ESP8266
+// WiFiClient only wraps a ClientContext for WiFiServer and subclasses
+class espIOTLib_heldClient : public WiFiClient
+{
+public:
+    explicit espIOTLib_heldClient(ClientContext *context) : WiFiClient(context) {}
+};
+#endif
+
+// --- Private Functions ---
+// DNS answer, ESP8266 between two loop() calls, ESP32 on the lwIP thread
+void espIOTLib_tcpProbe::_resolved(const char *name, const ip_addr_t *address, void *arg){
+    espIOTLib_tcpProbe *probe = (espIOTLib_tcpProbe *)arg;
+    // Late answer for a probe that timed out or was started again for another host
+    if(probe->_state.load() != ESP_IOTLIB_PROBE_RESOLVING || !name || strcmp(name, probe->_host) != 0)
+        return;
+    uint8_t expected = ESP_IOTLIB_PROBE_RESOLVING;
+    if(!address){
+        probe->_state.compare_exchange_strong(expected, ESP_IOTLIB_PROBE_FAILED);
+        return;
+    }
+    probe->_ip = IPAddress(ip4_addr_get_u32(ip_2_ip4(address)));
+    // The connect itself is started by poll()
+    probe->_state.compare_exchange_strong(expected, ESP_IOTLIB_PROBE_CONNECTING);
+}
+
+// ESP32: lwIP's raw API may only be used on its own thread, so this runs through tcpip_callback()
+void espIOTLib_tcpProbe::_resolve(void *arg){
+    espIOTLib_tcpProbe *probe = (espIOTLib_tcpProbe *)arg;
+    ip_addr_t address;
+    err_t result = dns_gethostbyname(probe->_host, &address, &espIOTLib_tcpProbe::_resolved, probe);
+    if(result == ERR_OK){
+        // Cached, the callback is not called then
+        _resolved(probe->_host, &address, probe);
+    } else if(result != ERR_INPROGRESS){
+        _resolved(probe->_host, NULL, probe);
+    }
+}
+
+#ifdef ESP8266
+err_t espIOTLib_tcpProbe::_connected(void *arg, struct tcp_pcb *pcb, err_t error){
+    espIOTLib_tcpProbe *probe = (espIOTLib_tcpProbe *)arg;
+    if(error == ERR_OK && probe->_keepOpen){
+        // Held for attach(), the error callback stays in place
+        tcp_recv(pcb, &espIOTLib_tcpProbe::_received);
+        probe->_state.store(ESP_IOTLIB_PROBE_REACHABLE);
+        return ERR_OK;
+    }
+    tcp_arg(pcb, NULL);
+    tcp_err(pcb, NULL);
+    probe->_pcb = NULL;
+    probe->_state.store(error == ERR_OK ? ESP_IOTLIB_PROBE_REACHABLE : ESP_IOTLIB_PROBE_FAILED);
+    // Only the handshake was needed
+    if(tcp_close(pcb) != ERR_OK){
+        tcp_abort(pcb);
+        return ERR_ABRT;
+    }
+    return ERR_OK;
+}
+
+// Data or FIN before attach(), the peer did not wait for us to speak first
+err_t espIOTLib_tcpProbe::_received(void *arg, struct tcp_pcb *, struct pbuf *data, err_t){
+    espIOTLib_tcpProbe *probe = (espIOTLib_tcpProbe *)arg;
+    if(data)
+        pbuf_free(data);
+    probe->_close();
+    probe->_state.store(ESP_IOTLIB_PROBE_FAILED);
+    return ERR_ABRT;
+}
+
+// Refused, reset or timed out by lwIP, the pcb is already freed
+void espIOTLib_tcpProbe::_error(void *arg, err_t){
+    espIOTLib_tcpProbe *probe = (espIOTLib_tcpProbe *)arg;
+    probe->_pcb = NULL;
+    probe->_state.store(ESP_IOTLIB_PROBE_FAILED);
+}
+#endif
+
+void espIOTLib_tcpProbe::_connect(){
+#ifdef ESP8266
+    this->_pcb = tcp_new();
+    if(!this->_pcb){
+        this->_state.store(ESP_IOTLIB_PROBE_FAILED);
+        return;
+    }
+    tcp_arg(this->_pcb, this);
+    tcp_err(this->_pcb, &espIOTLib_tcpProbe::_error);
+    ip_addr_t address;
+    IP_ADDR4(&address, this->_ip[0], this->_ip[1], this->_ip[2], this->_ip[3]);
+    if(tcp_connect(this->_pcb, &address, this->_port, &espIOTLib_tcpProbe::_connected) != ERR_OK){
+        this->_close();
+        this->_state.store(ESP_IOTLIB_PROBE_FAILED);
+        return;
+    }
+#elif defined(ESP32)
+    this->_fd = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if(this->_fd < 0){
+        this->_state.store(ESP_IOTLIB_PROBE_FAILED);
+        return;
+    }
+    fcntl(this->_fd, F_SETFL, fcntl(this->_fd, F_GETFL, 0) | O_NONBLOCK);
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(this->_port);
+    address.sin_addr.s_addr = (uint32_t)this->_ip;
+    if(connect(this->_fd, (struct sockaddr *)&address, sizeof(address)) < 0 && errno != EINPROGRESS){
+        this->_close();
+        this->_state.store(ESP_IOTLIB_PROBE_FAILED);
+        return;
+    }
+#endif
+    this->_state.store(ESP_IOTLIB_PROBE_CONNECTING);
+}
+
+void espIOTLib_tcpProbe::_close(){
+#ifdef ESP8266
+    if(this->_pcb){
+        tcp_arg(this->_pcb, NULL);
+        tcp_err(this->_pcb, NULL);
+        tcp_abort(this->_pcb);
+        this->_pcb = NULL;
+    }
+#elif defined(ESP32)
+    if(this->_fd >= 0){
+        close(this->_fd);
+        this->_fd = -1;
+    }
+#endif
+}
+
+// --- Public Functions ---
+espIOTLib_tcpProbe::espIOTLib_tcpProbe(){
+    this->_state.store(ESP_IOTLIB_PROBE_IDLE);
+    this->_host[0] = '\0';
+}
+
+espIOTLib_tcpProbe::~espIOTLib_tcpProbe(){
+    this->_close();
+}
+
+bool espIOTLib_tcpProbe::start(const char *host, uint16_t port, uint32_t timeout, uint32_t now, bool keepOpen){
+    this->cancel();
+    this->_keepOpen = keepOpen;
+    this->_port = port;
+    this->_start = now;
+    this->_timeout = timeout;
+    if(!host || strlen(host) >= ESP_IOTLIB_PROBE_HOST_LEN){
+        this->_state.store(ESP_IOTLIB_PROBE_FAILED);
+        return false;
+    }
+    strcpy(this->_host, host);
+    // IP literals skip DNS
+    if(this->_ip.fromString(host)){
+        this->_connect();
+        return this->_state.load() != ESP_IOTLIB_PROBE_FAILED;
+    }
+    this->_state.store(ESP_IOTLIB_PROBE_RESOLVING);
+#ifdef ESP8266
+    _resolve(this);
+#elif defined(ESP32)
+    if(tcpip_callback(&espIOTLib_tcpProbe::_resolve, this) != ERR_OK)
+        this->_state.store(ESP_IOTLIB_PROBE_FAILED);
+#endif
+    return this->_state.load() != ESP_IOTLIB_PROBE_FAILED;
+}
+
+espIOTLib_probeState espIOTLib_tcpProbe::poll(uint32_t now){
+    uint8_t state = this->_state.load();
+    if(state != ESP_IOTLIB_PROBE_RESOLVING && state != ESP_IOTLIB_PROBE_CONNECTING)
+        return (espIOTLib_probeState)state;
+#ifdef ESP8266
+    // Resolved since the last call
+    if(state == ESP_IOTLIB_PROBE_CONNECTING && !this->_pcb)
+        this->_connect();
+#elif defined(ESP32)
+    if(state == ESP_IOTLIB_PROBE_CONNECTING && this->_fd < 0){
+        this->_connect();
+    } else if(state == ESP_IOTLIB_PROBE_CONNECTING){
+        // Writable once the handshake is done, SO_ERROR tells whether it succeeded
+        fd_set writable;
+        FD_ZERO(&writable);
+        FD_SET(this->_fd, &writable);
+        struct timeval noWait = {0, 0};
+        if(select(this->_fd + 1, NULL, &writable, NULL, &noWait) > 0){
+            int error = 0;
+            socklen_t length = sizeof(error);
+            getsockopt(this->_fd, SOL_SOCKET, SO_ERROR, &error, &length);
+            if(error != 0 || !this->_keepOpen)
+                this->_close();
+            this->_state.store(error == 0 ? ESP_IOTLIB_PROBE_REACHABLE : ESP_IOTLIB_PROBE_FAILED);
+        }
+    }
+#endif
+    state = this->_state.load();
+    if((state == ESP_IOTLIB_PROBE_RESOLVING || state == ESP_IOTLIB_PROBE_CONNECTING) && now - this->_start >= this->_timeout){
+        this->_close();
+        this->_state.store(ESP_IOTLIB_PROBE_FAILED);
+        state = ESP_IOTLIB_PROBE_FAILED;
+    }
+    return (espIOTLib_probeState)state;
+}
+
+bool espIOTLib_tcpProbe::attach(WiFiClient &client){
+    if(this->_state.load() != ESP_IOTLIB_PROBE_REACHABLE)
+        return false;
+#ifdef ESP8266
+    if(!this->_pcb)
+        return false;
+    tcp_arg(this->_pcb, NULL);
+    tcp_err(this->_pcb, NULL);
+    tcp_recv(this->_pcb, NULL);
+    // Sets its own callbacks on the pcb and frees it when the last client lets go
+    client = espIOTLib_heldClient(new ClientContext(this->_pcb, nullptr, nullptr));
+    this->_pcb = NULL;
+#elif defined(ESP32)
+    if(this->_fd < 0)
+        return false;
+    // WiFiClient expects a blocking socket
+    fcntl(this->_fd, F_SETFL, fcntl(this->_fd, F_GETFL, 0) & ~O_NONBLOCK);
+    client = WiFiClient(this->_fd);
+    this->_fd = -1;
+#endif
+    this->_state.store(ESP_IOTLIB_PROBE_IDLE);
+    return true;
+}
+
+void espIOTLib_tcpProbe::cancel(){
+    this->_close();
+    this->_state.store(ESP_IOTLIB_PROBE_IDLE);
+}
+
+espIOTLib_probeState espIOTLib_tcpProbe::state(){
+    return (espIOTLib_probeState)this->_state.load();
+}
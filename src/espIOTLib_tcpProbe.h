@@ -0,0 +1,100 @@
+/**
+ * @file espIOTLib_tcpProbe.h
+ * @author Paul Schlarmann (paul.schlarmann@makerspace-minden.de)
+ * @brief Non-blocking check whether a host accepts TCP connections
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) Paul Schlarmann 2023
+ *
+ */
+#ifndef ESPIOTLIB_TCPPROBE_H
+#define ESPIOTLIB_TCPPROBE_H
+
+// --- Includes ---
+#include <Arduino.h>
+#include <WiFiClient.h>
+
+#include <atomic>
+#include <lwip/err.h>
+#include <lwip/ip_addr.h>
+
+// --- Defines ---
+#ifndef ESP_IOTLIB_PROBE_HOST_LEN
+    #define ESP_IOTLIB_PROBE_HOST_LEN 64
+#endif
+
+// --- Typedefs ---
+typedef enum {
+    ESP_IOTLIB_PROBE_IDLE = 0,
+    ESP_IOTLIB_PROBE_RESOLVING,
+    ESP_IOTLIB_PROBE_CONNECTING,
+    ESP_IOTLIB_PROBE_REACHABLE,
+    ESP_IOTLIB_PROBE_FAILED
+} espIOTLib_probeState;
+
+struct tcp_pcb;
+struct pbuf;
+
+// --- Public Classes ---
+
+/**
+ * @brief Resolves a host and opens a TCP connection to it without ever waiting, the connection is closed again
+ * as soon as it is established unless it is kept open for attach(). start() only sends the requests, poll() picks up the results.
+ * The lwIP callbacks of the ESP8266 run between two loop() calls; on ESP32 DNS runs on the lwIP thread and the connect
+ * is a non-blocking socket, so the state is atomic.
+ */
+class espIOTLib_tcpProbe
+{
+protected:
+    std::atomic<uint8_t> _state;
+    char _host[ESP_IOTLIB_PROBE_HOST_LEN];
+    uint16_t _port = 0;
+    IPAddress _ip;
+    uint32_t _start = 0;
+    uint32_t _timeout = 0;
+    bool _keepOpen = false;
+#ifdef ESP8266
+    struct tcp_pcb *_pcb = NULL;
+#elif defined(ESP32)
+    int _fd = -1;
+#endif
+
+    static void _resolved(const char *name, const ip_addr_t *address, void *arg);
+    static void _resolve(void *arg);
+#ifdef ESP8266
+    static err_t _connected(void *arg, struct tcp_pcb *pcb, err_t error);
+    static err_t _received(void *arg, struct tcp_pcb *pcb, struct pbuf *data, err_t error);
+    static void _error(void *arg, err_t error);
+#endif
+    void _connect();
+    void _close();
+
+public:
+    espIOTLib_tcpProbe();
+    ~espIOTLib_tcpProbe();
+
+    /**
+     * @brief Start a new probe, a running one is cancelled
+     *
+     * @param timeout ms for DNS and connect together
+     * @param keepOpen keep the connection once REACHABLE, until attach() takes it or cancel() closes it
+     * @return false if host is too long or no request could be sent, the state is ESP_IOTLIB_PROBE_FAILED then
+     */
+    bool start(const char *host, uint16_t port, uint32_t timeout, uint32_t now, bool keepOpen = false);
+    /**
+     * @brief Advance the probe, REACHABLE and FAILED stay until the next start() or cancel()
+     */
+    espIOTLib_probeState poll(uint32_t now);
+    /**
+     * @brief Hand a connection kept open by start() over to client, like WiFiServer does with an accepted one.
+     * The probe is IDLE afterwards
+     *
+     * @return false if the probe is not REACHABLE with an open connection
+     */
+    bool attach(WiFiClient &client);
+    void cancel();
+    espIOTLib_probeState state();
+};
+
+#endif /* ESPIOTLIB_TCPPROBE_H */
@@ -0,0 +1,58 @@
+/**
+ * @file espIOTLib_template.cpp
+ * @author Paul Schlarmann (paul.schlarmann@makerspace-minden.de)
+ * @brief Streams PROGMEM page templates with {{placeholder}} markers
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) Paul Schlarmann 2023
+ *
+ */
+
+// --- Includes ---
+#include "espIOTLib_template.h"
+
+// --- Public Functions ---
+size_t espIOTLib_renderTemplate(Print &out, PGM_P tmpl, const espIOTLibTemplateCB &callback){
+    char chunk[ESP_IOTLIB_TEMPLATE_CHUNK];
+    char name[ESP_IOTLIB_TEMPLATE_NAME_LEN + 1];
+    size_t length = 0;
+    size_t placeholders = 0;
+    PGM_P p = tmpl;
+    char c = pgm_read_byte(p);
+    while(c != '\0'){
+        if(c == '{' && pgm_read_byte(p + 1) == '{'){
+            // Look for the closing braces, no nesting and no line breaks
+            size_t nameLength = 0;
+            PGM_P end = p + 2;
+            char n = pgm_read_byte(end);
+            while(n != '\0' && n != '}' && n != '{' && n != '\n' && nameLength < ESP_IOTLIB_TEMPLATE_NAME_LEN){
+                name[nameLength++] = n;
+                n = pgm_read_byte(++end);
+            }
+            if(n == '}' && pgm_read_byte(end + 1) == '}' && nameLength > 0){
+                if(length > 0){
+                    out.write((const uint8_t *)chunk, length);
+                    length = 0;
+                }
+                name[nameLength] = '\0';
+                if(callback)
+                    callback(out, name);
+                placeholders++;
+                p = end + 2;
+                c = pgm_read_byte(p);
+                continue;
+            }
+        }
+        // Not a placeholder, plain text
+        chunk[length++] = c;
+        if(length >= ESP_IOTLIB_TEMPLATE_CHUNK){
+            out.write((const uint8_t *)chunk, length);
+            length = 0;
+        }
+        c = pgm_read_byte(++p);
+    }
+    if(length > 0)
+        out.write((const uint8_t *)chunk, length);
+    return placeholders;
+}
@@ -0,0 +1,52 @@
+/**
+ * @file espIOTLib_template.h
+ * @author Paul Schlarmann (paul.schlarmann@makerspace-minden.de)
+ * @brief Streams PROGMEM page templates with {{placeholder}} markers
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) Paul Schlarmann 2023
+ *
+ */
+#ifndef ESPIOTLIB_TEMPLATE_H
+#define ESPIOTLIB_TEMPLATE_H
+
+// --- Includes ---
+#include <Arduino.h>
+
+#include <functional>
+
+// --- Defines ---
+// Literal text is copied out of flash in pieces of this size, on the stack
+#ifndef ESP_IOTLIB_TEMPLATE_CHUNK
+    #define ESP_IOTLIB_TEMPLATE_CHUNK 64
+#endif
+// Longer names are not taken as placeholder and sent as they are
+#ifndef ESP_IOTLIB_TEMPLATE_NAME_LEN
+    #define ESP_IOTLIB_TEMPLATE_NAME_LEN 24
+#endif
+
+// --- Typedefs ---
+/**
+ * @brief Prints the value of placeholder name to out, unknown names can print nothing
+ */
+typedef std::function<void(Print &out, const char *name)> espIOTLibTemplateCB;
+
+// --- Public Functions ---
+
+/**
+ * @brief Render a template from flash. The text between the placeholders is copied to out in
+ * ESP_IOTLIB_TEMPLATE_CHUNK pieces, for every {{name}} the callback prints the value in its place.
+ * Neither the template nor the page is ever held in RAM, with an espIOTLib_pageWriter as out
+ * the page goes to the client in ESP_IOTLIB_PAGE_BUFFER_LEN chunks:
+ *
+ *     static const char PAGE[] PROGMEM = "<p>Heap: {{heap}} B</p>";
+ *     espIOTLib_renderTemplate(page, PAGE, [](Print &out, const char *name){ out.print(ESP.getFreeHeap()); });
+ *
+ * @param tmpl PROGMEM string
+ * @param callback May be empty, placeholders are dropped then
+ * @return Number of placeholders
+ */
+size_t espIOTLib_renderTemplate(Print &out, PGM_P tmpl, const espIOTLibTemplateCB &callback);
+
+#endif /* ESPIOTLIB_TEMPLATE_H */
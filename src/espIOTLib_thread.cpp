@@ -0,0 +1,75 @@
+/**
+ * @file espIOTLib_thread.cpp
+ * @author Paul Schlarmann (paul.schlarmann@makerspace-minden.de)
+ * @brief Minimal thread start/yield shim: FreeRTOS tasks on ESP32, std::thread on a host
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) Paul Schlarmann 2023
+ *
+ */
+
+// --- Includes ---
+#include "espIOTLib_thread.h"
+
+#if defined(ARDUINO)
+#include <Arduino.h>
+#else
+#include <thread>
+#include <chrono>
+#include <functional>
+#endif
+
+// --- Public Functions ---
+#if defined(ESP32)
+bool espIOTLib_startThread(const char *name, espIOTLibThreadFn fn, void *arg, uint32_t stackSize, uint8_t priority, int core){
+    BaseType_t result;
+    if(core < 0)
+        result = xTaskCreate(fn, name, stackSize, arg, priority, NULL);
+    else
+        result = xTaskCreatePinnedToCore(fn, name, stackSize, arg, priority, NULL, core);
+    return result == pdPASS;
+}
+
+void espIOTLib_threadSleep(uint32_t ms){
+    // vTaskDelay(0) would not let lower priority tasks (e.g. the idle task feeding the watchdog) run
+    vTaskDelay(ms > 0 ? pdMS_TO_TICKS(ms) : 1);
+}
+
+uintptr_t espIOTLib_threadId(){
+    return (uintptr_t)xTaskGetCurrentTaskHandle();
+}
+
+#elif !defined(ARDUINO)
+bool espIOTLib_startThread(const char *name, espIOTLibThreadFn fn, void *arg, uint32_t stackSize, uint8_t priority, int core){
+    (void)name; (void)stackSize; (void)priority; (void)core;
+    std::thread(fn, arg).detach();
+    return true;
+}
+
+void espIOTLib_threadSleep(uint32_t ms){
+    if(ms > 0)
+        std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+    else
+        std::this_thread::yield();
+}
+
+uintptr_t espIOTLib_threadId(){
+    return std::hash<std::thread::id>()(std::this_thread::get_id());
+}
+
+#else
+// ESP8266 and other single threaded cores
+bool espIOTLib_startThread(const char *name, espIOTLibThreadFn fn, void *arg, uint32_t stackSize, uint8_t priority, int core){
+    (void)name; (void)fn; (void)arg; (void)stackSize; (void)priority; (void)core;
+    return false;
+}
+
+void espIOTLib_threadSleep(uint32_t ms){
+    delay(ms);
+}
+
+uintptr_t espIOTLib_threadId(){
+    return 0;
+}
+#endif
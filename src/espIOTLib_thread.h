@@ -0,0 +1,39 @@
+/**
+ * @file espIOTLib_thread.h
+ * @author Paul Schlarmann (paul.schlarmann@makerspace-minden.de)
+ * @brief Minimal thread start/yield shim: FreeRTOS tasks on ESP32, std::thread on a host
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) Paul Schlarmann 2023
+ *
+ */
+#ifndef ESPIOTLIB_THREAD_H
+#define ESPIOTLIB_THREAD_H
+
+// --- Includes ---
+#include <stdint.h>
+
+// --- Typedefs ---
+typedef void (*espIOTLibThreadFn)(void *arg);
+
+// --- Public Functions ---
+/**
+ * @brief Start fn(arg) on its own thread, which is never joined
+ * 
+ * @param core Core to pin to on ESP32, -1 for any. Ignored on the host
+ * @param stackSize Stack in bytes, ignored on the host
+ * @param priority FreeRTOS priority, ignored on the host
+ * @return false if threads are not supported (ESP8266) or the thread could not be created
+ */
+bool espIOTLib_startThread(const char *name, espIOTLibThreadFn fn, void *arg, uint32_t stackSize, uint8_t priority, int core);
+/**
+ * @brief Give other threads on this core a chance to run
+ */
+void espIOTLib_threadSleep(uint32_t ms);
+/**
+ * @brief Identifies the calling thread, 0 on single threaded cores
+ */
+uintptr_t espIOTLib_threadId();
+
+#endif /* ESPIOTLIB_THREAD_H */
@@ -0,0 +1,220 @@
+/**
+ * @file espIOTLib_timeSeries.cpp
+ * @author Paul Schlarmann (paul.schlarmann@makerspace-minden.de)
+ * @brief Fixed memory history of numeric readings with min/max/avg rollups
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) Paul Schlarmann 2023
+ *
+ */
+
+// --- Includes ---
+#include "espIOTLib_timeSeries.h"
+#include "espIOTLib_publishFilter.h"
+#include "espIOTLib_format.h"
+
+// --- Defines ---
+#define TS_VALUE_PRECISION 3
+#define TS_NUMBER_BUFFER_LEN 24
+
+// --- Private Functions ---
+static void tsTopic(Print &out, const char *topic, espIOTLib_timeSeriesFormat format){
+    if(format == ESP_IOTLIB_TS_CSV){
+        out.print(topic);
+        return;
+    }
+    out.print('"');
+    for(const char *c = topic; *c; c++){
+        if(*c == '"' || *c == '\\')
+            out.print('\\');
+        out.print(*c);
+    }
+    out.print('"');
+}
+
+espIOTLib_tsSeries *espIOTLib_timeSeries::_get(const char *topic, bool create){
+    uint32_t hash = espIOTLib_topicHash(topic);
+    for(size_t i = 0; i < this->_count; i++){
+        if(this->_series[i]->topicHash == hash && strcmp(this->_series[i]->topic, topic) == 0)
+            return this->_series[i];
+    }
+    if(!create || this->_count >= this->_capacity || strlen(topic) >= ESP_IOTLIB_TS_TOPIC_LEN)
+        return NULL;
+    espIOTLib_tsSeries *series = new espIOTLib_tsSeries();
+    if(!series)
+        return NULL;
+    series->topicHash = hash;
+    strcpy(series->topic, topic);
+    // Only visible to write() once it is complete
+    this->_series[this->_count] = series;
+    this->_count++;
+    return series;
+}
+
+// Buckets are aligned to multiples of the period, gaps without readings simply have no bucket
+void espIOTLib_timeSeries::_rollup(espIOTLib_tsRollup *rollup, uint32_t period, uint32_t now, float value){
+    uint32_t start = now - now % period;
+    espIOTLib_tsBucket *bucket = &rollup->buckets[rollup->head];
+    if(rollup->count == 0 || bucket->start != start){
+        if(rollup->count > 0)
+            rollup->head = (rollup->head + 1) % ESP_IOTLIB_TS_ROLLUP_BUCKETS;
+        if(rollup->count < ESP_IOTLIB_TS_ROLLUP_BUCKETS)
+            rollup->count++;
+        bucket = &rollup->buckets[rollup->head];
+        bucket->start = start;
+        bucket->min = value;
+        bucket->max = value;
+        bucket->sum = 0;
+        bucket->count = 0;
+    }
+    if(value < bucket->min)
+        bucket->min = value;
+    if(value > bucket->max)
+        bucket->max = value;
+    bucket->sum += value;
+    bucket->count++;
+}
+
+void espIOTLib_timeSeries::_value(Print &out, float value){
+    char buffer[TS_NUMBER_BUFFER_LEN];
+    size_t length = espIOTLib_formatFloat(buffer, TS_NUMBER_BUFFER_LEN, value, TS_VALUE_PRECISION);
+    out.write((const uint8_t *)buffer, length);
+}
+
+// --- Public Functions ---
+espIOTLib_timeSeries::espIOTLib_timeSeries(size_t capacity){
+    this->_capacity = capacity;
+    this->_series = new espIOTLib_tsSeries*[capacity];
+}
+
+espIOTLib_timeSeries::~espIOTLib_timeSeries(){
+    for(size_t i = 0; i < this->_count; i++)
+        delete this->_series[i];
+    delete[] this->_series;
+}
+
+bool espIOTLib_timeSeries::record(const char *topic, float value, uint32_t now){
+    if(!topic || !isfinite(value))
+        return false;
+    espIOTLib_tsSeries *series = this->_get(topic, true);
+    if(!series){
+        this->_untracked++;
+        return false;
+    }
+    espIOTLib_tsSample *sample = &series->raw[series->rawHead];
+    sample->time = now;
+    sample->value = value;
+    series->rawHead = (series->rawHead + 1) % ESP_IOTLIB_TS_RAW_SAMPLES;
+    if(series->rawCount < ESP_IOTLIB_TS_RAW_SAMPLES)
+        series->rawCount++;
+    for(uint8_t level = 1; level < ESP_IOTLIB_TS_LEVELS; level++)
+        this->_rollup(&series->rollups[level - 1], espIOTLib_timeSeries::levelPeriod(level), now, value);
+    this->_recorded++;
+    return true;
+}
+
+// Times are written as age in ms relative to now, so the output does not depend on the device clock
+bool espIOTLib_timeSeries::write(Print &out, const char *topic, uint8_t level, espIOTLib_timeSeriesFormat format, uint32_t now){
+    if(!topic || level >= ESP_IOTLIB_TS_LEVELS)
+        return false;
+    espIOTLib_tsSeries *series = this->_get(topic, false);
+    if(!series)
+        return false;
+    bool json = format == ESP_IOTLIB_TS_JSON;
+    if(json){
+        out.print(F("{\"topic\":"));
+        tsTopic(out, series->topic, format);
+        out.print(F(",\"period\":"));
+        out.print(espIOTLib_timeSeries::levelPeriod(level));
+        out.print(level == 0 ? F(",\"columns\":[\"age_ms\",\"value\"],\"data\":[") : F(",\"columns\":[\"age_ms\",\"min\",\"max\",\"avg\",\"count\"],\"data\":["));
+    } else {
+        out.print(level == 0 ? F("age_ms,value\n") : F("age_ms,min,max,avg,count\n"));
+    }
+
+    if(level == 0){
+        uint16_t count = series->rawCount;
+        uint16_t first = (series->rawHead + ESP_IOTLIB_TS_RAW_SAMPLES - count) % ESP_IOTLIB_TS_RAW_SAMPLES;
+        for(uint16_t i = 0; i < count; i++){
+            const espIOTLib_tsSample *sample = &series->raw[(first + i) % ESP_IOTLIB_TS_RAW_SAMPLES];
+            if(json)
+                out.print(i == 0 ? F("[") : F(",["));
+            out.print(now - sample->time);
+            out.print(',');
+            this->_value(out, sample->value);
+            out.print(json ? F("]") : F("\n"));
+        }
+    } else {
+        const espIOTLib_tsRollup *rollup = &series->rollups[level - 1];
+        uint16_t count = rollup->count;
+        uint16_t first = (rollup->head + 1 + ESP_IOTLIB_TS_ROLLUP_BUCKETS - count) % ESP_IOTLIB_TS_ROLLUP_BUCKETS;
+        for(uint16_t i = 0; i < count; i++){
+            const espIOTLib_tsBucket *bucket = &rollup->buckets[(first + i) % ESP_IOTLIB_TS_ROLLUP_BUCKETS];
+            if(json)
+                out.print(i == 0 ? F("[") : F(",["));
+            out.print(now - bucket->start);
+            out.print(',');
+            this->_value(out, bucket->min);
+            out.print(',');
+            this->_value(out, bucket->max);
+            out.print(',');
+            this->_value(out, bucket->count > 0 ? bucket->sum / bucket->count : 0);
+            out.print(',');
+            out.print(bucket->count);
+            out.print(json ? F("]") : F("\n"));
+        }
+    }
+    if(json)
+        out.print(F("]}\n"));
+    return true;
+}
+
+void espIOTLib_timeSeries::writeIndex(Print &out, espIOTLib_timeSeriesFormat format){
+    bool json = format == ESP_IOTLIB_TS_JSON;
+    out.print(json ? F("{\"series\":[") : F("topic,raw,rollup1,rollup2\n"));
+    for(size_t i = 0; i < this->_count; i++){
+        const espIOTLib_tsSeries *series = this->_series[i];
+        if(json)
+            out.print(i == 0 ? F("{\"topic\":") : F(",{\"topic\":"));
+        tsTopic(out, series->topic, format);
+        out.print(json ? F(",\"samples\":[") : F(","));
+        out.print(series->rawCount);
+        for(uint8_t level = 1; level < ESP_IOTLIB_TS_LEVELS; level++){
+            out.print(',');
+            out.print(series->rollups[level - 1].count);
+        }
+        out.print(json ? F("]}") : F("\n"));
+    }
+    if(json){
+        out.print(F("],\"periods\":["));
+        for(uint8_t level = 0; level < ESP_IOTLIB_TS_LEVELS; level++){
+            if(level > 0)
+                out.print(',');
+            out.print(espIOTLib_timeSeries::levelPeriod(level));
+        }
+        out.print(F("]}\n"));
+    }
+}
+
+bool espIOTLib_timeSeries::contains(const char *topic){
+    return topic && this->_get(topic, false);
+}
+uint32_t espIOTLib_timeSeries::levelPeriod(uint8_t level){
+    switch(level){
+        case 1: return ESP_IOTLIB_TS_ROLLUP1_PERIOD;
+        case 2: return ESP_IOTLIB_TS_ROLLUP2_PERIOD;
+        default: return 0;
+    }
+}
+size_t espIOTLib_timeSeries::size(){
+    return this->_count;
+}
+size_t espIOTLib_timeSeries::capacity(){
+    return this->_capacity;
+}
+uint32_t espIOTLib_timeSeries::recordedCount(){
+    return this->_recorded;
+}
+uint32_t espIOTLib_timeSeries::untrackedCount(){
+    return this->_untracked;
+}
@@ -0,0 +1,122 @@
+/**
+ * @file espIOTLib_timeSeries.h
+ * @author Paul Schlarmann (paul.schlarmann@makerspace-minden.de)
+ * @brief Fixed memory history of numeric readings with min/max/avg rollups
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) Paul Schlarmann 2023
+ *
+ */
+#ifndef ESPIOTLIB_TIMESERIES_H
+#define ESPIOTLIB_TIMESERIES_H
+
+// --- Includes ---
+#include <Arduino.h>
+
+// --- Defines ---
+#ifndef ESP_IOTLIB_TS_SERIES
+    #define ESP_IOTLIB_TS_SERIES 4
+#endif
+#ifndef ESP_IOTLIB_TS_TOPIC_LEN
+    #define ESP_IOTLIB_TS_TOPIC_LEN 48
+#endif
+#ifndef ESP_IOTLIB_TS_RAW_SAMPLES
+    #define ESP_IOTLIB_TS_RAW_SAMPLES 60
+#endif
+#ifndef ESP_IOTLIB_TS_ROLLUP_BUCKETS
+    #define ESP_IOTLIB_TS_ROLLUP_BUCKETS 60
+#endif
+// Bucket width of the rollup levels, the defaults keep 1 h in 1 min and 15 h in 15 min buckets
+#ifndef ESP_IOTLIB_TS_ROLLUP1_PERIOD
+    #define ESP_IOTLIB_TS_ROLLUP1_PERIOD 60000
+#endif
+#ifndef ESP_IOTLIB_TS_ROLLUP2_PERIOD
+    #define ESP_IOTLIB_TS_ROLLUP2_PERIOD 900000
+#endif
+#define ESP_IOTLIB_TS_LEVELS 3 // Raw + 2 rollups
+
+// --- Typedefs ---
+typedef enum {
+    ESP_IOTLIB_TS_CSV = 0,
+    ESP_IOTLIB_TS_JSON
+} espIOTLib_timeSeriesFormat;
+
+struct espIOTLib_tsSample{
+    uint32_t time;
+    float value;
+};
+
+struct espIOTLib_tsBucket{
+    uint32_t start;
+    float min;
+    float max;
+    float sum;
+    uint32_t count;
+};
+
+struct espIOTLib_tsRollup{
+    espIOTLib_tsBucket buckets[ESP_IOTLIB_TS_ROLLUP_BUCKETS];
+    uint16_t head = 0;  // Index of the newest bucket
+    uint16_t count = 0;
+};
+
+struct espIOTLib_tsSeries{
+    uint32_t topicHash;
+    char topic[ESP_IOTLIB_TS_TOPIC_LEN];
+    espIOTLib_tsSample raw[ESP_IOTLIB_TS_RAW_SAMPLES];
+    uint16_t rawHead = 0;   // Index of the next raw sample
+    uint16_t rawCount = 0;
+    espIOTLib_tsRollup rollups[ESP_IOTLIB_TS_LEVELS - 1];
+};
+
+// --- Public Classes ---
+
+/**
+ * @brief Keeps the last raw samples and coarser min/max/avg buckets per topic.
+ * Each series is allocated once on its first sample, recording never allocates after that.
+ * Output is written straight to a Print (e.g. espIOTLib_pageWriter), oldest first.
+ */
+class espIOTLib_timeSeries
+{
+protected:
+    espIOTLib_tsSeries **_series;
+    size_t _capacity;
+    size_t _count = 0;
+
+    uint32_t _recorded = 0;
+    uint32_t _untracked = 0;
+
+    espIOTLib_tsSeries *_get(const char *topic, bool create);
+    void _rollup(espIOTLib_tsRollup *rollup, uint32_t period, uint32_t now, float value);
+    void _value(Print &out, float value);
+
+public:
+    espIOTLib_timeSeries(size_t capacity);
+    ~espIOTLib_timeSeries();
+
+    /**
+     * @brief Add a reading, a new topic takes a free series or is counted as untracked. NaN and inf are ignored
+     */
+    bool record(const char *topic, float value, uint32_t now);
+    /**
+     * @brief Write one level of a series
+     *
+     * @param level 0 for raw samples ("time,value"), 1..2 for the rollups ("time,min,max,avg,count")
+     * @return false if the topic or level is unknown, nothing was written then
+     */
+    bool write(Print &out, const char *topic, uint8_t level, espIOTLib_timeSeriesFormat format, uint32_t now);
+    /**
+     * @brief Write the list of recorded topics with their sample counts
+     */
+    void writeIndex(Print &out, espIOTLib_timeSeriesFormat format);
+
+    bool contains(const char *topic);
+    static uint32_t levelPeriod(uint8_t level);
+    size_t size();
+    size_t capacity();
+    uint32_t recordedCount();
+    uint32_t untrackedCount();
+};
+
+#endif /* ESPIOTLIB_TIMESERIES_H */
@@ -0,0 +1,135 @@
+/**
+ * @file espIOTLib_topicTree.cpp
+ * @author Paul Schlarmann (paul.schlarmann@makerspace-minden.de)
+ * @brief Topic level trie to dispatch MQTT messages to per-filter handlers
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) Paul Schlarmann 2023
+ *
+ */
+
+// --- Includes ---
+#include "espIOTLib_topicTree.h"
+
+// --- Private Functions ---
+espIOTLib_topicNode::~espIOTLib_topicNode(){
+    for(espIOTLib_topicNode *child : this->children)
+        delete child;
+    delete this->plus;
+}
+
+int espIOTLib_topicTree::_compareLevel(const String &level, const char *name, size_t length){
+    size_t levelLength = level.length();
+    int result = strncmp(level.c_str(), name, levelLength < length ? levelLength : length);
+    if(result != 0)
+        return result;
+    if(levelLength == length)
+        return 0;
+    return levelLength < length ? -1 : 1;
+}
+
+espIOTLib_topicNode *espIOTLib_topicTree::_findChild(espIOTLib_topicNode *node, const char *name, size_t length, bool create){
+    size_t low = 0;
+    size_t high = node->children.size();
+    while(low < high){
+        size_t mid = (low + high) / 2;
+        int result = _compareLevel(node->children[mid]->level, name, length);
+        if(result == 0)
+            return node->children[mid];
+        if(result < 0)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    if(!create)
+        return NULL;
+    espIOTLib_topicNode *child = new espIOTLib_topicNode();
+    child->level.reserve(length);
+    for(size_t i = 0; i < length; i++)
+        child->level += name[i];
+    node->children.insert(node->children.begin() + low, child);
+    return child;
+}
+
+// level points to the start of the current topic level, NULL once all levels are consumed
+size_t espIOTLib_topicTree::_match(espIOTLib_topicNode *node, const char *level, MQTTClient *client, char topic[], char bytes[], int length){
+    size_t called = 0;
+    // Wildcards must not match topics starting with '$' on the first level
+    bool wildcards = !(node == &this->_root && level && level[0] == '$');
+    if(wildcards){
+        for(espIOTLibMQTTCB handler : node->hashHandlers){
+            handler(client, topic, bytes, length);
+            called++;
+        }
+    }
+    if(!level){
+        for(espIOTLibMQTTCB handler : node->handlers){
+            handler(client, topic, bytes, length);
+            called++;
+        }
+        return called;
+    }
+    const char *end = strchr(level, '/');
+    size_t levelLength = end ? (size_t)(end - level) : strlen(level);
+    const char *next = end ? end + 1 : NULL;
+
+    espIOTLib_topicNode *child = this->_findChild(node, level, levelLength, false);
+    if(child)
+        called += this->_match(child, next, client, topic, bytes, length);
+    if(node->plus && wildcards)
+        called += this->_match(node->plus, next, client, topic, bytes, length);
+    return called;
+}
+
+// --- Public Functions ---
+bool espIOTLib_topicTree::isValidFilter(const char *filter){
+    if(!filter || filter[0] == '\0')
+        return false;
+    for(const char *c = filter; *c; c++){
+        bool levelStart = (c == filter || c[-1] == '/');
+        bool levelEnd = (c[1] == '\0' || c[1] == '/');
+        if(*c == '+' && !(levelStart && levelEnd))
+            return false;
+        if(*c == '#' && !(levelStart && c[1] == '\0'))
+            return false;
+    }
+    return true;
+}
+
+bool espIOTLib_topicTree::add(const char *filter, espIOTLibMQTTCB handler){
+    if(!handler || !isValidFilter(filter))
+        return false;
+    espIOTLib_topicNode *node = &this->_root;
+    const char *level = filter;
+    while(level){
+        const char *end = strchr(level, '/');
+        size_t levelLength = end ? (size_t)(end - level) : strlen(level);
+        if(levelLength == 1 && level[0] == '#'){
+            node->hashHandlers.push_back(handler);
+            this->_handlerCount++;
+            return true;
+        }
+        if(levelLength == 1 && level[0] == '+'){
+            if(!node->plus)
+                node->plus = new espIOTLib_topicNode();
+            node = node->plus;
+        } else {
+            node = this->_findChild(node, level, levelLength, true);
+        }
+        level = end ? end + 1 : NULL;
+    }
+    node->handlers.push_back(handler);
+    this->_handlerCount++;
+    return true;
+}
+
+size_t espIOTLib_topicTree::dispatch(MQTTClient *client, char topic[], char bytes[], int length){
+    if(!topic)
+        return 0;
+    return this->_match(&this->_root, topic, client, topic, bytes, length);
+}
+
+size_t espIOTLib_topicTree::handlerCount(){
+    return this->_handlerCount;
+}
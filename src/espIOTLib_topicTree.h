@@ -0,0 +1,59 @@
+/**
+ * @file espIOTLib_topicTree.h
+ * @author Paul Schlarmann (paul.schlarmann@makerspace-minden.de)
+ * @brief Topic level trie to dispatch MQTT messages to per-filter handlers
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) Paul Schlarmann 2023
+ *
+ */
+#ifndef ESPIOTLIB_TOPICTREE_H
+#define ESPIOTLIB_TOPICTREE_H
+
+// --- Includes ---
+#include <Arduino.h>
+
+#include <vector>
+
+#include <MQTT.h>
+
+// --- Typedefs ---
+typedef void (*espIOTLibMQTTCB)(MQTTClient *client, char topic[], char bytes[], int length);
+
+struct espIOTLib_topicNode{
+    String level;
+    std::vector<espIOTLib_topicNode *> children; // Sorted by level for binary search
+    espIOTLib_topicNode *plus = NULL;
+    std::vector<espIOTLibMQTTCB> handlers;
+    std::vector<espIOTLibMQTTCB> hashHandlers;   // Handlers of "<this level>/#"
+
+    ~espIOTLib_topicNode();
+};
+
+// --- Public Classes ---
+
+/**
+ * @brief Subscription filters split into levels, "+" and "#" get their own branches.
+ * A message only walks the branches matching its levels, so dispatch cost depends on
+ * topic depth and not on the number of registered filters.
+ */
+class espIOTLib_topicTree
+{
+protected:
+    espIOTLib_topicNode _root;
+    size_t _handlerCount = 0;
+
+    static int _compareLevel(const String &level, const char *name, size_t length);
+    espIOTLib_topicNode *_findChild(espIOTLib_topicNode *node, const char *name, size_t length, bool create);
+    size_t _match(espIOTLib_topicNode *node, const char *level, MQTTClient *client, char topic[], char bytes[], int length);
+
+public:
+    static bool isValidFilter(const char *filter);
+
+    bool add(const char *filter, espIOTLibMQTTCB handler);
+    size_t dispatch(MQTTClient *client, char topic[], char bytes[], int length);
+    size_t handlerCount();
+};
+
+#endif /* ESPIOTLIB_TOPICTREE_H */
@@ -0,0 +1,116 @@
+/**
+ * @file espIOTLib_wifiCache.cpp
+ * @author Paul Schlarmann (paul.schlarmann@makerspace-minden.de)
+ * @brief Last access point, channel and DHCP lease in RTC memory, for connecting without scan and DHCP
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) Paul Schlarmann 2023
+ *
+ */
+
+// --- Includes ---
+#include "espIOTLib_wifiCache.h"
+#include "espIOTLib_publishFilter.h"
+
+// --- Defines ---
+#ifdef ESP32
+// RTC slow memory keeps its content in deep sleep and over a software reset
+RTC_DATA_ATTR static espIOTLib_wifiCacheRecord rtcRecord;
+#endif
+
+// --- Private Functions ---
+// FNV-1a, only has to tell a record from random RTC content after power on
+uint32_t espIOTLib_wifiCache::_crc(const espIOTLib_wifiCacheRecord *record){
+    const uint8_t *data = (const uint8_t *)&record->ssidHash;
+    const uint8_t *end = (const uint8_t *)record + sizeof(espIOTLib_wifiCacheRecord);
+    uint32_t hash = 2166136261UL;
+    while(data < end){
+        hash ^= *data++;
+        hash *= 16777619UL;
+    }
+    return hash;
+}
+
+void espIOTLib_wifiCache::_write(){
+#ifdef ESP8266
+    ESP.rtcUserMemoryWrite(ESP_IOTLIB_WIFI_CACHE_RTC_OFFSET, (uint32_t *)&this->_record, sizeof(espIOTLib_wifiCacheRecord));
+#elif defined(ESP32)
+    memcpy(&rtcRecord, &this->_record, sizeof(espIOTLib_wifiCacheRecord));
+#endif
+    this->_writes++;
+}
+
+// --- Public Functions ---
+bool espIOTLib_wifiCache::load(const char *ssid){
+#ifdef ESP8266
+    if(!ESP.rtcUserMemoryRead(ESP_IOTLIB_WIFI_CACHE_RTC_OFFSET, (uint32_t *)&this->_record, sizeof(espIOTLib_wifiCacheRecord)))
+        memset(&this->_record, 0, sizeof(espIOTLib_wifiCacheRecord));
+#elif defined(ESP32)
+    memcpy(&this->_record, &rtcRecord, sizeof(espIOTLib_wifiCacheRecord));
+#endif
+    this->_valid = this->_record.magic == ESP_IOTLIB_WIFI_CACHE_MAGIC
+        && this->_record.crc == _crc(&this->_record)
+        && this->_record.ssidHash == espIOTLib_topicHash(ssid)
+        && this->_record.channel > 0;
+    return this->_valid;
+}
+
+void espIOTLib_wifiCache::store(const char *ssid, const uint8_t *bssid, uint8_t channel, bool lease, IPAddress ip, IPAddress gateway, IPAddress mask, IPAddress dns){
+    espIOTLib_wifiCacheRecord record;
+    memset(&record, 0, sizeof(espIOTLib_wifiCacheRecord));
+    record.ssidHash = espIOTLib_topicHash(ssid);
+    if(bssid)
+        memcpy(record.bssid, bssid, sizeof(record.bssid));
+    record.channel = channel;
+    if(lease){
+        record.hasLease = 1;
+        record.ip = (uint32_t)ip;
+        record.gateway = (uint32_t)gateway;
+        record.mask = (uint32_t)mask;
+        record.dns = (uint32_t)dns;
+    }
+    record.magic = ESP_IOTLIB_WIFI_CACHE_MAGIC;
+    record.crc = _crc(&record);
+    this->_valid = true;
+    if(memcmp(&record, &this->_record, sizeof(espIOTLib_wifiCacheRecord)) == 0)
+        return;
+    memcpy(&this->_record, &record, sizeof(espIOTLib_wifiCacheRecord));
+    this->_write();
+}
+
+void espIOTLib_wifiCache::invalidate(){
+    if(!this->_valid && this->_record.magic != ESP_IOTLIB_WIFI_CACHE_MAGIC)
+        return;
+    memset(&this->_record, 0, sizeof(espIOTLib_wifiCacheRecord));
+    this->_valid = false;
+    this->_write();
+}
+
+bool espIOTLib_wifiCache::valid(){
+    return this->_valid;
+}
+const uint8_t *espIOTLib_wifiCache::bssid(){
+    return this->_record.bssid;
+}
+uint8_t espIOTLib_wifiCache::channel(){
+    return this->_record.channel;
+}
+bool espIOTLib_wifiCache::hasLease(){
+    return this->_valid && this->_record.hasLease;
+}
+IPAddress espIOTLib_wifiCache::ip(){
+    return IPAddress(this->_record.ip);
+}
+IPAddress espIOTLib_wifiCache::gateway(){
+    return IPAddress(this->_record.gateway);
+}
+IPAddress espIOTLib_wifiCache::mask(){
+    return IPAddress(this->_record.mask);
+}
+IPAddress espIOTLib_wifiCache::dns(){
+    return IPAddress(this->_record.dns);
+}
+uint32_t espIOTLib_wifiCache::writeCount(){
+    return this->_writes;
+}
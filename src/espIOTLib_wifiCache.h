@@ -0,0 +1,86 @@
+/**
+ * @file espIOTLib_wifiCache.h
+ * @author Paul Schlarmann (paul.schlarmann@makerspace-minden.de)
+ * @brief Last access point, channel and DHCP lease in RTC memory, for connecting without scan and DHCP
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) Paul Schlarmann 2023
+ *
+ */
+#ifndef ESPIOTLIB_WIFICACHE_H
+#define ESPIOTLIB_WIFICACHE_H
+
+// --- Includes ---
+#include <Arduino.h>
+
+// --- Defines ---
+// Start of the record in the RTC user memory of the ESP8266, in 4 byte blocks
+#ifndef ESP_IOTLIB_WIFI_CACHE_RTC_OFFSET
+    #define ESP_IOTLIB_WIFI_CACHE_RTC_OFFSET 0
+#endif
+// A fast connect that did not succeed within this time falls back to scan and DHCP
+#ifndef ESP_IOTLIB_FAST_CONNECT_TIMEOUT
+    #define ESP_IOTLIB_FAST_CONNECT_TIMEOUT 3000
+#endif
+#define ESP_IOTLIB_WIFI_CACHE_MAGIC 0x57434331UL
+
+// --- Typedefs ---
+// Multiple of 4 bytes, the ESP8266 RTC memory is written in blocks
+struct espIOTLib_wifiCacheRecord{
+    uint32_t magic;
+    uint32_t crc;       // Over everything after this field
+    uint32_t ssidHash;  // A record of another network is never used
+    uint8_t bssid[6];
+    uint8_t channel;
+    uint8_t hasLease;   // ip..dns are valid
+    uint32_t ip;
+    uint32_t gateway;
+    uint32_t mask;
+    uint32_t dns;
+};
+
+// --- Public Classes ---
+
+/**
+ * @brief Keeps the BSSID and channel of the last successful connection and, if wanted, the IP settings DHCP handed out.
+ * The record lives in RTC memory and survives resets and deep sleep (ESP8266 RTC user memory, ESP32 RTC slow memory),
+ * but not a power cycle. It is checked with magic and CRC, so garbage after power on is never used.
+ */
+class espIOTLib_wifiCache
+{
+protected:
+    espIOTLib_wifiCacheRecord _record = {};
+    bool _valid = false;
+    uint32_t _writes = 0;
+
+    static uint32_t _crc(const espIOTLib_wifiCacheRecord *record);
+    void _write();
+
+public:
+    /**
+     * @brief Read the record from RTC memory
+     *
+     * @return true if there is a valid one for ssid
+     */
+    bool load(const char *ssid);
+    /**
+     * @brief Remember the current connection, RTC memory is only written if something changed
+     *
+     * @param lease Also remember ip/gateway/mask/dns
+     */
+    void store(const char *ssid, const uint8_t *bssid, uint8_t channel, bool lease, IPAddress ip, IPAddress gateway, IPAddress mask, IPAddress dns);
+    void invalidate();
+
+    bool valid();
+    const uint8_t *bssid();
+    uint8_t channel();
+    bool hasLease();
+    IPAddress ip();
+    IPAddress gateway();
+    IPAddress mask();
+    IPAddress dns();
+    uint32_t writeCount();
+};
+
+#endif /* ESPIOTLIB_WIFICACHE_H */